@@ -892,6 +892,11 @@ void bt_config_destroy(struct bt_object *obj)
 			g_ptr_array_free(cfg->cmd_data.run.connections,
 				TRUE);
 		}
+
+		if (cfg->cmd_data.run.checkpoint_path) {
+			g_string_free(cfg->cmd_data.run.checkpoint_path,
+				TRUE);
+		}
 		break;
 	case BT_CONFIG_COMMAND_LIST_PLUGINS:
 		break;
@@ -904,6 +909,10 @@ void bt_config_destroy(struct bt_object *obj)
 		if (cfg->cmd_data.query.object) {
 			g_string_free(cfg->cmd_data.query.object, TRUE);
 		}
+
+		if (cfg->cmd_data.query.cache_dir) {
+			g_string_free(cfg->cmd_data.query.cache_dir, TRUE);
+		}
 		break;
 	case BT_CONFIG_COMMAND_PRINT_CTF_METADATA:
 		if (cfg->cmd_data.print_ctf_metadata.path) {
@@ -1294,6 +1303,9 @@ enum {
 	OPT_NONE = 0,
 	OPT_BASE_PARAMS,
 	OPT_BEGIN,
+	OPT_CACHE_DIR,
+	OPT_CHECKPOINT,
+	OPT_CHECKPOINT_INTERVAL,
 	OPT_CLOCK_CYCLES,
 	OPT_CLOCK_DATE,
 	OPT_CLOCK_FORCE_CORRELATE,
@@ -1314,6 +1326,7 @@ enum {
 	OPT_INPUT_FORMAT,
 	OPT_KEY,
 	OPT_LIST,
+	OPT_MEMORY_BUDGET,
 	OPT_NAME,
 	OPT_NAMES,
 	OPT_NO_DEBUG_INFO,
@@ -1326,6 +1339,7 @@ enum {
 	OPT_PATH,
 	OPT_PLUGIN_PATH,
 	OPT_RESET_BASE_PARAMS,
+	OPT_RESUME,
 	OPT_RETRY_DURATION,
 	OPT_RUN_ARGS,
 	OPT_RUN_ARGS_0,
@@ -1954,6 +1968,8 @@ void print_query_usage(FILE *fp)
 	fprintf(fp, "\n");
 	fprintf(fp, "Options:\n");
 	fprintf(fp, "\n");
+	fprintf(fp, "      --cache-dir=DIR               Reuse the results of identical queries\n");
+	fprintf(fp, "                                    on unchanged files cached in DIR\n");
 	fprintf(fp, "  -c, --component=TYPE.PLUGIN.CLS   Query the component class CLS of type TYPE\n");
 	fprintf(fp, "                                    (`source`, `filter`, or `sink`) found in\n");
 	fprintf(fp, "                                    the plugin PLUGIN\n");
@@ -1972,6 +1988,7 @@ void print_query_usage(FILE *fp)
 static
 struct poptOption query_long_options[] = {
 	/* longName, shortName, argInfo, argPtr, value, descrip, argDesc */
+	{ "cache-dir", '\0', POPT_ARG_STRING, NULL, OPT_CACHE_DIR, NULL, NULL },
 	{ "component", 'c', POPT_ARG_STRING, NULL, OPT_COMPONENT, NULL, NULL },
 	{ "help", 'h', POPT_ARG_NONE, NULL, OPT_HELP, NULL, NULL },
 	{ "omit-home-plugin-path", '\0', POPT_ARG_NONE, NULL, OPT_OMIT_HOME_PLUGIN_PATH, NULL, NULL },
@@ -2040,6 +2057,18 @@ struct bt_config *bt_config_query_from_args(int argc, const char *argv[],
 		case OPT_OMIT_HOME_PLUGIN_PATH:
 			cfg->omit_home_plugin_path = true;
 			break;
+		case OPT_CACHE_DIR:
+			if (cfg->cmd_data.query.cache_dir) {
+				printf_err("Duplicate --cache-dir option\n");
+				goto error;
+			}
+
+			cfg->cmd_data.query.cache_dir = g_string_new(arg);
+			if (!cfg->cmd_data.query.cache_dir) {
+				print_err_oom();
+				goto error;
+			}
+			break;
 		case OPT_COMPONENT:
 			if (cfg->cmd_data.query.cfg_component) {
 				printf_err("Cannot specify more than one plugin and component class:\n    %s\n",
@@ -2282,6 +2311,59 @@ end:
 	return cfg;
 }
 
+/*
+ * Parses a size in bytes, with an optional `K`, `M`, or `G` binary
+ * prefix, from `arg`.
+ *
+ * Returns 0 on success.
+ */
+static
+int parse_size(const char *arg, uint64_t *size)
+{
+	int ret = 0;
+	char *endptr;
+	uint64_t value;
+	unsigned int shift = 0;
+
+	errno = 0;
+	value = g_ascii_strtoull(arg, &endptr, 10);
+	if (endptr == arg || errno != 0 || arg[0] == '-') {
+		ret = -1;
+		goto end;
+	}
+
+	switch (*endptr) {
+	case '\0':
+		break;
+	case 'K':
+	case 'k':
+		shift = 10;
+		endptr++;
+		break;
+	case 'M':
+		shift = 20;
+		endptr++;
+		break;
+	case 'G':
+		shift = 30;
+		endptr++;
+		break;
+	default:
+		ret = -1;
+		goto end;
+	}
+
+	if (*endptr != '\0' || value > (UINT64_MAX >> shift)) {
+		ret = -1;
+		goto end;
+	}
+
+	*size = value << shift;
+
+end:
+	return ret;
+}
+
 /*
  * Prints the run command usage.
  */
@@ -2296,6 +2378,10 @@ void print_run_usage(FILE *fp)
 	fprintf(fp, "                                    for all the following components until\n");
 	fprintf(fp, "                                    --reset-base-params is encountered\n");
 	fprintf(fp, "                                    (see the expected format of PARAMS below)\n");
+	fprintf(fp, "      --checkpoint=PATH             Periodically write the graph's progress to\n");
+	fprintf(fp, "                                    the checkpoint state file PATH (replaced)\n");
+	fprintf(fp, "      --checkpoint-interval=COUNT   Write a checkpoint every COUNT packets\n");
+	fprintf(fp, "                                    (default: 100)\n");
 	fprintf(fp, "  -c, --component=[NAME:]TYPE.PLUGIN.CLS\n");
 	fprintf(fp, "                                    Instantiate the component class CLS of type\n");
 	fprintf(fp, "                                    TYPE (`source`, `filter`, or `sink`) found\n");
@@ -2306,6 +2392,9 @@ void print_run_usage(FILE *fp)
 	fprintf(fp, "                                    expected format of CONNECTION below)\n");
 	fprintf(fp, "      --key=KEY                     Set the current initialization string\n");
 	fprintf(fp, "                                    parameter key to KEY (see --value)\n");
+	fprintf(fp, "      --memory-budget=SIZE          Ask the components to keep the memory they\n");
+	fprintf(fp, "                                    map or buffer within SIZE bytes (suffixes:\n");
+	fprintf(fp, "                                    K, M, and G)\n");
 	fprintf(fp, "  -n, --name=NAME                   Set the name of the current component\n");
 	fprintf(fp, "                                    to NAME (must be unique amongst all the\n");
 	fprintf(fp, "                                    names of the created components)\n");
@@ -2319,6 +2408,9 @@ void print_run_usage(FILE *fp)
 	fprintf(fp, "                                    dynamic plugins can be loaded\n");
 	fprintf(fp, "  -r, --reset-base-params           Reset the current base parameters to an\n");
 	fprintf(fp, "                                    empty map\n");
+	fprintf(fp, "      --resume=PATH                 Resume the interrupted run which wrote the\n");
+	fprintf(fp, "                                    checkpoint state file PATH, and keep\n");
+	fprintf(fp, "                                    writing checkpoints to PATH\n");
 	fprintf(fp, "      --retry-duration=DUR          When babeltrace(1) needs to retry to run\n");
 	fprintf(fp, "                                    the graph later, retry in DUR µs\n");
 	fprintf(fp, "                                    (default: 100000)\n");
@@ -2364,6 +2456,18 @@ void print_run_usage(FILE *fp)
 	fprintf(fp, "IMPORTANT: Make sure to single-quote the whole argument when you run\n");
 	fprintf(fp, "babeltrace from a shell.\n");
 	fprintf(fp, "\n\n");
+	fprintf(fp, "Checkpoints\n");
+	fprintf(fp, "-----------\n");
+	fprintf(fp, "\n");
+	fprintf(fp, "With --checkpoint or --resume, the components whose class supports\n");
+	fprintf(fp, "checkpoints (`source.ctf.fs` and `sink.ctf.fs`) receive the\n");
+	fprintf(fp, "`checkpoint-path` (string), `checkpoint-interval` (integer), and `resume`\n");
+	fprintf(fp, "(boolean) initialization parameters. They record their progress in the\n");
+	fprintf(fp, "checkpoint state file and, when resuming, restart from the first packet\n");
+	fprintf(fp, "of each stream which was not completely written by the sink. The sink\n");
+	fprintf(fp, "appends to the trace directories it was writing. The other components\n");
+	fprintf(fp, "keep their parameters unchanged.\n");
+	fprintf(fp, "\n\n");
 	print_expected_params_format(fp);
 }
 
@@ -2392,18 +2496,23 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 	GString *cur_param_key = NULL;
 	char error_buf[256] = { 0 };
 	long long retry_duration = -1;
+	long long checkpoint_interval = 100;
 	struct poptOption run_long_options[] = {
 		{ "base-params", 'b', POPT_ARG_STRING, NULL, OPT_BASE_PARAMS, NULL, NULL },
+		{ "checkpoint", '\0', POPT_ARG_STRING, NULL, OPT_CHECKPOINT, NULL, NULL },
+		{ "checkpoint-interval", '\0', POPT_ARG_LONGLONG, &checkpoint_interval, OPT_CHECKPOINT_INTERVAL, NULL, NULL },
 		{ "component", 'c', POPT_ARG_STRING, NULL, OPT_COMPONENT, NULL, NULL },
 		{ "connect", 'C', POPT_ARG_STRING, NULL, OPT_CONNECT, NULL, NULL },
 		{ "help", 'h', POPT_ARG_NONE, NULL, OPT_HELP, NULL, NULL },
 		{ "key", '\0', POPT_ARG_STRING, NULL, OPT_KEY, NULL, NULL },
+		{ "memory-budget", '\0', POPT_ARG_STRING, NULL, OPT_MEMORY_BUDGET, NULL, NULL },
 		{ "name", 'n', POPT_ARG_STRING, NULL, OPT_NAME, NULL, NULL },
 		{ "omit-home-plugin-path", '\0', POPT_ARG_NONE, NULL, OPT_OMIT_HOME_PLUGIN_PATH, NULL, NULL },
 		{ "omit-system-plugin-path", '\0', POPT_ARG_NONE, NULL, OPT_OMIT_SYSTEM_PLUGIN_PATH, NULL, NULL },
 		{ "params", 'p', POPT_ARG_STRING, NULL, OPT_PARAMS, NULL, NULL },
 		{ "plugin-path", '\0', POPT_ARG_STRING, NULL, OPT_PLUGIN_PATH, NULL, NULL },
 		{ "reset-base-params", 'r', POPT_ARG_NONE, NULL, OPT_RESET_BASE_PARAMS, NULL, NULL },
+		{ "resume", '\0', POPT_ARG_STRING, NULL, OPT_RESUME, NULL, NULL },
 		{ "retry-duration", '\0', POPT_ARG_LONGLONG, &retry_duration, OPT_RETRY_DURATION, NULL, NULL },
 		{ "value", '\0', POPT_ARG_STRING, NULL, OPT_VALUE, NULL, NULL },
 		{ NULL, 0, '\0', NULL, 0, NULL, NULL },
@@ -2629,6 +2738,35 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 			cfg->cmd_data.run.retry_duration_us =
 				(uint64_t) retry_duration;
 			break;
+		case OPT_MEMORY_BUDGET:
+			if (parse_size(arg, &cfg->cmd_data.run.memory_budget)) {
+				printf_err("Invalid --memory-budget option's argument: %s\n",
+					arg);
+				goto error;
+			}
+			break;
+		case OPT_CHECKPOINT:
+		case OPT_RESUME:
+			if (cfg->cmd_data.run.checkpoint_path) {
+				printf_err("Duplicate --checkpoint or --resume option\n");
+				goto error;
+			}
+
+			cfg->cmd_data.run.checkpoint_path = g_string_new(arg);
+			if (!cfg->cmd_data.run.checkpoint_path) {
+				print_err_oom();
+				goto error;
+			}
+
+			cfg->cmd_data.run.resume = opt == OPT_RESUME;
+			break;
+		case OPT_CHECKPOINT_INTERVAL:
+			if (checkpoint_interval <= 0) {
+				printf_err("--checkpoint-interval option's argument must be greater than 0: %lld\n",
+					checkpoint_interval);
+				goto error;
+			}
+			break;
 		case OPT_HELP:
 			print_run_usage(stdout);
 			*retcode = -1;
@@ -2677,6 +2815,8 @@ struct bt_config *bt_config_run_from_args(int argc, const char *argv[],
 		goto error;
 	}
 
+	cfg->cmd_data.run.checkpoint_interval = (uint64_t) checkpoint_interval;
+
 	if (append_home_and_system_plugin_paths_cfg(cfg)) {
 		goto error;
 	}
@@ -2769,6 +2909,9 @@ void print_convert_usage(FILE *fp)
 	fprintf(fp, "                                    conversion graph, and optionally name it\n");
 	fprintf(fp, "                                    NAME (you can also specify the name with\n");
 	fprintf(fp, "                                    --name)\n");
+	fprintf(fp, "      --memory-budget=SIZE          Ask the components to keep the memory they\n");
+	fprintf(fp, "                                    map or buffer within SIZE bytes (suffixes:\n");
+	fprintf(fp, "                                    K, M, and G)\n");
 	fprintf(fp, "      --name=NAME                   Set the name of the current component\n");
 	fprintf(fp, "                                    to NAME (must be unique amongst all the\n");
 	fprintf(fp, "                                    names of the created components)\n");
@@ -2909,6 +3052,7 @@ struct poptOption convert_long_options[] = {
 	{ "fields", 'f', POPT_ARG_STRING, NULL, OPT_FIELDS, NULL, NULL },
 	{ "help", 'h', POPT_ARG_NONE, NULL, OPT_HELP, NULL, NULL },
 	{ "input-format", 'i', POPT_ARG_STRING, NULL, OPT_INPUT_FORMAT, NULL, NULL },
+	{ "memory-budget", '\0', POPT_ARG_STRING, NULL, OPT_MEMORY_BUDGET, NULL, NULL },
 	{ "name", '\0', POPT_ARG_STRING, NULL, OPT_NAME, NULL, NULL },
 	{ "names", 'n', POPT_ARG_STRING, NULL, OPT_NAMES, NULL, NULL },
 	{ "no-debug-info", '\0', POPT_ARG_NONE, NULL, OPT_NO_DEBUG_INFO, NULL, NULL },
@@ -3912,6 +4056,18 @@ struct bt_config *bt_config_convert_from_args(int argc, const char *argv[],
 				goto error;
 			}
 
+			if (bt_value_array_append_string(run_args, arg)) {
+				print_err_oom();
+				goto error;
+			}
+			break;
+		case OPT_MEMORY_BUDGET:
+			if (bt_value_array_append_string(run_args,
+					"--memory-budget")) {
+				print_err_oom();
+				goto error;
+			}
+
 			if (bt_value_array_append_string(run_args, arg)) {
 				print_err_oom();
 				goto error;
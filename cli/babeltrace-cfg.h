@@ -91,6 +91,21 @@ struct bt_config {
 			 * to retry to run the graph.
 			 */
 			uint64_t retry_duration_us;
+
+			/*
+			 * Checkpoint state file path, or `NULL` if
+			 * checkpoints are disabled.
+			 */
+			GString *checkpoint_path;
+
+			/* Number of packets between two checkpoints */
+			uint64_t checkpoint_interval;
+
+			/* Resume from the checkpoint state file */
+			bool resume;
+
+			/* Graph's memory budget (bytes), 0 if none */
+			uint64_t memory_budget;
 		} run;
 
 		/* BT_CONFIG_COMMAND_HELP */
@@ -102,6 +117,12 @@ struct bt_config {
 		struct {
 			GString *object;
 			struct bt_config_component *cfg_component;
+
+			/*
+			 * Query result cache directory, or `NULL` if
+			 * the cache is disabled.
+			 */
+			GString *cache_dir;
 		} query;
 
 		/* BT_CONFIG_COMMAND_PRINT_CTF_METADATA */
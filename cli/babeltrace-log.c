@@ -34,29 +34,37 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
 #include <inttypes.h>
+#include <limits.h>
+#include <assert.h>
 #include <glib.h>
 #include <glib/gstdio.h>
 
 #include <babeltrace/babeltrace-internal.h>
-#include <babeltrace/ctf/types.h>
+#include <babeltrace/align-internal.h>
 #include <babeltrace/compat/uuid-internal.h>
 #include <babeltrace/compat/utc-internal.h>
-#include <babeltrace/compat/stdio-internal.h>
 #include <babeltrace/endian-internal.h>
+#include "../plugins/ctf/fs-src/lttng-index.h"
 
 #define NSEC_PER_USEC 1000UL
 #define NSEC_PER_MSEC 1000000UL
 #define NSEC_PER_SEC 1000000000ULL
 #define USEC_PER_SEC 1000000UL
 
-bool babeltrace_debug, babeltrace_verbose;
+#define PACKET_MAGIC		0xC1FC1FC1
+#define PACKET_LEN_PAGES	8
+#define INPUT_CHUNK_LEN		(4 * 1024 * 1024)
+
+bt_bool babeltrace_debug, babeltrace_verbose;
 
 static char *s_outputname;
 static int s_timestamp;
+static int s_index;
 static int s_help;
 static unsigned char s_uuid[BABELTRACE_UUID_LEN];
 
@@ -78,10 +86,12 @@ static const char metadata_fmt[] =
 "	};\n"
 "};\n"
 "\n"
+"%s"					/* Clock (opt.) */
 "stream {\n"
 "	packet.context := struct {\n"
 "		uint64_t content_size;\n"
 "		uint64_t packet_size;\n"
+"%s"					/* Packet time bounds (opt.) */
 "	};\n"
 "%s"					/* Stream event header (opt.) */
 "};\n"
@@ -91,12 +101,70 @@ static const char metadata_fmt[] =
 "	fields := struct { string str; };\n"
 "};\n";
 
+static const char metadata_clock[] =
+"clock {\n"
+"	name = log;\n"
+"	description = \"Log line timestamps\";\n"
+"	freq = 1000000000;\n"
+"	offset = 0;\n"
+"};\n"
+"\n"
+"typealias integer {\n"
+"	size = 64; align = 64; signed = false;\n"
+"	map = clock.log.value;\n"
+"} := uint64_clock_log_t;\n"
+"\n";
+
+static const char metadata_packet_context_timestamps[] =
+"		uint64_clock_log_t timestamp_begin;\n"
+"		uint64_clock_log_t timestamp_end;\n";
+
 static const char metadata_stream_event_header_timestamp[] =
-"	typealias integer { size = 64; align = 64; signed = false; } := uint64_t;\n"
 "	event.header := struct {\n"
-"		uint64_t timestamp;\n"
+"		uint64_clock_log_t timestamp;\n"
 "	};\n";
 
+/*
+ * Fixed layout of a packet's header and context, in bytes. All the
+ * fields are naturally aligned and written in the native byte order.
+ */
+#define PACKET_MAGIC_OFFSET		0
+#define PACKET_UUID_OFFSET		4
+#define PACKET_CONTENT_SIZE_OFFSET	24
+#define PACKET_PACKET_SIZE_OFFSET	32
+#define PACKET_TS_BEGIN_OFFSET		40
+#define PACKET_TS_END_OFFSET		48
+
+/* Data stream writer */
+struct log_writer {
+	int fd;
+	FILE *index_fp;
+
+	/* Current packet, `packet_len` bytes */
+	uint8_t *packet;
+	size_t packet_len;
+
+	/* Size of the packet header and context (bytes) */
+	size_t packet_ctx_len;
+
+	/* Current position within the current packet (bytes) */
+	size_t at;
+
+	/* Offset of the current packet within the data stream file */
+	uint64_t packet_offset;
+
+	/* Time bounds of the current packet's events */
+	uint64_t ts_begin, ts_end;
+	bool packet_has_events;
+};
+
+/* Last broken-down time converted by bt_timegm(), minute precision */
+struct timegm_cache {
+	bool valid;
+	unsigned long year, mon, mday, hour, min;
+	time_t ep_sec;
+};
+
 static
 void print_metadata(FILE *fp)
 {
@@ -113,238 +181,492 @@ void print_metadata(FILE *fp)
 		minor,
 		uuid_str,
 		BYTE_ORDER == LITTLE_ENDIAN ? "le" : "be",
+		s_timestamp ? metadata_clock : "",
+		s_timestamp ? metadata_packet_context_timestamps : "",
 		s_timestamp ? metadata_stream_event_header_timestamp : "");
 }
 
 static
-void write_packet_header(struct ctf_stream_pos *pos, unsigned char *uuid)
+int write_all(int fd, const void *buf, size_t len)
 {
-	struct ctf_stream_pos dummy;
+	const uint8_t *p = buf;
 
-	/* magic */
-	ctf_dummy_pos(pos, &dummy);
-	if (!ctf_align_pos(&dummy, sizeof(uint32_t) * CHAR_BIT))
-		goto error;
-	if (!ctf_move_pos(&dummy, sizeof(uint32_t) * CHAR_BIT))
-		goto error;
-	assert(!ctf_pos_packet(&dummy));
+	while (len > 0) {
+		ssize_t ret = write(fd, p, len);
 
-	if (!ctf_align_pos(pos, sizeof(uint32_t) * CHAR_BIT))
-		goto error;
-	*(uint32_t *) ctf_get_pos_addr(pos) = 0xC1FC1FC1;
-	if (!ctf_move_pos(pos, sizeof(uint32_t) * CHAR_BIT))
-		goto error;
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
 
-	/* uuid */
-	ctf_dummy_pos(pos, &dummy);
-	if (!ctf_align_pos(&dummy, sizeof(uint8_t) * CHAR_BIT))
-		goto error;
-	if (!ctf_move_pos(&dummy, 16 * CHAR_BIT))
-		goto error;
-	assert(!ctf_pos_packet(&dummy));
+			perror("write");
+			return -1;
+		}
 
-	if (!ctf_align_pos(pos, sizeof(uint8_t) * CHAR_BIT))
-		goto error;
-	memcpy(ctf_get_pos_addr(pos), uuid, BABELTRACE_UUID_LEN);
-	if (!ctf_move_pos(pos, BABELTRACE_UUID_LEN * CHAR_BIT))
-		goto error;
-	return;
+		p += ret;
+		len -= ret;
+	}
 
-error:
-	fprintf(stderr, "[error] Out of packet bounds when writing packet header\n");
-	abort();
+	return 0;
 }
 
 static
-void write_packet_context(struct ctf_stream_pos *pos)
+void write_u64(uint8_t *addr, uint64_t val)
 {
-	struct ctf_stream_pos dummy;
+	memcpy(addr, &val, sizeof(val));
+}
 
-	/* content_size */
-	ctf_dummy_pos(pos, &dummy);
-	if (!ctf_align_pos(&dummy, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
-	if (!ctf_move_pos(&dummy, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
-	assert(!ctf_pos_packet(&dummy));
+static
+void begin_packet(struct log_writer *writer)
+{
+	const uint32_t magic = PACKET_MAGIC;
+
+	/*
+	 * The packet header and the constant part of the packet
+	 * context are the same for all the packets: only the content
+	 * size and the time bounds are written when closing the
+	 * packet.
+	 */
+	memset(writer->packet, 0, writer->packet_len);
+	memcpy(&writer->packet[PACKET_MAGIC_OFFSET], &magic, sizeof(magic));
+	memcpy(&writer->packet[PACKET_UUID_OFFSET], s_uuid,
+		BABELTRACE_UUID_LEN);
+	write_u64(&writer->packet[PACKET_PACKET_SIZE_OFFSET],
+		(uint64_t) writer->packet_len * CHAR_BIT);
+	writer->at = writer->packet_ctx_len;
+	writer->ts_begin = 0;
+	writer->ts_end = 0;
+	writer->packet_has_events = false;
+}
 
-	if (!ctf_align_pos(pos, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
-	*(uint64_t *) ctf_get_pos_addr(pos) = ~0ULL;	/* Not known yet */
-	pos->content_size_loc = (uint64_t *) ctf_get_pos_addr(pos);
-	if (!ctf_move_pos(pos, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
+static
+int write_index_entry(struct log_writer *writer)
+{
+	struct ctf_packet_index entry;
+
+	memset(&entry, 0, sizeof(entry));
+	entry.offset = htobe64(writer->packet_offset);
+	entry.packet_size = htobe64((uint64_t) writer->packet_len * CHAR_BIT);
+	entry.content_size = htobe64((uint64_t) writer->at * CHAR_BIT);
+	entry.timestamp_begin = htobe64(writer->ts_begin);
+	entry.timestamp_end = htobe64(writer->ts_end);
+	if (fwrite(&entry, sizeof(entry), 1, writer->index_fp) != 1) {
+		perror("fwrite");
+		return -1;
+	}
 
-	/* packet_size */
-	ctf_dummy_pos(pos, &dummy);
-	if (!ctf_align_pos(&dummy, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
-	if (!ctf_move_pos(&dummy, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
-	assert(!ctf_pos_packet(&dummy));
+	return 0;
+}
 
-	if (!ctf_align_pos(pos, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
-	*(uint64_t *) ctf_get_pos_addr(pos) = pos->packet_size;
-	if (!ctf_move_pos(pos, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
-	return;
+static
+int end_packet(struct log_writer *writer)
+{
+	int ret;
 
-error:
-	fprintf(stderr, "[error] Out of packet bounds when writing packet context\n");
-	abort();
+	write_u64(&writer->packet[PACKET_CONTENT_SIZE_OFFSET],
+		(uint64_t) writer->at * CHAR_BIT);
+	if (s_timestamp) {
+		write_u64(&writer->packet[PACKET_TS_BEGIN_OFFSET],
+			writer->ts_begin);
+		write_u64(&writer->packet[PACKET_TS_END_OFFSET],
+			writer->ts_end);
+	}
+
+	ret = write_all(writer->fd, writer->packet, writer->packet_len);
+	if (ret) {
+		goto end;
+	}
+
+	if (writer->index_fp) {
+		ret = write_index_entry(writer);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	writer->packet_offset += writer->packet_len;
+
+end:
+	return ret;
 }
 
+/*
+ * Parses an unsigned decimal integer at `*p` (before `end`), moving
+ * `*p` after its last digit. Returns the number of parsed digits.
+ */
 static
-void write_event_header(struct ctf_stream_pos *pos, char *line,
-			char **tline, size_t len, size_t *tlen,
-			uint64_t *ts)
+int parse_ulong(const char **p, const char *end, unsigned long *val)
 {
-	if (!s_timestamp)
-		return;
-
-	/* Only need to be executed on first pass (dummy) */
-	if (pos->dummy)	{
-		int has_timestamp = 0;
-		unsigned long sec, usec, msec;
-		unsigned int year, mon, mday, hour, min;
-
-		/* Extract time from input line */
-		if (sscanf(line, "[%lu.%lu] ", &sec, &usec) == 2) {
-			*ts = (uint64_t) sec * USEC_PER_SEC + (uint64_t) usec;
-			/*
-			 * Default CTF clock has 1GHz frequency. Convert
-			 * from usec to nsec.
-			 */
-			*ts *= NSEC_PER_USEC;
-			has_timestamp = 1;
-		} else if (sscanf(line, "[%u-%u-%u %u:%u:%lu.%lu] ",
-				&year, &mon, &mday, &hour, &min,
-				&sec, &msec) == 7) {
-			time_t ep_sec;
-			struct tm ti;
-
-			memset(&ti, 0, sizeof(ti));
-			ti.tm_year = year - 1900;	/* from 1900 */
-			ti.tm_mon = mon - 1;		/* 0 to 11 */
-			ti.tm_mday = mday;
-			ti.tm_hour = hour;
-			ti.tm_min = min;
-			ti.tm_sec = sec;
-
-			ep_sec = bt_timegm(&ti);
-			if (ep_sec != (time_t) -1) {
-				*ts = (uint64_t) ep_sec * NSEC_PER_SEC
-					+ (uint64_t) msec * NSEC_PER_MSEC;
-			}
-			has_timestamp = 1;
+	int digits = 0;
+
+	*val = 0;
+	while (*p < end && **p >= '0' && **p <= '9') {
+		*val = *val * 10 + (unsigned long) (**p - '0');
+		(*p)++;
+		digits++;
+	}
+
+	return digits;
+}
+
+static
+bool parse_char(const char **p, const char *end, char c)
+{
+	if (*p < end && **p == c) {
+		(*p)++;
+		return true;
+	}
+
+	return false;
+}
+
+static
+time_t cached_timegm(struct timegm_cache *cache, unsigned long year,
+		unsigned long mon, unsigned long mday, unsigned long hour,
+		unsigned long min)
+{
+	struct tm ti;
+
+	if (cache->valid && cache->year == year && cache->mon == mon &&
+			cache->mday == mday && cache->hour == hour &&
+			cache->min == min) {
+		return cache->ep_sec;
+	}
+
+	memset(&ti, 0, sizeof(ti));
+	ti.tm_year = year - 1900;	/* from 1900 */
+	ti.tm_mon = mon - 1;		/* 0 to 11 */
+	ti.tm_mday = mday;
+	ti.tm_hour = hour;
+	ti.tm_min = min;
+	cache->ep_sec = bt_timegm(&ti);
+	cache->year = year;
+	cache->mon = mon;
+	cache->mday = mday;
+	cache->hour = hour;
+	cache->min = min;
+	cache->valid = true;
+	return cache->ep_sec;
+}
+
+/*
+ * Extracts the timestamp of a line having one of those formats:
+ *
+ *     [SEC.USEC] TEXT
+ *     [YYYY-MM-DD HH:MM:SS.MSEC] TEXT
+ *
+ * On success, sets `*ts` (ns) and `*text` (start of TEXT) and returns
+ * true.
+ */
+static
+bool parse_timestamp(const char *line, const char *end,
+		struct timegm_cache *cache, uint64_t *ts, const char **text)
+{
+	const char *p = line;
+	unsigned long first, sec, frac;
+
+	if (!parse_char(&p, end, '[') || !parse_ulong(&p, end, &first)) {
+		return false;
+	}
+
+	if (parse_char(&p, end, '.')) {
+		if (!parse_ulong(&p, end, &frac)) {
+			return false;
 		}
-		if (has_timestamp) {
-			*tline = strchr(line, ']');
-			assert(*tline);
-			(*tline)++;
-			if ((*tline)[0] == ' ') {
-				(*tline)++;
-			}
-			*tlen = len + line - *tline;
+
+		/*
+		 * Default CTF clock has 1GHz frequency. Convert from
+		 * usec to nsec.
+		 */
+		*ts = ((uint64_t) first * USEC_PER_SEC + (uint64_t) frac) *
+			NSEC_PER_USEC;
+	} else {
+		unsigned long mon, mday, hour, min;
+		time_t ep_sec;
+
+		if (!parse_char(&p, end, '-') ||
+				!parse_ulong(&p, end, &mon) ||
+				!parse_char(&p, end, '-') ||
+				!parse_ulong(&p, end, &mday) ||
+				!parse_char(&p, end, ' ') ||
+				!parse_ulong(&p, end, &hour) ||
+				!parse_char(&p, end, ':') ||
+				!parse_ulong(&p, end, &min) ||
+				!parse_char(&p, end, ':') ||
+				!parse_ulong(&p, end, &sec) ||
+				!parse_char(&p, end, '.') ||
+				!parse_ulong(&p, end, &frac)) {
+			return false;
+		}
+
+		ep_sec = cached_timegm(cache, first, mon, mday, hour, min);
+		*ts = 0;
+		if (ep_sec != (time_t) -1) {
+			*ts = ((uint64_t) ep_sec + sec) * NSEC_PER_SEC +
+				(uint64_t) frac * NSEC_PER_MSEC;
 		}
 	}
-	/* timestamp */
-	if (!ctf_align_pos(pos, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
-	if (!pos->dummy)
-		*(uint64_t *) ctf_get_pos_addr(pos) = *ts;
-	if (!ctf_move_pos(pos, sizeof(uint64_t) * CHAR_BIT))
-		goto error;
-	return;
 
-error:
-	fprintf(stderr, "[error] Out of packet bounds when writing event header\n");
-	abort();
+	p = memchr(p, ']', end - p);
+	if (!p) {
+		return false;
+	}
+
+	p++;
+	parse_char(&p, end, ' ');
+	*text = p;
+	return true;
 }
 
+/*
+ * Writes one event for the line `line` of `len` bytes (without its
+ * newline character).
+ */
 static
-void trace_string(char *line, struct ctf_stream_pos *pos, size_t len)
+int trace_string(struct log_writer *writer, struct timegm_cache *cache,
+		const char *line, size_t len)
 {
-	struct ctf_stream_pos dummy;
-	int attempt = 0;
-	char *tline = line;	/* tline is start of text, after timestamp */
-	size_t tlen = len;
+	int ret = 0;
+	const char *end = line + len;
+	const char *text = line;
 	uint64_t ts = 0;
+	size_t text_len;
+	size_t event_at;
+	size_t event_end;
+
+	printf_debug("read: %.*s\n", (int) len, line);
 
-	printf_debug("read: %s\n", line);
+	if (s_timestamp) {
+		parse_timestamp(line, end, cache, &ts, &text);
+	}
+
+	/* Payload string, including its null character */
+	text_len = end - text + 1;
 
+	/*
+	 * Single pass: the event's size is known up front, so check
+	 * once whether it fits the current packet, otherwise in a new
+	 * one.
+	 */
 	for (;;) {
-		int packet_filled = 0;
-
-		ctf_dummy_pos(pos, &dummy);
-		write_event_header(&dummy, line, &tline, len, &tlen, &ts);
-		if (!ctf_align_pos(&dummy, sizeof(uint8_t) * CHAR_BIT))
-			packet_filled = 1;
-		if (!ctf_move_pos(&dummy, tlen * CHAR_BIT))
-			packet_filled = 1;
-		if (packet_filled || ctf_pos_packet(&dummy)) {
-			ctf_pos_pad_packet(pos);
-			write_packet_header(pos, s_uuid);
-			write_packet_context(pos);
-			if (attempt++ == 1) {
-				fprintf(stderr, "[Error] Line too large for packet size (%" PRIu64 "kB) (discarded)\n",
-					pos->packet_size / CHAR_BIT / 1024);
-				return;
-			}
-			continue;
-		} else {
+		event_at = writer->at;
+		if (s_timestamp) {
+			event_at = ALIGN(event_at, sizeof(uint64_t)) +
+				sizeof(uint64_t);
+		}
+
+		event_end = event_at + text_len;
+		if (event_end <= writer->packet_len) {
 			break;
 		}
+
+		if (!writer->packet_has_events) {
+			fprintf(stderr, "[Error] Line too large for packet size (%zukB) (discarded)\n",
+				writer->packet_len / 1024);
+			goto end;
+		}
+
+		ret = end_packet(writer);
+		if (ret) {
+			goto end;
+		}
+
+		begin_packet(writer);
 	}
 
-	write_event_header(pos, line, &tline, len, &tlen, &ts);
-	if (!ctf_align_pos(pos, sizeof(uint8_t) * CHAR_BIT))
-		goto error;
-	memcpy(ctf_get_pos_addr(pos), tline, tlen);
-	if (!ctf_move_pos(pos, tlen * CHAR_BIT))
-		goto error;
-	return;
+	if (s_timestamp) {
+		write_u64(&writer->packet[event_at - sizeof(uint64_t)], ts);
+		if (!writer->packet_has_events || ts < writer->ts_begin) {
+			writer->ts_begin = ts;
+		}
 
-error:
-	fprintf(stderr, "[error] Out of packet bounds when writing event payload\n");
-	abort();
+		if (!writer->packet_has_events || ts > writer->ts_end) {
+			writer->ts_end = ts;
+		}
+	}
+
+	memcpy(&writer->packet[event_at], text, text_len - 1);
+	writer->packet[event_end - 1] = '\0';
+	writer->at = event_end;
+	writer->packet_has_events = true;
+
+end:
+	return ret;
 }
 
+/*
+ * Writes one event per complete line of `buf`. Returns the number of
+ * consumed bytes, or -1 on error. If `last` is true, a final line
+ * without a newline character is also written.
+ */
 static
-void trace_text(FILE *input, int output)
+ssize_t trace_lines(struct log_writer *writer, struct timegm_cache *cache,
+		const char *buf, size_t len, bool last)
 {
-	struct ctf_stream_pos pos;
-	ssize_t len;
-	char *line = NULL, *nl;
-	size_t linesize = 0;
-	int ret;
+	const char *p = buf;
+	const char *end = buf + len;
 
-	memset(&pos, 0, sizeof(pos));
-	ret = ctf_init_pos(&pos, NULL, output, O_RDWR);
-	if (ret) {
-		fprintf(stderr, "Error in ctf_init_pos\n");
-		return;
+	while (p < end) {
+		const char *nl = memchr(p, '\n', end - p);
+
+		if (!nl) {
+			if (!last) {
+				break;
+			}
+
+			nl = end;
+		}
+
+		if (trace_string(writer, cache, p, nl - p)) {
+			return -1;
+		}
+
+		p = nl + 1;
+	}
+
+	return (p > end ? end : p) - buf;
+}
+
+/*
+ * Reads the whole input with mmap() if it's a regular file, otherwise
+ * with large read() calls.
+ */
+static
+int trace_input(struct log_writer *writer, int input)
+{
+	int ret = 0;
+	struct stat st;
+	struct timegm_cache cache = { .valid = false };
+	char *buf = NULL;
+	size_t buf_len = INPUT_CHUNK_LEN;
+	size_t buf_used = 0;
+
+	if (fstat(input, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+			input, 0);
+
+		if (addr != MAP_FAILED) {
+			ssize_t consumed;
+
+			consumed = trace_lines(writer, &cache, addr,
+				st.st_size, true);
+			if (munmap(addr, st.st_size)) {
+				perror("munmap");
+			}
+
+			ret = consumed < 0 ? -1 : 0;
+			goto end;
+		}
 	}
-	ctf_packet_seek(&pos.parent, 0, SEEK_CUR);
-	write_packet_header(&pos, s_uuid);
-	write_packet_context(&pos);
+
+	buf = g_malloc(buf_len);
 	for (;;) {
-		len = bt_getline(&line, &linesize, input);
-		if (len < 0)
+		ssize_t len;
+		ssize_t consumed;
+
+		if (buf_used == buf_len) {
+			/* Line longer than the buffer */
+			buf_len *= 2;
+			buf = g_realloc(buf, buf_len);
+		}
+
+		len = read(input, buf + buf_used, buf_len - buf_used);
+		if (len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			perror("read");
+			ret = -1;
+			goto end;
+		}
+
+		buf_used += len;
+		consumed = trace_lines(writer, &cache, buf, buf_used,
+			len == 0);
+		if (consumed < 0) {
+			ret = -1;
+			goto end;
+		}
+
+		memmove(buf, buf + consumed, buf_used - consumed);
+		buf_used -= consumed;
+		if (len == 0) {
 			break;
-		nl = strrchr(line, '\n');
-		if (nl) {
-			*nl = '\0';
-			trace_string(line, &pos, nl - line + 1);
-		} else {
-			trace_string(line, &pos, strlen(line) + 1);
 		}
 	}
-	ret = ctf_fini_pos(&pos);
+
+end:
+	g_free(buf);
+	return ret;
+}
+
+static
+FILE *open_index_file(int dir_fd)
+{
+	int ret;
+	int index_fd;
+	FILE *index_fp;
+	struct ctf_packet_index_file_hdr hdr;
+
+	ret = mkdirat(dir_fd, "index", S_IRWXU|S_IRWXG);
+	if (ret) {
+		perror("mkdirat");
+		return NULL;
+	}
+
+	index_fd = openat(dir_fd, "index/datastream.idx", O_WRONLY|O_CREAT,
+			  S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP);
+	if (index_fd < 0) {
+		perror("openat");
+		return NULL;
+	}
+
+	index_fp = fdopen(index_fd, "w");
+	if (!index_fp) {
+		perror("fdopen");
+		close(index_fd);
+		return NULL;
+	}
+
+	hdr.magic = htobe32(CTF_INDEX_MAGIC);
+	hdr.index_major = htobe32(CTF_INDEX_MAJOR);
+	hdr.index_minor = htobe32(CTF_INDEX_MINOR);
+	hdr.packet_index_len = htobe32(sizeof(struct ctf_packet_index));
+	if (fwrite(&hdr, sizeof(hdr), 1, index_fp) != 1) {
+		perror("fwrite");
+		fclose(index_fp);
+		return NULL;
+	}
+
+	return index_fp;
+}
+
+static
+int trace_text(int input, int output, FILE *index_fp)
+{
+	int ret;
+	struct log_writer writer;
+
+	memset(&writer, 0, sizeof(writer));
+	writer.fd = output;
+	writer.index_fp = index_fp;
+	writer.packet_len = getpagesize() * PACKET_LEN_PAGES;
+	writer.packet_ctx_len = s_timestamp ? PACKET_TS_END_OFFSET +
+		sizeof(uint64_t) : PACKET_PACKET_SIZE_OFFSET +
+		sizeof(uint64_t);
+	writer.packet = g_malloc(writer.packet_len);
+	begin_packet(&writer);
+	ret = trace_input(&writer, input);
 	if (ret) {
-		fprintf(stderr, "Error in ctf_fini_pos\n");
+		goto end;
 	}
+
+	ret = end_packet(&writer);
+
+end:
+	g_free(writer.packet);
+	return ret;
 }
 
 static
@@ -360,6 +682,7 @@ void usage(FILE *fp)
 	fprintf(fp, "\n");
 	fprintf(fp, "  -t                             With timestamps (format: [sec.usec] string\\n)\n");
 	fprintf(fp, "                                                 (format: [YYYY-MM-DD HH:MM:SS.MS] string\\n)\n");
+	fprintf(fp, "  -i                             Also write a packet index (OUTPUT/index/datastream.idx)\n");
 	fprintf(fp, "\n");
 }
 
@@ -371,6 +694,8 @@ int parse_args(int argc, char **argv)
 	for (i = 1; i < argc; i++) {
 		if (!strcmp(argv[i], "-t"))
 			s_timestamp = 1;
+		else if (!strcmp(argv[i], "-i"))
+			s_index = 1;
 		else if (!strcmp(argv[i], "-h")) {
 			s_help = 1;
 			return 0;
@@ -390,6 +715,7 @@ int main(int argc, char **argv)
 	DIR *dir;
 	int dir_fd;
 	FILE *metadata_fp;
+	FILE *index_fp = NULL;
 
 	ret = parse_args(argc, argv);
 	if (ret) {
@@ -439,14 +765,31 @@ int main(int argc, char **argv)
 		goto error_closemetadatafd;
 	}
 
+	if (s_index) {
+		index_fp = open_index_file(dir_fd);
+		if (!index_fp) {
+			goto error_closemetadatafd;
+		}
+	}
+
 	bt_uuid_generate(s_uuid);
 	print_metadata(metadata_fp);
-	trace_text(stdin, fd);
+	ret = trace_text(STDIN_FILENO, fd, index_fp);
+	if (ret) {
+		fprintf(stderr, "[error] Cannot convert the text log\n");
+	}
 
-	ret = close(fd);
-	if (ret)
+	if (index_fp && fclose(index_fp)) {
+		perror("fclose");
+		ret = -1;
+	}
+
+	if (close(fd)) {
 		perror("close");
-	exit(EXIT_SUCCESS);
+		ret = -1;
+	}
+
+	exit(ret ? EXIT_FAILURE : EXIT_SUCCESS);
 
 	/* error handling */
 error_closemetadatafd:
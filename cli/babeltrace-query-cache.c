@@ -0,0 +1,369 @@
+/*
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <babeltrace/ref.h>
+#include <babeltrace/values.h>
+#include <babeltrace/common-internal.h>
+#include "babeltrace-query-cache.h"
+
+#define BT_LOG_TAG "CLI-QUERY-CACHE"
+#include "logging.h"
+
+#define QUERY_CACHE_MAGIC		0xca5ec11e
+#define QUERY_CACHE_VERSION		1
+#define QUERY_CACHE_FILE_SUFFIX		".query"
+
+/* Maximum directory depth of the files named by query parameters */
+#define QUERY_CACHE_MAX_DIR_DEPTH	64
+
+static
+gint compare_names(gconstpointer a, gconstpointer b)
+{
+	return strcmp(*(const char * const *) a, *(const char * const *) b);
+}
+
+static
+void checksum_update_u64(GChecksum *checksum, uint64_t val)
+{
+	g_checksum_update(checksum, (const guchar *) &val, sizeof(val));
+}
+
+static
+void checksum_update_str(GChecksum *checksum, const char *str)
+{
+	/* Include the terminating null character as a separator */
+	g_checksum_update(checksum, (const guchar *) str, strlen(str) + 1);
+}
+
+/*
+ * Adds the path, size, and modification time of the file `path` to
+ * `checksum`, recursively for a directory (in name order). Returns
+ * false if `path` does not exist.
+ */
+static
+bool checksum_update_file(GChecksum *checksum, const char *path,
+		unsigned int depth)
+{
+	GStatBuf st;
+	GDir *dir = NULL;
+	GPtrArray *names = NULL;
+	const gchar *name;
+	guint i;
+
+	if (g_stat(path, &st)) {
+		return false;
+	}
+
+	checksum_update_str(checksum, path);
+	checksum_update_u64(checksum, (uint64_t) st.st_size);
+	checksum_update_u64(checksum, (uint64_t) st.st_mtime);
+
+	if (!S_ISDIR(st.st_mode) || depth >= QUERY_CACHE_MAX_DIR_DEPTH) {
+		goto end;
+	}
+
+	dir = g_dir_open(path, 0, NULL);
+	if (!dir) {
+		goto end;
+	}
+
+	names = g_ptr_array_new_with_free_func(g_free);
+	if (!names) {
+		goto end;
+	}
+
+	while ((name = g_dir_read_name(dir))) {
+		g_ptr_array_add(names, g_strdup(name));
+	}
+
+	g_ptr_array_sort(names, compare_names);
+
+	for (i = 0; i < names->len; i++) {
+		gchar *child_path = g_build_filename(path,
+			g_ptr_array_index(names, i), NULL);
+
+		(void) checksum_update_file(checksum, child_path, depth + 1);
+		g_free(child_path);
+	}
+
+end:
+	if (names) {
+		g_ptr_array_free(names, TRUE);
+	}
+
+	if (dir) {
+		g_dir_close(dir);
+	}
+
+	return true;
+}
+
+struct input_files_data {
+	GChecksum *checksum;
+
+	/* True if at least one string value names an existing file */
+	bool has_input;
+};
+
+static
+void checksum_update_input_files(struct input_files_data *data,
+		struct bt_value *value);
+
+static
+bt_bool checksum_update_map_entry_input_files(const char *key,
+		struct bt_value *object, void *data)
+{
+	checksum_update_input_files(data, object);
+	return BT_TRUE;
+}
+
+/*
+ * Adds the files named by the string values of `value` (recursively)
+ * to the checksum of `data`.
+ */
+static
+void checksum_update_input_files(struct input_files_data *data,
+		struct bt_value *value)
+{
+	switch (bt_value_get_type(value)) {
+	case BT_VALUE_TYPE_STRING:
+	{
+		const char *str;
+		int ret = bt_value_string_get(value, &str);
+
+		assert(ret == 0);
+		if (checksum_update_file(data->checksum, str, 0)) {
+			data->has_input = true;
+		}
+
+		break;
+	}
+	case BT_VALUE_TYPE_ARRAY:
+	{
+		int64_t size = bt_value_array_size(value);
+		int64_t i;
+
+		for (i = 0; i < size; i++) {
+			struct bt_value *elem = bt_value_array_get(value, i);
+
+			checksum_update_input_files(data, elem);
+			bt_put(elem);
+		}
+
+		break;
+	}
+	case BT_VALUE_TYPE_MAP:
+		/*
+		 * The iteration order does not matter: the paths are
+		 * part of the checksum.
+		 */
+		(void) bt_value_map_foreach(value,
+			checksum_update_map_entry_input_files, data);
+		break;
+	default:
+		break;
+	}
+}
+
+static
+gchar *get_entry_path(const char *cache_dir, const char *key)
+{
+	gchar *path;
+	GString *basename = g_string_new(key);
+
+	if (!basename) {
+		return NULL;
+	}
+
+	g_string_append(basename, QUERY_CACHE_FILE_SUFFIX);
+	path = g_build_filename(cache_dir, basename->str, NULL);
+	g_string_free(basename, TRUE);
+	return path;
+}
+
+gchar *query_cache_get_key(const char *plugin_name,
+		const char *comp_cls_name, enum bt_component_class_type type,
+		const char *object, struct bt_value *params)
+{
+	GChecksum *checksum = NULL;
+	GByteArray *params_buf = NULL;
+	gchar *key = NULL;
+	struct input_files_data input_files_data;
+
+	assert(plugin_name);
+	assert(comp_cls_name);
+	assert(object);
+	assert(params);
+	checksum = g_checksum_new(G_CHECKSUM_SHA256);
+	if (!checksum) {
+		goto end;
+	}
+
+	checksum_update_u64(checksum, QUERY_CACHE_VERSION);
+	checksum_update_str(checksum, plugin_name);
+	checksum_update_str(checksum, comp_cls_name);
+	checksum_update_u64(checksum, (uint64_t) type);
+	checksum_update_str(checksum, object);
+	params_buf = g_byte_array_new();
+	if (!params_buf) {
+		goto end;
+	}
+
+	if (bt_common_bin_write_value(params_buf, params)) {
+		goto end;
+	}
+
+	g_checksum_update(checksum, params_buf->data, params_buf->len);
+	input_files_data.checksum = checksum;
+	input_files_data.has_input = false;
+	checksum_update_input_files(&input_files_data, params);
+	if (!input_files_data.has_input) {
+		BT_LOGD("Query does not read any existing file: not caching it: "
+			"object=\"%s\"", object);
+		goto end;
+	}
+
+	key = g_strdup(g_checksum_get_string(checksum));
+
+end:
+	if (params_buf) {
+		g_byte_array_free(params_buf, TRUE);
+	}
+
+	if (checksum) {
+		g_checksum_free(checksum);
+	}
+
+	return key;
+}
+
+struct bt_value *query_cache_load(const char *cache_dir, const char *key)
+{
+	gchar *path;
+	gchar *contents = NULL;
+	gsize len;
+	uint32_t magic, version;
+	struct bt_common_bin_reader reader;
+	struct bt_value *result = NULL;
+
+	assert(cache_dir);
+	assert(key);
+	path = get_entry_path(cache_dir, key);
+	if (!path) {
+		goto end;
+	}
+
+	if (!g_file_get_contents(path, &contents, &len, NULL)) {
+		BT_LOGD("No query cache entry: path=\"%s\"", path);
+		goto end;
+	}
+
+	reader.buf = (const uint8_t *) contents;
+	reader.len = len;
+	reader.at = 0;
+
+	if (bt_common_bin_read_u32(&reader, &magic) ||
+			magic != QUERY_CACHE_MAGIC ||
+			bt_common_bin_read_u32(&reader, &version) ||
+			version != QUERY_CACHE_VERSION) {
+		BT_LOGW("Invalid query cache entry header: path=\"%s\"", path);
+		goto end;
+	}
+
+	result = bt_common_bin_read_value(&reader);
+	if (!result || reader.at != reader.len) {
+		BT_LOGW("Cannot load query cache entry: path=\"%s\"", path);
+		BT_PUT(result);
+		goto end;
+	}
+
+	BT_LOGD("Loaded query result from cache entry: path=\"%s\"", path);
+
+end:
+	g_free(contents);
+	g_free(path);
+	return result;
+}
+
+int query_cache_store(const char *cache_dir, const char *key,
+		struct bt_value *result)
+{
+	int ret;
+	gchar *path = NULL;
+	GByteArray *buf = NULL;
+
+	assert(cache_dir);
+	assert(key);
+	assert(result);
+	buf = g_byte_array_new();
+	if (!buf) {
+		ret = -1;
+		goto end;
+	}
+
+	bt_common_bin_write_u32(buf, QUERY_CACHE_MAGIC);
+	bt_common_bin_write_u32(buf, QUERY_CACHE_VERSION);
+	ret = bt_common_bin_write_value(buf, result);
+	if (ret) {
+		goto end;
+	}
+
+	ret = g_mkdir_with_parents(cache_dir, 0755);
+	if (ret) {
+		BT_LOGW("Cannot create query cache directory: path=\"%s\"",
+			cache_dir);
+		goto end;
+	}
+
+	path = get_entry_path(cache_dir, key);
+	if (!path) {
+		ret = -1;
+		goto end;
+	}
+
+	/* g_file_set_contents() atomically replaces the entry */
+	if (!g_file_set_contents(path, (const gchar *) buf->data, buf->len,
+			NULL)) {
+		BT_LOGW("Cannot write query cache entry: path=\"%s\"", path);
+		ret = -1;
+		goto end;
+	}
+
+	BT_LOGD("Stored query result in cache entry: path=\"%s\", size=%u",
+		path, buf->len);
+
+end:
+	g_free(path);
+	if (buf) {
+		g_byte_array_free(buf, TRUE);
+	}
+
+	return ret;
+}
@@ -0,0 +1,70 @@
+#ifndef CLI_BABELTRACE_QUERY_CACHE_H
+#define CLI_BABELTRACE_QUERY_CACHE_H
+
+/*
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <babeltrace/values.h>
+#include <babeltrace/graph/component-class.h>
+#include <glib.h>
+
+/*
+ * The query result cache keeps, in a directory, the results of
+ * component class queries, so that issuing the same query again does
+ * not run the component class's query method.
+ *
+ * A cache entry is identified by a key computed from the component
+ * class (plugin name, name, and type), the query object, the query
+ * parameters, and the sizes and modification times of the files named
+ * by the string query parameters (recursively for directories).
+ */
+
+/*
+ * Computes the cache key of a query.
+ *
+ * Returns a new string which you must free with g_free(), or `NULL`
+ * if the query cannot be cached: a query of which no string parameter
+ * names an existing file could depend on anything (for example, the
+ * sessions of a remote relay daemon).
+ */
+gchar *query_cache_get_key(const char *plugin_name,
+		const char *comp_cls_name, enum bt_component_class_type type,
+		const char *object, struct bt_value *params);
+
+/*
+ * Loads the query result having the cache key `key` from the cache
+ * directory `cache_dir`.
+ *
+ * Returns `NULL` if there's no such cache entry, or if it's invalid.
+ */
+struct bt_value *query_cache_load(const char *cache_dir, const char *key);
+
+/*
+ * Stores the query result `result` in the cache directory `cache_dir`
+ * with the cache key `key`, creating the directory if needed.
+ *
+ * Returns 0 on success.
+ */
+int query_cache_store(const char *cache_dir, const char *key,
+		struct bt_value *result);
+
+#endif /* CLI_BABELTRACE_QUERY_CACHE_H */
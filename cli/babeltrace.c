@@ -44,6 +44,7 @@
 #include <babeltrace/ref.h>
 #include <babeltrace/values.h>
 #include <babeltrace/logging.h>
+#include <babeltrace/object-stats.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <popt.h>
@@ -53,12 +54,15 @@
 #include <inttypes.h>
 #include <unistd.h>
 #include <signal.h>
+#include <errno.h>
 #include "babeltrace-cfg.h"
 #include "babeltrace-cfg-cli-args.h"
 #include "babeltrace-cfg-cli-args-default.h"
+#include "babeltrace-query-cache.h"
 
 #define ENV_BABELTRACE_WARN_COMMAND_NAME_DIRECTORY_CLASH "BABELTRACE_CLI_WARN_COMMAND_NAME_DIRECTORY_CLASH"
 #define ENV_BABELTRACE_CLI_LOG_LEVEL "BABELTRACE_CLI_LOG_LEVEL"
+#define ENV_BABELTRACE_CLI_QUERY_CACHE_DIR "BABELTRACE_CLI_QUERY_CACHE_DIR"
 
 /*
  * Known environment variable names for the log levels of the project's
@@ -459,6 +463,12 @@ void print_cfg_run(struct bt_config *cfg)
 			cfg_connection->downstream_port_glob->len > 0 ? "." : "",
 			cfg_connection->downstream_port_glob->str);
 	}
+
+	if (cfg->cmd_data.run.checkpoint_path) {
+		fprintf(stderr, "  Checkpoint state file: %s%s\n",
+			cfg->cmd_data.run.checkpoint_path->str,
+			cfg->cmd_data.run.resume ? " (resuming)" : "");
+	}
 }
 
 static
@@ -496,6 +506,11 @@ void print_cfg_query(struct bt_config *cfg)
 	fprintf(stderr, "  Object: `%s`\n", cfg->cmd_data.query.object->str);
 	fprintf(stderr, "  Component class:\n");
 	print_bt_config_component(cfg->cmd_data.query.cfg_component);
+
+	if (cfg->cmd_data.query.cache_dir) {
+		fprintf(stderr, "  Cache directory: %s\n",
+			cfg->cmd_data.query.cache_dir->str);
+	}
 }
 
 static
@@ -708,6 +723,70 @@ void print_plugin_info(struct bt_plugin *plugin)
 		license ? license : "(Unknown)");
 }
 
+/*
+ * Queries the object `object` from the component class `comp_cls`
+ * (found in the plugin `plugin_name`) with the parameters `params`.
+ *
+ * If `cache_dir` is not `NULL`, the result is loaded from this query
+ * result cache directory if the same query was already made on
+ * unchanged files, and stored there otherwise.
+ */
+static
+struct bt_value *query(struct bt_component_class *comp_cls,
+		const char *plugin_name, const char *object,
+		struct bt_value *params, const char *cache_dir)
+{
+	struct bt_value *results = NULL;
+	gchar *key = NULL;
+
+	if (cache_dir) {
+		key = query_cache_get_key(plugin_name,
+			bt_component_class_get_name(comp_cls),
+			bt_component_class_get_type(comp_cls), object, params);
+	}
+
+	if (key) {
+		results = query_cache_load(cache_dir, key);
+		if (results) {
+			BT_LOGI("Reusing cached query result: object=\"%s\", "
+				"cache-dir=\"%s\", key=%s", object, cache_dir,
+				key);
+			goto end;
+		}
+	}
+
+	results = bt_component_class_query(comp_cls, object, params);
+	if (results && key) {
+		/* Not fatal: the next identical query is not cached */
+		(void) query_cache_store(cache_dir, key, results);
+	}
+
+end:
+	g_free(key);
+	return results;
+}
+
+/*
+ * Returns the query result cache directory to use for the command
+ * configuration `cfg`, or `NULL` if the cache is disabled.
+ */
+static
+const char *get_query_cache_dir(struct bt_config *cfg)
+{
+	const char *cache_dir = getenv(ENV_BABELTRACE_CLI_QUERY_CACHE_DIR);
+
+	if (cfg->command == BT_CONFIG_COMMAND_QUERY &&
+			cfg->cmd_data.query.cache_dir) {
+		cache_dir = cfg->cmd_data.query.cache_dir->str;
+	}
+
+	if (cache_dir && strlen(cache_dir) == 0) {
+		cache_dir = NULL;
+	}
+
+	return cache_dir;
+}
+
 static
 int cmd_query(struct bt_config *cfg)
 {
@@ -737,9 +816,11 @@ int cmd_query(struct bt_config *cfg)
 		goto end;
 	}
 
-	results = bt_component_class_query(comp_cls,
+	results = query(comp_cls,
+		cfg->cmd_data.query.cfg_component->plugin_name->str,
 		cfg->cmd_data.query.object->str,
-		cfg->cmd_data.query.cfg_component->params);
+		cfg->cmd_data.query.cfg_component->params,
+		get_query_cache_dir(cfg));
 	if (!results) {
 		BT_LOGE("Failed to query component class: plugin-name=\"%s\", "
 			"comp-cls-name=\"%s\", comp-cls-type=%d "
@@ -1134,8 +1215,8 @@ int cmd_print_ctf_metadata(struct bt_config *cfg)
 		goto end;
 	}
 
-	results = bt_component_class_query(comp_cls, "metadata-info",
-		params);
+	results = query(comp_cls, plugin_name, "metadata-info", params,
+		get_query_cache_dir(cfg));
 	if (!results) {
 		ret = -1;
 		BT_LOGE_STR("Failed to query for metadata info.");
@@ -1543,6 +1624,20 @@ int cmd_run_ctx_init(struct cmd_run_ctx *ctx, struct bt_config *cfg)
 		goto error;
 	}
 
+	if (cfg->cmd_data.run.memory_budget > 0) {
+		ret = bt_graph_set_memory_budget(ctx->graph,
+			cfg->cmd_data.run.memory_budget);
+		if (ret) {
+			BT_LOGE("Cannot set graph's memory budget: "
+				"budget=%" PRIu64,
+				cfg->cmd_data.run.memory_budget);
+			goto error;
+		}
+
+		BT_LOGI("Set graph's memory budget: budget=%" PRIu64,
+			cfg->cmd_data.run.memory_budget);
+	}
+
 	the_graph = ctx->graph;
 	ret = bt_graph_add_port_added_listener(ctx->graph,
 		graph_port_added_listener, ctx);
@@ -1582,6 +1677,78 @@ end:
 	return ret;
 }
 
+/*
+ * Returns whether or not the component class `comp_cls` supports
+ * checkpoints, that is, if its `checkpoint-support` query object is
+ * the boolean value true.
+ */
+static
+bool component_class_supports_checkpoints(struct bt_component_class *comp_cls)
+{
+	struct bt_value *params = bt_value_map_create();
+	struct bt_value *results = NULL;
+	bt_bool supported = BT_FALSE;
+
+	if (!params) {
+		goto end;
+	}
+
+	results = bt_component_class_query(comp_cls, "checkpoint-support",
+		params);
+	if (!results || !bt_value_is_bool(results)) {
+		goto end;
+	}
+
+	(void) bt_value_bool_get(results, &supported);
+
+end:
+	bt_put(results);
+	bt_put(params);
+	return supported;
+}
+
+/*
+ * Returns the initialization parameters of the configuration component
+ * `cfg_comp` instantiated from the component class `comp_cls`.
+ *
+ * The checkpoint parameters are only added, to a copy of the
+ * configured parameters, when the checkpoints are enabled and the
+ * component class supports them.
+ */
+static
+struct bt_value *get_component_params(struct bt_config *cfg,
+		struct bt_config_component *cfg_comp,
+		struct bt_component_class *comp_cls)
+{
+	struct bt_value *params = NULL;
+
+	if (!cfg->cmd_data.run.checkpoint_path ||
+			!component_class_supports_checkpoints(comp_cls)) {
+		params = bt_get(cfg_comp->params);
+		goto end;
+	}
+
+	BT_LOGI("Passing checkpoint parameters to component: comp-name=\"%s\"",
+		cfg_comp->instance_name->str);
+	params = bt_value_copy(cfg_comp->params);
+	if (!params) {
+		goto end;
+	}
+
+	if (bt_value_map_insert_string(params, "checkpoint-path",
+			cfg->cmd_data.run.checkpoint_path->str) ||
+			bt_value_map_insert_integer(params,
+				"checkpoint-interval",
+				(int64_t) cfg->cmd_data.run.checkpoint_interval) ||
+			bt_value_map_insert_bool(params, "resume",
+				cfg->cmd_data.run.resume)) {
+		BT_PUT(params);
+	}
+
+end:
+	return params;
+}
+
 static
 int cmd_run_ctx_create_components_from_config_components(
 		struct cmd_run_ctx *ctx, GPtrArray *cfg_components)
@@ -1589,6 +1756,7 @@ int cmd_run_ctx_create_components_from_config_components(
 	size_t i;
 	struct bt_component_class *comp_cls = NULL;
 	struct bt_component *comp = NULL;
+	struct bt_value *params = NULL;
 	int ret = 0;
 
 	for (i = 0; i < cfg_components->len; i++) {
@@ -1616,8 +1784,19 @@ int cmd_run_ctx_create_components_from_config_components(
 			goto error;
 		}
 
+		params = get_component_params(ctx->cfg, cfg_comp, comp_cls);
+		if (!params) {
+			BT_LOGE_STR("Cannot create component's initialization parameters.");
+			fprintf(stderr, "%s%sCannot create initialization parameters of component `%s`%s\n",
+				bt_common_color_bold(),
+				bt_common_color_fg_red(),
+				cfg_comp->instance_name->str,
+				bt_common_color_reset());
+			goto error;
+		}
+
 		ret = bt_graph_add_component(ctx->graph, comp_cls,
-			cfg_comp->instance_name->str, cfg_comp->params, &comp);
+			cfg_comp->instance_name->str, params, &comp);
 		if (ret) {
 			BT_LOGE("Cannot create component: plugin-name=\"%s\", "
 				"comp-cls-name=\"%s\", comp-cls-type=%d, "
@@ -1640,6 +1819,7 @@ int cmd_run_ctx_create_components_from_config_components(
 		g_hash_table_insert(ctx->components,
 			GUINT_TO_POINTER(quark), comp);
 		comp = NULL;
+		BT_PUT(params);
 		BT_PUT(comp_cls);
 	}
 
@@ -1649,6 +1829,7 @@ error:
 	ret = -1;
 
 end:
+	bt_put(params);
 	bt_put(comp);
 	bt_put(comp_cls);
 	return ret;
@@ -1779,6 +1960,23 @@ int cmd_run(struct bt_config *cfg)
 	int ret = 0;
 	struct cmd_run_ctx ctx = { 0 };
 
+	if (cfg->cmd_data.run.checkpoint_path && !cfg->cmd_data.run.resume) {
+		/*
+		 * Fresh run: the components must not find the state of
+		 * a previous run when they merge their own.
+		 */
+		if (unlink(cfg->cmd_data.run.checkpoint_path->str) &&
+				errno != ENOENT) {
+			BT_LOGE("Cannot remove existing checkpoint state file: "
+				"path=\"%s\", errno=%d",
+				cfg->cmd_data.run.checkpoint_path->str, errno);
+			fprintf(stderr, "Cannot remove existing checkpoint state file `%s`: %s\n",
+				cfg->cmd_data.run.checkpoint_path->str,
+				strerror(errno));
+			goto error;
+		}
+	}
+
 	/* Initialize the command's context and the graph object */
 	if (cmd_run_ctx_init(&ctx, cfg)) {
 		BT_LOGE_STR("Cannot initialize the command's context.");
@@ -1995,6 +2193,54 @@ void set_sigint_handler(void)
 	}
 }
 
+static
+void print_object_stats_line(const char *name, struct bt_object_stats *stats)
+{
+	fprintf(stderr, "%-28s %12" PRIu64 " %12" PRIu64 " %10" PRIu64
+		" %10" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n", name,
+		stats->created, stats->destroyed, stats->live,
+		stats->peak_live, stats->live_bytes,
+		stats->peak_live_bytes);
+}
+
+/*
+ * Prints the library's object statistics to the standard error when
+ * they are enabled (`BABELTRACE_OBJECT_STATS=1`). The objects which
+ * are still live at this point are leaked or retained by something
+ * which was not destroyed.
+ */
+static
+void print_object_stats(void)
+{
+	struct bt_object_stats stats;
+	int type;
+
+	if (!bt_object_stats_is_enabled()) {
+		return;
+	}
+
+	fprintf(stderr, "\n%-28s %12s %12s %10s %10s %12s %12s\n",
+		"Object type", "Created", "Destroyed", "Live", "Peak",
+		"Live bytes", "Peak bytes");
+
+	for (type = 0; type < BT_OBJECT_STATS_TYPE_NR; type++) {
+		if (bt_object_stats_get(type, &stats)) {
+			continue;
+		}
+
+		if (stats.created == 0) {
+			continue;
+		}
+
+		print_object_stats_line(bt_object_stats_type_string(type),
+			&stats);
+	}
+
+	if (!bt_object_stats_get_total(&stats)) {
+		print_object_stats_line("total", &stats);
+	}
+}
+
 int main(int argc, const char **argv)
 {
 	int ret;
@@ -2072,5 +2318,6 @@ int main(int argc, const char **argv)
 end:
 	BT_PUT(cfg);
 	fini_static_data();
+	print_object_stats();
 	return retcode;
 }
@@ -30,7 +30,11 @@
 #include <ctype.h>
 #include <glib.h>
 #include <stdlib.h>
+#include <inttypes.h>
+#include <pthread.h>
 #include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/ref.h>
+#include <babeltrace/values.h>
 #include <babeltrace/common-internal.h>
 #include <babeltrace/compat/unistd-internal.h>
 
@@ -42,6 +46,40 @@
 #define HOME_ENV_VAR		"HOME"
 #define HOME_PLUGIN_SUBPATH	"/.local/lib/babeltrace/plugins"
 
+/* Length written instead of a string's length for a `NULL` string */
+#define BIN_NULL_STR_LEN	UINT32_MAX
+
+/* Maximum nesting level of a value, to reject corrupted buffers */
+#define BIN_MAX_VALUE_DEPTH	256
+
+enum bin_value_type {
+	BIN_VALUE_TYPE_NULL	= 0,
+	BIN_VALUE_TYPE_BOOL	= 1,
+	BIN_VALUE_TYPE_INTEGER	= 2,
+	BIN_VALUE_TYPE_FLOAT	= 3,
+	BIN_VALUE_TYPE_STRING	= 4,
+	BIN_VALUE_TYPE_ARRAY	= 5,
+	BIN_VALUE_TYPE_MAP	= 6,
+};
+
+struct job_pool {
+	char *jobs;
+	size_t job_count;
+	size_t job_size;
+	bt_common_job_func func;
+
+	/* Protects `next_job` and `failed` */
+	pthread_mutex_t lock;
+	size_t next_job;
+	bool failed;
+};
+
+struct job_worker {
+	struct job_pool *pool;
+	void *thread_data;
+	pthread_t thread;
+};
+
 static const char *bt_common_color_code_reset = "";
 static const char *bt_common_color_code_bold = "";
 static const char *bt_common_color_code_fg_default = "";
@@ -1162,3 +1200,613 @@ size_t bt_common_get_page_size(void)
 
 	return page_size;
 }
+
+BT_HIDDEN
+GKeyFile *bt_common_checkpoint_load(const char *path)
+{
+	GKeyFile *key_file;
+	GError *error = NULL;
+
+	key_file = g_key_file_new();
+	if (!key_file) {
+		goto end;
+	}
+
+	if (!g_key_file_load_from_file(key_file, path, G_KEY_FILE_NONE,
+			&error)) {
+		if (g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+			/* No checkpoint yet */
+			goto end;
+		}
+
+		printf_error("Cannot load checkpoint state file `%s`: %s\n",
+			path, error->message);
+		g_key_file_free(key_file);
+		key_file = NULL;
+	}
+
+end:
+	if (error) {
+		g_error_free(error);
+	}
+
+	return key_file;
+}
+
+BT_HIDDEN
+int bt_common_checkpoint_save(const char *path, GKeyFile *update)
+{
+	int ret = 0;
+	GKeyFile *key_file;
+	gchar **groups = NULL;
+	gchar **keys = NULL;
+	gchar *data = NULL;
+	gsize data_len;
+	GError *error = NULL;
+	gsize i, j;
+
+	/*
+	 * Other components may write their own groups to the same
+	 * file: start from the current state.
+	 */
+	key_file = bt_common_checkpoint_load(path);
+	if (!key_file) {
+		goto error;
+	}
+
+	groups = g_key_file_get_groups(update, NULL);
+	for (i = 0; groups[i]; i++) {
+		keys = g_key_file_get_keys(update, groups[i], NULL, NULL);
+		if (!keys) {
+			continue;
+		}
+
+		for (j = 0; keys[j]; j++) {
+			gchar *value = g_key_file_get_value(update, groups[i],
+				keys[j], NULL);
+
+			if (value) {
+				g_key_file_set_value(key_file, groups[i],
+					keys[j], value);
+				g_free(value);
+			}
+		}
+
+		g_strfreev(keys);
+		keys = NULL;
+	}
+
+	data = g_key_file_to_data(key_file, &data_len, NULL);
+	if (!data) {
+		goto error;
+	}
+
+	/* g_file_set_contents() replaces the file atomically */
+	if (!g_file_set_contents(path, data, data_len, &error)) {
+		printf_error("Cannot write checkpoint state file `%s`: %s\n",
+			path, error->message);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	if (key_file) {
+		g_key_file_free(key_file);
+	}
+
+	if (error) {
+		g_error_free(error);
+	}
+
+	g_strfreev(groups);
+	g_free(data);
+	return ret;
+}
+
+BT_HIDDEN
+gchar *bt_common_checkpoint_stream_key(const char *trace_name,
+		int64_t stream_class_id, int64_t stream_id,
+		const char *stream_name)
+{
+	gchar *identity;
+	gchar *key;
+
+	/*
+	 * Trace and stream names can contain characters which are
+	 * not valid in key file keys: use a digest of the identity.
+	 */
+	identity = g_strdup_printf("%s\n%" PRId64 "\n%" PRId64 "\n%s",
+		trace_name ? trace_name : "", stream_class_id, stream_id,
+		stream_name ? stream_name : "");
+	key = g_compute_checksum_for_string(G_CHECKSUM_SHA1, identity, -1);
+	g_free(identity);
+	return key;
+}
+
+BT_HIDDEN
+void bt_common_bin_write_u8(GByteArray *buf, uint8_t val)
+{
+	g_byte_array_append(buf, &val, sizeof(val));
+}
+
+BT_HIDDEN
+void bt_common_bin_write_u32(GByteArray *buf, uint32_t val)
+{
+	g_byte_array_append(buf, (const guint8 *) &val, sizeof(val));
+}
+
+BT_HIDDEN
+void bt_common_bin_write_u64(GByteArray *buf, uint64_t val)
+{
+	g_byte_array_append(buf, (const guint8 *) &val, sizeof(val));
+}
+
+BT_HIDDEN
+void bt_common_bin_write_str(GByteArray *buf, const char *str)
+{
+	uint32_t len;
+
+	if (!str) {
+		bt_common_bin_write_u32(buf, BIN_NULL_STR_LEN);
+		return;
+	}
+
+	len = strlen(str);
+	bt_common_bin_write_u32(buf, len);
+	g_byte_array_append(buf, (const guint8 *) str, len);
+}
+
+static
+bt_bool append_map_key(const char *key, struct bt_value *object, void *data)
+{
+	GPtrArray *keys = data;
+
+	/* Map keys are quark strings: they are never freed */
+	g_ptr_array_add(keys, (gpointer) key);
+	return BT_TRUE;
+}
+
+static
+gint compare_map_keys(gconstpointer a, gconstpointer b)
+{
+	return strcmp(*(const char * const *) a, *(const char * const *) b);
+}
+
+BT_HIDDEN
+int bt_common_bin_write_value(GByteArray *buf, struct bt_value *value)
+{
+	int ret = 0;
+
+	switch (bt_value_get_type(value)) {
+	case BT_VALUE_TYPE_NULL:
+		bt_common_bin_write_u8(buf, BIN_VALUE_TYPE_NULL);
+		break;
+	case BT_VALUE_TYPE_BOOL:
+	{
+		bt_bool val;
+
+		ret = bt_value_bool_get(value, &val);
+		assert(ret == 0);
+		bt_common_bin_write_u8(buf, BIN_VALUE_TYPE_BOOL);
+		bt_common_bin_write_u8(buf, val ? 1 : 0);
+		break;
+	}
+	case BT_VALUE_TYPE_INTEGER:
+	{
+		int64_t val;
+
+		ret = bt_value_integer_get(value, &val);
+		assert(ret == 0);
+		bt_common_bin_write_u8(buf, BIN_VALUE_TYPE_INTEGER);
+		bt_common_bin_write_u64(buf, (uint64_t) val);
+		break;
+	}
+	case BT_VALUE_TYPE_FLOAT:
+	{
+		double val;
+		uint64_t bits;
+
+		ret = bt_value_float_get(value, &val);
+		assert(ret == 0);
+		memcpy(&bits, &val, sizeof(bits));
+		bt_common_bin_write_u8(buf, BIN_VALUE_TYPE_FLOAT);
+		bt_common_bin_write_u64(buf, bits);
+		break;
+	}
+	case BT_VALUE_TYPE_STRING:
+	{
+		const char *val;
+
+		ret = bt_value_string_get(value, &val);
+		assert(ret == 0);
+		bt_common_bin_write_u8(buf, BIN_VALUE_TYPE_STRING);
+		bt_common_bin_write_str(buf, val);
+		break;
+	}
+	case BT_VALUE_TYPE_ARRAY:
+	{
+		int64_t size = bt_value_array_size(value);
+		int64_t i;
+
+		assert(size >= 0);
+		bt_common_bin_write_u8(buf, BIN_VALUE_TYPE_ARRAY);
+		bt_common_bin_write_u64(buf, (uint64_t) size);
+
+		for (i = 0; i < size; i++) {
+			struct bt_value *elem = bt_value_array_get(value, i);
+
+			assert(elem);
+			ret = bt_common_bin_write_value(buf, elem);
+			bt_put(elem);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		break;
+	}
+	case BT_VALUE_TYPE_MAP:
+	{
+		GPtrArray *keys = g_ptr_array_new();
+		guint i;
+
+		if (!keys) {
+			ret = -1;
+			goto end;
+		}
+
+		(void) bt_value_map_foreach(value, append_map_key, keys);
+		g_ptr_array_sort(keys, compare_map_keys);
+		bt_common_bin_write_u8(buf, BIN_VALUE_TYPE_MAP);
+		bt_common_bin_write_u64(buf, (uint64_t) keys->len);
+
+		for (i = 0; i < keys->len; i++) {
+			const char *key = g_ptr_array_index(keys, i);
+			struct bt_value *entry = bt_value_map_get(value, key);
+
+			assert(entry);
+			bt_common_bin_write_str(buf, key);
+			ret = bt_common_bin_write_value(buf, entry);
+			bt_put(entry);
+			if (ret) {
+				break;
+			}
+		}
+
+		g_ptr_array_free(keys, TRUE);
+		break;
+	}
+	default:
+		ret = -1;
+		break;
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int bt_common_bin_read_bytes(struct bt_common_bin_reader *reader,
+		void *dst, size_t len)
+{
+	if (reader->len - reader->at < len) {
+		return -1;
+	}
+
+	memcpy(dst, &reader->buf[reader->at], len);
+	reader->at += len;
+	return 0;
+}
+
+BT_HIDDEN
+int bt_common_bin_read_u8(struct bt_common_bin_reader *reader,
+		uint8_t *val)
+{
+	return bt_common_bin_read_bytes(reader, val, sizeof(*val));
+}
+
+BT_HIDDEN
+int bt_common_bin_read_u32(struct bt_common_bin_reader *reader,
+		uint32_t *val)
+{
+	return bt_common_bin_read_bytes(reader, val, sizeof(*val));
+}
+
+BT_HIDDEN
+int bt_common_bin_read_u64(struct bt_common_bin_reader *reader,
+		uint64_t *val)
+{
+	return bt_common_bin_read_bytes(reader, val, sizeof(*val));
+}
+
+BT_HIDDEN
+int bt_common_bin_read_i64(struct bt_common_bin_reader *reader,
+		int64_t *val)
+{
+	return bt_common_bin_read_bytes(reader, val, sizeof(*val));
+}
+
+BT_HIDDEN
+int bt_common_bin_read_str(struct bt_common_bin_reader *reader, char **str)
+{
+	int ret;
+	uint32_t len;
+
+	*str = NULL;
+	ret = bt_common_bin_read_u32(reader, &len);
+	if (ret || len == BIN_NULL_STR_LEN) {
+		goto end;
+	}
+
+	if (reader->len - reader->at < len) {
+		ret = -1;
+		goto end;
+	}
+
+	*str = g_strndup((const char *) &reader->buf[reader->at], len);
+	reader->at += len;
+
+end:
+	return ret;
+}
+
+static
+struct bt_value *read_value(struct bt_common_bin_reader *reader,
+		unsigned int depth)
+{
+	uint8_t type;
+	uint64_t u64;
+	uint64_t i;
+	char *str = NULL;
+	struct bt_value *value = NULL;
+
+	if (depth > BIN_MAX_VALUE_DEPTH) {
+		goto error;
+	}
+
+	if (bt_common_bin_read_u8(reader, &type)) {
+		goto error;
+	}
+
+	switch (type) {
+	case BIN_VALUE_TYPE_NULL:
+		value = bt_get(bt_value_null);
+		break;
+	case BIN_VALUE_TYPE_BOOL:
+	{
+		uint8_t val;
+
+		if (bt_common_bin_read_u8(reader, &val)) {
+			goto error;
+		}
+
+		value = bt_value_bool_create_init(val ? BT_TRUE : BT_FALSE);
+		break;
+	}
+	case BIN_VALUE_TYPE_INTEGER:
+		if (bt_common_bin_read_u64(reader, &u64)) {
+			goto error;
+		}
+
+		value = bt_value_integer_create_init((int64_t) u64);
+		break;
+	case BIN_VALUE_TYPE_FLOAT:
+	{
+		double val;
+
+		if (bt_common_bin_read_u64(reader, &u64)) {
+			goto error;
+		}
+
+		memcpy(&val, &u64, sizeof(val));
+		value = bt_value_float_create_init(val);
+		break;
+	}
+	case BIN_VALUE_TYPE_STRING:
+		if (bt_common_bin_read_str(reader, &str) || !str) {
+			goto error;
+		}
+
+		value = bt_value_string_create_init(str);
+		break;
+	case BIN_VALUE_TYPE_ARRAY:
+		if (bt_common_bin_read_u64(reader, &u64)) {
+			goto error;
+		}
+
+		value = bt_value_array_create();
+		if (!value) {
+			goto error;
+		}
+
+		for (i = 0; i < u64; i++) {
+			struct bt_value *elem = read_value(reader, depth + 1);
+			enum bt_value_status status;
+
+			if (!elem) {
+				goto error;
+			}
+
+			status = bt_value_array_append(value, elem);
+			bt_put(elem);
+			if (status != BT_VALUE_STATUS_OK) {
+				goto error;
+			}
+		}
+
+		break;
+	case BIN_VALUE_TYPE_MAP:
+		if (bt_common_bin_read_u64(reader, &u64)) {
+			goto error;
+		}
+
+		value = bt_value_map_create();
+		if (!value) {
+			goto error;
+		}
+
+		for (i = 0; i < u64; i++) {
+			struct bt_value *entry;
+			enum bt_value_status status;
+
+			if (bt_common_bin_read_str(reader, &str) || !str) {
+				goto error;
+			}
+
+			entry = read_value(reader, depth + 1);
+			if (!entry) {
+				goto error;
+			}
+
+			status = bt_value_map_insert(value, str, entry);
+			bt_put(entry);
+			g_free(str);
+			str = NULL;
+			if (status != BT_VALUE_STATUS_OK) {
+				goto error;
+			}
+		}
+
+		break;
+	default:
+		goto error;
+	}
+
+	if (!value) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_PUT(value);
+
+end:
+	g_free(str);
+	return value;
+}
+
+BT_HIDDEN
+struct bt_value *bt_common_bin_read_value(
+		struct bt_common_bin_reader *reader)
+{
+	return read_value(reader, 0);
+}
+
+BT_HIDDEN
+size_t bt_common_get_job_thread_count(size_t job_count,
+		size_t min_jobs_per_thread, size_t max_thread_count)
+{
+	long cpu_count = bt_sysconf(_SC_NPROCESSORS_ONLN);
+	size_t thread_count;
+
+	assert(min_jobs_per_thread > 0);
+	thread_count = job_count / min_jobs_per_thread;
+
+	if (cpu_count > 0 && thread_count > (size_t) cpu_count) {
+		thread_count = (size_t) cpu_count;
+	}
+
+	if (thread_count > max_thread_count) {
+		thread_count = max_thread_count;
+	}
+
+	if (thread_count == 0) {
+		thread_count = 1;
+	}
+
+	return thread_count;
+}
+
+static
+void job_pool_run(struct job_pool *pool, void *thread_data)
+{
+	while (true) {
+		void *job;
+
+		pthread_mutex_lock(&pool->lock);
+		if (pool->failed || pool->next_job == pool->job_count) {
+			pthread_mutex_unlock(&pool->lock);
+			break;
+		}
+
+		job = &pool->jobs[pool->next_job * pool->job_size];
+		pool->next_job++;
+		pthread_mutex_unlock(&pool->lock);
+
+		if (pool->func(job, thread_data)) {
+			pthread_mutex_lock(&pool->lock);
+			pool->failed = true;
+			pthread_mutex_unlock(&pool->lock);
+		}
+	}
+}
+
+static
+void *job_worker_run(void *data)
+{
+	struct job_worker *worker = data;
+
+	job_pool_run(worker->pool, worker->thread_data);
+	return NULL;
+}
+
+BT_HIDDEN
+int bt_common_run_jobs(void *jobs, size_t job_count, size_t job_size,
+		bt_common_job_func func, void **thread_data,
+		size_t thread_count)
+{
+	struct job_pool pool = {
+		.jobs = jobs,
+		.job_count = job_count,
+		.job_size = job_size,
+		.func = func,
+		.next_job = 0,
+		.failed = false,
+	};
+	struct job_worker *workers = NULL;
+	size_t worker_count = 0;
+	size_t started_count = 0;
+	size_t i;
+
+	assert(func);
+	assert(thread_count > 0);
+	pthread_mutex_init(&pool.lock, NULL);
+
+	if (thread_count > 1) {
+		workers = g_new0(struct job_worker, thread_count - 1);
+
+		/* Not fatal: the calling thread runs all the jobs */
+		if (workers) {
+			worker_count = thread_count - 1;
+		}
+	}
+
+	for (i = 0; i < worker_count; i++) {
+		struct job_worker *worker = &workers[started_count];
+
+		worker->pool = &pool;
+		worker->thread_data = thread_data ? thread_data[i + 1] : NULL;
+		if (pthread_create(&worker->thread, NULL, job_worker_run,
+				worker)) {
+			/* Not fatal: the other threads run its jobs */
+			continue;
+		}
+
+		started_count++;
+	}
+
+	job_pool_run(&pool, thread_data ? thread_data[0] : NULL);
+
+	for (i = 0; i < started_count; i++) {
+		pthread_join(workers[i].thread, NULL);
+	}
+
+	g_free(workers);
+	pthread_mutex_destroy(&pool.lock);
+	return pool.failed ? -1 : 0;
+}
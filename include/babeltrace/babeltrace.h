@@ -27,6 +27,7 @@
 
 /* Core API */
 #include <babeltrace/logging.h>
+#include <babeltrace/object-stats.h>
 #include <babeltrace/ref.h>
 #include <babeltrace/types.h>
 #include <babeltrace/values.h>
@@ -2,6 +2,8 @@
 #define BABELTRACE_COMMON_INTERNAL_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <babeltrace/babeltrace-internal.h>
 
 #define BT_COMMON_COLOR_RESET              "\033[0m"
@@ -205,4 +207,169 @@ GString *bt_common_normalize_path(const char *path, const char *wd);
 BT_HIDDEN
 size_t bt_common_get_page_size(void);
 
+/*
+ * Name of the checkpoint state file group in which sinks record, for
+ * each input stream, the number of packets they durably wrote.
+ */
+#define BT_COMMON_CHECKPOINT_STREAMS_GROUP	"streams"
+
+/*
+ * Loads the checkpoint state file `path`.
+ *
+ * Returns an empty key file if `path` does not exist, or `NULL` on
+ * error. The caller owns the returned key file.
+ */
+BT_HIDDEN
+GKeyFile *bt_common_checkpoint_load(const char *path);
+
+/*
+ * Merges the groups and keys of `update` into the checkpoint state
+ * file `path`, replacing the existing values of the same keys, and
+ * atomically replaces the file.
+ *
+ * Returns 0 on success.
+ */
+BT_HIDDEN
+int bt_common_checkpoint_save(const char *path, GKeyFile *update);
+
+/*
+ * Returns the checkpoint state file key of the stream named
+ * `stream_name` (may be `NULL`), of ID `stream_id` (-1 if none), of
+ * the stream class of ID `stream_class_id`, within the trace named
+ * `trace_name` (may be `NULL`).
+ *
+ * The caller owns the returned string, which must be freed with
+ * g_free().
+ */
+BT_HIDDEN
+gchar *bt_common_checkpoint_stream_key(const char *trace_name,
+		int64_t stream_class_id, int64_t stream_id,
+		const char *stream_name);
+
+/*
+ * Binary serialization: values are written in the native byte order.
+ * A file written with these functions must start with a magic number
+ * so that a file written on a machine with another byte order is
+ * rejected because its magic number does not match.
+ */
+
+/* Reader of a buffer written with the bt_common_bin_write_*() functions */
+struct bt_common_bin_reader {
+	const uint8_t *buf;
+	size_t len;
+
+	/* Offset, within `buf`, of the next byte to read */
+	size_t at;
+};
+
+struct bt_value;
+
+BT_HIDDEN
+void bt_common_bin_write_u8(GByteArray *buf, uint8_t val);
+
+BT_HIDDEN
+void bt_common_bin_write_u32(GByteArray *buf, uint32_t val);
+
+BT_HIDDEN
+void bt_common_bin_write_u64(GByteArray *buf, uint64_t val);
+
+/*
+ * Writes the string `str`, which may be `NULL`.
+ */
+BT_HIDDEN
+void bt_common_bin_write_str(GByteArray *buf, const char *str);
+
+/*
+ * Writes the value `value` and, recursively, its elements or entries.
+ * Map entries are written in key order so that equal values are always
+ * written the same way.
+ *
+ * Returns 0 on success.
+ */
+BT_HIDDEN
+int bt_common_bin_write_value(GByteArray *buf, struct bt_value *value);
+
+/*
+ * Reads `len` bytes into `dst`.
+ *
+ * Returns 0 on success, or -1 if `reader` has less than `len` bytes
+ * left.
+ */
+BT_HIDDEN
+int bt_common_bin_read_bytes(struct bt_common_bin_reader *reader,
+		void *dst, size_t len);
+
+BT_HIDDEN
+int bt_common_bin_read_u8(struct bt_common_bin_reader *reader,
+		uint8_t *val);
+
+BT_HIDDEN
+int bt_common_bin_read_u32(struct bt_common_bin_reader *reader,
+		uint32_t *val);
+
+BT_HIDDEN
+int bt_common_bin_read_u64(struct bt_common_bin_reader *reader,
+		uint64_t *val);
+
+BT_HIDDEN
+int bt_common_bin_read_i64(struct bt_common_bin_reader *reader,
+		int64_t *val);
+
+/*
+ * Reads a string written with bt_common_bin_write_str(): on success,
+ * `*str` is `NULL` or a new string which must be freed with g_free().
+ *
+ * Returns 0 on success.
+ */
+BT_HIDDEN
+int bt_common_bin_read_str(struct bt_common_bin_reader *reader, char **str);
+
+/*
+ * Reads a value written with bt_common_bin_write_value().
+ *
+ * Returns a new value, or `NULL` on error.
+ */
+BT_HIDDEN
+struct bt_value *bt_common_bin_read_value(
+		struct bt_common_bin_reader *reader);
+
+/*
+ * Runs a job of bt_common_run_jobs(). `thread_data` is the data of
+ * the thread which runs the job.
+ *
+ * Returns 0 on success.
+ */
+typedef int (*bt_common_job_func)(void *job, void *thread_data);
+
+/*
+ * Returns the number of threads, including the calling thread, with
+ * which to run `job_count` independent jobs: one thread for each
+ * `min_jobs_per_thread` jobs, without exceeding the number of online
+ * CPUs and `max_thread_count`. Always returns at least 1.
+ */
+BT_HIDDEN
+size_t bt_common_get_job_thread_count(size_t job_count,
+		size_t min_jobs_per_thread, size_t max_thread_count);
+
+/*
+ * Runs `func` on each of the `job_count` jobs of the array `jobs`,
+ * each one being `job_size` bytes, with the calling thread and
+ * `thread_count - 1` worker threads.
+ *
+ * `thread_data` is `NULL` or an array of `thread_count` pointers: the
+ * first one is passed to `func` when the calling thread runs a job,
+ * and the others when the corresponding worker thread does.
+ *
+ * The jobs are claimed in order, and no job is claimed once a job
+ * fails, so that all the jobs before the first failed one are run.
+ * Failing to create a worker thread is not fatal: the other threads
+ * run its jobs.
+ *
+ * Returns 0 if all the jobs succeeded, or -1 otherwise.
+ */
+BT_HIDDEN
+int bt_common_run_jobs(void *jobs, size_t job_count, size_t job_size,
+		bt_common_job_func func, void **thread_data,
+		size_t thread_count);
+
 #endif /* BABELTRACE_COMMON_INTERNAL_H */
@@ -33,6 +33,7 @@
 #include <errno.h>
 
 #define _SC_PAGESIZE 30
+#define _SC_NPROCESSORS_ONLN 84
 
 static inline
 long bt_sysconf(int name)
@@ -43,6 +44,9 @@ long bt_sysconf(int name)
 	case _SC_PAGESIZE:
 		GetNativeSystemInfo(&si);
 		return si.dwPageSize;
+	case _SC_NPROCESSORS_ONLN:
+		GetNativeSystemInfo(&si);
+		return si.dwNumberOfProcessors;
 	default:
 		errno = EINVAL;
 		return -1;
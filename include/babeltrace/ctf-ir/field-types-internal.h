@@ -28,6 +28,7 @@
  */
 
 #include <stdint.h>
+#include <assert.h>
 #include <babeltrace/ctf-writer/event-types.h>
 #include <babeltrace/ctf-writer/event-fields.h>
 #include <babeltrace/ctf-writer/writer.h>
@@ -43,6 +44,25 @@ typedef void (*type_freeze_func)(struct bt_ctf_field_type *);
 typedef int (*type_serialize_func)(struct bt_ctf_field_type *,
 		struct metadata_context *);
 
+/*
+ * Static layout of a field type, computed when it is frozen.
+ */
+struct bt_ctf_field_type_layout {
+	/* True if all the fields of this type have the same size */
+	bt_bool has_static_size;
+
+	/* Size (bits) of a field of this type if `has_static_size` is true */
+	uint64_t static_size;
+
+	/*
+	 * Byte order of a field of this type if it's a basic field type
+	 * (integer, floating point number, or enumeration), or
+	 * BT_CTF_BYTE_ORDER_UNKNOWN otherwise. BT_CTF_BYTE_ORDER_NETWORK
+	 * is reported as BT_CTF_BYTE_ORDER_BIG_ENDIAN.
+	 */
+	enum bt_ctf_byte_order byte_order;
+};
+
 struct bt_ctf_field_type {
 	struct bt_object base;
 	enum bt_ctf_field_type_id id;
@@ -61,6 +81,9 @@ struct bt_ctf_field_type {
 	 * a valid field type are also valid (and thus frozen).
 	 */
 	int valid;
+
+	/* Only set when frozen: use bt_ctf_field_type_get_layout() */
+	struct bt_ctf_field_type_layout layout;
 };
 
 struct bt_ctf_field_type_integer {
@@ -90,6 +113,10 @@ struct bt_ctf_field_type_enumeration {
 	struct bt_ctf_field_type parent;
 	struct bt_ctf_field_type *container;
 	GPtrArray *entries; /* Array of ptrs to struct enumeration_mapping */
+
+	/* Contiguous storage of the mappings of `entries` once frozen */
+	struct enumeration_mapping *compact_entries;
+
 	/* Only set during validation. */
 	bt_bool has_overlapping_ranges;
 };
@@ -124,10 +151,24 @@ struct structure_field {
 	struct bt_ctf_field_type *type;
 };
 
+/* Entry of a field name index, sorted by name */
+struct field_name_index_entry {
+	GQuark name;
+	guint index;
+};
+
+/*
+ * When a non-empty structure or variant field type is frozen, it is
+ * compacted: its fields are moved to `compact_fields`, a single array
+ * to which `fields` points, and `field_name_to_index` is replaced by
+ * `field_name_index`.
+ */
 struct bt_ctf_field_type_structure {
 	struct bt_ctf_field_type parent;
-	GHashTable *field_name_to_index;
+	GHashTable *field_name_to_index; /* NULL once compacted */
 	GPtrArray *fields; /* Array of pointers to struct structure_field */
+	struct structure_field *compact_fields;
+	struct field_name_index_entry *field_name_index;
 };
 
 struct bt_ctf_field_type_variant {
@@ -135,8 +176,10 @@ struct bt_ctf_field_type_variant {
 	GString *tag_name;
 	struct bt_ctf_field_type_enumeration *tag;
 	struct bt_ctf_field_path *tag_field_path;
-	GHashTable *field_name_to_index;
+	GHashTable *field_name_to_index; /* NULL once compacted */
 	GPtrArray *fields; /* Array of pointers to struct structure_field */
+	struct structure_field *compact_fields;
+	struct field_name_index_entry *field_name_index;
 };
 
 struct bt_ctf_field_type_array {
@@ -160,6 +203,20 @@ struct bt_ctf_field_type_string {
 BT_HIDDEN
 void bt_ctf_field_type_freeze(struct bt_ctf_field_type *type);
 
+/*
+ * Returns the static layout of `type`, or NULL if `type` is not frozen.
+ *
+ * The space of a field of which the type has a static size can be
+ * reserved at once, before writing its contents.
+ */
+static inline
+const struct bt_ctf_field_type_layout *bt_ctf_field_type_get_layout(
+		struct bt_ctf_field_type *type)
+{
+	assert(type);
+	return type->frozen ? &type->layout : NULL;
+}
+
 BT_HIDDEN
 struct bt_ctf_field_type *bt_ctf_field_type_variant_get_field_type_signed(
 		struct bt_ctf_field_type_variant *variant, int64_t tag_value);
@@ -215,6 +272,25 @@ BT_HIDDEN
 int bt_ctf_field_type_get_field_index(struct bt_ctf_field_type *type,
 		const char *name);
 
+/*
+ * Replaces the child field type at index `index` of the compound
+ * field type `type` with `field_type` (`index` is ignored for array
+ * and sequence field types). `type` must not be frozen.
+ */
+BT_HIDDEN
+int bt_ctf_field_type_set_field_at_index(struct bt_ctf_field_type *type,
+		int index, struct bt_ctf_field_type *field_type);
+
+/*
+ * Copies the compound field type node `type` without copying its
+ * child field types: the copy shares the children, the variant tag
+ * field type, and the length/tag field path of `type`. The copy is
+ * not frozen.
+ */
+BT_HIDDEN
+struct bt_ctf_field_type *bt_ctf_field_type_copy_shallow(
+		struct bt_ctf_field_type *type);
+
 BT_HIDDEN
 int bt_ctf_field_type_integer_set_mapped_clock_class_no_check(
 		struct bt_ctf_field_type *int_field_type,
@@ -64,7 +64,6 @@ struct bt_ctf_field_floating_point {
 
 struct bt_ctf_field_structure {
 	struct bt_ctf_field parent;
-	GHashTable *field_name_to_index;
 	GPtrArray *fields; /* Array of pointers to struct bt_ctf_field */
 };
 
@@ -53,20 +53,26 @@ enum bt_ctf_resolve_flag {
  *
  * Resolving is performed based on the flags in `flags`.
  *
- * It is expected that, amongst all the provided types, no common
- * references to sequence variant field types exist. In other words,
- * this function does not copy field types.
+ * The provided field types are never modified: resolving is
+ * copy-on-write. When a resolved root field type needs a different
+ * length/tag field path or tag field type within it, the affected
+ * sequence and variant field types, as well as their ancestors, are
+ * copied shallowly, and the copies share all the unchanged subtrees
+ * with the original. The corresponding `*_type` parameter is then
+ * replaced with the resolved copy (the original reference is put).
+ * Thus, common references to sequence and variant field types amongst
+ * the provided types are allowed.
  *
  * All parameters are owned by the caller.
  */
 BT_HIDDEN
 int bt_ctf_resolve_types(struct bt_value *environment,
-		struct bt_ctf_field_type *packet_header_type,
-		struct bt_ctf_field_type *packet_context_type,
-		struct bt_ctf_field_type *event_header_type,
-		struct bt_ctf_field_type *stream_event_ctx_type,
-		struct bt_ctf_field_type *event_context_type,
-		struct bt_ctf_field_type *event_payload_type,
+		struct bt_ctf_field_type **packet_header_type,
+		struct bt_ctf_field_type **packet_context_type,
+		struct bt_ctf_field_type **event_header_type,
+		struct bt_ctf_field_type **stream_event_ctx_type,
+		struct bt_ctf_field_type **event_context_type,
+		struct bt_ctf_field_type **event_payload_type,
 		enum bt_ctf_resolve_flag flags);
 
 #endif /* BABELTRACE_CTF_IR_RESOLVE_INTERNAL_H */
@@ -68,6 +68,15 @@ BT_HIDDEN
 int bt_ctf_stream_class_serialize(struct bt_ctf_stream_class *stream_class,
 		struct metadata_context *context);
 
+/*
+ * Serializes the event classes of `stream_class` from the index
+ * `first_index`, without the stream class's own block.
+ */
+BT_HIDDEN
+int bt_ctf_stream_class_serialize_event_classes(
+		struct bt_ctf_stream_class *stream_class,
+		struct metadata_context *context, uint64_t first_index);
+
 BT_HIDDEN
 void bt_ctf_stream_class_set_byte_order(
 		struct bt_ctf_stream_class *stream_class, int byte_order);
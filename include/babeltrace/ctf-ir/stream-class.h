@@ -584,6 +584,43 @@ extern int bt_ctf_stream_class_add_event_class(
 		struct bt_ctf_stream_class *stream_class,
 		struct bt_ctf_event_class *event_class);
 
+/**
+@brief	Adds the \p count CTF IR event classes \p event_classes to the
+	CTF IR stream class \p stream_class.
+
+This function is equivalent to calling
+bt_ctf_stream_class_add_event_class() for each event class of
+\p event_classes, but it's faster when adding many event classes: the
+field types of \p stream_class and of its trace class are obtained
+once, each event class is validated once, and the event class IDs are
+checked with a hash table lookup.
+
+Either all the event classes are added, or none of them are: if any
+event class cannot be added, this function fails without modifying
+\p stream_class. However, the automatically assigned IDs of the event
+classes which had no ID can remain set.
+
+@param[in] stream_class	Stream class to which to add \p event_classes.
+@param[in] event_classes	Event classes to add to \p stream_class.
+@param[in] count	Number of event classes in \p event_classes.
+@returns		0 on success, or a negative value on error.
+
+@prenotnull{stream_class}
+@pre \p event_classes contains \p count distinct, non-NULL
+	event classes.
+@pre Each event class of \p event_classes is not frozen.
+@postrefcountsame{stream_class}
+@post <strong>On success</strong>, the reference count of each event
+	class of \p event_classes is incremented, and each event class
+	of \p event_classes is frozen.
+
+@sa bt_ctf_stream_class_add_event_class(): Adds a single event
+	class to a stream class.
+*/
+extern int bt_ctf_stream_class_add_event_classes(
+		struct bt_ctf_stream_class *stream_class,
+		struct bt_ctf_event_class **event_classes, uint64_t count);
+
 /** @} */
 
 /**
@@ -90,6 +90,15 @@ struct bt_ctf_stream {
 BT_HIDDEN
 int bt_ctf_stream_set_fd(struct bt_ctf_stream *stream, int fd);
 
+/*
+ * Creates a stream without checking if its trace was created by a CTF
+ * writer. `id` is -1ULL to use the stream class's next stream ID.
+ */
+BT_HIDDEN
+struct bt_ctf_stream *bt_ctf_stream_create_with_id_no_check(
+		struct bt_ctf_stream_class *stream_class,
+		const char *name, uint64_t id);
+
 BT_HIDDEN
 void bt_ctf_stream_map_component_to_port(struct bt_ctf_stream *stream,
 		struct bt_component *comp,
@@ -79,6 +79,43 @@ struct metadata_context {
 	unsigned int current_indentation_level;
 };
 
+/*
+ * What was already serialized by
+ * bt_ctf_trace_get_metadata_string_incremental().
+ */
+struct bt_ctf_trace_metadata_state {
+	/* Signature, trace, environment, and clock class blocks */
+	GString *preamble;
+
+	/*
+	 * Number of serialized event classes (size_t) for each
+	 * serialized stream class, in the trace's stream class order.
+	 */
+	GArray *event_class_counts;
+};
+
+BT_HIDDEN
+int bt_ctf_trace_metadata_state_init(struct bt_ctf_trace_metadata_state *state);
+
+BT_HIDDEN
+void bt_ctf_trace_metadata_state_fini(struct bt_ctf_trace_metadata_state *state);
+
+BT_HIDDEN
+void bt_ctf_trace_metadata_state_reset(struct bt_ctf_trace_metadata_state *state);
+
+/*
+ * Returns the metadata of `trace` which is not described by `state`
+ * yet (possibly an empty string), and updates `state`.
+ *
+ * `*is_full` is set to true when the returned string is the complete
+ * metadata, which replaces any previously returned one; this happens
+ * when something else than new stream classes, event classes, or
+ * clock classes was added to or modified in `trace`.
+ */
+BT_HIDDEN
+char *bt_ctf_trace_get_metadata_string_incremental(struct bt_ctf_trace *trace,
+		struct bt_ctf_trace_metadata_state *state, bt_bool *is_full);
+
 BT_HIDDEN
 const char *get_byte_order_string(int byte_order);
 
@@ -33,7 +33,9 @@
 #include <dirent.h>
 #include <sys/types.h>
 #include <babeltrace/ctf-ir/trace.h>
+#include <babeltrace/ctf-ir/trace-internal.h>
 #include <babeltrace/object-internal.h>
+#include <babeltrace/types.h>
 
 struct bt_ctf_writer {
 	struct bt_object base;
@@ -42,6 +44,12 @@ struct bt_ctf_writer {
 	GString *path;
 	int trace_dir_fd;
 	int metadata_fd;
+
+	/* What the metadata file already contains */
+	struct bt_ctf_trace_metadata_state metadata_state;
+	bt_bool packetized_metadata;
+	/* Open the existing stream files in append mode */
+	bt_bool append_stream_files;
 };
 
 BT_HIDDEN
@@ -79,6 +79,42 @@ extern struct bt_ctf_stream *bt_ctf_writer_create_stream(
 		struct bt_ctf_writer *writer,
 		struct bt_ctf_stream_class *stream_class);
 
+/*
+ * bt_ctf_writer_create_stream_with_id: create a stream instance with an ID.
+ *
+ * Like bt_ctf_writer_create_stream(), but the stream's ID, and thus the
+ * numeric suffix of its stream file's name, is \p id instead of being
+ * chosen automatically. The ID must be unique amongst the streams of the
+ * same stream class.
+ *
+ * @param writer Writer instance.
+ * @param stream_class Stream class to instantiate.
+ * @param id Stream's ID (must be less than or equal to INT64_MAX).
+ *
+ * Returns an allocated stream on success, NULL on error.
+ */
+extern struct bt_ctf_stream *bt_ctf_writer_create_stream_with_id(
+		struct bt_ctf_writer *writer,
+		struct bt_ctf_stream_class *stream_class, uint64_t id);
+
+/*
+ * bt_ctf_writer_set_append_stream_files: set the stream files' open mode.
+ *
+ * Set whether the streams which the writer creates append their packets
+ * to their existing stream file instead of truncating it (the default).
+ * This makes it possible to continue a trace which a previous writer
+ * wrote to the same path.
+ *
+ * This cannot be changed once the writer created its first stream.
+ *
+ * @param writer Writer instance.
+ * @param append BT_TRUE to append to existing stream files.
+ *
+ * Returns 0 on success, a negative value on error.
+ */
+extern int bt_ctf_writer_set_append_stream_files(struct bt_ctf_writer *writer,
+		bt_bool append);
+
 /*
  * bt_ctf_writer_add_environment_field: add an environment field to the trace.
  *
@@ -145,10 +181,32 @@ extern char *bt_ctf_writer_get_metadata_string(struct bt_ctf_writer *writer);
  * be flushed automatically when the Writer instance is released (last call to
  * bt_ctf_writer_put).
  *
+ * Only the stream classes, event classes, and clocks which were added since
+ * the last flush are appended to the metadata file. The metadata file is
+ * rewritten completely if anything else changed in the trace's metadata.
+ *
  * @param writer Writer instance.
  */
 extern void bt_ctf_writer_flush_metadata(struct bt_ctf_writer *writer);
 
+/*
+ * bt_ctf_writer_set_packetized_metadata: set the metadata file's format.
+ *
+ * Set whether the metadata file is written as packetized metadata (a
+ * sequence of metadata packets, each one with a packet header) or as
+ * plain text (the default). Since each flush appends complete packets,
+ * a live consumer can read a packetized metadata file while it grows.
+ *
+ * Changing the format rewrites the whole metadata file on the next flush.
+ *
+ * @param writer Writer instance.
+ * @param packetized BT_TRUE to write packetized metadata.
+ *
+ * Returns 0 on success, a negative value on error.
+ */
+extern int bt_ctf_writer_set_packetized_metadata(struct bt_ctf_writer *writer,
+		bt_bool packetized);
+
 /*
  * bt_ctf_writer_set_byte_order: set a field type's byte order.
  *
@@ -59,6 +59,18 @@ struct bt_graph {
 
 	bt_bool canceled;
 
+	/* Cooperative memory budget (see bt_graph_set_memory_budget()) */
+	struct {
+		/* Budget (bytes), 0 if none */
+		uint64_t budget;
+
+		/* Currently reserved (bytes) */
+		uint64_t reserved;
+
+		/* Maximum value of `reserved` */
+		uint64_t peak_reserved;
+	} memory;
+
 	struct {
 		GArray *port_added;
 		GArray *port_removed;
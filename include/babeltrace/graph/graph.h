@@ -29,6 +29,7 @@
 
 #include <babeltrace/graph/component.h>
 #include <babeltrace/types.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -120,6 +121,46 @@ extern int bt_graph_add_ports_disconnected_listener(struct bt_graph *graph,
 extern enum bt_graph_status bt_graph_cancel(struct bt_graph *graph);
 extern bt_bool bt_graph_is_canceled(struct bt_graph *graph);
 
+/**
+ * Sets the memory budget of the graph to `budget` bytes (0 means no
+ * budget, which is the default).
+ *
+ * The memory budget is cooperative: components which hold large
+ * buffers or memory mappings reserve them from the budget with
+ * bt_graph_reserve_memory() and, when a reservation is refused, use
+ * smaller buffers or release the idle ones, so that the graph runs
+ * within a fixed memory envelope.
+ */
+extern enum bt_graph_status bt_graph_set_memory_budget(struct bt_graph *graph,
+		uint64_t budget);
+
+extern enum bt_graph_status bt_graph_get_memory_budget(struct bt_graph *graph,
+		uint64_t *budget);
+
+/**
+ * Gets the number of bytes which are currently reserved from the
+ * graph's memory budget.
+ */
+extern enum bt_graph_status bt_graph_get_reserved_memory(
+		struct bt_graph *graph, uint64_t *reserved);
+
+/**
+ * Reserves `size` bytes from the graph's memory budget.
+ *
+ * Returns BT_GRAPH_STATUS_AGAIN, without reserving anything, if the
+ * reservation would exceed the budget. Always succeeds if the graph
+ * has no memory budget.
+ */
+extern enum bt_graph_status bt_graph_reserve_memory(struct bt_graph *graph,
+		uint64_t size);
+
+/**
+ * Releases `size` bytes previously reserved with
+ * bt_graph_reserve_memory().
+ */
+extern enum bt_graph_status bt_graph_release_memory(struct bt_graph *graph,
+		uint64_t size);
+
 #ifdef __cplusplus
 }
 #endif
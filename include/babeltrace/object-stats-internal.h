@@ -0,0 +1,69 @@
+#ifndef BABELTRACE_OBJECT_STATS_INTERNAL_H
+#define BABELTRACE_OBJECT_STATS_INTERNAL_H
+
+/*
+ * Babeltrace - Object statistics (internal)
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/object-stats.h>
+
+BT_HIDDEN
+extern bool bt_object_stats_enabled;
+
+BT_HIDDEN
+void bt_object_stats_add(enum bt_object_stats_type type, size_t size);
+
+BT_HIDDEN
+void bt_object_stats_remove(enum bt_object_stats_type type, size_t size);
+
+/*
+ * Accounts for the creation of an object of type `type` of which the
+ * structure is `size` bytes. This is a single, predictable branch
+ * when the object statistics are disabled.
+ */
+static inline
+void bt_object_stats_record_create(enum bt_object_stats_type type,
+		size_t size)
+{
+	if (unlikely(bt_object_stats_enabled)) {
+		bt_object_stats_add(type, size);
+	}
+}
+
+/*
+ * Accounts for the destruction of an object previously recorded with
+ * bt_object_stats_record_create() with the same `type` and `size`.
+ */
+static inline
+void bt_object_stats_record_destroy(enum bt_object_stats_type type,
+		size_t size)
+{
+	if (unlikely(bt_object_stats_enabled)) {
+		bt_object_stats_remove(type, size);
+	}
+}
+
+#endif /* BABELTRACE_OBJECT_STATS_INTERNAL_H */
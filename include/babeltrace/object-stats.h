@@ -0,0 +1,203 @@
+#ifndef BABELTRACE_OBJECT_STATS_H
+#define BABELTRACE_OBJECT_STATS_H
+
+/*
+ * Babeltrace - Object statistics
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <babeltrace/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+@defgroup object-stats Object statistics
+@ingroup apiref
+@brief Object statistics.
+
+@code
+#include <babeltrace/object-stats.h>
+@endcode
+
+The functions in this module give access to the Babeltrace library's
+object statistics: the number of created and destroyed objects, as
+well as the current (live) and peak counts and sizes, for each
+object type of #bt_object_stats_type.
+
+The object statistics are disabled by default, so that they have no
+cost. You can enable them by setting the
+\c BABELTRACE_OBJECT_STATS environment variable to \c 1 before the
+library is loaded: the library cannot start accounting objects which
+already exist.
+
+The size of an object, as reported by the object statistics, is the
+size of its own structure. It does not include the size of the objects
+it refers to (for example, the fields of an event), nor the size of
+its variable-length contents (for example, the payload of a string
+field).
+
+@file
+@brief Object statistics functions.
+@sa object-stats
+
+@addtogroup object-stats
+@{
+*/
+
+/**
+@brief	Object statistics types.
+*/
+enum bt_object_stats_type {
+	/// Unknown (used for errors).
+	BT_OBJECT_STATS_TYPE_UNKNOWN = -1,
+
+	/// Integer field objects.
+	BT_OBJECT_STATS_TYPE_FIELD_INTEGER = 0,
+
+	/// Floating point number field objects.
+	BT_OBJECT_STATS_TYPE_FIELD_FLOAT,
+
+	/// Enumeration field objects.
+	BT_OBJECT_STATS_TYPE_FIELD_ENUM,
+
+	/// String field objects.
+	BT_OBJECT_STATS_TYPE_FIELD_STRING,
+
+	/// Structure field objects.
+	BT_OBJECT_STATS_TYPE_FIELD_STRUCT,
+
+	/// Array field objects.
+	BT_OBJECT_STATS_TYPE_FIELD_ARRAY,
+
+	/// Sequence field objects.
+	BT_OBJECT_STATS_TYPE_FIELD_SEQUENCE,
+
+	/// Variant field objects.
+	BT_OBJECT_STATS_TYPE_FIELD_VARIANT,
+
+	/// CTF IR event objects.
+	BT_OBJECT_STATS_TYPE_EVENT,
+
+	/// CTF IR packet objects.
+	BT_OBJECT_STATS_TYPE_PACKET,
+
+	/// Notification objects (all notification types).
+	BT_OBJECT_STATS_TYPE_NOTIFICATION,
+
+	/// CTF IR clock value objects.
+	BT_OBJECT_STATS_TYPE_CLOCK_VALUE,
+
+	/// Value objects (all value types but the null value).
+	BT_OBJECT_STATS_TYPE_VALUE,
+
+	/// Number of object statistics types.
+	BT_OBJECT_STATS_TYPE_NR,
+};
+
+/**
+@brief	Object statistics of one object type, or of all the object types.
+*/
+struct bt_object_stats {
+	/// Number of created objects.
+	uint64_t created;
+
+	/// Number of destroyed objects.
+	uint64_t destroyed;
+
+	/// Number of live (created, but not destroyed yet) objects.
+	uint64_t live;
+
+	/// Maximum value of \c live.
+	uint64_t peak_live;
+
+	/// Total size of the live objects (bytes).
+	uint64_t live_bytes;
+
+	/// Maximum value of \c live_bytes.
+	uint64_t peak_live_bytes;
+};
+
+/**
+@brief	Returns whether or not the object statistics of the Babeltrace
+	library are enabled.
+
+@returns	#BT_TRUE if the object statistics are enabled.
+*/
+extern bt_bool bt_object_stats_is_enabled(void);
+
+/**
+@brief	Returns the name of the object statistics type \p type.
+
+@param[in] type	Object statistics type.
+@returns	Name of \p type, or \c NULL if \p type is unknown.
+*/
+extern const char *bt_object_stats_type_string(
+		enum bt_object_stats_type type);
+
+/**
+@brief	Gets the current object statistics of the object type \p type
+	into \p stats.
+
+@param[in] type		Object statistics type.
+@param[out] stats	Returned object statistics.
+@returns		0 on success, or a negative value on error.
+
+@prenotnull{stats}
+@pre \p type is not #BT_OBJECT_STATS_TYPE_UNKNOWN and is less
+	than #BT_OBJECT_STATS_TYPE_NR.
+@pre The object statistics are enabled.
+
+@sa bt_object_stats_get_total(): Gets the object statistics of all
+	the object types.
+*/
+extern int bt_object_stats_get(enum bt_object_stats_type type,
+		struct bt_object_stats *stats);
+
+/**
+@brief	Gets the current object statistics of all the object types
+	into \p stats.
+
+The peak values of \p stats are the maximum values of the total live
+count and size, which can be less than the sum of the peak values of
+the individual object types.
+
+@param[out] stats	Returned object statistics.
+@returns		0 on success, or a negative value on error.
+
+@prenotnull{stats}
+@pre The object statistics are enabled.
+
+@sa bt_object_stats_get(): Gets the object statistics of a given
+	object type.
+*/
+extern int bt_object_stats_get_total(struct bt_object_stats *stats);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BABELTRACE_OBJECT_STATS_H */
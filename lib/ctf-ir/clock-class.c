@@ -38,6 +38,7 @@
 #include <babeltrace/compat/string-internal.h>
 #include <inttypes.h>
 #include <babeltrace/object-internal.h>
+#include <babeltrace/object-stats-internal.h>
 
 static
 void bt_ctf_clock_class_destroy(struct bt_object *obj);
@@ -582,6 +583,8 @@ void bt_ctf_clock_value_destroy(struct bt_object *obj)
 		"clock-class-name=\"%s\"", obj, value->clock_class,
 		bt_ctf_clock_class_get_name(value->clock_class));
 	bt_put(value->clock_class);
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_CLOCK_VALUE,
+		sizeof(*value));
 	g_free(value);
 }
 
@@ -606,6 +609,8 @@ struct bt_ctf_clock_value *bt_ctf_clock_value_create(
 	}
 
 	bt_object_init(ret, bt_ctf_clock_value_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_CLOCK_VALUE,
+		sizeof(*ret));
 	ret->clock_class = bt_get(clock_class);
 	ret->value = value;
 	BT_LOGD("Created clock value object: clock-value-addr=%p, "
@@ -47,6 +47,7 @@
 #include <babeltrace/ctf-ir/utils.h>
 #include <babeltrace/ctf-writer/serialize-internal.h>
 #include <babeltrace/ref.h>
+#include <babeltrace/object-stats-internal.h>
 #include <babeltrace/ctf-ir/attributes-internal.h>
 #include <babeltrace/compiler-internal.h>
 #include <inttypes.h>
@@ -160,6 +161,8 @@ struct bt_ctf_event *bt_ctf_event_create(struct bt_ctf_event_class *event_class)
 	}
 
 	bt_object_init(event, bt_ctf_event_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_EVENT,
+		sizeof(*event));
 
 	/*
 	 * event does not share a common ancestor with the event class; it has
@@ -765,6 +768,8 @@ void bt_ctf_event_destroy(struct bt_object *obj)
 	bt_put(event->fields_payload);
 	BT_LOGD_STR("Putting event's packet.");
 	bt_put(event->packet);
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_EVENT,
+		sizeof(*event));
 	g_free(event);
 }
 
@@ -40,6 +40,7 @@
 #include <babeltrace/ref.h>
 #include <babeltrace/compiler-internal.h>
 #include <babeltrace/endian-internal.h>
+#include <babeltrace/align-internal.h>
 #include <float.h>
 #include <inttypes.h>
 #include <stdlib.h>
@@ -318,6 +319,182 @@ void destroy_structure_field(struct structure_field *field)
 	g_free(field);
 }
 
+static
+void put_compact_structure_field(struct structure_field *field)
+{
+	bt_put(field->type);
+}
+
+static
+int compare_field_name_index_entries(const void *a, const void *b)
+{
+	const struct field_name_index_entry *entry_a = a;
+	const struct field_name_index_entry *entry_b = b;
+
+	if (entry_a->name < entry_b->name) {
+		return -1;
+	} else if (entry_a->name > entry_b->name) {
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Finds the index of the field named `name` within the fields of a
+ * structure or variant field type, compacted or not.
+ */
+static
+bool get_structure_field_index(GHashTable *field_name_to_index,
+		struct field_name_index_entry *field_name_index,
+		GPtrArray *fields, GQuark name, size_t *index)
+{
+	bool found = false;
+
+	if (field_name_index) {
+		struct field_name_index_entry key = {
+			.name = name,
+		};
+		struct field_name_index_entry *entry;
+
+		entry = bsearch(&key, field_name_index, fields->len,
+			sizeof(*field_name_index),
+			compare_field_name_index_entries);
+		if (entry) {
+			*index = entry->index;
+			found = true;
+		}
+	} else {
+		gpointer value;
+
+		if (g_hash_table_lookup_extended(field_name_to_index,
+				GUINT_TO_POINTER(name), NULL, &value)) {
+			*index = GPOINTER_TO_SIZE(value);
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+/*
+ * Moves the fields of `*fields` to a single array, which
+ * `*compact_fields` is set to, replaces `*fields` with an array of the
+ * exact size pointing to them, and replaces `*field_name_to_index`
+ * with a field name index sorted by name. Leaves everything as is on
+ * error.
+ */
+static
+int compact_structure_fields(GPtrArray **fields,
+		GHashTable **field_name_to_index,
+		struct structure_field **compact_fields,
+		struct field_name_index_entry **field_name_index)
+{
+	int ret = 0;
+	guint i;
+	guint count = (*fields)->len;
+	GPtrArray *new_fields = NULL;
+	struct structure_field *new_compact_fields = NULL;
+	struct field_name_index_entry *new_field_name_index = NULL;
+
+	if (count == 0 || *compact_fields) {
+		goto end;
+	}
+
+	new_fields = g_ptr_array_sized_new(count);
+	new_compact_fields = g_new(struct structure_field, count);
+	new_field_name_index = g_new(struct field_name_index_entry, count);
+	if (!new_fields || !new_compact_fields || !new_field_name_index) {
+		BT_LOGE_STR("Failed to allocate compact structure/variant field type fields.");
+		ret = -1;
+		goto error;
+	}
+
+	g_ptr_array_set_free_func(new_fields,
+		(GDestroyNotify) put_compact_structure_field);
+	g_ptr_array_set_free_func(*fields, NULL);
+
+	for (i = 0; i < count; i++) {
+		struct structure_field *field = g_ptr_array_index(*fields, i);
+
+		/* Move the field type's reference */
+		new_compact_fields[i] = *field;
+		g_free(field);
+		new_field_name_index[i].name = new_compact_fields[i].name;
+		new_field_name_index[i].index = i;
+		g_ptr_array_add(new_fields, &new_compact_fields[i]);
+	}
+
+	qsort(new_field_name_index, count, sizeof(*new_field_name_index),
+		compare_field_name_index_entries);
+	g_ptr_array_free(*fields, TRUE);
+	*fields = new_fields;
+	g_hash_table_destroy(*field_name_to_index);
+	*field_name_to_index = NULL;
+	*compact_fields = new_compact_fields;
+	*field_name_index = new_field_name_index;
+	goto end;
+
+error:
+	if (new_fields) {
+		g_ptr_array_free(new_fields, TRUE);
+	}
+
+	g_free(new_compact_fields);
+	g_free(new_field_name_index);
+
+end:
+	return ret;
+}
+
+/*
+ * Moves the mappings of an enumeration field type to a single array.
+ * Leaves everything as is on error.
+ */
+static
+int compact_enumeration_mappings(
+		struct bt_ctf_field_type_enumeration *enumeration)
+{
+	int ret = 0;
+	guint i;
+	guint count = enumeration->entries->len;
+	GPtrArray *new_entries = NULL;
+	struct enumeration_mapping *new_compact_entries = NULL;
+
+	if (count == 0 || enumeration->compact_entries) {
+		goto end;
+	}
+
+	new_entries = g_ptr_array_sized_new(count);
+	new_compact_entries = g_new(struct enumeration_mapping, count);
+	if (!new_entries || !new_compact_entries) {
+		BT_LOGE_STR("Failed to allocate compact enumeration field type mappings.");
+		ret = -1;
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		new_compact_entries[i] = *(struct enumeration_mapping *)
+			g_ptr_array_index(enumeration->entries, i);
+		g_ptr_array_add(new_entries, &new_compact_entries[i]);
+	}
+
+	g_ptr_array_free(enumeration->entries, TRUE);
+	enumeration->entries = new_entries;
+	enumeration->compact_entries = new_compact_entries;
+	goto end;
+
+error:
+	if (new_entries) {
+		g_ptr_array_free(new_entries, TRUE);
+	}
+
+	g_free(new_compact_entries);
+
+end:
+	return ret;
+}
+
 static
 void check_ranges_overlap(gpointer element, gpointer query)
 {
@@ -2238,8 +2415,9 @@ struct bt_ctf_field_type *bt_ctf_field_type_structure_get_field_type_by_name(
 
 	structure = container_of(type, struct bt_ctf_field_type_structure,
 		parent);
-	if (!g_hash_table_lookup_extended(structure->field_name_to_index,
-			GUINT_TO_POINTER(name_quark), NULL, (gpointer *)&index)) {
+	if (!get_structure_field_index(structure->field_name_to_index,
+			structure->field_name_index, structure->fields,
+			name_quark, &index)) {
 		BT_LOGV("No such structure field type field name: "
 			"ft-addr=%p, field-name=\"%s\"",
 			type, name);
@@ -2526,8 +2704,9 @@ struct bt_ctf_field_type *bt_ctf_field_type_variant_get_field_type_by_name(
 	}
 
 	variant = container_of(type, struct bt_ctf_field_type_variant, parent);
-	if (!g_hash_table_lookup_extended(variant->field_name_to_index,
-			GUINT_TO_POINTER(name_quark), NULL, (gpointer *)&index)) {
+	if (!get_structure_field_index(variant->field_name_to_index,
+			variant->field_name_index, variant->fields,
+			name_quark, &index)) {
 		BT_LOGV("No such variant field type field name: "
 			"ft-addr=%p, field-name=\"%s\"",
 			type, field_name);
@@ -3304,6 +3483,138 @@ void bt_ctf_field_type_put(struct bt_ctf_field_type *type)
 	bt_put(type);
 }
 
+static
+enum bt_ctf_byte_order get_layout_byte_order(enum bt_ctf_byte_order bo)
+{
+	return bo == BT_CTF_BYTE_ORDER_NETWORK ?
+		BT_CTF_BYTE_ORDER_BIG_ENDIAN : bo;
+}
+
+/*
+ * Adds the size of a member field type, located `*offset` bits after
+ * the beginning of a compound field type with the layout `layout`, to
+ * the latter, and updates `*offset` to the end of the member.
+ */
+static
+void add_member_layout(struct bt_ctf_field_type_layout *layout,
+		struct bt_ctf_field_type *member_type, uint64_t *offset)
+{
+	const struct bt_ctf_field_type_layout *member_layout =
+		&member_type->layout;
+
+	assert(member_type->frozen);
+
+	if (!member_layout->has_static_size) {
+		layout->has_static_size = BT_FALSE;
+		return;
+	}
+
+	*offset = ALIGN(*offset, (uint64_t) member_type->alignment) +
+		member_layout->static_size;
+}
+
+/*
+ * Computes the static layout of a field type of which all the
+ * contained field types are frozen.
+ */
+static
+void set_field_type_layout(struct bt_ctf_field_type *type)
+{
+	struct bt_ctf_field_type_layout *layout = &type->layout;
+	uint64_t offset = 0;
+
+	layout->has_static_size = BT_TRUE;
+	layout->static_size = 0;
+	layout->byte_order = BT_CTF_BYTE_ORDER_UNKNOWN;
+
+	switch (type->id) {
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+	{
+		struct bt_ctf_field_type_integer *integer = container_of(
+			type, struct bt_ctf_field_type_integer, parent);
+
+		layout->static_size = integer->size;
+		layout->byte_order = get_layout_byte_order(
+			integer->user_byte_order);
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_FLOAT:
+	{
+		struct bt_ctf_field_type_floating_point *floating_point =
+			container_of(type,
+				struct bt_ctf_field_type_floating_point,
+				parent);
+
+		layout->static_size = floating_point->exp_dig +
+			floating_point->mant_dig;
+		layout->byte_order = get_layout_byte_order(
+			floating_point->user_byte_order);
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+	{
+		struct bt_ctf_field_type_enumeration *enumeration =
+			container_of(type,
+				struct bt_ctf_field_type_enumeration, parent);
+
+		*layout = enumeration->container->layout;
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+	{
+		struct bt_ctf_field_type_structure *structure = container_of(
+			type, struct bt_ctf_field_type_structure, parent);
+		guint i;
+
+		for (i = 0; i < structure->fields->len &&
+				layout->has_static_size; i++) {
+			struct structure_field *field = g_ptr_array_index(
+				structure->fields, i);
+
+			add_member_layout(layout, field->type, &offset);
+		}
+
+		layout->static_size = offset;
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+	{
+		struct bt_ctf_field_type_array *array = container_of(
+			type, struct bt_ctf_field_type_array, parent);
+
+		if (array->length == 0) {
+			break;
+		}
+
+		/*
+		 * Each element but the last one is followed by the
+		 * padding which aligns the next one.
+		 */
+		add_member_layout(layout, array->element_type, &offset);
+		if (layout->has_static_size) {
+			layout->static_size = offset +
+				(array->length - 1) *
+				ALIGN(offset,
+					(uint64_t) array->element_type->alignment);
+		}
+		break;
+	}
+	default:
+		/* Sequences, variants, and strings have a dynamic size */
+		layout->has_static_size = BT_FALSE;
+		break;
+	}
+
+	if (!layout->has_static_size) {
+		layout->static_size = 0;
+	}
+
+	BT_LOGV("Set field type's layout: addr=%p, has-static-size=%d, "
+		"static-size=%" PRIu64 ", bo=%s",
+		type, layout->has_static_size, layout->static_size,
+		bt_ctf_byte_order_string(layout->byte_order));
+}
+
 BT_HIDDEN
 void bt_ctf_field_type_freeze(struct bt_ctf_field_type *type)
 {
@@ -3312,6 +3623,9 @@ void bt_ctf_field_type_freeze(struct bt_ctf_field_type *type)
 	}
 
 	type->freeze(type);
+
+	/* All the contained field types are frozen now */
+	set_field_type_layout(type);
 }
 
 BT_HIDDEN
@@ -3321,7 +3635,7 @@ struct bt_ctf_field_type *bt_ctf_field_type_variant_get_field_type_signed(
 {
 	struct bt_ctf_field_type *type = NULL;
 	GQuark field_name_quark;
-	gpointer index;
+	size_t index;
 	struct structure_field *field_entry;
 	struct range_overlap_query query = {
 		.range_start._signed = tag_value,
@@ -3337,12 +3651,13 @@ struct bt_ctf_field_type *bt_ctf_field_type_variant_get_field_type_signed(
 	}
 
 	field_name_quark = query.mapping_name;
-	if (!g_hash_table_lookup_extended(variant->field_name_to_index,
-			GUINT_TO_POINTER(field_name_quark), NULL, &index)) {
+	if (!get_structure_field_index(variant->field_name_to_index,
+			variant->field_name_index, variant->fields,
+			field_name_quark, &index)) {
 		goto end;
 	}
 
-	field_entry = g_ptr_array_index(variant->fields, (size_t) index);
+	field_entry = g_ptr_array_index(variant->fields, index);
 	type = field_entry->type;
 end:
 	return type;
@@ -3355,7 +3670,7 @@ struct bt_ctf_field_type *bt_ctf_field_type_variant_get_field_type_unsigned(
 {
 	struct bt_ctf_field_type *type = NULL;
 	GQuark field_name_quark;
-	gpointer index;
+	size_t index;
 	struct structure_field *field_entry;
 	struct range_overlap_query query = {
 		.range_start._unsigned = tag_value,
@@ -3372,12 +3687,13 @@ struct bt_ctf_field_type *bt_ctf_field_type_variant_get_field_type_unsigned(
 	}
 
 	field_name_quark = query.mapping_name;
-	if (!g_hash_table_lookup_extended(variant->field_name_to_index,
-		GUINT_TO_POINTER(field_name_quark), NULL, &index)) {
+	if (!get_structure_field_index(variant->field_name_to_index,
+			variant->field_name_index, variant->fields,
+			field_name_quark, &index)) {
 		goto end;
 	}
 
-	field_entry = g_ptr_array_index(variant->fields, (size_t)index);
+	field_entry = g_ptr_array_index(variant->fields, index);
 	type = field_entry->type;
 end:
 	return type;
@@ -3425,6 +3741,145 @@ end:
 	return copy;
 }
 
+static
+int copy_structure_fields_shallow(GPtrArray *fields,
+		GHashTable *copy_field_name_to_index, GPtrArray *copy_fields)
+{
+	int ret = 0;
+	guint i;
+
+	for (i = 0; i < fields->len; i++) {
+		struct structure_field *entry = g_ptr_array_index(fields, i);
+		struct structure_field *copy_entry =
+			g_new0(struct structure_field, 1);
+
+		if (!copy_entry) {
+			BT_LOGE_STR("Failed to allocate one structure/variant field type field.");
+			ret = -1;
+			goto end;
+		}
+
+		copy_entry->name = entry->name;
+		copy_entry->type = bt_get(entry->type);
+		g_hash_table_insert(copy_field_name_to_index,
+			GUINT_TO_POINTER(entry->name), GUINT_TO_POINTER(i));
+		g_ptr_array_add(copy_fields, copy_entry);
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+struct bt_ctf_field_type *bt_ctf_field_type_copy_shallow(
+		struct bt_ctf_field_type *type)
+{
+	struct bt_ctf_field_type *copy = NULL;
+
+	assert(type);
+
+	switch (type->id) {
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+	{
+		struct bt_ctf_field_type_structure *structure, *copy_structure;
+
+		structure = container_of(type,
+			struct bt_ctf_field_type_structure, parent);
+		copy = bt_ctf_field_type_structure_create();
+		if (!copy) {
+			BT_LOGE_STR("Cannot create structure field type.");
+			goto error;
+		}
+
+		copy_structure = container_of(copy,
+			struct bt_ctf_field_type_structure, parent);
+		if (copy_structure_fields_shallow(
+				structure->fields,
+				copy_structure->field_name_to_index,
+				copy_structure->fields)) {
+			goto error;
+		}
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_VARIANT:
+	{
+		struct bt_ctf_field_type_variant *variant, *copy_variant;
+
+		variant = container_of(type,
+			struct bt_ctf_field_type_variant, parent);
+		copy = bt_ctf_field_type_variant_create(
+			variant->tag ? &variant->tag->parent : NULL,
+			variant->tag_name->len ? variant->tag_name->str : NULL);
+		if (!copy) {
+			BT_LOGE_STR("Cannot create variant field type.");
+			goto error;
+		}
+
+		copy_variant = container_of(copy,
+			struct bt_ctf_field_type_variant, parent);
+		if (copy_structure_fields_shallow(
+				variant->fields,
+				copy_variant->field_name_to_index,
+				copy_variant->fields)) {
+			goto error;
+		}
+
+		copy_variant->tag_field_path = bt_get(variant->tag_field_path);
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+	{
+		struct bt_ctf_field_type_array *array = container_of(type,
+			struct bt_ctf_field_type_array, parent);
+
+		copy = bt_ctf_field_type_array_create(array->element_type,
+			array->length);
+		if (!copy) {
+			BT_LOGE_STR("Cannot create array field type.");
+			goto error;
+		}
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_SEQUENCE:
+	{
+		struct bt_ctf_field_type_sequence *sequence, *copy_sequence;
+
+		sequence = container_of(type,
+			struct bt_ctf_field_type_sequence, parent);
+		copy = bt_ctf_field_type_sequence_create(
+			sequence->element_type,
+			sequence->length_field_name->len ?
+				sequence->length_field_name->str : NULL);
+		if (!copy) {
+			BT_LOGE_STR("Cannot create sequence field type.");
+			goto error;
+		}
+
+		copy_sequence = container_of(copy,
+			struct bt_ctf_field_type_sequence, parent);
+		copy_sequence->length_field_path =
+			bt_get(sequence->length_field_path);
+		break;
+	}
+	default:
+		BT_LOGW("Invalid parameter: field type is not a compound field type: "
+			"addr=%p, ft-id=%s", type,
+			bt_ctf_field_type_id_string(type->id));
+		goto error;
+	}
+
+	copy->alignment = type->alignment;
+	BT_LOGV("Copied field type (shallow): original-ft-addr=%p, copy-ft-addr=%p",
+		type, copy);
+	goto end;
+
+error:
+	BT_PUT(copy);
+
+end:
+	return copy;
+}
+
 BT_HIDDEN
 int bt_ctf_field_type_structure_get_field_name_index(
 		struct bt_ctf_field_type *type, const char *name)
@@ -3465,9 +3920,9 @@ int bt_ctf_field_type_structure_get_field_name_index(
 
 	structure = container_of(type, struct bt_ctf_field_type_structure,
 		parent);
-	if (!g_hash_table_lookup_extended(structure->field_name_to_index,
-			GUINT_TO_POINTER(name_quark),
-			NULL, (gpointer *)&index)) {
+	if (!get_structure_field_index(structure->field_name_to_index,
+			structure->field_name_index, structure->fields,
+			name_quark, &index)) {
 		BT_LOGV("No such structure field type field name: "
 			"ft-addr=%p, field-name=\"%s\"",
 			type, name);
@@ -3519,9 +3974,9 @@ int bt_ctf_field_type_variant_get_field_name_index(
 
 	variant = container_of(type, struct bt_ctf_field_type_variant,
 		parent);
-	if (!g_hash_table_lookup_extended(variant->field_name_to_index,
-			GUINT_TO_POINTER(name_quark),
-			NULL, (gpointer *)&index)) {
+	if (!get_structure_field_index(variant->field_name_to_index,
+			variant->field_name_index, variant->fields,
+			name_quark, &index)) {
 		BT_LOGV("No such variant field type field name: "
 			"ft-addr=%p, field-name=\"%s\"",
 			type, name);
@@ -3665,6 +4120,7 @@ void bt_ctf_field_type_enumeration_destroy(struct bt_ctf_field_type *type)
 
 	BT_LOGD("Destroying enumeration field type object: addr=%p", type);
 	g_ptr_array_free(enumeration->entries, TRUE);
+	g_free(enumeration->compact_entries);
 	BT_LOGD_STR("Putting container field type.");
 	bt_put(enumeration->container);
 	g_free(enumeration);
@@ -3696,7 +4152,13 @@ void bt_ctf_field_type_structure_destroy(struct bt_ctf_field_type *type)
 
 	BT_LOGD("Destroying structure field type object: addr=%p", type);
 	g_ptr_array_free(structure->fields, TRUE);
-	g_hash_table_destroy(structure->field_name_to_index);
+	g_free(structure->compact_fields);
+	g_free(structure->field_name_index);
+
+	if (structure->field_name_to_index) {
+		g_hash_table_destroy(structure->field_name_to_index);
+	}
+
 	g_free(structure);
 }
 
@@ -3712,7 +4174,13 @@ void bt_ctf_field_type_variant_destroy(struct bt_ctf_field_type *type)
 
 	BT_LOGD("Destroying variant field type object: addr=%p", type);
 	g_ptr_array_free(variant->fields, TRUE);
-	g_hash_table_destroy(variant->field_name_to_index);
+	g_free(variant->compact_fields);
+	g_free(variant->field_name_index);
+
+	if (variant->field_name_to_index) {
+		g_hash_table_destroy(variant->field_name_to_index);
+	}
+
 	g_string_free(variant->tag_name, TRUE);
 	BT_LOGD_STR("Putting tag field type.");
 	bt_put(&variant->tag->parent);
@@ -3803,6 +4271,9 @@ void bt_ctf_field_type_enumeration_freeze(struct bt_ctf_field_type *type)
 	BT_LOGD("Freezing enumeration field type object's container field type: int-ft-addr=%p",
 		enumeration_type->container);
 	bt_ctf_field_type_freeze(enumeration_type->container);
+
+	/* Not fatal: the mappings are kept as is on error */
+	compact_enumeration_mappings(enumeration_type);
 }
 
 static
@@ -3826,6 +4297,12 @@ void bt_ctf_field_type_structure_freeze(struct bt_ctf_field_type *type)
 	generic_field_type_freeze(type);
 	g_ptr_array_foreach(structure_type->fields,
 		(GFunc) freeze_structure_field, NULL);
+
+	/* Not fatal: the fields are kept as is on error */
+	compact_structure_fields(&structure_type->fields,
+		&structure_type->field_name_to_index,
+		&structure_type->compact_fields,
+		&structure_type->field_name_index);
 }
 
 static
@@ -3838,6 +4315,12 @@ void bt_ctf_field_type_variant_freeze(struct bt_ctf_field_type *type)
 	generic_field_type_freeze(type);
 	g_ptr_array_foreach(variant_type->fields,
 		(GFunc) freeze_structure_field, NULL);
+
+	/* Not fatal: the fields are kept as is on error */
+	compact_structure_fields(&variant_type->fields,
+		&variant_type->field_name_to_index,
+		&variant_type->compact_fields,
+		&variant_type->field_name_index);
 }
 
 static
@@ -4475,8 +4958,6 @@ struct bt_ctf_field_type *bt_ctf_field_type_structure_copy(
 		struct bt_ctf_field_type *type)
 {
 	int64_t i;
-	GHashTableIter iter;
-	gpointer key, value;
 	struct bt_ctf_field_type *copy;
 	struct bt_ctf_field_type_structure *structure, *copy_structure;
 
@@ -4492,13 +4973,6 @@ struct bt_ctf_field_type *bt_ctf_field_type_structure_copy(
 	copy_structure = container_of(copy,
 		struct bt_ctf_field_type_structure, parent);
 
-	/* Copy field_name_to_index */
-	g_hash_table_iter_init(&iter, structure->field_name_to_index);
-	while (g_hash_table_iter_next (&iter, &key, &value)) {
-		g_hash_table_insert(copy_structure->field_name_to_index,
-			key, value);
-	}
-
 	for (i = 0; i < structure->fields->len; i++) {
 		struct structure_field *entry, *copy_entry;
 		struct bt_ctf_field_type *copy_field;
@@ -4526,6 +5000,8 @@ struct bt_ctf_field_type *bt_ctf_field_type_structure_copy(
 
 		copy_entry->name = entry->name;
 		copy_entry->type = copy_field;
+		g_hash_table_insert(copy_structure->field_name_to_index,
+			GUINT_TO_POINTER(entry->name), GUINT_TO_POINTER(i));
 		g_ptr_array_add(copy_structure->fields, copy_entry);
 	}
 
@@ -4544,8 +5020,6 @@ struct bt_ctf_field_type *bt_ctf_field_type_variant_copy(
 		struct bt_ctf_field_type *type)
 {
 	int64_t i;
-	GHashTableIter iter;
-	gpointer key, value;
 	struct bt_ctf_field_type *copy = NULL, *copy_tag = NULL;
 	struct bt_ctf_field_type_variant *variant, *copy_variant;
 
@@ -4571,13 +5045,6 @@ struct bt_ctf_field_type *bt_ctf_field_type_variant_copy(
 	copy_variant = container_of(copy, struct bt_ctf_field_type_variant,
 		parent);
 
-	/* Copy field_name_to_index */
-	g_hash_table_iter_init(&iter, variant->field_name_to_index);
-	while (g_hash_table_iter_next (&iter, &key, &value)) {
-		g_hash_table_insert(copy_variant->field_name_to_index,
-			key, value);
-	}
-
 	for (i = 0; i < variant->fields->len; i++) {
 		struct structure_field *entry, *copy_entry;
 		struct bt_ctf_field_type *copy_field;
@@ -4605,6 +5072,8 @@ struct bt_ctf_field_type *bt_ctf_field_type_variant_copy(
 
 		copy_entry->name = entry->name;
 		copy_entry->type = copy_field;
+		g_hash_table_insert(copy_variant->field_name_to_index,
+			GUINT_TO_POINTER(entry->name), GUINT_TO_POINTER(i));
 		g_ptr_array_add(copy_variant->fields, copy_entry);
 	}
 
@@ -5308,6 +5777,62 @@ end:
 	return field;
 }
 
+BT_HIDDEN
+int bt_ctf_field_type_set_field_at_index(struct bt_ctf_field_type *type,
+		int index, struct bt_ctf_field_type *field_type)
+{
+	int ret = 0;
+	GPtrArray *fields = NULL;
+	struct structure_field *entry;
+
+	assert(type);
+	assert(field_type);
+
+	if (type->frozen) {
+		BT_LOGW("Invalid parameter: field type is frozen: addr=%p",
+			type);
+		ret = -1;
+		goto end;
+	}
+
+	switch (type->id) {
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+		fields = container_of(type, struct bt_ctf_field_type_structure,
+			parent)->fields;
+		break;
+	case BT_CTF_FIELD_TYPE_ID_VARIANT:
+		fields = container_of(type, struct bt_ctf_field_type_variant,
+			parent)->fields;
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+		ret = bt_ctf_field_type_array_set_element_type(type,
+			field_type);
+		goto end;
+	case BT_CTF_FIELD_TYPE_ID_SEQUENCE:
+		ret = bt_ctf_field_type_sequence_set_element_type(type,
+			field_type);
+		goto end;
+	default:
+		ret = -1;
+		goto end;
+	}
+
+	if (index < 0 || index >= fields->len) {
+		BT_LOGW("Invalid parameter: index is out of bounds: "
+			"addr=%p, index=%d, count=%u",
+			type, index, fields->len);
+		ret = -1;
+		goto end;
+	}
+
+	entry = g_ptr_array_index(fields, index);
+	bt_get(field_type);
+	BT_MOVE(entry->type, field_type);
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 int bt_ctf_field_type_get_field_index(struct bt_ctf_field_type *field_type,
 		const char *name)
@@ -33,6 +33,7 @@
 #include <babeltrace/ctf-ir/field-types-internal.h>
 #include <babeltrace/ctf-writer/serialize-internal.h>
 #include <babeltrace/object-internal.h>
+#include <babeltrace/object-stats-internal.h>
 #include <babeltrace/ref.h>
 #include <babeltrace/compiler-internal.h>
 #include <babeltrace/compat/fcntl-internal.h>
@@ -208,6 +209,31 @@ void (* const field_destroy_funcs[])(struct bt_ctf_field *) = {
 	[BT_CTF_FIELD_TYPE_ID_STRING] = bt_ctf_field_string_destroy,
 };
 
+static
+const enum bt_object_stats_type field_stats_types[] = {
+	[BT_CTF_FIELD_TYPE_ID_INTEGER] = BT_OBJECT_STATS_TYPE_FIELD_INTEGER,
+	[BT_CTF_FIELD_TYPE_ID_ENUM] = BT_OBJECT_STATS_TYPE_FIELD_ENUM,
+	[BT_CTF_FIELD_TYPE_ID_FLOAT] = BT_OBJECT_STATS_TYPE_FIELD_FLOAT,
+	[BT_CTF_FIELD_TYPE_ID_STRUCT] = BT_OBJECT_STATS_TYPE_FIELD_STRUCT,
+	[BT_CTF_FIELD_TYPE_ID_VARIANT] = BT_OBJECT_STATS_TYPE_FIELD_VARIANT,
+	[BT_CTF_FIELD_TYPE_ID_ARRAY] = BT_OBJECT_STATS_TYPE_FIELD_ARRAY,
+	[BT_CTF_FIELD_TYPE_ID_SEQUENCE] = BT_OBJECT_STATS_TYPE_FIELD_SEQUENCE,
+	[BT_CTF_FIELD_TYPE_ID_STRING] = BT_OBJECT_STATS_TYPE_FIELD_STRING,
+};
+
+static
+const size_t field_sizes[] = {
+	[BT_CTF_FIELD_TYPE_ID_INTEGER] = sizeof(struct bt_ctf_field_integer),
+	[BT_CTF_FIELD_TYPE_ID_ENUM] = sizeof(struct bt_ctf_field_enumeration),
+	[BT_CTF_FIELD_TYPE_ID_FLOAT] =
+		sizeof(struct bt_ctf_field_floating_point),
+	[BT_CTF_FIELD_TYPE_ID_STRUCT] = sizeof(struct bt_ctf_field_structure),
+	[BT_CTF_FIELD_TYPE_ID_VARIANT] = sizeof(struct bt_ctf_field_variant),
+	[BT_CTF_FIELD_TYPE_ID_ARRAY] = sizeof(struct bt_ctf_field_array),
+	[BT_CTF_FIELD_TYPE_ID_SEQUENCE] = sizeof(struct bt_ctf_field_sequence),
+	[BT_CTF_FIELD_TYPE_ID_STRING] = sizeof(struct bt_ctf_field_string),
+};
+
 static
 int (* const field_validate_funcs[])(struct bt_ctf_field *) = {
 	[BT_CTF_FIELD_TYPE_ID_INTEGER] = bt_ctf_field_generic_validate,
@@ -321,6 +347,8 @@ struct bt_ctf_field *bt_ctf_field_create(struct bt_ctf_field_type *type)
 	bt_get(type);
 	bt_object_init(field, bt_ctf_field_destroy);
 	field->type = type;
+	bt_object_stats_record_create(field_stats_types[type_id],
+		field_sizes[type_id]);
 error:
 	return field;
 }
@@ -512,10 +540,9 @@ struct bt_ctf_field *bt_ctf_field_structure_get_field_by_name(
 		struct bt_ctf_field *field, const char *name)
 {
 	struct bt_ctf_field *new_field = NULL;
-	GQuark field_quark;
 	struct bt_ctf_field_structure *structure;
 	struct bt_ctf_field_type *field_type = NULL;
-	size_t index;
+	int index;
 
 	if (!field) {
 		BT_LOGW_STR("Invalid parameter: field is NULL.");
@@ -536,14 +563,13 @@ struct bt_ctf_field *bt_ctf_field_structure_get_field_by_name(
 		goto error;
 	}
 
-	field_quark = g_quark_from_string(name);
 	structure = container_of(field, struct bt_ctf_field_structure, parent);
 	field_type =
 		bt_ctf_field_type_structure_get_field_type_by_name(field->type,
 		name);
-	if (!g_hash_table_lookup_extended(structure->field_name_to_index,
-			GUINT_TO_POINTER(field_quark),
-			NULL, (gpointer *)&index)) {
+	index = bt_ctf_field_type_structure_get_field_name_index(field->type,
+		name);
+	if (index < 0) {
 		BT_LOGV("Invalid parameter: no such field in structure field's type: "
 			"struct-field-addr=%p, struct-ft-addr=%p, "
 			"field-ft-addr=%p, name=\"%s\"",
@@ -666,10 +692,9 @@ int bt_ctf_field_structure_set_field(struct bt_ctf_field *field,
 		const char *name, struct bt_ctf_field *value)
 {
 	int ret = 0;
-	GQuark field_quark;
 	struct bt_ctf_field_structure *structure;
 	struct bt_ctf_field_type *expected_field_type = NULL;
-	size_t index;
+	int index;
 
 	if (!field) {
 		BT_LOGW_STR("Invalid parameter: structure field is NULL.");
@@ -699,7 +724,6 @@ int bt_ctf_field_structure_set_field(struct bt_ctf_field *field,
 		goto end;
 	}
 
-	field_quark = g_quark_from_string(name);
 	structure = container_of(field, struct bt_ctf_field_structure, parent);
 	expected_field_type =
 		bt_ctf_field_type_structure_get_field_type_by_name(field->type,
@@ -714,8 +738,9 @@ int bt_ctf_field_structure_set_field(struct bt_ctf_field *field,
 		goto end;
 	}
 
-	if (!g_hash_table_lookup_extended(structure->field_name_to_index,
-			GUINT_TO_POINTER(field_quark), NULL, (gpointer *) &index)) {
+	index = bt_ctf_field_type_structure_get_field_name_index(field->type,
+		name);
+	if (index < 0) {
 		BT_LOGV("Invalid parameter: no such field in structure field's type: "
 			"struct-field-addr=%p, struct-ft-addr=%p, "
 			"field-ft-addr=%p, name=\"%s\"",
@@ -1859,11 +1884,10 @@ struct bt_ctf_field *bt_ctf_field_structure_create(
 		goto end;
 	}
 
-	structure->field_name_to_index = structure_type->field_name_to_index;
 	structure->fields = g_ptr_array_new_with_free_func(
 		(GDestroyNotify)bt_ctf_field_put);
 	g_ptr_array_set_size(structure->fields,
-		g_hash_table_size(structure->field_name_to_index));
+		structure_type->fields->len);
 	field = &structure->parent;
 	BT_LOGD("Created structure field object: addr=%p, ft-addr=%p",
 		field, type);
@@ -1972,6 +1996,8 @@ void bt_ctf_field_destroy(struct bt_object *obj)
 	assert(type_id > BT_CTF_FIELD_TYPE_ID_UNKNOWN &&
 		type_id < BT_CTF_NR_TYPE_IDS);
 	field_destroy_funcs[type_id](field);
+	bt_object_stats_record_destroy(field_stats_types[type_id],
+		field_sizes[type_id]);
 	BT_LOGD_STR("Putting field's type.");
 	bt_put(type);
 }
@@ -2547,6 +2573,36 @@ end:
 	return ret;
 }
 
+/*
+ * Makes sure that `pos` can hold the alignment padding of `field` and,
+ * when its type has a static size, the whole field, so that its
+ * members do not need to grow the packet one after the other.
+ */
+static
+int reserve_field_space(struct bt_ctf_field *field,
+		struct bt_ctf_stream_pos *pos)
+{
+	int ret = 0;
+	uint64_t len = offset_align(pos->offset, field->type->alignment);
+	const struct bt_ctf_field_type_layout *layout =
+		bt_ctf_field_type_get_layout(field->type);
+
+	if (layout && layout->has_static_size) {
+		len += layout->static_size;
+	}
+
+	while (!bt_ctf_stream_pos_access_ok(pos, len)) {
+		ret = increase_packet_size(pos);
+		if (ret) {
+			BT_LOGE("Cannot increase packet size: ret=%d", ret);
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
 static
 int bt_ctf_field_structure_serialize(struct bt_ctf_field *field,
 		struct bt_ctf_stream_pos *pos,
@@ -2561,13 +2617,9 @@ int bt_ctf_field_structure_serialize(struct bt_ctf_field *field,
 		"native-bo=%s", field, pos->offset,
 		bt_ctf_byte_order_string(native_byte_order));
 
-	while (!bt_ctf_stream_pos_access_ok(pos,
-		offset_align(pos->offset, field->type->alignment))) {
-		ret = increase_packet_size(pos);
-		if (ret) {
-			BT_LOGE("Cannot increase packet size: ret=%d", ret);
-			goto end;
-		}
+	ret = reserve_field_space(field, pos);
+	if (ret) {
+		goto end;
 	}
 
 	if (!bt_ctf_stream_pos_align(pos, field->type->alignment)) {
@@ -2644,6 +2696,11 @@ int bt_ctf_field_array_serialize(struct bt_ctf_field *field,
 		"native-bo=%s", field, pos->offset,
 		bt_ctf_byte_order_string(native_byte_order));
 
+	ret = reserve_field_space(field, pos);
+	if (ret) {
+		goto end;
+	}
+
 	for (i = 0; i < array->elements->len; i++) {
 		struct bt_ctf_field *elem_field =
 			g_ptr_array_index(array->elements, i);
@@ -2819,8 +2876,6 @@ int bt_ctf_field_structure_copy(struct bt_ctf_field *src,
 	struct_src = container_of(src, struct bt_ctf_field_structure, parent);
 	struct_dst = container_of(dst, struct bt_ctf_field_structure, parent);
 
-	/* This field_name_to_index HT is owned by the structure field type */
-	struct_dst->field_name_to_index = struct_src->field_name_to_index;
 	g_ptr_array_set_size(struct_dst->fields, struct_src->fields->len);
 
 	for (i = 0; i < struct_src->fields->len; i++) {
@@ -37,6 +37,7 @@
 #include <babeltrace/ctf-ir/stream-internal.h>
 #include <babeltrace/ctf-ir/trace-internal.h>
 #include <babeltrace/object-internal.h>
+#include <babeltrace/object-stats-internal.h>
 #include <babeltrace/ref.h>
 #include <inttypes.h>
 
@@ -215,6 +216,8 @@ void bt_ctf_packet_destroy(struct bt_object *obj)
 	bt_put(packet->context);
 	BT_LOGD_STR("Putting packet's stream.");
 	bt_put(packet->stream);
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_PACKET,
+		sizeof(*packet));
 	g_free(packet);
 }
 
@@ -254,6 +257,8 @@ struct bt_ctf_packet *bt_ctf_packet_create(
 	}
 
 	bt_object_init(packet, bt_ctf_packet_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_PACKET,
+		sizeof(*packet));
 	packet->stream = bt_get(stream);
 
 	if (trace->packet_header_type) {
@@ -35,11 +35,13 @@
 #include <babeltrace/ctf-ir/stream-class.h>
 #include <babeltrace/ctf-ir/resolve-internal.h>
 #include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/ctf-ir/field-types-internal.h>
 #include <babeltrace/ctf-ir/field-path.h>
 #include <babeltrace/ctf-ir/field-path-internal.h>
 #include <babeltrace/ctf-ir/event-internal.h>
 #include <babeltrace/ref.h>
 #include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/compiler-internal.h>
 #include <babeltrace/values.h>
 #include <babeltrace/types.h>
 #include <limits.h>
@@ -988,20 +990,61 @@ end:
 	return ret;
 }
 
+/*
+ * Returns whether or not the field paths `field_path1` and
+ * `field_path2` are equal.
+ *
+ * `field_path1` and `field_path2` are owned by the caller.
+ */
+static
+bt_bool field_paths_are_equal(struct bt_ctf_field_path *field_path1,
+		struct bt_ctf_field_path *field_path2)
+{
+	guint i;
+
+	if (!field_path1 || !field_path2) {
+		return field_path1 == field_path2;
+	}
+
+	if (field_path1->root != field_path2->root ||
+			field_path1->indexes->len != field_path2->indexes->len) {
+		return BT_FALSE;
+	}
+
+	for (i = 0; i < field_path1->indexes->len; i++) {
+		if (g_array_index(field_path1->indexes, int, i) !=
+				g_array_index(field_path2->indexes, int, i)) {
+			return BT_FALSE;
+		}
+	}
+
+	return BT_TRUE;
+}
+
 /*
  * Resolves a variant or sequence field type `type`.
  *
- * `type` is owned by the caller.
+ * `type` is never modified: if its current target field path (and
+ * tag field type, for a variant field type) differs from the resolved
+ * one, `*resolved_type` is set to a new shallow copy of `type` holding
+ * the resolved values. Otherwise `*resolved_type` is left unchanged.
+ *
+ * `type` is owned by the caller. `*resolved_type`, if set, is owned
+ * by the caller on success.
  */
 static
 int resolve_sequence_or_variant_type(struct bt_ctf_field_type *type,
-		struct resolve_context *ctx)
+		struct resolve_context *ctx,
+		struct bt_ctf_field_type **resolved_type)
 {
 	int ret = 0;
 	const char *pathstr;
 	int type_id = bt_ctf_field_type_get_type_id(type);
 	struct bt_ctf_field_path *target_field_path = NULL;
+	struct bt_ctf_field_path *cur_field_path;
 	struct bt_ctf_field_type *target_type = NULL;
+	struct bt_ctf_field_type *cur_target_type = NULL;
+	struct bt_ctf_field_type *copy = NULL;
 	GString *target_field_path_pretty = NULL;
 	const char *target_field_path_pretty_str;
 
@@ -1051,10 +1094,39 @@ int resolve_sequence_or_variant_type(struct bt_ctf_field_type *type,
 		goto end;
 	}
 
+	/* Keep `type` as is if it's already resolved this way */
+	if (type_id == CTF_TYPE_SEQUENCE) {
+		cur_field_path = container_of(type,
+			struct bt_ctf_field_type_sequence,
+			parent)->length_field_path;
+	} else {
+		struct bt_ctf_field_type_variant *variant = container_of(type,
+			struct bt_ctf_field_type_variant, parent);
+
+		cur_field_path = variant->tag_field_path;
+		cur_target_type = variant->tag ? &variant->tag->parent : NULL;
+	}
+
+	if (field_paths_are_equal(cur_field_path, target_field_path) &&
+			(type_id == CTF_TYPE_SEQUENCE ||
+			cur_target_type == target_type)) {
+		BT_LOGV("Field type is already resolved: ft-addr=%p, "
+			"path=\"%s\", target-field-path=\"%s\"",
+			type, pathstr, target_field_path_pretty_str);
+		goto end;
+	}
+
+	copy = bt_ctf_field_type_copy_shallow(type);
+	if (!copy) {
+		BT_LOGE("Cannot copy field type: ft-addr=%p", type);
+		ret = -1;
+		goto end;
+	}
+
 	/* Set target field path and target field type */
 	if (type_id == CTF_TYPE_SEQUENCE) {
 		ret = bt_ctf_field_type_sequence_set_length_field_path(
-			type, target_field_path);
+			copy, target_field_path);
 		if (ret) {
 			BT_LOGW("Cannot set sequence field type's length field path: "
 				"ret=%d, ft-addr=%p, path=\"%s\", target-field-path=\"%s\"",
@@ -1064,7 +1136,7 @@ int resolve_sequence_or_variant_type(struct bt_ctf_field_type *type,
 		}
 	} else if (type_id == CTF_TYPE_VARIANT) {
 		ret = bt_ctf_field_type_variant_set_tag_field_path(
-			type, target_field_path);
+			copy, target_field_path);
 		if (ret) {
 			BT_LOGW("Cannot set varaint field type's tag field path: "
 				"ret=%d, ft-addr=%p, path=\"%s\", target-field-path=\"%s\"",
@@ -1074,7 +1146,7 @@ int resolve_sequence_or_variant_type(struct bt_ctf_field_type *type,
 		}
 
 		ret = bt_ctf_field_type_variant_set_tag_field_type(
-			type, target_type);
+			copy, target_type);
 		if (ret) {
 			BT_LOGW("Cannot set varaint field type's tag field type: "
 				"ret=%d, ft-addr=%p, path=\"%s\", target-field-path=\"%s\"",
@@ -1086,11 +1158,17 @@ int resolve_sequence_or_variant_type(struct bt_ctf_field_type *type,
 		abort();
 	}
 
+	BT_LOGV("Resolved field type copy: ft-addr=%p, copy-ft-addr=%p, "
+		"path=\"%s\", target-field-path=\"%s\"",
+		type, copy, pathstr, target_field_path_pretty_str);
+	BT_MOVE(*resolved_type, copy);
+
 end:
 	if (target_field_path_pretty) {
 		g_string_free(target_field_path_pretty, TRUE);
 	}
 
+	BT_PUT(copy);
 	BT_PUT(target_field_path);
 	BT_PUT(target_type);
 	return ret;
@@ -1099,13 +1177,23 @@ end:
 /*
  * Resolves a field type `type`.
  *
- * `type` is owned by the caller.
+ * `type` and its children are never modified (copy-on-write): if
+ * resolving any sequence or variant field type within `type` changes
+ * it, `*resolved_type` is set to a shallow copy of `type` in which the
+ * changed children are replaced with their own resolved copies. The
+ * unchanged subtrees are shared with `type`. If nothing changes,
+ * `*resolved_type` is set to NULL.
+ *
+ * `type` is owned by the caller. `*resolved_type`, if not NULL, is
+ * owned by the caller on success.
  */
 static
-int resolve_type(struct bt_ctf_field_type *type, struct resolve_context *ctx)
+int resolve_type(struct bt_ctf_field_type *type, struct resolve_context *ctx,
+		struct bt_ctf_field_type **resolved_type)
 {
 	int ret = 0;
 	int type_id;
+	struct bt_ctf_field_type *copy = NULL;
 
 	if (!type) {
 		/* Type is not available; still valid */
@@ -1119,7 +1207,7 @@ int resolve_type(struct bt_ctf_field_type *type, struct resolve_context *ctx)
 	switch (type_id) {
 	case CTF_TYPE_SEQUENCE:
 	case CTF_TYPE_VARIANT:
-		ret = resolve_sequence_or_variant_type(type, ctx);
+		ret = resolve_sequence_or_variant_type(type, ctx, &copy);
 		if (ret) {
 			BT_LOGW("Cannot resolve sequence field type's length or variant field type's tag: "
 				"ret=%d, ft-addr=%p", ret, type);
@@ -1156,6 +1244,7 @@ int resolve_type(struct bt_ctf_field_type *type, struct resolve_context *ctx)
 		}
 
 		for (f_index = 0; f_index < field_count; f_index++) {
+			struct bt_ctf_field_type *resolved_child_type = NULL;
 			struct bt_ctf_field_type *child_type =
 				bt_ctf_field_type_get_field_at_index(type,
 					f_index);
@@ -1181,11 +1270,38 @@ int resolve_type(struct bt_ctf_field_type *type, struct resolve_context *ctx)
 				"parent-ft-addr=%p, child-ft-addr=%p, "
 				"index=%" PRId64 ", count=%" PRId64,
 				type, child_type, f_index, field_count);
-			ret = resolve_type(child_type, ctx);
+			ret = resolve_type(child_type, ctx,
+				&resolved_child_type);
 			BT_PUT(child_type);
 			if (ret) {
 				goto end;
 			}
+
+			if (!resolved_child_type) {
+				continue;
+			}
+
+			/* Detach this field type from `type` once */
+			if (!copy) {
+				copy = bt_ctf_field_type_copy_shallow(type);
+				if (!copy) {
+					BT_LOGE("Cannot copy field type: "
+						"ft-addr=%p", type);
+					BT_PUT(resolved_child_type);
+					ret = -1;
+					goto end;
+				}
+			}
+
+			ret = bt_ctf_field_type_set_field_at_index(copy,
+				f_index, resolved_child_type);
+			BT_PUT(resolved_child_type);
+			if (ret) {
+				BT_LOGW("Cannot replace field type's child field type: "
+					"ft-addr=%p, index=%" PRId64,
+					copy, f_index);
+				goto end;
+			}
 		}
 
 		type_stack_pop(ctx->type_stack);
@@ -1196,46 +1312,69 @@ int resolve_type(struct bt_ctf_field_type *type, struct resolve_context *ctx)
 	}
 
 end:
+	if (ret) {
+		BT_PUT(copy);
+	}
+
+	*resolved_type = copy;
 	return ret;
 }
 
 /*
  * Resolves the root field type corresponding to the scope `root_scope`.
+ *
+ * If resolving changes the root field type, the context's root field
+ * type is replaced with its resolved copy and `*root_type` becomes a
+ * new reference to this copy (the previous reference is put).
  */
 static
-int resolve_root_type(enum bt_ctf_scope root_scope, struct resolve_context *ctx)
+int resolve_root_type(enum bt_ctf_scope root_scope, struct resolve_context *ctx,
+		struct bt_ctf_field_type **root_type)
 {
 	int ret;
+	struct bt_ctf_field_type *resolved_type = NULL;
 
 	assert(type_stack_size(ctx->type_stack) == 0);
 	ctx->root_scope = root_scope;
-	ret = resolve_type(get_type_from_ctx(ctx, root_scope), ctx);
+	ret = resolve_type(get_type_from_ctx(ctx, root_scope), ctx,
+		&resolved_type);
 	ctx->root_scope = BT_CTF_SCOPE_UNKNOWN;
+	if (ret || !resolved_type) {
+		goto end;
+	}
+
+	BT_LOGV("Replacing root field type with its resolved copy: "
+		"root-scope=%s, ft-addr=%p, copy-ft-addr=%p",
+		bt_ctf_scope_string(root_scope), *root_type, resolved_type);
+	ctx->scopes[root_scope - BT_CTF_SCOPE_TRACE_PACKET_HEADER] =
+		resolved_type;
+	BT_MOVE(*root_type, resolved_type);
 
+end:
 	return ret;
 }
 
 BT_HIDDEN
 int bt_ctf_resolve_types(
 		struct bt_value *environment,
-		struct bt_ctf_field_type *packet_header_type,
-		struct bt_ctf_field_type *packet_context_type,
-		struct bt_ctf_field_type *event_header_type,
-		struct bt_ctf_field_type *stream_event_ctx_type,
-		struct bt_ctf_field_type *event_context_type,
-		struct bt_ctf_field_type *event_payload_type,
+		struct bt_ctf_field_type **packet_header_type,
+		struct bt_ctf_field_type **packet_context_type,
+		struct bt_ctf_field_type **event_header_type,
+		struct bt_ctf_field_type **stream_event_ctx_type,
+		struct bt_ctf_field_type **event_context_type,
+		struct bt_ctf_field_type **event_payload_type,
 		enum bt_ctf_resolve_flag flags)
 {
 	int ret = 0;
 	struct resolve_context ctx = {
 		.environment = environment,
 		.scopes = {
-			packet_header_type,
-			packet_context_type,
-			event_header_type,
-			stream_event_ctx_type,
-			event_context_type,
-			event_payload_type,
+			*packet_header_type,
+			*packet_context_type,
+			*event_header_type,
+			*stream_event_ctx_type,
+			*event_context_type,
+			*event_payload_type,
 		},
 		.root_scope = BT_CTF_SCOPE_UNKNOWN,
 	};
@@ -1247,8 +1386,9 @@ int bt_ctf_resolve_types(
 		"stream-event-context-ft-addr=%p, "
 		"event-context-ft-addr=%p, "
 		"event-payload-ft-addr=%p",
-		packet_header_type, packet_context_type, event_header_type,
-		stream_event_ctx_type, event_context_type, event_payload_type);
+		*packet_header_type, *packet_context_type, *event_header_type,
+		*stream_event_ctx_type, *event_context_type,
+		*event_payload_type);
 
 	/* Initialize type stack */
 	ctx.type_stack = type_stack_create();
@@ -1260,7 +1400,8 @@ int bt_ctf_resolve_types(
 
 	/* Resolve packet header type */
 	if (flags & BT_CTF_RESOLVE_FLAG_PACKET_HEADER) {
-		ret = resolve_root_type(BT_CTF_SCOPE_TRACE_PACKET_HEADER, &ctx);
+		ret = resolve_root_type(BT_CTF_SCOPE_TRACE_PACKET_HEADER, &ctx,
+			packet_header_type);
 		if (ret) {
 			BT_LOGW("Cannot resolve trace packet header field type: "
 				"ret=%d", ret);
@@ -1270,7 +1411,8 @@ int bt_ctf_resolve_types(
 
 	/* Resolve packet context type */
 	if (flags & BT_CTF_RESOLVE_FLAG_PACKET_CONTEXT) {
-		ret = resolve_root_type(BT_CTF_SCOPE_STREAM_PACKET_CONTEXT, &ctx);
+		ret = resolve_root_type(BT_CTF_SCOPE_STREAM_PACKET_CONTEXT, &ctx,
+			packet_context_type);
 		if (ret) {
 			BT_LOGW("Cannot resolve stream packet context field type: "
 				"ret=%d", ret);
@@ -1280,7 +1422,8 @@ int bt_ctf_resolve_types(
 
 	/* Resolve event header type */
 	if (flags & BT_CTF_RESOLVE_FLAG_EVENT_HEADER) {
-		ret = resolve_root_type(BT_CTF_SCOPE_STREAM_EVENT_HEADER, &ctx);
+		ret = resolve_root_type(BT_CTF_SCOPE_STREAM_EVENT_HEADER, &ctx,
+			event_header_type);
 		if (ret) {
 			BT_LOGW("Cannot resolve stream event header field type: "
 				"ret=%d", ret);
@@ -1290,7 +1433,8 @@ int bt_ctf_resolve_types(
 
 	/* Resolve stream event context type */
 	if (flags & BT_CTF_RESOLVE_FLAG_STREAM_EVENT_CTX) {
-		ret = resolve_root_type(BT_CTF_SCOPE_STREAM_EVENT_CONTEXT, &ctx);
+		ret = resolve_root_type(BT_CTF_SCOPE_STREAM_EVENT_CONTEXT, &ctx,
+			stream_event_ctx_type);
 		if (ret) {
 			BT_LOGW("Cannot resolve stream event context field type: "
 				"ret=%d", ret);
@@ -1300,7 +1444,8 @@ int bt_ctf_resolve_types(
 
 	/* Resolve event context type */
 	if (flags & BT_CTF_RESOLVE_FLAG_EVENT_CONTEXT) {
-		ret = resolve_root_type(BT_CTF_SCOPE_EVENT_CONTEXT, &ctx);
+		ret = resolve_root_type(BT_CTF_SCOPE_EVENT_CONTEXT, &ctx,
+			event_context_type);
 		if (ret) {
 			BT_LOGW("Cannot resolve event context field type: "
 				"ret=%d", ret);
@@ -1310,7 +1455,8 @@ int bt_ctf_resolve_types(
 
 	/* Resolve event payload type */
 	if (flags & BT_CTF_RESOLVE_FLAG_EVENT_PAYLOAD) {
-		ret = resolve_root_type(BT_CTF_SCOPE_EVENT_FIELDS, &ctx);
+		ret = resolve_root_type(BT_CTF_SCOPE_EVENT_FIELDS, &ctx,
+			event_payload_type);
 		if (ret) {
 			BT_LOGW("Cannot resolve event payload field type: "
 				"ret=%d", ret);
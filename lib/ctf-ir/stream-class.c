@@ -363,153 +363,211 @@ end:
 	return ret;
 }
 
+/*
+ * Checks that the event classes of a batch can be added to a stream
+ * class, and sets their IDs (automatic IDs are the next available
+ * ones) and stream class IDs.
+ *
+ * `event_ids` (`count` elements) is filled with the IDs of the event
+ * classes, allocated to become keys of the stream class's event class
+ * hash table.
+ */
 static
-void event_class_exists(gpointer element, gpointer query)
+int prepare_event_classes(struct bt_ctf_stream_class *stream_class,
+		struct bt_ctf_event_class **event_classes, uint64_t count,
+		int64_t **event_ids)
 {
-	struct bt_ctf_event_class *event_class_a = element;
-	struct search_query *search_query = query;
-	struct bt_ctf_event_class *event_class_b = search_query->value;
-	int64_t id_a, id_b;
+	int ret = 0;
+	uint64_t i;
+	GHashTable *batch_ids = NULL;
+	GHashTable *batch_event_classes = NULL;
 
-	if (search_query->value == element) {
-		search_query->found = 1;
+	/* Event class ID (int64_t *) -> event class (weak) */
+	batch_ids = g_hash_table_new(g_int64_hash, g_int64_equal);
+	if (!batch_ids) {
+		BT_LOGE_STR("Failed to allocate a GHashTable.");
+		ret = -1;
 		goto end;
 	}
 
-	/*
-	 * Two event classes cannot share the same ID in a given
-	 * stream class.
-	 */
-	id_a = bt_ctf_event_class_get_id(event_class_a);
-	id_b = bt_ctf_event_class_get_id(event_class_b);
-
-	if (id_a < 0 || id_b < 0) {
-		/* at least one ID is not set: will be automatically set later */
+	/* Event class -> event class (weak) */
+	batch_event_classes = g_hash_table_new(g_direct_hash, g_direct_equal);
+	if (!batch_event_classes) {
+		BT_LOGE_STR("Failed to allocate a GHashTable.");
+		ret = -1;
 		goto end;
 	}
 
-	if (id_a == id_b) {
-		BT_LOGW("Event class with this ID already exists in the stream class: "
-			"id=%" PRId64 ", name=\"%s\"",
-			id_a, bt_ctf_event_class_get_name(event_class_a));
-		search_query->found = 1;
-		goto end;
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_event_class *event_class = event_classes[i];
+		struct bt_ctf_stream_class *old_stream_class;
+
+		if (!event_class) {
+			BT_LOGW("Invalid parameter: event class is NULL: "
+				"index=%" PRIu64, i);
+			ret = -1;
+			goto end;
+		}
+
+		if (g_hash_table_lookup(batch_event_classes, event_class)) {
+			BT_LOGW("Invalid parameter: event class is added more than once: "
+				"addr=%p, name=\"%s\"", event_class,
+				bt_ctf_event_class_get_name(event_class));
+			ret = -1;
+			goto end;
+		}
+
+		g_hash_table_insert(batch_event_classes, event_class,
+			event_class);
+		old_stream_class =
+			bt_ctf_event_class_get_stream_class(event_class);
+		if (old_stream_class) {
+			/* Event class is already associated to a stream class. */
+			BT_LOGW("Event class is already part of another stream class: "
+				"event-class-name=\"%s\", "
+				"event-class-stream-class-addr=%p, "
+				"event-class-stream-class-name=\"%s\", "
+				"event-class-stream-class-id=%" PRId64,
+				bt_ctf_event_class_get_name(event_class),
+				old_stream_class,
+				bt_ctf_stream_class_get_name(old_stream_class),
+				bt_ctf_stream_class_get_id(old_stream_class));
+			bt_put(old_stream_class);
+			ret = -1;
+			goto end;
+		}
+
+		event_ids[i] = g_new(int64_t, 1);
+		if (!event_ids[i]) {
+			BT_LOGE_STR("Failed to allocate one int64_t.");
+			ret = -1;
+			goto end;
+		}
+
+		*event_ids[i] = bt_ctf_event_class_get_id(event_class);
+		if (*event_ids[i] < 0) {
+			/* Automatic ID: set below */
+			continue;
+		}
+
+		/*
+		 * Two event classes cannot share the same ID in a given
+		 * stream class.
+		 */
+		if (g_hash_table_lookup(stream_class->event_classes_ht,
+				event_ids[i]) ||
+				g_hash_table_lookup(batch_ids, event_ids[i])) {
+			BT_LOGW("Event class with this ID already exists in the stream class: "
+				"id=%" PRId64 ", name=\"%s\"",
+				*event_ids[i],
+				bt_ctf_event_class_get_name(event_class));
+			ret = -1;
+			goto end;
+		}
+
+		g_hash_table_insert(batch_ids, event_ids[i], event_class);
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_event_class *event_class = event_classes[i];
+
+		/* Only set an event ID if none was explicitly set before */
+		if (*event_ids[i] < 0) {
+			while (g_hash_table_lookup(stream_class->event_classes_ht,
+					&stream_class->next_event_id) ||
+					g_hash_table_lookup(batch_ids,
+						&stream_class->next_event_id)) {
+				stream_class->next_event_id++;
+			}
+
+			BT_LOGV("Event class has no ID: automatically setting it: "
+				"id=%" PRId64, stream_class->next_event_id);
+
+			if (bt_ctf_event_class_set_id(event_class,
+					stream_class->next_event_id)) {
+				BT_LOGE("Cannot set event class's ID: id=%" PRId64,
+					stream_class->next_event_id);
+				ret = -1;
+				goto end;
+			}
+
+			*event_ids[i] = stream_class->next_event_id;
+			stream_class->next_event_id++;
+		}
+
+		ret = bt_ctf_event_class_set_stream_id(event_class,
+			stream_class->id);
+		if (ret) {
+			BT_LOGE("Cannot set event class's stream class ID attribute: ret=%d",
+				ret);
+			goto end;
+		}
 	}
 
 end:
-	return;
+	if (batch_ids) {
+		g_hash_table_destroy(batch_ids);
+	}
+
+	if (batch_event_classes) {
+		g_hash_table_destroy(batch_event_classes);
+	}
+
+	return ret;
 }
 
-int bt_ctf_stream_class_add_event_class(
+/*
+ * Validates the field types of the event classes of a batch within
+ * the trace of their stream class, getting the trace and stream class
+ * field types once for the whole batch.
+ */
+static
+int validate_event_classes(struct bt_ctf_trace *trace,
 		struct bt_ctf_stream_class *stream_class,
-		struct bt_ctf_event_class *event_class)
+		struct bt_ctf_event_class **event_classes, uint64_t count,
+		struct bt_ctf_validation_output *validation_outputs)
 {
 	int ret = 0;
-	int64_t *event_id = NULL;
-	struct bt_ctf_trace *trace = NULL;
-	struct bt_ctf_stream_class *old_stream_class = NULL;
-	struct bt_ctf_validation_output validation_output = { 0 };
+	uint64_t i;
 	struct bt_ctf_field_type *packet_header_type = NULL;
 	struct bt_ctf_field_type *packet_context_type = NULL;
 	struct bt_ctf_field_type *event_header_type = NULL;
 	struct bt_ctf_field_type *stream_event_ctx_type = NULL;
-	struct bt_ctf_field_type *event_context_type = NULL;
-	struct bt_ctf_field_type *event_payload_type = NULL;
 	const enum bt_ctf_validation_flag validation_flags =
 		BT_CTF_VALIDATION_FLAG_EVENT;
 
-	if (!stream_class || !event_class) {
-		BT_LOGW("Invalid parameter: stream class or event class is NULL: "
-			"stream-class-addr=%p, event-class-addr=%p",
-			stream_class, event_class);
-		ret = -1;
-		goto end;
-	}
-
-	BT_LOGD("Adding event class to stream class: "
-		"stream-class-addr=%p, stream-class-name=\"%s\", "
-		"stream-class-id=%" PRId64 ", event-class-addr=%p, "
-		"event-class-name=\"%s\", event-class-id=%" PRId64,
-		stream_class, bt_ctf_stream_class_get_name(stream_class),
-		bt_ctf_stream_class_get_id(stream_class),
-		event_class,
-		bt_ctf_event_class_get_name(event_class),
-		bt_ctf_event_class_get_id(event_class));
-
-	trace = bt_ctf_stream_class_get_trace(stream_class);
-	if (trace && trace->is_static) {
-		ret = -1;
-		goto end;
-	}
-
-	event_id = g_new(int64_t, 1);
-	if (!event_id) {
-		BT_LOGE_STR("Failed to allocate one int64_t.");
-		ret = -1;
-		goto end;
-	}
-
-	/* Check for duplicate event classes */
-	struct search_query query = { .value = event_class, .found = 0 };
-	g_ptr_array_foreach(stream_class->event_classes, event_class_exists,
-		&query);
-	if (query.found) {
-		BT_LOGW_STR("Another event class part of this stream class has the same ID.");
-		ret = -1;
-		goto end;
-	}
-
-	old_stream_class = bt_ctf_event_class_get_stream_class(event_class);
-	if (old_stream_class) {
-		/* Event class is already associated to a stream class. */
-		BT_LOGW("Event class is already part of another stream class: "
-			"event-class-stream-class-addr=%p, "
-			"event-class-stream-class-name=\"%s\", "
-			"event-class-stream-class-id=%" PRId64,
-			old_stream_class,
-			bt_ctf_stream_class_get_name(old_stream_class),
-			bt_ctf_stream_class_get_id(old_stream_class));
-		ret = -1;
-		goto end;
-	}
-
-	if (trace) {
-		/*
-		 * If the stream class is associated with a trace, then
-		 * both those objects are frozen. Also, this event class
-		 * is about to be frozen.
-		 *
-		 * Therefore the event class must be validated here.
-		 * The trace and stream class should be valid at this
-		 * point.
-		 */
-		assert(trace->valid);
-		assert(stream_class->valid);
-		packet_header_type =
-			bt_ctf_trace_get_packet_header_type(trace);
-		packet_context_type =
-			bt_ctf_stream_class_get_packet_context_type(
-				stream_class);
-		event_header_type =
-			bt_ctf_stream_class_get_event_header_type(stream_class);
-		stream_event_ctx_type =
-			bt_ctf_stream_class_get_event_context_type(
-				stream_class);
-		event_context_type =
+	/*
+	 * If the stream class is associated with a trace, then both
+	 * those objects are frozen. Also, the event classes are about
+	 * to be frozen.
+	 *
+	 * Therefore the event classes must be validated here. The
+	 * trace and stream class should be valid at this point.
+	 */
+	assert(trace->valid);
+	assert(stream_class->valid);
+	packet_header_type = bt_ctf_trace_get_packet_header_type(trace);
+	packet_context_type =
+		bt_ctf_stream_class_get_packet_context_type(stream_class);
+	event_header_type =
+		bt_ctf_stream_class_get_event_header_type(stream_class);
+	stream_event_ctx_type =
+		bt_ctf_stream_class_get_event_context_type(stream_class);
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_event_class *event_class = event_classes[i];
+		struct bt_ctf_field_type *event_context_type =
 			bt_ctf_event_class_get_context_type(event_class);
-		event_payload_type =
+		struct bt_ctf_field_type *event_payload_type =
 			bt_ctf_event_class_get_payload_type(event_class);
+
 		ret = bt_ctf_validate_class_types(
 			trace->environment, packet_header_type,
 			packet_context_type, event_header_type,
 			stream_event_ctx_type, event_context_type,
 			event_payload_type, trace->valid,
 			stream_class->valid, event_class->valid,
-			&validation_output, validation_flags);
-		BT_PUT(packet_header_type);
-		BT_PUT(packet_context_type);
-		BT_PUT(event_header_type);
-		BT_PUT(stream_event_ctx_type);
+			&validation_outputs[i], validation_flags);
 		BT_PUT(event_context_type);
 		BT_PUT(event_payload_type);
 
@@ -523,99 +581,181 @@ int bt_ctf_stream_class_add_event_class(
 			goto end;
 		}
 
-		if ((validation_output.valid_flags & validation_flags) !=
+		if ((validation_outputs[i].valid_flags & validation_flags) !=
 				validation_flags) {
 			/* Invalid event class */
 			BT_LOGW("Invalid trace, stream class, or event class: "
-				"valid-flags=0x%x",
-				validation_output.valid_flags);
+				"event-class-name=\"%s\", valid-flags=0x%x",
+				bt_ctf_event_class_get_name(event_class),
+				validation_outputs[i].valid_flags);
 			ret = -1;
 			goto end;
 		}
 	}
 
-	/* Only set an event ID if none was explicitly set before */
-	*event_id = bt_ctf_event_class_get_id(event_class);
-	if (*event_id < 0) {
-		BT_LOGV("Event class has no ID: automatically setting it: "
-			"id=%" PRId64, stream_class->next_event_id);
+end:
+	BT_PUT(packet_header_type);
+	BT_PUT(packet_context_type);
+	BT_PUT(event_header_type);
+	BT_PUT(stream_event_ctx_type);
+	return ret;
+}
 
-		if (bt_ctf_event_class_set_id(event_class,
-				stream_class->next_event_id)) {
-			BT_LOGE("Cannot set event class's ID: id=%" PRId64,
-				stream_class->next_event_id);
-			ret = -1;
-			goto end;
-		}
-		stream_class->next_event_id++;
-		*event_id = stream_class->next_event_id;
+int bt_ctf_stream_class_add_event_class(
+		struct bt_ctf_stream_class *stream_class,
+		struct bt_ctf_event_class *event_class)
+{
+	if (!event_class) {
+		BT_LOGW("Invalid parameter: event class is NULL: "
+			"stream-class-addr=%p", stream_class);
+		return -1;
 	}
 
-	ret = bt_ctf_event_class_set_stream_id(event_class, stream_class->id);
-	if (ret) {
-		BT_LOGE("Cannot set event class's stream class ID attribute: ret=%d",
-			ret);
+	return bt_ctf_stream_class_add_event_classes(stream_class,
+		&event_class, 1);
+}
+
+int bt_ctf_stream_class_add_event_classes(
+		struct bt_ctf_stream_class *stream_class,
+		struct bt_ctf_event_class **event_classes, uint64_t count)
+{
+	int ret = 0;
+	uint64_t i;
+	int64_t **event_ids = NULL;
+	struct bt_ctf_trace *trace = NULL;
+	struct bt_ctf_validation_output *validation_outputs = NULL;
+
+	if (!stream_class || (!event_classes && count > 0)) {
+		BT_LOGW("Invalid parameter: stream class or event classes is NULL: "
+			"stream-class-addr=%p, event-classes-addr=%p",
+			stream_class, event_classes);
+		ret = -1;
 		goto end;
 	}
 
-	bt_object_set_parent(event_class, stream_class);
+	BT_LOGD("Adding event classes to stream class: "
+		"stream-class-addr=%p, stream-class-name=\"%s\", "
+		"stream-class-id=%" PRId64 ", count=%" PRIu64,
+		stream_class, bt_ctf_stream_class_get_name(stream_class),
+		bt_ctf_stream_class_get_id(stream_class), count);
 
-	if (trace) {
-		/*
-		 * At this point we know that the function will be
-		 * successful. Therefore we can replace the event
-		 * class's field types with what's in the validation
-		 * output structure and mark this event class as valid.
-		 */
-		bt_ctf_validation_replace_types(NULL, NULL, event_class,
-			&validation_output, validation_flags);
-		event_class->valid = 1;
+	if (count == 0) {
+		goto end;
+	}
 
-		/*
-		 * Put what was not moved in
-		 * bt_ctf_validation_replace_types().
-		 */
-		bt_ctf_validation_output_put_types(&validation_output);
+	trace = bt_ctf_stream_class_get_trace(stream_class);
+	if (trace && trace->is_static) {
+		BT_LOGW("Invalid parameter: stream class's trace is static: "
+			"trace-addr=%p, trace-name=\"%s\"",
+			trace, bt_ctf_trace_get_name(trace));
+		ret = -1;
+		goto end;
 	}
 
-	/* Add to the event classes of the stream class */
-	g_ptr_array_add(stream_class->event_classes, event_class);
-	g_hash_table_insert(stream_class->event_classes_ht, event_id,
-			event_class);
-	event_id = NULL;
+	event_ids = g_new0(int64_t *, count);
+	if (!event_ids) {
+		BT_LOGE("Failed to allocate event class IDs: count=%" PRIu64,
+			count);
+		ret = -1;
+		goto end;
+	}
 
-	/* Freeze the event class */
-	bt_ctf_event_class_freeze(event_class);
+	ret = prepare_event_classes(stream_class, event_classes, count,
+		event_ids);
+	if (ret) {
+		goto end;
+	}
 
-	/* Notifiy listeners of the trace's schema modification. */
 	if (trace) {
-		struct bt_ctf_object obj = { .object = event_class,
-				.type = BT_CTF_OBJECT_TYPE_EVENT_CLASS };
+		validation_outputs = g_new0(struct bt_ctf_validation_output,
+			count);
+		if (!validation_outputs) {
+			BT_LOGE("Failed to allocate validation output structures: "
+				"count=%" PRIu64, count);
+			ret = -1;
+			goto end;
+		}
 
-		(void) bt_ctf_trace_object_modification(&obj, trace);
+		ret = validate_event_classes(trace, stream_class,
+			event_classes, count, validation_outputs);
+		if (ret) {
+			goto end;
+		}
 	}
 
-	BT_LOGD("Added event class to stream class: "
+	/*
+	 * At this point we know that the function will be successful.
+	 */
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_event_class *event_class = event_classes[i];
+
+		bt_object_set_parent(event_class, stream_class);
+
+		if (trace) {
+			/*
+			 * Replace the event class's field types with
+			 * what's in the validation output structure and
+			 * mark this event class as valid.
+			 */
+			bt_ctf_validation_replace_types(NULL, NULL,
+				event_class, &validation_outputs[i],
+				BT_CTF_VALIDATION_FLAG_EVENT);
+			event_class->valid = 1;
+		}
+
+		/* Add to the event classes of the stream class */
+		g_ptr_array_add(stream_class->event_classes, event_class);
+		g_hash_table_insert(stream_class->event_classes_ht,
+			event_ids[i], event_class);
+		event_ids[i] = NULL;
+
+		/* Freeze the event class */
+		bt_ctf_event_class_freeze(event_class);
+
+		/* Notifiy listeners of the trace's schema modification. */
+		if (trace) {
+			struct bt_ctf_object obj = { .object = event_class,
+					.type = BT_CTF_OBJECT_TYPE_EVENT_CLASS };
+
+			(void) bt_ctf_trace_object_modification(&obj, trace);
+		}
+
+		BT_LOGV("Added event class to stream class: "
+			"event-class-addr=%p, event-class-name=\"%s\", "
+			"event-class-id=%" PRId64,
+			event_class, bt_ctf_event_class_get_name(event_class),
+			bt_ctf_event_class_get_id(event_class));
+	}
+
+	BT_LOGD("Added event classes to stream class: "
 		"stream-class-addr=%p, stream-class-name=\"%s\", "
-		"stream-class-id=%" PRId64 ", event-class-addr=%p, "
-		"event-class-name=\"%s\", event-class-id=%" PRId64,
+		"stream-class-id=%" PRId64 ", count=%" PRIu64,
 		stream_class, bt_ctf_stream_class_get_name(stream_class),
-		bt_ctf_stream_class_get_id(stream_class),
-		event_class,
-		bt_ctf_event_class_get_name(event_class),
-		bt_ctf_event_class_get_id(event_class));
+		bt_ctf_stream_class_get_id(stream_class), count);
 
 end:
 	BT_PUT(trace);
-	BT_PUT(old_stream_class);
-	bt_ctf_validation_output_put_types(&validation_output);
-	assert(!packet_header_type);
-	assert(!packet_context_type);
-	assert(!event_header_type);
-	assert(!stream_event_ctx_type);
-	assert(!event_context_type);
-	assert(!event_payload_type);
-	g_free(event_id);
+
+	if (validation_outputs) {
+		for (i = 0; i < count; i++) {
+			/*
+			 * Put what was not moved in
+			 * bt_ctf_validation_replace_types().
+			 */
+			bt_ctf_validation_output_put_types(
+				&validation_outputs[i]);
+		}
+
+		g_free(validation_outputs);
+	}
+
+	if (event_ids) {
+		for (i = 0; i < count; i++) {
+			g_free(event_ids[i]);
+		}
+
+		g_free(event_ids);
+	}
 
 	return ret;
 }
@@ -984,7 +1124,6 @@ int bt_ctf_stream_class_serialize(struct bt_ctf_stream_class *stream_class,
 		struct metadata_context *context)
 {
 	int ret = 0;
-	size_t i;
 
 	BT_LOGD("Serializing stream class's metadata: "
 		"stream-class-addr=%p, stream-class-name=\"%s\", "
@@ -1042,8 +1181,31 @@ int bt_ctf_stream_class_serialize(struct bt_ctf_stream_class *stream_class,
 	}
 
 	g_string_append(context->string, "\n};\n\n");
+	ret = bt_ctf_stream_class_serialize_event_classes(stream_class,
+		context, 0);
+
+end:
+	context->current_indentation_level = 0;
+	return ret;
+}
 
-	for (i = 0; i < stream_class->event_classes->len; i++) {
+BT_HIDDEN
+int bt_ctf_stream_class_serialize_event_classes(
+		struct bt_ctf_stream_class *stream_class,
+		struct metadata_context *context, uint64_t first_index)
+{
+	int ret = 0;
+	size_t i;
+
+	BT_LOGD("Serializing stream class's event classes' metadata: "
+		"stream-class-addr=%p, stream-class-name=\"%s\", "
+		"stream-class-id=%" PRId64 ", first-index=%" PRIu64 ", "
+		"count=%u",
+		stream_class, bt_ctf_stream_class_get_name(stream_class),
+		bt_ctf_stream_class_get_id(stream_class), first_index,
+		stream_class->event_classes->len);
+
+	for (i = first_index; i < stream_class->event_classes->len; i++) {
 		struct bt_ctf_event_class *event_class =
 			stream_class->event_classes->pdata[i];
 
@@ -1058,6 +1220,7 @@ int bt_ctf_stream_class_serialize(struct bt_ctf_stream_class *stream_class,
 			goto end;
 		}
 	}
+
 end:
 	context->current_indentation_level = 0;
 	return ret;
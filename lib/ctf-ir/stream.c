@@ -49,6 +49,7 @@
 #include <babeltrace/align-internal.h>
 #include <inttypes.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 static
 void bt_ctf_stream_destroy(struct bt_object *obj);
@@ -693,7 +694,7 @@ int create_stream_file(struct bt_ctf_writer *writer,
 
 	g_string_append_printf(filename, "_%" PRId64, stream->id);
 	fd = openat(writer->trace_dir_fd, filename->str,
-		O_RDWR | O_CREAT | O_TRUNC,
+		O_RDWR | O_CREAT | (writer->append_stream_files ? 0 : O_TRUNC),
 		S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
 	if (fd < 0) {
 		BT_LOGW("Failed to open stream file for writing: %s: "
@@ -703,6 +704,26 @@ int create_stream_file(struct bt_ctf_writer *writer,
 		goto end;
 	}
 
+	if (writer->append_stream_files) {
+		struct stat st;
+
+		if (fstat(fd, &st)) {
+			BT_LOGW("Failed to get stream file's size: %s: "
+				"filename=\"%s\", fd=%d, errno=%d",
+				strerror(errno), filename->str, fd, errno);
+			(void) close(fd);
+			fd = -1;
+			goto end;
+		}
+
+		/* The first packet is written after the existing ones. */
+		stream->size = (uint64_t) st.st_size;
+		stream->pos.mmap_offset = (off_t) st.st_size;
+		BT_LOGD("Appending to existing stream file: "
+			"filename=\"%s\", size=%" PRIu64,
+			filename->str, stream->size);
+	}
+
 	BT_LOGD("Created stream file for writing: "
 		"stream-addr=%p, stream-name=\"%s\", writer-trace-dir-fd=%d, "
 		"filename=\"%s\", fd=%d", stream, bt_ctf_stream_get_name(stream),
@@ -730,7 +751,7 @@ void component_destroy_listener(struct bt_component *component, void *data)
 	g_hash_table_remove(stream->comp_cur_port, component);
 }
 
-static
+BT_HIDDEN
 struct bt_ctf_stream *bt_ctf_stream_create_with_id_no_check(
 		struct bt_ctf_stream_class *stream_class,
 		const char *name, uint64_t id)
@@ -833,7 +854,11 @@ struct bt_ctf_stream *bt_ctf_stream_create_with_id_no_check(
 	if (trace->is_created_by_writer) {
 		int fd;
 		writer = (struct bt_ctf_writer *) bt_object_get_parent(trace);
-		stream->id = (int64_t) stream_class->next_stream_id++;
+		if (id == -1ULL) {
+			stream->id = (int64_t) stream_class->next_stream_id++;
+		} else if (stream->id >= stream_class->next_stream_id) {
+			stream_class->next_stream_id = stream->id + 1;
+		}
 
 		BT_LOGD("Stream object belongs to a writer's trace: "
 			"writer-addr=%p", writer);
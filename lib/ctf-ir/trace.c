@@ -1759,17 +1759,28 @@ loop_next:
 	g_string_append(context->string, "};\n\n");
 }
 
-char *bt_ctf_trace_get_metadata_string(struct bt_ctf_trace *trace)
+/*
+ * Serializes the metadata of `trace`.
+ *
+ * If `state` is NULL, the complete metadata is returned. Otherwise,
+ * only the part of the metadata which is not already described by
+ * `state` is returned, `state` is updated accordingly, and `*is_full`
+ * indicates whether the returned string is the complete metadata,
+ * that is, whether the previously serialized metadata must be
+ * discarded. This is the case when the preamble (signature, trace,
+ * environment, and clock class blocks) changed other than by having
+ * new clock classes appended.
+ */
+static
+char *get_metadata_string(struct bt_ctf_trace *trace,
+		struct bt_ctf_trace_metadata_state *state, bt_bool *is_full)
 {
 	char *metadata = NULL;
 	struct metadata_context *context = NULL;
 	int err = 0;
 	size_t i;
-
-	if (!trace) {
-		BT_LOGW_STR("Invalid parameter: trace is NULL.");
-		goto end;
-	}
+	size_t preamble_len;
+	bt_bool full = BT_TRUE;
 
 	context = g_new0(struct metadata_context, 1);
 	if (!context) {
@@ -1782,16 +1793,60 @@ char *bt_ctf_trace_get_metadata_string(struct bt_ctf_trace *trace)
 	g_string_append(context->string, "/* CTF 1.8 */\n\n");
 	if (append_trace_metadata(trace, context)) {
 		/* append_trace_metadata() logs errors */
+		err = -1;
 		goto error;
 	}
 	append_env_metadata(trace, context);
 	g_ptr_array_foreach(trace->clocks,
 		(GFunc)bt_ctf_clock_class_serialize, context);
+	preamble_len = context->string->len;
+
+	if (state) {
+		GString *preamble = state->preamble;
+		size_t prev_preamble_len = preamble->len;
+
+		/*
+		 * Keep the previously serialized metadata if its
+		 * preamble is a prefix of the new one.
+		 */
+		if (prev_preamble_len > 0 && prev_preamble_len <= preamble_len &&
+				memcmp(preamble->str, context->string->str,
+					prev_preamble_len) == 0) {
+			full = BT_FALSE;
+		} else {
+			prev_preamble_len = 0;
+			bt_ctf_trace_metadata_state_reset(state);
+		}
+
+		g_string_truncate(preamble, 0);
+		g_string_append_len(preamble, context->string->str,
+			preamble_len);
+		g_string_erase(context->string, 0, prev_preamble_len);
+	}
 
 	for (i = 0; i < trace->stream_classes->len; i++) {
-		/* bt_ctf_stream_class_serialize() logs details */
-		err = bt_ctf_stream_class_serialize(
-			trace->stream_classes->pdata[i], context);
+		struct bt_ctf_stream_class *stream_class =
+			trace->stream_classes->pdata[i];
+		size_t event_class_count = stream_class->event_classes->len;
+
+		if (state && i < state->event_class_counts->len) {
+			/* Stream class block is already serialized */
+			err = bt_ctf_stream_class_serialize_event_classes(
+				stream_class, context,
+				g_array_index(state->event_class_counts,
+					size_t, i));
+			g_array_index(state->event_class_counts, size_t, i) =
+				event_class_count;
+		} else {
+			/* bt_ctf_stream_class_serialize() logs details */
+			err = bt_ctf_stream_class_serialize(stream_class,
+				context);
+			if (state) {
+				g_array_append_val(state->event_class_counts,
+					event_class_count);
+			}
+		}
+
 		if (err) {
 			/* bt_ctf_stream_class_serialize() logs errors */
 			goto error;
@@ -1801,14 +1856,85 @@ char *bt_ctf_trace_get_metadata_string(struct bt_ctf_trace *trace)
 	metadata = context->string->str;
 
 error:
+	if (err && state) {
+		/* Start over on the next serialization */
+		bt_ctf_trace_metadata_state_reset(state);
+	}
+
 	g_string_free(context->string, err ? TRUE : FALSE);
 	g_string_free(context->field_name, TRUE);
 	g_free(context);
 
+end:
+	if (is_full) {
+		*is_full = full;
+	}
+
+	return metadata;
+}
+
+BT_HIDDEN
+int bt_ctf_trace_metadata_state_init(struct bt_ctf_trace_metadata_state *state)
+{
+	int ret = 0;
+
+	state->preamble = g_string_new(NULL);
+	state->event_class_counts = g_array_new(FALSE, TRUE, sizeof(size_t));
+	if (!state->preamble || !state->event_class_counts) {
+		BT_LOGE_STR("Failed to initialize metadata serialization state.");
+		bt_ctf_trace_metadata_state_fini(state);
+		ret = -1;
+	}
+
+	return ret;
+}
+
+BT_HIDDEN
+void bt_ctf_trace_metadata_state_fini(struct bt_ctf_trace_metadata_state *state)
+{
+	if (state->preamble) {
+		g_string_free(state->preamble, TRUE);
+		state->preamble = NULL;
+	}
+
+	if (state->event_class_counts) {
+		g_array_free(state->event_class_counts, TRUE);
+		state->event_class_counts = NULL;
+	}
+}
+
+BT_HIDDEN
+void bt_ctf_trace_metadata_state_reset(struct bt_ctf_trace_metadata_state *state)
+{
+	g_string_truncate(state->preamble, 0);
+	g_array_set_size(state->event_class_counts, 0);
+}
+
+char *bt_ctf_trace_get_metadata_string(struct bt_ctf_trace *trace)
+{
+	char *metadata = NULL;
+
+	if (!trace) {
+		BT_LOGW_STR("Invalid parameter: trace is NULL.");
+		goto end;
+	}
+
+	metadata = get_metadata_string(trace, NULL, NULL);
+
 end:
 	return metadata;
 }
 
+BT_HIDDEN
+char *bt_ctf_trace_get_metadata_string_incremental(struct bt_ctf_trace *trace,
+		struct bt_ctf_trace_metadata_state *state, bt_bool *is_full)
+{
+	assert(trace);
+	assert(state);
+	assert(is_full);
+	return get_metadata_string(trace, state, is_full);
+}
+
 enum bt_ctf_byte_order bt_ctf_trace_get_native_byte_order(
 		struct bt_ctf_trace *trace)
 {
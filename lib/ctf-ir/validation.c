@@ -37,12 +37,34 @@
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/ref.h>
 
+/*
+ * Freezes the resolved field type `type`, which is valid, and marks it
+ * as such.
+ *
+ * A resolved field type is only frozen once it's known to be valid:
+ * it can share subtrees with the caller's original field types, which
+ * must remain modifiable when the validation fails.
+ */
+static
+void freeze_valid_type(struct bt_ctf_field_type *type)
+{
+	if (!type) {
+		return;
+	}
+
+	bt_ctf_field_type_freeze(type);
+	type->valid = 1;
+}
+
 /*
  * This function resolves and validates the field types of an event
- * class. Only `event_context_type` and `event_payload_type` are
+ * class. Only `*event_context_type` and `*event_payload_type` are
  * resolved and validated; the other field types are used as eventual
  * resolving targets.
  *
+ * `*event_context_type` and `*event_payload_type` can be replaced
+ * with their resolved copies (see bt_ctf_resolve_types()).
+ *
  * All parameters are owned by the caller.
  */
 static
@@ -51,8 +73,8 @@ int validate_event_class_types(struct bt_value *environment,
 		struct bt_ctf_field_type *packet_context_type,
 		struct bt_ctf_field_type *event_header_type,
 		struct bt_ctf_field_type *stream_event_ctx_type,
-		struct bt_ctf_field_type *event_context_type,
-		struct bt_ctf_field_type *event_payload_type)
+		struct bt_ctf_field_type **event_context_type,
+		struct bt_ctf_field_type **event_payload_type)
 {
 	int ret = 0;
 
@@ -64,12 +86,14 @@ int validate_event_class_types(struct bt_value *environment,
 		"event-context-ft-addr=%p, "
 		"event-payload-ft-addr=%p",
 		packet_header_type, packet_context_type, event_header_type,
-		stream_event_ctx_type, event_context_type, event_payload_type);
+		stream_event_ctx_type, *event_context_type,
+		*event_payload_type);
 
 	/* Resolve sequence type lengths and variant type tags first */
-	ret = bt_ctf_resolve_types(environment, packet_header_type,
-		packet_context_type, event_header_type, stream_event_ctx_type,
-		event_context_type, event_payload_type,
+	ret = bt_ctf_resolve_types(environment, &packet_header_type,
+		&packet_context_type, &event_header_type,
+		&stream_event_ctx_type, event_context_type,
+		event_payload_type,
 		BT_CTF_RESOLVE_FLAG_EVENT_CONTEXT |
 		BT_CTF_RESOLVE_FLAG_EVENT_PAYLOAD);
 	if (ret) {
@@ -79,8 +103,8 @@ int validate_event_class_types(struct bt_value *environment,
 	}
 
 	/* Validate field types individually */
-	if (event_context_type) {
-		ret = bt_ctf_field_type_validate(event_context_type);
+	if (*event_context_type) {
+		ret = bt_ctf_field_type_validate(*event_context_type);
 		if (ret) {
 			BT_LOGW("Invalid event class's context field type: "
 				"ret=%d", ret);
@@ -88,8 +112,8 @@ int validate_event_class_types(struct bt_value *environment,
 		}
 	}
 
-	if (event_payload_type) {
-		ret = bt_ctf_field_type_validate(event_payload_type);
+	if (*event_payload_type) {
+		ret = bt_ctf_field_type_validate(*event_payload_type);
 		if (ret) {
 			BT_LOGW("Invalid event class's payload field type: "
 				"ret=%d", ret);
@@ -97,39 +121,48 @@ int validate_event_class_types(struct bt_value *environment,
 		}
 	}
 
+	freeze_valid_type(*event_context_type);
+	freeze_valid_type(*event_payload_type);
+
 end:
 	return ret;
 }
 
 /*
  * This function resolves and validates the field types of a stream
- * class. Only `packet_context_type`, `event_header_type`, and
- * `stream_event_ctx_type` are resolved and validated; the other field
+ * class. Only `*packet_context_type`, `*event_header_type`, and
+ * `*stream_event_ctx_type` are resolved and validated; the other field
  * type is used as an eventual resolving target.
  *
+ * `*packet_context_type`, `*event_header_type`, and
+ * `*stream_event_ctx_type` can be replaced with their resolved copies
+ * (see bt_ctf_resolve_types()).
+ *
  * All parameters are owned by the caller.
  */
 static
 int validate_stream_class_types(struct bt_value *environment,
 		struct bt_ctf_field_type *packet_header_type,
-		struct bt_ctf_field_type *packet_context_type,
-		struct bt_ctf_field_type *event_header_type,
-		struct bt_ctf_field_type *stream_event_ctx_type)
+		struct bt_ctf_field_type **packet_context_type,
+		struct bt_ctf_field_type **event_header_type,
+		struct bt_ctf_field_type **stream_event_ctx_type)
 {
 	int ret = 0;
+	struct bt_ctf_field_type *event_context_type = NULL;
+	struct bt_ctf_field_type *event_payload_type = NULL;
 
 	BT_LOGV("Validating stream class field types: "
 		"packet-header-ft-addr=%p, "
 		"packet-context-ft-addr=%p, "
 		"event-header-ft-addr=%p, "
 		"stream-event-context-ft-addr=%p",
-		packet_header_type, packet_context_type, event_header_type,
-		stream_event_ctx_type);
+		packet_header_type, *packet_context_type, *event_header_type,
+		*stream_event_ctx_type);
 
 	/* Resolve sequence type lengths and variant type tags first */
-	ret = bt_ctf_resolve_types(environment, packet_header_type,
+	ret = bt_ctf_resolve_types(environment, &packet_header_type,
 		packet_context_type, event_header_type, stream_event_ctx_type,
-		NULL, NULL,
+		&event_context_type, &event_payload_type,
 		BT_CTF_RESOLVE_FLAG_PACKET_CONTEXT |
 		BT_CTF_RESOLVE_FLAG_EVENT_HEADER |
 		BT_CTF_RESOLVE_FLAG_STREAM_EVENT_CTX);
@@ -140,8 +173,8 @@ int validate_stream_class_types(struct bt_value *environment,
 	}
 
 	/* Validate field types individually */
-	if (packet_context_type) {
-		ret = bt_ctf_field_type_validate(packet_context_type);
+	if (*packet_context_type) {
+		ret = bt_ctf_field_type_validate(*packet_context_type);
 		if (ret) {
 			BT_LOGW("Invalid stream class's packet context field type: "
 				"ret=%d", ret);
@@ -149,8 +182,8 @@ int validate_stream_class_types(struct bt_value *environment,
 		}
 	}
 
-	if (event_header_type) {
-		ret = bt_ctf_field_type_validate(event_header_type);
+	if (*event_header_type) {
+		ret = bt_ctf_field_type_validate(*event_header_type);
 		if (ret) {
 			BT_LOGW("Invalid stream class's event header field type: "
 				"ret=%d", ret);
@@ -158,9 +191,9 @@ int validate_stream_class_types(struct bt_value *environment,
 		}
 	}
 
-	if (stream_event_ctx_type) {
+	if (*stream_event_ctx_type) {
 		ret = bt_ctf_field_type_validate(
-			stream_event_ctx_type);
+			*stream_event_ctx_type);
 		if (ret) {
 			BT_LOGW("Invalid stream class's event context field type: "
 				"ret=%d", ret);
@@ -168,6 +201,10 @@ int validate_stream_class_types(struct bt_value *environment,
 		}
 	}
 
+	freeze_valid_type(*packet_context_type);
+	freeze_valid_type(*event_header_type);
+	freeze_valid_type(*stream_event_ctx_type);
+
 end:
 	return ret;
 }
@@ -175,20 +212,30 @@ end:
 /*
  * This function resolves and validates the field types of a trace.
  *
+ * `*packet_header_type` can be replaced with its resolved copy (see
+ * bt_ctf_resolve_types()).
+ *
  * All parameters are owned by the caller.
  */
 static
 int validate_trace_types(struct bt_value *environment,
-		struct bt_ctf_field_type *packet_header_type)
+		struct bt_ctf_field_type **packet_header_type)
 {
 	int ret = 0;
+	struct bt_ctf_field_type *packet_context_type = NULL;
+	struct bt_ctf_field_type *event_header_type = NULL;
+	struct bt_ctf_field_type *stream_event_ctx_type = NULL;
+	struct bt_ctf_field_type *event_context_type = NULL;
+	struct bt_ctf_field_type *event_payload_type = NULL;
 
 	BT_LOGV("Validating event class field types: "
-		"packet-header-ft-addr=%p", packet_header_type);
+		"packet-header-ft-addr=%p", *packet_header_type);
 
 	/* Resolve sequence type lengths and variant type tags first */
 	ret = bt_ctf_resolve_types(environment, packet_header_type,
-		NULL, NULL, NULL, NULL, NULL,
+		&packet_context_type, &event_header_type,
+		&stream_event_ctx_type, &event_context_type,
+		&event_payload_type,
 		BT_CTF_RESOLVE_FLAG_PACKET_HEADER);
 	if (ret) {
 		BT_LOGW("Cannot resolve trace field types: ret=%d",
@@ -197,8 +244,8 @@ int validate_trace_types(struct bt_value *environment,
 	}
 
 	/* Validate field types individually */
-	if (packet_header_type) {
-		ret = bt_ctf_field_type_validate(packet_header_type);
+	if (*packet_header_type) {
+		ret = bt_ctf_field_type_validate(*packet_header_type);
 		if (ret) {
 			BT_LOGW("Invalid trace's packet header field type: "
 				"ret=%d", ret);
@@ -206,54 +253,7 @@ int validate_trace_types(struct bt_value *environment,
 		}
 	}
 
-end:
-	return ret;
-}
-
-/*
- * Checks whether or not `field_type` contains a variant or a sequence
- * field type, recursively. Returns 1 if it's the case.
- *
- * `field_type` is owned by the caller.
- */
-static
-int field_type_contains_sequence_or_variant_ft(struct bt_ctf_field_type *type)
-{
-	int ret = 0;
-	enum bt_ctf_field_type_id type_id = bt_ctf_field_type_get_type_id(type);
-
-	switch (type_id) {
-	case BT_CTF_FIELD_TYPE_ID_SEQUENCE:
-	case BT_CTF_FIELD_TYPE_ID_VARIANT:
-		ret = 1;
-		goto end;
-	case BT_CTF_FIELD_TYPE_ID_ARRAY:
-	case BT_CTF_FIELD_TYPE_ID_STRUCT:
-	{
-		int i;
-		int field_count = bt_ctf_field_type_get_field_count(type);
-
-		if (field_count < 0) {
-			ret = -1;
-			goto end;
-		}
-
-		for (i = 0; i < field_count; ++i) {
-			struct bt_ctf_field_type *child_type =
-				bt_ctf_field_type_get_field_at_index(type, i);
-
-			ret = field_type_contains_sequence_or_variant_ft(
-				child_type);
-			BT_PUT(child_type);
-			if (ret != 0) {
-				goto end;
-			}
-		}
-		break;
-	}
-	default:
-		break;
-	}
+	freeze_valid_type(*packet_header_type);
 
 end:
 	return ret;
@@ -272,7 +272,6 @@ int bt_ctf_validate_class_types(struct bt_value *environment,
 		enum bt_ctf_validation_flag validate_flags)
 {
 	int ret = 0;
-	int contains_seq_var;
 	int valid_ret;
 
 	BT_LOGV("Validating field types: "
@@ -305,7 +304,10 @@ int bt_ctf_validate_class_types(struct bt_value *environment,
 		output->valid_flags |= BT_CTF_VALIDATION_FLAG_EVENT;
 	}
 
-	/* Own the type parameters */
+	/*
+	 * Own the type parameters. Resolving does not modify them: it
+	 * replaces those references with resolved copies when needed.
+	 */
 	bt_get(packet_header_type);
 	bt_get(packet_context_type);
 	bt_get(event_header_type);
@@ -315,47 +317,9 @@ int bt_ctf_validate_class_types(struct bt_value *environment,
 
 	/* Validate trace */
 	if ((validate_flags & BT_CTF_VALIDATION_FLAG_TRACE) && !trace_valid) {
-		struct bt_ctf_field_type *packet_header_type_copy = NULL;
-
-		/* Create field type copies */
-		if (packet_header_type) {
-			contains_seq_var =
-				field_type_contains_sequence_or_variant_ft(
-					packet_header_type);
-			if (contains_seq_var < 0) {
-				ret = contains_seq_var;
-				goto error;
-			} else if (!contains_seq_var) {
-				/* No copy is needed */
-				packet_header_type_copy = packet_header_type;
-				bt_get(packet_header_type_copy);
-				goto skip_packet_header_type_copy;
-			}
-
-			BT_LOGV_STR("Copying packet header field type because it contains at least one sequence or variant field type.");
-			packet_header_type_copy =
-				bt_ctf_field_type_copy(packet_header_type);
-			if (!packet_header_type_copy) {
-				ret = -1;
-				BT_LOGE_STR("Cannot copy packet header field type.");
-				goto error;
-			}
-
-			/*
-			 * Freeze this copy: if it's returned to the
-			 * caller, it cannot be modified any way since
-			 * it will be resolved.
-			 */
-			bt_ctf_field_type_freeze(packet_header_type_copy);
-		}
-
-skip_packet_header_type_copy:
-		/* Put original reference and move copy */
-		BT_MOVE(packet_header_type, packet_header_type_copy);
-
 		/* Validate trace field types */
 		valid_ret = validate_trace_types(environment,
-			packet_header_type);
+			&packet_header_type);
 		if (valid_ret == 0) {
 			/* Trace is valid */
 			output->valid_flags |= BT_CTF_VALIDATION_FLAG_TRACE;
@@ -365,225 +329,34 @@ skip_packet_header_type_copy:
 	/* Validate stream class */
 	if ((validate_flags & BT_CTF_VALIDATION_FLAG_STREAM) &&
 			!stream_class_valid) {
-		struct bt_ctf_field_type *packet_context_type_copy = NULL;
-		struct bt_ctf_field_type *event_header_type_copy = NULL;
-		struct bt_ctf_field_type *stream_event_ctx_type_copy = NULL;
-
-		if (packet_context_type) {
-			contains_seq_var =
-				field_type_contains_sequence_or_variant_ft(
-					packet_context_type);
-			if (contains_seq_var < 0) {
-				ret = contains_seq_var;
-				goto error;
-			} else if (!contains_seq_var) {
-				/* No copy is needed */
-				packet_context_type_copy = packet_context_type;
-				bt_get(packet_context_type_copy);
-				goto skip_packet_context_type_copy;
-			}
-
-			BT_LOGV_STR("Copying packet context field type because it contains at least one sequence or variant field type.");
-			packet_context_type_copy =
-				bt_ctf_field_type_copy(packet_context_type);
-			if (!packet_context_type_copy) {
-				BT_LOGE_STR("Cannot copy packet context field type.");
-				goto sc_validation_error;
-			}
-
-			/*
-			 * Freeze this copy: if it's returned to the
-			 * caller, it cannot be modified any way since
-			 * it will be resolved.
-			 */
-			bt_ctf_field_type_freeze(packet_context_type_copy);
-		}
-
-skip_packet_context_type_copy:
-		if (event_header_type) {
-			contains_seq_var =
-				field_type_contains_sequence_or_variant_ft(
-					event_header_type);
-			if (contains_seq_var < 0) {
-				ret = contains_seq_var;
-				goto error;
-			} else if (!contains_seq_var) {
-				/* No copy is needed */
-				event_header_type_copy = event_header_type;
-				bt_get(event_header_type_copy);
-				goto skip_event_header_type_copy;
-			}
-
-			BT_LOGV_STR("Copying event header field type because it contains at least one sequence or variant field type.");
-			event_header_type_copy =
-				bt_ctf_field_type_copy(event_header_type);
-			if (!event_header_type_copy) {
-				BT_LOGE_STR("Cannot copy event header field type.");
-				goto sc_validation_error;
-			}
-
-			/*
-			 * Freeze this copy: if it's returned to the
-			 * caller, it cannot be modified any way since
-			 * it will be resolved.
-			 */
-			bt_ctf_field_type_freeze(event_header_type_copy);
-		}
-
-skip_event_header_type_copy:
-		if (stream_event_ctx_type) {
-			contains_seq_var =
-				field_type_contains_sequence_or_variant_ft(
-					stream_event_ctx_type);
-			if (contains_seq_var < 0) {
-				ret = contains_seq_var;
-				goto error;
-			} else if (!contains_seq_var) {
-				/* No copy is needed */
-				stream_event_ctx_type_copy =
-					stream_event_ctx_type;
-				bt_get(stream_event_ctx_type_copy);
-				goto skip_stream_event_ctx_type_copy;
-			}
-
-			BT_LOGV_STR("Copying stream event context field type because it contains at least one sequence or variant field type.");
-			stream_event_ctx_type_copy =
-				bt_ctf_field_type_copy(stream_event_ctx_type);
-			if (!stream_event_ctx_type_copy) {
-				BT_LOGE_STR("Cannot copy stream event context field type.");
-				goto sc_validation_error;
-			}
-
-			/*
-			 * Freeze this copy: if it's returned to the
-			 * caller, it cannot be modified any way since
-			 * it will be resolved.
-			 */
-			bt_ctf_field_type_freeze(stream_event_ctx_type_copy);
-		}
-
-skip_stream_event_ctx_type_copy:
-		/* Put original references and move copies */
-		BT_MOVE(packet_context_type, packet_context_type_copy);
-		BT_MOVE(event_header_type, event_header_type_copy);
-		BT_MOVE(stream_event_ctx_type, stream_event_ctx_type_copy);
-
 		/* Validate stream class field types */
 		valid_ret = validate_stream_class_types(environment,
-			packet_header_type, packet_context_type,
-			event_header_type, stream_event_ctx_type);
+			packet_header_type, &packet_context_type,
+			&event_header_type, &stream_event_ctx_type);
 		if (valid_ret == 0) {
 			/* Stream class is valid */
 			output->valid_flags |= BT_CTF_VALIDATION_FLAG_STREAM;
 		}
-
-		goto sc_validation_done;
-
-sc_validation_error:
-		BT_PUT(packet_context_type_copy);
-		BT_PUT(event_header_type_copy);
-		BT_PUT(stream_event_ctx_type_copy);
-		ret = -1;
-		goto error;
 	}
 
-sc_validation_done:
 	/* Validate event class */
 	if ((validate_flags & BT_CTF_VALIDATION_FLAG_EVENT) &&
 			!event_class_valid) {
-		struct bt_ctf_field_type *event_context_type_copy = NULL;
-		struct bt_ctf_field_type *event_payload_type_copy = NULL;
-
-		if (event_context_type) {
-			contains_seq_var =
-				field_type_contains_sequence_or_variant_ft(
-					event_context_type);
-			if (contains_seq_var < 0) {
-				ret = contains_seq_var;
-				goto error;
-			} else if (!contains_seq_var) {
-				/* No copy is needed */
-				event_context_type_copy = event_context_type;
-				bt_get(event_context_type_copy);
-				goto skip_event_context_type_copy;
-			}
-
-			BT_LOGV_STR("Copying event context field type because it contains at least one sequence or variant field type.");
-			event_context_type_copy =
-				bt_ctf_field_type_copy(event_context_type);
-			if (!event_context_type_copy) {
-				BT_LOGE_STR("Cannot copy event context field type.");
-				goto ec_validation_error;
-			}
-
-			/*
-			 * Freeze this copy: if it's returned to the
-			 * caller, it cannot be modified any way since
-			 * it will be resolved.
-			 */
-			bt_ctf_field_type_freeze(event_context_type_copy);
-		}
-
-skip_event_context_type_copy:
-		if (event_payload_type) {
-			contains_seq_var =
-				field_type_contains_sequence_or_variant_ft(
-					event_payload_type);
-			if (contains_seq_var < 0) {
-				ret = contains_seq_var;
-				goto error;
-			} else if (!contains_seq_var) {
-				/* No copy is needed */
-				event_payload_type_copy = event_payload_type;
-				bt_get(event_payload_type_copy);
-				goto skip_event_payload_type_copy;
-			}
-
-			BT_LOGV_STR("Copying event payload field type because it contains at least one sequence or variant field type.");
-			event_payload_type_copy =
-				bt_ctf_field_type_copy(event_payload_type);
-			if (!event_payload_type_copy) {
-				BT_LOGE_STR("Cannot copy event payload field type.");
-				goto ec_validation_error;
-			}
-
-			/*
-			 * Freeze this copy: if it's returned to the
-			 * caller, it cannot be modified any way since
-			 * it will be resolved.
-			 */
-			bt_ctf_field_type_freeze(event_payload_type_copy);
-		}
-
-skip_event_payload_type_copy:
-		/* Put original references and move copies */
-		BT_MOVE(event_context_type, event_context_type_copy);
-		BT_MOVE(event_payload_type, event_payload_type_copy);
-
 		/* Validate event class field types */
 		valid_ret = validate_event_class_types(environment,
 			packet_header_type, packet_context_type,
 			event_header_type, stream_event_ctx_type,
-			event_context_type, event_payload_type);
+			&event_context_type, &event_payload_type);
 		if (valid_ret == 0) {
 			/* Event class is valid */
 			output->valid_flags |= BT_CTF_VALIDATION_FLAG_EVENT;
 		}
-
-		goto ec_validation_done;
-
-ec_validation_error:
-		BT_PUT(event_context_type_copy);
-		BT_PUT(event_payload_type_copy);
-		ret = -1;
-		goto error;
 	}
 
-ec_validation_done:
 	/*
 	 * Validation is complete. Move the field types that were used
-	 * to validate (and that were possibly altered by the validation
-	 * process) to the output values.
+	 * to validate (and that were possibly replaced with resolved
+	 * copies by the validation process) to the output values.
 	 */
 	BT_MOVE(output->packet_header_type, packet_header_type);
 	BT_MOVE(output->packet_context_type, packet_context_type);
@@ -592,15 +365,6 @@ ec_validation_done:
 	BT_MOVE(output->event_context_type, event_context_type);
 	BT_MOVE(output->event_payload_type, event_payload_type);
 	return ret;
-
-error:
-	BT_PUT(packet_header_type);
-	BT_PUT(packet_context_type);
-	BT_PUT(event_header_type);
-	BT_PUT(stream_event_ctx_type);
-	BT_PUT(event_context_type);
-	BT_PUT(event_payload_type);
-	return ret;
 }
 
 BT_HIDDEN
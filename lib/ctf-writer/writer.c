@@ -48,6 +48,25 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <limits.h>
+#include <string.h>
+
+#define TSDL_MAGIC			0x75d11d57
+#define METADATA_PACKET_SIZE		4096
+
+/* Packetized metadata packet header (CTF 1.8, section 7.1) */
+struct metadata_packet_header {
+	uint32_t magic;
+	uint8_t  uuid[16];
+	uint32_t checksum;
+	uint32_t content_size;
+	uint32_t packet_size;
+	uint8_t  compression_scheme;
+	uint8_t  encryption_scheme;
+	uint8_t  checksum_scheme;
+	uint8_t  major;
+	uint8_t  minor;
+} __attribute__((__packed__));
 
 static
 void bt_ctf_writer_destroy(struct bt_object *obj);
@@ -125,6 +144,11 @@ struct bt_ctf_writer *bt_ctf_writer_create(const char *path)
 		goto error_destroy;
 	}
 
+	ret = bt_ctf_trace_metadata_state_init(&writer->metadata_state);
+	if (ret) {
+		goto error_destroy;
+	}
+
 	writer->trace = bt_ctf_trace_create();
 	if (!writer->trace) {
 		goto error_destroy;
@@ -202,6 +226,7 @@ void bt_ctf_writer_destroy(struct bt_object *obj)
 		}
 	}
 
+	bt_ctf_trace_metadata_state_fini(&writer->metadata_state);
 	bt_object_release(writer->trace);
 	g_free(writer);
 }
@@ -220,8 +245,9 @@ end:
 	return trace;
 }
 
-struct bt_ctf_stream *bt_ctf_writer_create_stream(struct bt_ctf_writer *writer,
-		struct bt_ctf_stream_class *stream_class)
+static
+struct bt_ctf_stream *create_stream(struct bt_ctf_writer *writer,
+		struct bt_ctf_stream_class *stream_class, uint64_t id)
 {
 	struct bt_ctf_stream *stream = NULL;
 	int stream_class_count;
@@ -263,7 +289,7 @@ struct bt_ctf_stream *bt_ctf_writer_create_stream(struct bt_ctf_writer *writer,
 		}
 	}
 
-	stream = bt_ctf_stream_create(stream_class, NULL);
+	stream = bt_ctf_stream_create_with_id_no_check(stream_class, NULL, id);
 	if (!stream) {
 		goto error;
 	}
@@ -275,6 +301,58 @@ error:
 	return stream;
 }
 
+struct bt_ctf_stream *bt_ctf_writer_create_stream(struct bt_ctf_writer *writer,
+		struct bt_ctf_stream_class *stream_class)
+{
+	return create_stream(writer, stream_class, -1ULL);
+}
+
+struct bt_ctf_stream *bt_ctf_writer_create_stream_with_id(
+		struct bt_ctf_writer *writer,
+		struct bt_ctf_stream_class *stream_class, uint64_t id)
+{
+	if (!writer || !stream_class) {
+		BT_LOGW("Invalid parameter: writer or stream class is NULL: "
+			"writer-addr=%p, stream-class-addr=%p",
+			writer, stream_class);
+		return NULL;
+	}
+
+	if ((int64_t) id < 0) {
+		BT_LOGW("Invalid parameter: invalid stream's ID: id=%" PRIu64,
+			id);
+		return NULL;
+	}
+
+	return create_stream(writer, stream_class, id);
+}
+
+int bt_ctf_writer_set_append_stream_files(struct bt_ctf_writer *writer,
+		bt_bool append)
+{
+	int ret = 0;
+
+	if (!writer) {
+		BT_LOGW_STR("Invalid parameter: writer is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (writer->frozen) {
+		BT_LOGW("Invalid parameter: writer is frozen: addr=%p",
+			writer);
+		ret = -1;
+		goto end;
+	}
+
+	writer->append_stream_files = append;
+	BT_LOGV("Set writer's stream file append mode: addr=%p, append=%d",
+		writer, append);
+
+end:
+	return ret;
+}
+
 int bt_ctf_writer_add_environment_field(struct bt_ctf_writer *writer,
 		const char *name,
 		const char *value)
@@ -334,41 +412,168 @@ end:
 	return metadata_string;
 }
 
+static
+int write_all(int fd, const void *buf, size_t len)
+{
+	const char *ptr = buf;
+
+	while (len > 0) {
+		ssize_t ret = write(fd, ptr, len);
+
+		if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			perror("write");
+			return -1;
+		}
+
+		ptr += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+static inline
+uint32_t metadata_packet_header_uint32(struct bt_ctf_writer *writer,
+		uint32_t value)
+{
+	if (writer->trace->native_byte_order ==
+			BT_CTF_BYTE_ORDER_LITTLE_ENDIAN) {
+		return GUINT32_TO_LE(value);
+	} else {
+		return GUINT32_TO_BE(value);
+	}
+}
+
+/*
+ * Writes `metadata` as packetized metadata: a sequence of packets of
+ * at most METADATA_PACKET_SIZE bytes, each one with a packet header.
+ * Each flush writes complete packets so that a consumer can read the
+ * metadata file while it grows.
+ */
+static
+int write_metadata_packets(struct bt_ctf_writer *writer,
+		const char *metadata, size_t len)
+{
+	int ret = 0;
+	const size_t max_content_len = METADATA_PACKET_SIZE -
+		sizeof(struct metadata_packet_header);
+
+	while (len > 0) {
+		struct metadata_packet_header header = {
+			.major = 1,
+			.minor = 8,
+		};
+		size_t content_len = MIN(len, max_content_len);
+		uint32_t content_size = (uint32_t) (sizeof(header) +
+			content_len) * CHAR_BIT;
+
+		header.magic = metadata_packet_header_uint32(writer,
+			TSDL_MAGIC);
+		memcpy(header.uuid, writer->trace->uuid, sizeof(header.uuid));
+		header.content_size = metadata_packet_header_uint32(writer,
+			content_size);
+		header.packet_size = header.content_size;
+		ret = write_all(writer->metadata_fd, &header, sizeof(header));
+		if (ret) {
+			goto end;
+		}
+
+		ret = write_all(writer->metadata_fd, metadata, content_len);
+		if (ret) {
+			goto end;
+		}
+
+		metadata += content_len;
+		len -= content_len;
+	}
+
+end:
+	return ret;
+}
+
 void bt_ctf_writer_flush_metadata(struct bt_ctf_writer *writer)
 {
 	int ret;
 	char *metadata_string = NULL;
+	bt_bool is_full;
+	size_t len;
 
-	if (!writer) {
+	if (!writer || !writer->trace || !writer->metadata_state.preamble) {
 		goto end;
 	}
 
-	metadata_string = bt_ctf_trace_get_metadata_string(
-		writer->trace);
+	/*
+	 * Only append what the metadata file does not contain yet,
+	 * unless what it contains is not up to date anymore.
+	 */
+	metadata_string = bt_ctf_trace_get_metadata_string_incremental(
+		writer->trace, &writer->metadata_state, &is_full);
 	if (!metadata_string) {
 		goto end;
 	}
 
-	if (lseek(writer->metadata_fd, 0, SEEK_SET) == (off_t)-1) {
-		perror("lseek");
-		goto end;
+	if (is_full) {
+		if (lseek(writer->metadata_fd, 0, SEEK_SET) == (off_t)-1) {
+			perror("lseek");
+			goto error;
+		}
+
+		if (ftruncate(writer->metadata_fd, 0)) {
+			perror("ftruncate");
+			goto error;
+		}
 	}
 
-	if (ftruncate(writer->metadata_fd, 0)) {
-		perror("ftruncate");
+	len = strlen(metadata_string);
+	if (len == 0) {
 		goto end;
 	}
 
-	ret = write(writer->metadata_fd, metadata_string,
-		strlen(metadata_string));
-	if (ret < 0) {
-		perror("write");
-		goto end;
+	if (writer->packetized_metadata) {
+		ret = write_metadata_packets(writer, metadata_string, len);
+	} else {
+		ret = write_all(writer->metadata_fd, metadata_string, len);
 	}
+
+	if (ret) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	/* Rewrite the whole metadata file on the next flush */
+	bt_ctf_trace_metadata_state_reset(&writer->metadata_state);
+
 end:
 	g_free(metadata_string);
 }
 
+int bt_ctf_writer_set_packetized_metadata(struct bt_ctf_writer *writer,
+		bt_bool packetized)
+{
+	int ret = 0;
+
+	if (!writer) {
+		ret = -1;
+		goto end;
+	}
+
+	if (writer->packetized_metadata != packetized) {
+		writer->packetized_metadata = packetized;
+
+		/* Rewrite the whole metadata file on the next flush */
+		bt_ctf_trace_metadata_state_reset(&writer->metadata_state);
+	}
+
+end:
+	return ret;
+}
+
 int bt_ctf_writer_set_byte_order(struct bt_ctf_writer *writer,
 		enum bt_ctf_byte_order byte_order)
 {
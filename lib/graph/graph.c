@@ -40,6 +40,7 @@
 #include <babeltrace/values.h>
 #include <babeltrace/values-internal.h>
 #include <unistd.h>
+#include <inttypes.h>
 #include <glib.h>
 
 struct bt_graph_listener {
@@ -82,6 +83,13 @@ void bt_graph_destroy(struct bt_object *obj)
 	BT_LOGD("Destroying graph: addr=%p", graph);
 	obj->ref_count.count++;
 
+	if (graph->memory.budget > 0) {
+		BT_LOGI("Graph's memory budget usage: addr=%p, "
+			"budget=%" PRIu64 ", peak-reserved=%" PRIu64,
+			graph, graph->memory.budget,
+			graph->memory.peak_reserved);
+	}
+
 	/*
 	 * Cancel the graph to disallow some operations, like creating
 	 * notification iterators and adding ports to components.
@@ -763,6 +771,119 @@ extern bt_bool bt_graph_is_canceled(struct bt_graph *graph)
 	return graph ? graph->canceled : BT_FALSE;
 }
 
+enum bt_graph_status bt_graph_set_memory_budget(struct bt_graph *graph,
+		uint64_t budget)
+{
+	enum bt_graph_status ret = BT_GRAPH_STATUS_OK;
+
+	if (!graph) {
+		BT_LOGW_STR("Invalid parameter: graph is NULL.");
+		ret = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	graph->memory.budget = budget;
+	BT_LOGV("Set graph's memory budget: addr=%p, budget=%" PRIu64,
+		graph, budget);
+
+end:
+	return ret;
+}
+
+enum bt_graph_status bt_graph_get_memory_budget(struct bt_graph *graph,
+		uint64_t *budget)
+{
+	enum bt_graph_status ret = BT_GRAPH_STATUS_OK;
+
+	if (!graph || !budget) {
+		BT_LOGW("Invalid parameter: graph or budget is NULL: "
+			"graph-addr=%p, budget-addr=%p", graph, budget);
+		ret = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	*budget = graph->memory.budget;
+
+end:
+	return ret;
+}
+
+enum bt_graph_status bt_graph_get_reserved_memory(struct bt_graph *graph,
+		uint64_t *reserved)
+{
+	enum bt_graph_status ret = BT_GRAPH_STATUS_OK;
+
+	if (!graph || !reserved) {
+		BT_LOGW("Invalid parameter: graph or reserved size is NULL: "
+			"graph-addr=%p, reserved-addr=%p", graph, reserved);
+		ret = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	*reserved = graph->memory.reserved;
+
+end:
+	return ret;
+}
+
+enum bt_graph_status bt_graph_reserve_memory(struct bt_graph *graph,
+		uint64_t size)
+{
+	enum bt_graph_status ret = BT_GRAPH_STATUS_OK;
+
+	if (!graph) {
+		BT_LOGW_STR("Invalid parameter: graph is NULL.");
+		ret = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	if (graph->memory.budget > 0 &&
+			(size > graph->memory.budget ||
+			graph->memory.reserved >
+				graph->memory.budget - size)) {
+		BT_LOGV("Refusing memory reservation: graph-addr=%p, "
+			"size=%" PRIu64 ", reserved=%" PRIu64
+			", budget=%" PRIu64, graph, size,
+			graph->memory.reserved, graph->memory.budget);
+		ret = BT_GRAPH_STATUS_AGAIN;
+		goto end;
+	}
+
+	graph->memory.reserved += size;
+
+	if (graph->memory.reserved > graph->memory.peak_reserved) {
+		graph->memory.peak_reserved = graph->memory.reserved;
+	}
+
+end:
+	return ret;
+}
+
+enum bt_graph_status bt_graph_release_memory(struct bt_graph *graph,
+		uint64_t size)
+{
+	enum bt_graph_status ret = BT_GRAPH_STATUS_OK;
+
+	if (!graph) {
+		BT_LOGW_STR("Invalid parameter: graph is NULL.");
+		ret = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	if (size > graph->memory.reserved) {
+		BT_LOGW("Invalid parameter: releasing more memory than reserved: "
+			"graph-addr=%p, size=%" PRIu64 ", reserved=%" PRIu64,
+			graph, size, graph->memory.reserved);
+		ret = BT_GRAPH_STATUS_INVALID;
+		goto end;
+	}
+
+	graph->memory.reserved -= size;
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 void bt_graph_remove_connection(struct bt_graph *graph,
 		struct bt_connection *connection)
@@ -34,6 +34,7 @@
 #include <babeltrace/graph/clock-class-priority-map-internal.h>
 #include <babeltrace/graph/notification-event-internal.h>
 #include <babeltrace/types.h>
+#include <babeltrace/object-stats-internal.h>
 #include <stdbool.h>
 
 static
@@ -44,6 +45,8 @@ void bt_notification_event_destroy(struct bt_object *obj)
 
 	BT_PUT(notification->event);
 	BT_PUT(notification->cc_prio_map);
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	g_free(notification);
 }
 
@@ -162,6 +165,8 @@ struct bt_notification *bt_notification_event_create(struct bt_ctf_event *event,
 	bt_notification_init(&notification->parent,
 			BT_NOTIFICATION_TYPE_EVENT,
 			bt_notification_event_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	notification->event = bt_get(event);
 	notification->cc_prio_map = bt_get(cc_prio_map);
 	if (!validate_clock_classes(notification)) {
@@ -27,6 +27,7 @@
 #include <babeltrace/graph/clock-class-priority-map-internal.h>
 #include <babeltrace/graph/notification-internal.h>
 #include <babeltrace/graph/notification-inactivity-internal.h>
+#include <babeltrace/object-stats-internal.h>
 
 static
 void bt_notification_inactivity_destroy(struct bt_object *obj)
@@ -40,6 +41,8 @@ void bt_notification_inactivity_destroy(struct bt_object *obj)
 		g_hash_table_destroy(notification->clock_values);
 	}
 
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	g_free(notification);
 }
 
@@ -60,6 +63,8 @@ struct bt_notification *bt_notification_inactivity_create(
 	bt_notification_init(&notification->parent,
 			BT_NOTIFICATION_TYPE_INACTIVITY,
 			bt_notification_inactivity_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	ret_notif = &notification->parent;
 	notification->clock_values = g_hash_table_new_full(g_direct_hash,
 			g_direct_equal, bt_put, bt_put);
@@ -26,6 +26,7 @@
 
 #include <babeltrace/compiler-internal.h>
 #include <babeltrace/graph/notification-packet-internal.h>
+#include <babeltrace/object-stats-internal.h>
 
 static
 void bt_notification_packet_begin_destroy(struct bt_object *obj)
@@ -34,6 +35,8 @@ void bt_notification_packet_begin_destroy(struct bt_object *obj)
 			(struct bt_notification_packet_begin *) obj;
 
 	BT_PUT(notification->packet);
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	g_free(notification);
 }
 
@@ -44,6 +47,8 @@ void bt_notification_packet_end_destroy(struct bt_object *obj)
 			(struct bt_notification_packet_end *) obj;
 
 	BT_PUT(notification->packet);
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	g_free(notification);
 }
 
@@ -60,6 +65,8 @@ struct bt_notification *bt_notification_packet_begin_create(
 	bt_notification_init(&notification->parent,
 			BT_NOTIFICATION_TYPE_PACKET_BEGIN,
 			bt_notification_packet_begin_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	notification->packet = bt_get(packet);
 	return &notification->parent;
 error:
@@ -96,6 +103,8 @@ struct bt_notification *bt_notification_packet_end_create(
 	bt_notification_init(&notification->parent,
 			BT_NOTIFICATION_TYPE_PACKET_END,
 			bt_notification_packet_end_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	notification->packet = bt_get(packet);
 	return &notification->parent;
 error:
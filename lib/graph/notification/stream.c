@@ -27,6 +27,7 @@
 #include <babeltrace/compiler-internal.h>
 #include <babeltrace/ctf-ir/stream-internal.h>
 #include <babeltrace/graph/notification-stream-internal.h>
+#include <babeltrace/object-stats-internal.h>
 
 static
 void bt_notification_stream_end_destroy(struct bt_object *obj)
@@ -35,6 +36,8 @@ void bt_notification_stream_end_destroy(struct bt_object *obj)
 			(struct bt_notification_stream_end *) obj;
 
 	BT_PUT(notification->stream);
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	g_free(notification);
 }
 
@@ -51,6 +54,8 @@ struct bt_notification *bt_notification_stream_end_create(
 	bt_notification_init(&notification->parent,
 			BT_NOTIFICATION_TYPE_STREAM_END,
 			bt_notification_stream_end_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	notification->stream = bt_get(stream);
 	return &notification->parent;
 error:
@@ -74,6 +79,8 @@ void bt_notification_stream_begin_destroy(struct bt_object *obj)
 			(struct bt_notification_stream_begin *) obj;
 
 	BT_PUT(notification->stream);
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	g_free(notification);
 }
 
@@ -90,6 +97,8 @@ struct bt_notification *bt_notification_stream_begin_create(
 	bt_notification_init(&notification->parent,
 			BT_NOTIFICATION_TYPE_STREAM_BEGIN,
 			bt_notification_stream_begin_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_NOTIFICATION,
+		sizeof(*notification));
 	notification->stream = bt_get(stream);
 	return &notification->parent;
 error:
@@ -0,0 +1,190 @@
+/*
+ * object-stats.c
+ *
+ * Babeltrace Library - Object statistics
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define BT_LOG_TAG "OBJECT-STATS"
+#include <babeltrace/lib-logging-internal.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <babeltrace/object-stats.h>
+#include <babeltrace/object-stats-internal.h>
+#include <babeltrace/types.h>
+
+#define ENV_OBJECT_STATS	"BABELTRACE_OBJECT_STATS"
+
+BT_HIDDEN
+bool bt_object_stats_enabled;
+
+static
+struct bt_object_stats stats[BT_OBJECT_STATS_TYPE_NR];
+
+static
+struct bt_object_stats total_stats;
+
+static
+const char * const type_strings[] = {
+	[BT_OBJECT_STATS_TYPE_FIELD_INTEGER] = "integer field",
+	[BT_OBJECT_STATS_TYPE_FIELD_FLOAT] = "floating point number field",
+	[BT_OBJECT_STATS_TYPE_FIELD_ENUM] = "enumeration field",
+	[BT_OBJECT_STATS_TYPE_FIELD_STRING] = "string field",
+	[BT_OBJECT_STATS_TYPE_FIELD_STRUCT] = "structure field",
+	[BT_OBJECT_STATS_TYPE_FIELD_ARRAY] = "array field",
+	[BT_OBJECT_STATS_TYPE_FIELD_SEQUENCE] = "sequence field",
+	[BT_OBJECT_STATS_TYPE_FIELD_VARIANT] = "variant field",
+	[BT_OBJECT_STATS_TYPE_EVENT] = "event",
+	[BT_OBJECT_STATS_TYPE_PACKET] = "packet",
+	[BT_OBJECT_STATS_TYPE_NOTIFICATION] = "notification",
+	[BT_OBJECT_STATS_TYPE_CLOCK_VALUE] = "clock value",
+	[BT_OBJECT_STATS_TYPE_VALUE] = "value",
+};
+
+static inline
+bool type_is_valid(enum bt_object_stats_type type)
+{
+	return type > BT_OBJECT_STATS_TYPE_UNKNOWN &&
+		type < BT_OBJECT_STATS_TYPE_NR;
+}
+
+static inline
+void stats_add(struct bt_object_stats *s, size_t size)
+{
+	s->created++;
+	s->live++;
+	s->live_bytes += size;
+
+	if (s->live > s->peak_live) {
+		s->peak_live = s->live;
+	}
+
+	if (s->live_bytes > s->peak_live_bytes) {
+		s->peak_live_bytes = s->live_bytes;
+	}
+}
+
+static inline
+void stats_remove(struct bt_object_stats *s, size_t size)
+{
+	assert(s->live > 0);
+	assert(s->live_bytes >= size);
+	s->destroyed++;
+	s->live--;
+	s->live_bytes -= size;
+}
+
+BT_HIDDEN
+void bt_object_stats_add(enum bt_object_stats_type type, size_t size)
+{
+	assert(type_is_valid(type));
+	stats_add(&stats[type], size);
+	stats_add(&total_stats, size);
+}
+
+BT_HIDDEN
+void bt_object_stats_remove(enum bt_object_stats_type type, size_t size)
+{
+	assert(type_is_valid(type));
+	stats_remove(&stats[type], size);
+	stats_remove(&total_stats, size);
+}
+
+bt_bool bt_object_stats_is_enabled(void)
+{
+	return bt_object_stats_enabled ? BT_TRUE : BT_FALSE;
+}
+
+const char *bt_object_stats_type_string(enum bt_object_stats_type type)
+{
+	if (!type_is_valid(type)) {
+		return NULL;
+	}
+
+	return type_strings[type];
+}
+
+int bt_object_stats_get(enum bt_object_stats_type type,
+		struct bt_object_stats *s)
+{
+	int ret = 0;
+
+	if (!s) {
+		BT_LOGW_STR("Invalid parameter: object statistics output is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!type_is_valid(type)) {
+		BT_LOGW("Invalid parameter: unknown object statistics type: "
+			"type=%d", type);
+		ret = -1;
+		goto end;
+	}
+
+	if (!bt_object_stats_enabled) {
+		BT_LOGW_STR("Invalid parameter: object statistics are disabled.");
+		ret = -1;
+		goto end;
+	}
+
+	*s = stats[type];
+
+end:
+	return ret;
+}
+
+int bt_object_stats_get_total(struct bt_object_stats *s)
+{
+	int ret = 0;
+
+	if (!s) {
+		BT_LOGW_STR("Invalid parameter: object statistics output is NULL.");
+		ret = -1;
+		goto end;
+	}
+
+	if (!bt_object_stats_enabled) {
+		BT_LOGW_STR("Invalid parameter: object statistics are disabled.");
+		ret = -1;
+		goto end;
+	}
+
+	*s = total_stats;
+
+end:
+	return ret;
+}
+
+static
+void __attribute__((constructor)) bt_object_stats_ctor(void)
+{
+	const char *env = getenv(ENV_OBJECT_STATS);
+
+	if (env && strcmp(env, "1") == 0) {
+		bt_object_stats_enabled = true;
+		BT_LOGI_STR("Object statistics are enabled.");
+	}
+}
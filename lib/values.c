@@ -39,6 +39,7 @@
 #include <babeltrace/compat/glib-internal.h>
 #include <babeltrace/types.h>
 #include <babeltrace/object-internal.h>
+#include <babeltrace/object-stats-internal.h>
 #include <babeltrace/values-internal.h>
 
 #define BT_VALUE_FROM_CONCRETE(_concrete) ((struct bt_value *) (_concrete))
@@ -142,6 +143,17 @@ void (* const destroy_funcs[])(struct bt_value *) = {
 	[BT_VALUE_TYPE_MAP] =		bt_value_map_destroy,
 };
 
+static
+const size_t value_sizes[] = {
+	[BT_VALUE_TYPE_NULL] =		sizeof(struct bt_value),
+	[BT_VALUE_TYPE_BOOL] =		sizeof(struct bt_value_bool),
+	[BT_VALUE_TYPE_INTEGER] =	sizeof(struct bt_value_integer),
+	[BT_VALUE_TYPE_FLOAT] =		sizeof(struct bt_value_float),
+	[BT_VALUE_TYPE_STRING] =	sizeof(struct bt_value_string),
+	[BT_VALUE_TYPE_ARRAY] =		sizeof(struct bt_value_array),
+	[BT_VALUE_TYPE_MAP] =		sizeof(struct bt_value_map),
+};
+
 static
 struct bt_value *bt_value_null_copy(const struct bt_value *null_obj)
 {
@@ -534,6 +546,8 @@ void bt_value_destroy(struct bt_object *obj)
 		destroy_funcs[value->type](value);
 	}
 
+	bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_VALUE,
+		value_sizes[value->type]);
 	g_free(value);
 }
 
@@ -585,6 +599,8 @@ struct bt_value bt_value_create_base(enum bt_value_type type)
 	base.type = type;
 	base.is_frozen = BT_FALSE;
 	bt_object_init(&base, bt_value_destroy);
+	bt_object_stats_record_create(BT_OBJECT_STATS_TYPE_VALUE,
+		value_sizes[type]);
 	return base;
 }
 
@@ -687,6 +703,8 @@ struct bt_value *bt_value_string_create_init(const char *val)
 
 	if (!string_obj->gstr) {
 		BT_LOGE_STR("Failed to allocate a GString.");
+		bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_VALUE,
+			value_sizes[BT_VALUE_TYPE_STRING]);
 		g_free(string_obj);
 		string_obj = NULL;
 		goto end;
@@ -722,6 +740,8 @@ struct bt_value *bt_value_array_create(void)
 
 	if (!array_obj->garray) {
 		BT_LOGE_STR("Failed to allocate a GPtrArray.");
+		bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_VALUE,
+			value_sizes[BT_VALUE_TYPE_ARRAY]);
 		g_free(array_obj);
 		array_obj = NULL;
 		goto end;
@@ -752,6 +772,8 @@ struct bt_value *bt_value_map_create(void)
 
 	if (!map_obj->ght) {
 		BT_LOGE_STR("Failed to allocate a GHashTable.");
+		bt_object_stats_record_destroy(BT_OBJECT_STATS_TYPE_VALUE,
+			value_sizes[BT_VALUE_TYPE_MAP]);
 		g_free(map_obj);
 		map_obj = NULL;
 		goto end;
@@ -414,6 +414,15 @@ int get_basic_field_type_size(struct bt_ctf_btr *btr,
 		struct bt_ctf_field_type *field_type)
 {
 	int size;
+	const struct bt_ctf_field_type_layout *layout =
+		bt_ctf_field_type_get_layout(field_type);
+
+	/* Precomputed when the field type was frozen */
+	if (likely(layout)) {
+		assert(layout->has_static_size);
+		size = (int) layout->static_size;
+		goto end;
+	}
 
 	switch (bt_ctf_field_type_get_type_id(field_type)) {
 	case BT_CTF_FIELD_TYPE_ID_INTEGER:
@@ -450,6 +459,7 @@ int get_basic_field_type_size(struct bt_ctf_btr *btr,
 		break;
 	}
 
+end:
 	return size;
 }
 
@@ -552,6 +562,21 @@ enum bt_ctf_btr_status read_signed_bitfield(const uint8_t *buf, size_t at,
 	return status;
 }
 
+static inline
+enum bt_ctf_byte_order get_basic_field_type_byte_order(
+		struct bt_ctf_field_type *field_type)
+{
+	const struct bt_ctf_field_type_layout *layout =
+		bt_ctf_field_type_get_layout(field_type);
+
+	/* Precomputed when the field type was frozen */
+	if (likely(layout)) {
+		return layout->byte_order;
+	}
+
+	return bt_ctf_field_type_get_byte_order(field_type);
+}
+
 typedef enum bt_ctf_btr_status (* read_basic_and_call_cb_t)(struct bt_ctf_btr *,
 		const uint8_t *, size_t);
 
@@ -616,7 +641,7 @@ enum bt_ctf_btr_status read_basic_float_and_call_cb(struct bt_ctf_btr *btr,
 	enum bt_ctf_btr_status status = BT_CTF_BTR_STATUS_OK;
 
 	field_size = get_basic_field_type_size(btr, btr->cur_basic_field_type);
-	bo = bt_ctf_field_type_get_byte_order(btr->cur_basic_field_type);
+	bo = get_basic_field_type_byte_order(btr->cur_basic_field_type);
 	btr->cur_bo = bo;
 
 	switch (field_size) {
@@ -719,7 +744,7 @@ enum bt_ctf_btr_status read_basic_int_and_call(struct bt_ctf_btr *btr,
 		goto end;
 	}
 
-	bo = bt_ctf_field_type_get_byte_order(int_type);
+	bo = get_basic_field_type_byte_order(int_type);
 
 	/*
 	 * Update current byte order now because we could be reading
@@ -892,7 +917,7 @@ enum bt_ctf_btr_status read_basic_type_and_call_begin(struct bt_ctf_btr *btr,
 		goto end;
 	}
 
-	bo = bt_ctf_field_type_get_byte_order(btr->cur_basic_field_type);
+	bo = get_basic_field_type_byte_order(btr->cur_basic_field_type);
 	status = validate_contiguous_bo(btr, bo);
 	if (status != BT_CTF_BTR_STATUS_OK) {
 		/* validate_contiguous_bo() logs errors */
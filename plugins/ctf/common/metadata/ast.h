@@ -313,6 +313,16 @@ struct ctf_visitor_generate_ir *ctf_visitor_generate_ir_create(
 
 void ctf_visitor_generate_ir_destroy(struct ctf_visitor_generate_ir *visitor);
 
+/*
+ * Sets the number of threads with which the visitor builds the event
+ * classes of a metadata root, instead of the number of online CPUs:
+ * 1 means a serial visit, and 0 restores the default.
+ */
+BT_HIDDEN
+void ctf_visitor_generate_ir_set_thread_count(
+		struct ctf_visitor_generate_ir *visitor,
+		unsigned int thread_count);
+
 BT_HIDDEN
 struct bt_ctf_trace *ctf_visitor_generate_ir_get_trace(
 		struct ctf_visitor_generate_ir *visitor);
@@ -0,0 +1,1871 @@
+/*
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <assert.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <babeltrace/ref.h>
+#include <babeltrace/values.h>
+#include <babeltrace/ctf-ir/trace.h>
+#include <babeltrace/ctf-ir/clock-class.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/common-internal.h>
+
+#include "ir-cache.h"
+
+#define BT_LOG_TAG "PLUGIN-CTF-METADATA-IR-CACHE"
+#include "logging.h"
+
+/*
+ * The header (magic number and version) is followed by the SHA-256
+ * digest of the rest of the entry, to reject a corrupted entry early.
+ * The classes of an entry are validated, like any other classes, when
+ * they are added to their trace.
+ */
+#define IR_CACHE_MAGIC		0xc1f1ca5e
+#define IR_CACHE_VERSION	4
+#define IR_CACHE_DIGEST_LEN	32
+#define IR_CACHE_FILE_SUFFIX	".ir"
+
+/* Maximum nesting level of a field type, to reject corrupted entries */
+#define IR_CACHE_MAX_FT_DEPTH	256
+
+static
+int write_field_type(GByteArray *buf, struct bt_ctf_field_type *ft);
+
+static
+int write_compound_fields(GByteArray *buf, struct bt_ctf_field_type *ft,
+		bool is_variant)
+{
+	int ret = 0;
+	int64_t count;
+	int64_t i;
+
+	count = is_variant ? bt_ctf_field_type_variant_get_field_count(ft) :
+		bt_ctf_field_type_structure_get_field_count(ft);
+	if (count < 0) {
+		ret = -1;
+		goto end;
+	}
+
+	bt_common_bin_write_u64(buf, (uint64_t) count);
+
+	for (i = 0; i < count; i++) {
+		const char *name;
+		struct bt_ctf_field_type *field_ft = NULL;
+
+		ret = is_variant ?
+			bt_ctf_field_type_variant_get_field_by_index(ft,
+				&name, &field_ft, i) :
+			bt_ctf_field_type_structure_get_field_by_index(ft,
+				&name, &field_ft, i);
+		if (ret) {
+			goto end;
+		}
+
+		bt_common_bin_write_str(buf, name);
+		ret = write_field_type(buf, field_ft);
+		bt_put(field_ft);
+		if (ret) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+static
+int write_enum_mappings(GByteArray *buf, struct bt_ctf_field_type *ft)
+{
+	int ret = 0;
+	int64_t count;
+	int64_t i;
+	struct bt_ctf_field_type *container_ft;
+	bool is_signed;
+
+	container_ft = bt_ctf_field_type_enumeration_get_container_type(ft);
+	if (!container_ft) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = write_field_type(buf, container_ft);
+	if (ret) {
+		goto end;
+	}
+
+	is_signed = bt_ctf_field_type_integer_is_signed(container_ft);
+	count = bt_ctf_field_type_enumeration_get_mapping_count(ft);
+	if (count < 0) {
+		ret = -1;
+		goto end;
+	}
+
+	bt_common_bin_write_u64(buf, (uint64_t) count);
+
+	for (i = 0; i < count; i++) {
+		const char *name;
+
+		if (is_signed) {
+			int64_t begin, end;
+
+			ret = bt_ctf_field_type_enumeration_get_mapping_signed(
+				ft, i, &name, &begin, &end);
+			bt_common_bin_write_u64(buf, (uint64_t) begin);
+			bt_common_bin_write_u64(buf, (uint64_t) end);
+		} else {
+			uint64_t begin, end;
+
+			ret = bt_ctf_field_type_enumeration_get_mapping_unsigned(
+				ft, i, &name, &begin, &end);
+			bt_common_bin_write_u64(buf, begin);
+			bt_common_bin_write_u64(buf, end);
+		}
+
+		if (ret) {
+			goto end;
+		}
+
+		bt_common_bin_write_str(buf, name);
+	}
+
+end:
+	bt_put(container_ft);
+	return ret;
+}
+
+/*
+ * Writes a field type, or a placeholder if `ft` is `NULL`.
+ */
+static
+int write_field_type(GByteArray *buf, struct bt_ctf_field_type *ft)
+{
+	int ret = 0;
+	struct bt_ctf_field_type *element_ft = NULL;
+	struct bt_ctf_clock_class *clock_class = NULL;
+
+	if (!ft) {
+		bt_common_bin_write_u8(buf,
+			(uint8_t) BT_CTF_FIELD_TYPE_ID_UNKNOWN);
+		goto end;
+	}
+
+	bt_common_bin_write_u8(buf,
+		(uint8_t) bt_ctf_field_type_get_type_id(ft));
+
+	switch (bt_ctf_field_type_get_type_id(ft)) {
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+		bt_common_bin_write_u32(buf,
+			(uint32_t) bt_ctf_field_type_integer_get_size(ft));
+		bt_common_bin_write_u8(buf,
+			(uint8_t) bt_ctf_field_type_integer_is_signed(ft));
+		bt_common_bin_write_u8(buf,
+			(uint8_t) bt_ctf_field_type_integer_get_base(ft));
+		bt_common_bin_write_u8(buf,
+			(uint8_t) bt_ctf_field_type_integer_get_encoding(ft));
+		bt_common_bin_write_u8(buf,
+			(uint8_t) bt_ctf_field_type_get_byte_order(ft));
+		bt_common_bin_write_u32(buf,
+			(uint32_t) bt_ctf_field_type_get_alignment(ft));
+		clock_class = bt_ctf_field_type_integer_get_mapped_clock_class(ft);
+		bt_common_bin_write_str(buf, clock_class ?
+			bt_ctf_clock_class_get_name(clock_class) : NULL);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_FLOAT:
+		bt_common_bin_write_u32(buf, (uint32_t)
+			bt_ctf_field_type_floating_point_get_exponent_digits(ft));
+		bt_common_bin_write_u32(buf, (uint32_t)
+			bt_ctf_field_type_floating_point_get_mantissa_digits(ft));
+		bt_common_bin_write_u8(buf,
+			(uint8_t) bt_ctf_field_type_get_byte_order(ft));
+		bt_common_bin_write_u32(buf,
+			(uint32_t) bt_ctf_field_type_get_alignment(ft));
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+		ret = write_enum_mappings(buf, ft);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_STRING:
+		bt_common_bin_write_u8(buf,
+			(uint8_t) bt_ctf_field_type_string_get_encoding(ft));
+		break;
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+		bt_common_bin_write_u32(buf,
+			(uint32_t) bt_ctf_field_type_get_alignment(ft));
+		ret = write_compound_fields(buf, ft, false);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_VARIANT:
+		bt_common_bin_write_str(buf,
+			bt_ctf_field_type_variant_get_tag_name(ft));
+		ret = write_compound_fields(buf, ft, true);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+		bt_common_bin_write_u64(buf,
+			(uint64_t) bt_ctf_field_type_array_get_length(ft));
+		element_ft = bt_ctf_field_type_array_get_element_type(ft);
+		ret = write_field_type(buf, element_ft);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_SEQUENCE:
+		bt_common_bin_write_str(buf,
+			bt_ctf_field_type_sequence_get_length_field_name(ft));
+		element_ft = bt_ctf_field_type_sequence_get_element_type(ft);
+		ret = write_field_type(buf, element_ft);
+		break;
+	default:
+		BT_LOGD("Unsupported field type: ft-addr=%p", ft);
+		ret = -1;
+		break;
+	}
+
+end:
+	bt_put(element_ft);
+	bt_put(clock_class);
+	return ret;
+}
+
+static
+int set_byte_order_and_alignment(struct bt_ctf_field_type *ft,
+		uint8_t byte_order, uint32_t alignment)
+{
+	int ret = 0;
+
+	switch ((int8_t) byte_order) {
+	case BT_CTF_BYTE_ORDER_NATIVE:
+	case BT_CTF_BYTE_ORDER_LITTLE_ENDIAN:
+	case BT_CTF_BYTE_ORDER_BIG_ENDIAN:
+	case BT_CTF_BYTE_ORDER_NETWORK:
+		ret = bt_ctf_field_type_set_byte_order(ft,
+			(enum bt_ctf_byte_order) byte_order);
+		if (ret) {
+			goto end;
+		}
+		break;
+	default:
+		break;
+	}
+
+	ret = bt_ctf_field_type_set_alignment(ft, alignment);
+
+end:
+	return ret;
+}
+
+static
+struct bt_ctf_field_type *read_field_type(struct bt_common_bin_reader *reader,
+		struct bt_ctf_trace *trace, unsigned int depth, bool *is_null);
+
+static
+struct bt_ctf_field_type *read_non_null_field_type(
+		struct bt_common_bin_reader *reader, struct bt_ctf_trace *trace,
+		unsigned int depth)
+{
+	bool is_null;
+	struct bt_ctf_field_type *ft;
+
+	ft = read_field_type(reader, trace, depth, &is_null);
+	if (is_null) {
+		BT_LOGW_STR("Unexpected empty field type in CTF IR cache entry.");
+	}
+
+	return ft;
+}
+
+static
+int read_compound_fields(struct bt_common_bin_reader *reader,
+		struct bt_ctf_trace *trace, struct bt_ctf_field_type *ft,
+		bool is_variant, unsigned int depth)
+{
+	int ret;
+	uint64_t count;
+	uint64_t i;
+
+	ret = bt_common_bin_read_u64(reader, &count);
+	if (ret) {
+		goto end;
+	}
+
+	for (i = 0; i < count; i++) {
+		char *name;
+		struct bt_ctf_field_type *field_ft;
+
+		ret = bt_common_bin_read_str(reader, &name);
+		if (ret) {
+			goto end;
+		}
+
+		field_ft = read_non_null_field_type(reader, trace, depth + 1);
+		if (!field_ft) {
+			g_free(name);
+			ret = -1;
+			goto end;
+		}
+
+		ret = is_variant ?
+			bt_ctf_field_type_variant_add_field(ft, field_ft, name) :
+			bt_ctf_field_type_structure_add_field(ft, field_ft, name);
+		g_free(name);
+		bt_put(field_ft);
+		if (ret) {
+			goto end;
+		}
+	}
+
+end:
+	return ret;
+}
+
+static
+struct bt_ctf_field_type *read_enum_field_type(struct bt_common_bin_reader *reader,
+		struct bt_ctf_trace *trace, unsigned int depth)
+{
+	int ret;
+	uint64_t count;
+	uint64_t i;
+	struct bt_ctf_field_type *container_ft;
+	struct bt_ctf_field_type *ft = NULL;
+	bool is_signed;
+
+	container_ft = read_non_null_field_type(reader, trace, depth + 1);
+	if (!container_ft) {
+		goto error;
+	}
+
+	is_signed = bt_ctf_field_type_integer_is_signed(container_ft);
+	ft = bt_ctf_field_type_enumeration_create(container_ft);
+	if (!ft) {
+		goto error;
+	}
+
+	if (bt_common_bin_read_u64(reader, &count)) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		uint64_t begin, end;
+		char *name;
+
+		if (bt_common_bin_read_u64(reader, &begin) ||
+				bt_common_bin_read_u64(reader, &end) ||
+				bt_common_bin_read_str(reader, &name)) {
+			goto error;
+		}
+
+		if (!name) {
+			goto error;
+		}
+
+		if (is_signed) {
+			ret = bt_ctf_field_type_enumeration_add_mapping_signed(
+				ft, name, (int64_t) begin, (int64_t) end);
+		} else {
+			ret = bt_ctf_field_type_enumeration_add_mapping_unsigned(
+				ft, name, begin, end);
+		}
+
+		g_free(name);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	BT_PUT(ft);
+
+end:
+	bt_put(container_ft);
+	return ft;
+}
+
+/*
+ * Reads a field type. `*is_null` is set to true if the cache entry
+ * contains an empty field type placeholder, in which case this function
+ * returns `NULL`.
+ */
+static
+struct bt_ctf_field_type *read_field_type(struct bt_common_bin_reader *reader,
+		struct bt_ctf_trace *trace, unsigned int depth, bool *is_null)
+{
+	int ret = 0;
+	uint8_t type_id;
+	struct bt_ctf_field_type *ft = NULL;
+	struct bt_ctf_field_type *element_ft = NULL;
+	struct bt_ctf_clock_class *clock_class = NULL;
+	char *str = NULL;
+
+	*is_null = false;
+
+	if (depth > IR_CACHE_MAX_FT_DEPTH) {
+		BT_LOGW("Field type nesting is too deep in CTF IR cache entry: "
+			"depth=%u", depth);
+		goto error;
+	}
+
+	if (bt_common_bin_read_u8(reader, &type_id)) {
+		goto error;
+	}
+
+	switch ((int8_t) type_id) {
+	case BT_CTF_FIELD_TYPE_ID_UNKNOWN:
+		*is_null = true;
+		goto end;
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+	{
+		uint32_t size, alignment;
+		uint8_t is_signed, base, encoding, byte_order;
+
+		if (bt_common_bin_read_u32(reader, &size) ||
+				bt_common_bin_read_u8(reader, &is_signed) ||
+				bt_common_bin_read_u8(reader, &base) ||
+				bt_common_bin_read_u8(reader, &encoding) ||
+				bt_common_bin_read_u8(reader, &byte_order) ||
+				bt_common_bin_read_u32(reader, &alignment) ||
+				bt_common_bin_read_str(reader, &str)) {
+			goto error;
+		}
+
+		ft = bt_ctf_field_type_integer_create(size);
+		if (!ft) {
+			goto error;
+		}
+
+		ret = bt_ctf_field_type_integer_set_is_signed(ft, is_signed);
+		ret |= bt_ctf_field_type_integer_set_base(ft,
+			(enum bt_ctf_integer_base) base);
+		ret |= bt_ctf_field_type_integer_set_encoding(ft,
+			(enum bt_ctf_string_encoding) encoding);
+		ret |= set_byte_order_and_alignment(ft, byte_order, alignment);
+		if (ret) {
+			goto error;
+		}
+
+		if (str) {
+			clock_class = bt_ctf_trace_get_clock_class_by_name(
+				trace, str);
+			if (!clock_class) {
+				BT_LOGW("Unknown mapped clock class in CTF IR cache entry: "
+					"name=\"%s\"", str);
+				goto error;
+			}
+
+			ret = bt_ctf_field_type_integer_set_mapped_clock_class(
+				ft, clock_class);
+			if (ret) {
+				goto error;
+			}
+		}
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_FLOAT:
+	{
+		uint32_t exp_dig, mant_dig, alignment;
+		uint8_t byte_order;
+
+		if (bt_common_bin_read_u32(reader, &exp_dig) ||
+				bt_common_bin_read_u32(reader, &mant_dig) ||
+				bt_common_bin_read_u8(reader, &byte_order) ||
+				bt_common_bin_read_u32(reader, &alignment)) {
+			goto error;
+		}
+
+		ft = bt_ctf_field_type_floating_point_create();
+		if (!ft) {
+			goto error;
+		}
+
+		ret = bt_ctf_field_type_floating_point_set_exponent_digits(ft,
+			exp_dig);
+		ret |= bt_ctf_field_type_floating_point_set_mantissa_digits(ft,
+			mant_dig);
+		ret |= set_byte_order_and_alignment(ft, byte_order, alignment);
+		if (ret) {
+			goto error;
+		}
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+		ft = read_enum_field_type(reader, trace, depth);
+		if (!ft) {
+			goto error;
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_STRING:
+	{
+		uint8_t encoding;
+
+		if (bt_common_bin_read_u8(reader, &encoding)) {
+			goto error;
+		}
+
+		ft = bt_ctf_field_type_string_create();
+		if (!ft) {
+			goto error;
+		}
+
+		ret = bt_ctf_field_type_string_set_encoding(ft,
+			(enum bt_ctf_string_encoding) encoding);
+		if (ret) {
+			goto error;
+		}
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+	{
+		uint32_t alignment;
+
+		if (bt_common_bin_read_u32(reader, &alignment)) {
+			goto error;
+		}
+
+		ft = bt_ctf_field_type_structure_create();
+		if (!ft) {
+			goto error;
+		}
+
+		ret = bt_ctf_field_type_set_alignment(ft, alignment);
+		if (ret) {
+			goto error;
+		}
+
+		ret = read_compound_fields(reader, trace, ft, false, depth);
+		if (ret) {
+			goto error;
+		}
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_VARIANT:
+		if (bt_common_bin_read_str(reader, &str)) {
+			goto error;
+		}
+
+		ft = bt_ctf_field_type_variant_create(NULL, NULL);
+		if (!ft) {
+			goto error;
+		}
+
+		if (str) {
+			ret = bt_ctf_field_type_variant_set_tag_name(ft, str);
+			if (ret) {
+				goto error;
+			}
+		}
+
+		ret = read_compound_fields(reader, trace, ft, true, depth);
+		if (ret) {
+			goto error;
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+	{
+		uint64_t length;
+
+		if (bt_common_bin_read_u64(reader, &length) ||
+				length > UINT_MAX) {
+			goto error;
+		}
+
+		element_ft = read_non_null_field_type(reader, trace,
+			depth + 1);
+		if (!element_ft) {
+			goto error;
+		}
+
+		ft = bt_ctf_field_type_array_create(element_ft,
+			(unsigned int) length);
+		if (!ft) {
+			goto error;
+		}
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_SEQUENCE:
+		if (bt_common_bin_read_str(reader, &str) || !str) {
+			goto error;
+		}
+
+		element_ft = read_non_null_field_type(reader, trace,
+			depth + 1);
+		if (!element_ft) {
+			goto error;
+		}
+
+		ft = bt_ctf_field_type_sequence_create(element_ft, str);
+		if (!ft) {
+			goto error;
+		}
+		break;
+	default:
+		BT_LOGW("Unknown field type ID in CTF IR cache entry: id=%d",
+			(int) (int8_t) type_id);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_PUT(ft);
+
+end:
+	g_free(str);
+	bt_put(element_ft);
+	bt_put(clock_class);
+	return ft;
+}
+
+/*
+ * Reads an optional field type and sets it with `set_func`.
+ */
+static
+int read_and_set_field_type(struct bt_common_bin_reader *reader,
+		struct bt_ctf_trace *trace, void *obj,
+		int (*set_func)(void *, struct bt_ctf_field_type *))
+{
+	int ret;
+	bool is_null;
+	struct bt_ctf_field_type *ft;
+
+	ft = read_field_type(reader, trace, 0, &is_null);
+	if (!ft && !is_null) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = set_func(obj, ft);
+
+end:
+	bt_put(ft);
+	return ret;
+}
+
+static
+int write_clock_class(GByteArray *buf, struct bt_ctf_clock_class *clock_class)
+{
+	int ret;
+	int64_t offset_s, offset_cycles;
+	const unsigned char *uuid;
+
+	ret = bt_ctf_clock_class_get_offset_s(clock_class, &offset_s);
+	ret |= bt_ctf_clock_class_get_offset_cycles(clock_class,
+		&offset_cycles);
+	if (ret) {
+		goto end;
+	}
+
+	bt_common_bin_write_str(buf, bt_ctf_clock_class_get_name(clock_class));
+	bt_common_bin_write_str(buf,
+		bt_ctf_clock_class_get_description(clock_class));
+	bt_common_bin_write_u64(buf,
+		bt_ctf_clock_class_get_frequency(clock_class));
+	bt_common_bin_write_u64(buf,
+		bt_ctf_clock_class_get_precision(clock_class));
+	bt_common_bin_write_u64(buf, (uint64_t) offset_s);
+	bt_common_bin_write_u64(buf, (uint64_t) offset_cycles);
+	bt_common_bin_write_u8(buf,
+		(uint8_t) bt_ctf_clock_class_is_absolute(clock_class));
+	uuid = bt_ctf_clock_class_get_uuid(clock_class);
+	bt_common_bin_write_u8(buf, uuid ? 1 : 0);
+	if (uuid) {
+		g_byte_array_append(buf, uuid, 16);
+	}
+
+end:
+	return ret;
+}
+
+static
+struct bt_ctf_clock_class *read_clock_class(struct bt_common_bin_reader *reader)
+{
+	int ret;
+	char *name = NULL;
+	char *description = NULL;
+	uint64_t frequency, precision;
+	int64_t offset_s, offset_cycles;
+	uint8_t is_absolute, has_uuid;
+	unsigned char uuid[16];
+	struct bt_ctf_clock_class *clock_class = NULL;
+
+	if (bt_common_bin_read_str(reader, &name) || !name ||
+			bt_common_bin_read_str(reader, &description) ||
+			bt_common_bin_read_u64(reader, &frequency) ||
+			bt_common_bin_read_u64(reader, &precision) ||
+			bt_common_bin_read_i64(reader, &offset_s) ||
+			bt_common_bin_read_i64(reader, &offset_cycles) ||
+			bt_common_bin_read_u8(reader, &is_absolute) ||
+			bt_common_bin_read_u8(reader, &has_uuid)) {
+		goto error;
+	}
+
+	if (has_uuid && bt_common_bin_read_bytes(reader, uuid,
+			sizeof(uuid))) {
+		goto error;
+	}
+
+	clock_class = bt_ctf_clock_class_create(name);
+	if (!clock_class) {
+		goto error;
+	}
+
+	ret = 0;
+	if (description) {
+		ret |= bt_ctf_clock_class_set_description(clock_class,
+			description);
+	}
+
+	ret |= bt_ctf_clock_class_set_frequency(clock_class, frequency);
+	ret |= bt_ctf_clock_class_set_precision(clock_class, precision);
+	ret |= bt_ctf_clock_class_set_offset_s(clock_class, offset_s);
+	ret |= bt_ctf_clock_class_set_offset_cycles(clock_class,
+		offset_cycles);
+	ret |= bt_ctf_clock_class_set_is_absolute(clock_class, is_absolute);
+	if (has_uuid) {
+		ret |= bt_ctf_clock_class_set_uuid(clock_class, uuid);
+	}
+
+	if (ret) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_PUT(clock_class);
+
+end:
+	g_free(name);
+	g_free(description);
+	return clock_class;
+}
+
+static
+int write_event_class(GByteArray *buf, struct bt_ctf_event_class *event_class)
+{
+	int ret = 0;
+	int64_t count;
+	int64_t i;
+	struct bt_ctf_field_type *ft = NULL;
+
+	bt_common_bin_write_str(buf, bt_ctf_event_class_get_name(event_class));
+	count = bt_ctf_event_class_get_attribute_count(event_class);
+	if (count < 0) {
+		ret = -1;
+		goto end;
+	}
+
+	bt_common_bin_write_u64(buf, (uint64_t) count);
+
+	for (i = 0; i < count; i++) {
+		struct bt_value *value;
+
+		bt_common_bin_write_str(buf,
+			bt_ctf_event_class_get_attribute_name_by_index(
+			event_class, i));
+		value = bt_ctf_event_class_get_attribute_value_by_index(
+			event_class, i);
+		ret = bt_common_bin_write_value(buf, value);
+		bt_put(value);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	ft = bt_ctf_event_class_get_context_type(event_class);
+	ret = write_field_type(buf, ft);
+	if (ret) {
+		goto end;
+	}
+
+	BT_PUT(ft);
+	ft = bt_ctf_event_class_get_payload_type(event_class);
+	ret = write_field_type(buf, ft);
+
+end:
+	bt_put(ft);
+	return ret;
+}
+
+static
+int set_event_class_context_type(void *obj, struct bt_ctf_field_type *ft)
+{
+	return bt_ctf_event_class_set_context_type(obj, ft);
+}
+
+static
+int set_event_class_payload_type(void *obj, struct bt_ctf_field_type *ft)
+{
+	return bt_ctf_event_class_set_payload_type(obj, ft);
+}
+
+static
+struct bt_ctf_event_class *read_event_class(struct bt_common_bin_reader *reader,
+		struct bt_ctf_trace *trace)
+{
+	int ret;
+	char *name = NULL;
+	uint64_t count;
+	uint64_t i;
+	struct bt_ctf_event_class *event_class = NULL;
+
+	if (bt_common_bin_read_str(reader, &name) || !name ||
+			bt_common_bin_read_u64(reader, &count)) {
+		goto error;
+	}
+
+	event_class = bt_ctf_event_class_create(name);
+	if (!event_class) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		char *attr_name;
+		struct bt_value *value;
+
+		if (bt_common_bin_read_str(reader, &attr_name) ||
+				!attr_name) {
+			goto error;
+		}
+
+		value = bt_common_bin_read_value(reader);
+		if (!value) {
+			g_free(attr_name);
+			goto error;
+		}
+
+		/*
+		 * The name is set at creation time, and the stream ID
+		 * is set when the event class is added to its stream
+		 * class.
+		 */
+		ret = 0;
+		if (strcmp(attr_name, "name") != 0 &&
+				strcmp(attr_name, "stream_id") != 0) {
+			ret = bt_ctf_event_class_set_attribute(event_class,
+				attr_name, value);
+		}
+
+		g_free(attr_name);
+		bt_put(value);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	ret = read_and_set_field_type(reader, trace, event_class,
+		set_event_class_context_type);
+	if (ret) {
+		goto error;
+	}
+
+	ret = read_and_set_field_type(reader, trace, event_class,
+		set_event_class_payload_type);
+	if (ret) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_PUT(event_class);
+
+end:
+	g_free(name);
+	return event_class;
+}
+
+static
+int write_stream_class(GByteArray *buf,
+		struct bt_ctf_stream_class *stream_class)
+{
+	int ret = 0;
+	int64_t count;
+	int64_t i;
+	struct bt_ctf_field_type *ft = NULL;
+
+	bt_common_bin_write_str(buf,
+		bt_ctf_stream_class_get_name(stream_class));
+	bt_common_bin_write_u64(buf,
+		(uint64_t) bt_ctf_stream_class_get_id(stream_class));
+	ft = bt_ctf_stream_class_get_packet_context_type(stream_class);
+	ret = write_field_type(buf, ft);
+	if (ret) {
+		goto end;
+	}
+
+	BT_PUT(ft);
+	ft = bt_ctf_stream_class_get_event_header_type(stream_class);
+	ret = write_field_type(buf, ft);
+	if (ret) {
+		goto end;
+	}
+
+	BT_PUT(ft);
+	ft = bt_ctf_stream_class_get_event_context_type(stream_class);
+	ret = write_field_type(buf, ft);
+	if (ret) {
+		goto end;
+	}
+
+	count = bt_ctf_stream_class_get_event_class_count(stream_class);
+	if (count < 0) {
+		ret = -1;
+		goto end;
+	}
+
+	bt_common_bin_write_u64(buf, (uint64_t) count);
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_event_class *event_class =
+			bt_ctf_stream_class_get_event_class_by_index(
+				stream_class, i);
+
+		ret = write_event_class(buf, event_class);
+		bt_put(event_class);
+		if (ret) {
+			goto end;
+		}
+	}
+
+end:
+	bt_put(ft);
+	return ret;
+}
+
+static
+int set_stream_class_packet_context_type(void *obj,
+		struct bt_ctf_field_type *ft)
+{
+	return bt_ctf_stream_class_set_packet_context_type(obj, ft);
+}
+
+static
+int set_stream_class_event_header_type(void *obj,
+		struct bt_ctf_field_type *ft)
+{
+	return bt_ctf_stream_class_set_event_header_type(obj, ft);
+}
+
+static
+int set_stream_class_event_context_type(void *obj,
+		struct bt_ctf_field_type *ft)
+{
+	return bt_ctf_stream_class_set_event_context_type(obj, ft);
+}
+
+static
+struct bt_ctf_stream_class *read_stream_class(struct bt_common_bin_reader *reader,
+		struct bt_ctf_trace *trace)
+{
+	int ret;
+	char *name = NULL;
+	int64_t id;
+	uint64_t count;
+	uint64_t i;
+	struct bt_ctf_stream_class *stream_class = NULL;
+	GPtrArray *event_classes = NULL;
+
+	if (bt_common_bin_read_str(reader, &name) ||
+			bt_common_bin_read_i64(reader, &id)) {
+		goto error;
+	}
+
+	stream_class = bt_ctf_stream_class_create(name);
+	if (!stream_class) {
+		goto error;
+	}
+
+	if (id >= 0) {
+		ret = bt_ctf_stream_class_set_id(stream_class, (uint64_t) id);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	ret = read_and_set_field_type(reader, trace, stream_class,
+		set_stream_class_packet_context_type);
+	ret |= read_and_set_field_type(reader, trace, stream_class,
+		set_stream_class_event_header_type);
+	ret |= read_and_set_field_type(reader, trace, stream_class,
+		set_stream_class_event_context_type);
+	if (ret) {
+		goto error;
+	}
+
+	if (bt_common_bin_read_u64(reader, &count)) {
+		goto error;
+	}
+
+	event_classes = g_ptr_array_new_with_free_func((GDestroyNotify) bt_put);
+	if (!event_classes) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_event_class *event_class;
+
+		event_class = read_event_class(reader, trace);
+		if (!event_class) {
+			goto error;
+		}
+
+		g_ptr_array_add(event_classes, event_class);
+	}
+
+	/* Add all the event classes at once */
+	ret = bt_ctf_stream_class_add_event_classes(stream_class,
+		(struct bt_ctf_event_class **) event_classes->pdata,
+		event_classes->len);
+	if (ret) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_PUT(stream_class);
+
+end:
+	if (event_classes) {
+		g_ptr_array_free(event_classes, TRUE);
+	}
+
+	g_free(name);
+	return stream_class;
+}
+
+/*
+ * Computes the digest of the `len` bytes at `data` into `digest`.
+ */
+static
+int get_digest(const uint8_t *data, size_t len,
+		uint8_t digest[IR_CACHE_DIGEST_LEN])
+{
+	int ret = 0;
+	gsize digest_len = IR_CACHE_DIGEST_LEN;
+	GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+
+	if (!checksum) {
+		ret = -1;
+		goto end;
+	}
+
+	g_checksum_update(checksum, (const guchar *) data, len);
+	g_checksum_get_digest(checksum, (guint8 *) digest, &digest_len);
+	g_checksum_free(checksum);
+	assert(digest_len == IR_CACHE_DIGEST_LEN);
+
+end:
+	return ret;
+}
+
+/*
+ * Reads the entry's digest and checks that it matches the rest of the
+ * entry.
+ */
+static
+int check_digest(struct bt_common_bin_reader *reader)
+{
+	int ret;
+	uint8_t expected[IR_CACHE_DIGEST_LEN];
+	uint8_t digest[IR_CACHE_DIGEST_LEN];
+
+	ret = bt_common_bin_read_bytes(reader, expected, sizeof(expected));
+	if (ret) {
+		goto end;
+	}
+
+	ret = get_digest(&reader->buf[reader->at], reader->len - reader->at,
+		digest);
+	if (ret) {
+		goto end;
+	}
+
+	if (memcmp(expected, digest, sizeof(digest)) != 0) {
+		BT_LOGW_STR("CTF IR cache entry's digest does not match its contents.");
+		ret = -1;
+	}
+
+end:
+	return ret;
+}
+
+static
+int write_trace(GByteArray *buf, struct bt_ctf_trace *trace)
+{
+	int ret = 0;
+	int64_t count;
+	int64_t i;
+	const unsigned char *uuid;
+	struct bt_ctf_field_type *ft = NULL;
+	const uint8_t digest_placeholder[IR_CACHE_DIGEST_LEN] = { 0 };
+	guint digest_at;
+
+	bt_common_bin_write_u32(buf, IR_CACHE_MAGIC);
+	bt_common_bin_write_u32(buf, IR_CACHE_VERSION);
+
+	/* The digest is set once the rest of the entry is written */
+	digest_at = buf->len;
+	g_byte_array_append(buf, digest_placeholder,
+		sizeof(digest_placeholder));
+	bt_common_bin_write_u8(buf,
+		(uint8_t) bt_ctf_trace_get_native_byte_order(trace));
+	uuid = bt_ctf_trace_get_uuid(trace);
+	bt_common_bin_write_u8(buf, uuid ? 1 : 0);
+	if (uuid) {
+		g_byte_array_append(buf, uuid, 16);
+	}
+
+	count = bt_ctf_trace_get_environment_field_count(trace);
+	if (count < 0) {
+		ret = -1;
+		goto end;
+	}
+
+	bt_common_bin_write_u64(buf, (uint64_t) count);
+
+	for (i = 0; i < count; i++) {
+		struct bt_value *value;
+
+		bt_common_bin_write_str(buf,
+			bt_ctf_trace_get_environment_field_name_by_index(
+			trace, i));
+		value = bt_ctf_trace_get_environment_field_value_by_index(
+			trace, i);
+		ret = bt_common_bin_write_value(buf, value);
+		bt_put(value);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	count = bt_ctf_trace_get_clock_class_count(trace);
+	if (count < 0) {
+		ret = -1;
+		goto end;
+	}
+
+	bt_common_bin_write_u64(buf, (uint64_t) count);
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_clock_class *clock_class =
+			bt_ctf_trace_get_clock_class_by_index(trace, i);
+
+		ret = write_clock_class(buf, clock_class);
+		bt_put(clock_class);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	ft = bt_ctf_trace_get_packet_header_type(trace);
+	ret = write_field_type(buf, ft);
+	if (ret) {
+		goto end;
+	}
+
+	count = bt_ctf_trace_get_stream_class_count(trace);
+	if (count < 0) {
+		ret = -1;
+		goto end;
+	}
+
+	bt_common_bin_write_u64(buf, (uint64_t) count);
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_stream_class *stream_class =
+			bt_ctf_trace_get_stream_class_by_index(trace, i);
+
+		ret = write_stream_class(buf, stream_class);
+		bt_put(stream_class);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	ret = get_digest(&buf->data[digest_at + IR_CACHE_DIGEST_LEN],
+		buf->len - digest_at - IR_CACHE_DIGEST_LEN,
+		&buf->data[digest_at]);
+
+end:
+	bt_put(ft);
+	return ret;
+}
+
+/*
+ * Sets the name of a trace loaded from the cache exactly like the
+ * metadata visitor does: the `hostname` environment entry, if any,
+ * followed by the name suffix.
+ */
+static
+int set_trace_name(struct bt_ctf_trace *trace, const char *name_suffix)
+{
+	int ret;
+	GString *name;
+	struct bt_value *value;
+
+	name = g_string_new(NULL);
+	if (!name) {
+		ret = -1;
+		goto end;
+	}
+
+	value = bt_ctf_trace_get_environment_field_value_by_name(trace,
+		"hostname");
+	if (bt_value_is_string(value)) {
+		const char *hostname;
+
+		ret = bt_value_string_get(value, &hostname);
+		assert(ret == 0);
+		g_string_append(name, hostname);
+
+		if (name_suffix) {
+			g_string_append_c(name, G_DIR_SEPARATOR);
+		}
+	}
+
+	bt_put(value);
+
+	if (name_suffix) {
+		g_string_append(name, name_suffix);
+	}
+
+	ret = bt_ctf_trace_set_name(trace, name->str);
+	g_string_free(name, TRUE);
+
+end:
+	return ret;
+}
+
+static
+int set_trace_packet_header_type(void *obj, struct bt_ctf_field_type *ft)
+{
+	return bt_ctf_trace_set_packet_header_type(obj, ft);
+}
+
+static
+struct bt_ctf_trace *read_trace(struct bt_common_bin_reader *reader,
+		const char *name)
+{
+	int ret;
+	uint32_t magic, version;
+	uint8_t byte_order, has_uuid;
+	unsigned char uuid[16];
+	uint64_t count;
+	uint64_t i;
+	struct bt_ctf_trace *trace = NULL;
+
+	if (bt_common_bin_read_u32(reader, &magic) ||
+			bt_common_bin_read_u32(reader, &version)) {
+		goto error;
+	}
+
+	if (magic != IR_CACHE_MAGIC || version != IR_CACHE_VERSION) {
+		BT_LOGW("Invalid CTF IR cache entry header: "
+			"magic=0x%" PRIx32 ", version=%" PRIu32,
+			magic, version);
+		goto error;
+	}
+
+	if (check_digest(reader)) {
+		goto error;
+	}
+
+	if (bt_common_bin_read_u8(reader, &byte_order) ||
+			bt_common_bin_read_u8(reader, &has_uuid)) {
+		goto error;
+	}
+
+	if (has_uuid && bt_common_bin_read_bytes(reader, uuid,
+			sizeof(uuid))) {
+		goto error;
+	}
+
+	trace = bt_ctf_trace_create();
+	if (!trace) {
+		goto error;
+	}
+
+	ret = bt_ctf_trace_set_native_byte_order(trace,
+		(enum bt_ctf_byte_order) (int8_t) byte_order);
+	if (ret) {
+		goto error;
+	}
+
+	if (has_uuid) {
+		ret = bt_ctf_trace_set_uuid(trace, uuid);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	/* Environment */
+	if (bt_common_bin_read_u64(reader, &count)) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		char *env_name;
+		struct bt_value *value;
+
+		if (bt_common_bin_read_str(reader, &env_name) ||
+				!env_name) {
+			goto error;
+		}
+
+		value = bt_common_bin_read_value(reader);
+		if (!value) {
+			g_free(env_name);
+			goto error;
+		}
+
+		ret = bt_ctf_trace_set_environment_field(trace, env_name,
+			value);
+		g_free(env_name);
+		bt_put(value);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	/* Clock classes */
+	if (bt_common_bin_read_u64(reader, &count)) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_clock_class *clock_class;
+
+		clock_class = read_clock_class(reader);
+		if (!clock_class) {
+			goto error;
+		}
+
+		ret = bt_ctf_trace_add_clock_class(trace, clock_class);
+		bt_put(clock_class);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	ret = read_and_set_field_type(reader, trace, trace,
+		set_trace_packet_header_type);
+	if (ret) {
+		goto error;
+	}
+
+	/*
+	 * The trace's name must be set before adding the first stream
+	 * class, which freezes the trace.
+	 */
+	ret = set_trace_name(trace, name);
+	if (ret) {
+		goto error;
+	}
+
+	/* Stream classes */
+	if (bt_common_bin_read_u64(reader, &count)) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_stream_class *stream_class;
+
+		stream_class = read_stream_class(reader, trace);
+		if (!stream_class) {
+			goto error;
+		}
+
+		/*
+		 * This validates the stream class and its event
+		 * classes: an entry's contents are never trusted.
+		 */
+		ret = bt_ctf_trace_add_stream_class(trace, stream_class);
+		bt_put(stream_class);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	if (reader->at != reader->len) {
+		BT_LOGW("Unexpected trailing data in CTF IR cache entry: "
+			"at=%zu, len=%zu", reader->at, reader->len);
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_PUT(trace);
+
+end:
+	return trace;
+}
+
+/*
+ * Creates a new event class with the same name and attributes as
+ * `event_class`, sharing its field types.
+ */
+static
+struct bt_ctf_event_class *share_event_class(
+		struct bt_ctf_event_class *event_class)
+{
+	int ret;
+	int64_t count;
+	int64_t i;
+	struct bt_ctf_field_type *ft = NULL;
+	struct bt_ctf_event_class *new_event_class;
+
+	new_event_class = bt_ctf_event_class_create(
+		bt_ctf_event_class_get_name(event_class));
+	if (!new_event_class) {
+		goto error;
+	}
+
+	count = bt_ctf_event_class_get_attribute_count(event_class);
+	if (count < 0) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		const char *attr_name;
+		struct bt_value *value;
+
+		attr_name = bt_ctf_event_class_get_attribute_name_by_index(
+			event_class, i);
+		if (!attr_name) {
+			goto error;
+		}
+
+		/* See read_event_class() */
+		if (strcmp(attr_name, "name") == 0 ||
+				strcmp(attr_name, "stream_id") == 0) {
+			continue;
+		}
+
+		value = bt_ctf_event_class_get_attribute_value_by_index(
+			event_class, i);
+		ret = bt_ctf_event_class_set_attribute(new_event_class,
+			attr_name, value);
+		bt_put(value);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	ft = bt_ctf_event_class_get_context_type(event_class);
+	ret = bt_ctf_event_class_set_context_type(new_event_class, ft);
+	if (ret) {
+		goto error;
+	}
+
+	BT_PUT(ft);
+	ft = bt_ctf_event_class_get_payload_type(event_class);
+	ret = bt_ctf_event_class_set_payload_type(new_event_class, ft);
+	if (ret) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_PUT(new_event_class);
+
+end:
+	bt_put(ft);
+	return new_event_class;
+}
+
+/*
+ * Creates a new stream class with the same name, ID, and event classes
+ * as `stream_class`, sharing its field types.
+ */
+static
+struct bt_ctf_stream_class *share_stream_class(
+		struct bt_ctf_stream_class *stream_class)
+{
+	int ret;
+	int64_t id;
+	int64_t count;
+	int64_t i;
+	struct bt_ctf_field_type *ft = NULL;
+	struct bt_ctf_stream_class *new_stream_class;
+	GPtrArray *event_classes = NULL;
+
+	new_stream_class = bt_ctf_stream_class_create(
+		bt_ctf_stream_class_get_name(stream_class));
+	if (!new_stream_class) {
+		goto error;
+	}
+
+	id = bt_ctf_stream_class_get_id(stream_class);
+	if (id >= 0) {
+		ret = bt_ctf_stream_class_set_id(new_stream_class,
+			(uint64_t) id);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	ft = bt_ctf_stream_class_get_packet_context_type(stream_class);
+	ret = bt_ctf_stream_class_set_packet_context_type(new_stream_class,
+		ft);
+	BT_PUT(ft);
+	ft = bt_ctf_stream_class_get_event_header_type(stream_class);
+	ret |= bt_ctf_stream_class_set_event_header_type(new_stream_class,
+		ft);
+	BT_PUT(ft);
+	ft = bt_ctf_stream_class_get_event_context_type(stream_class);
+	ret |= bt_ctf_stream_class_set_event_context_type(new_stream_class,
+		ft);
+	BT_PUT(ft);
+	if (ret) {
+		goto error;
+	}
+
+	count = bt_ctf_stream_class_get_event_class_count(stream_class);
+	if (count < 0) {
+		goto error;
+	}
+
+	event_classes = g_ptr_array_new_with_free_func((GDestroyNotify) bt_put);
+	if (!event_classes) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_event_class *event_class =
+			bt_ctf_stream_class_get_event_class_by_index(
+				stream_class, i);
+		struct bt_ctf_event_class *new_event_class =
+			share_event_class(event_class);
+
+		bt_put(event_class);
+		if (!new_event_class) {
+			goto error;
+		}
+
+		g_ptr_array_add(event_classes, new_event_class);
+	}
+
+	ret = bt_ctf_stream_class_add_event_classes(new_stream_class,
+		(struct bt_ctf_event_class **) event_classes->pdata,
+		event_classes->len);
+	if (ret) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	BT_PUT(new_stream_class);
+
+end:
+	if (event_classes) {
+		g_ptr_array_free(event_classes, TRUE);
+	}
+
+	return new_stream_class;
+}
+
+static
+gchar *get_entry_path(const char *cache_dir, const char *key)
+{
+	gchar *path;
+	GString *basename = g_string_new(key);
+
+	if (!basename) {
+		return NULL;
+	}
+
+	g_string_append(basename, IR_CACHE_FILE_SUFFIX);
+	path = g_build_filename(cache_dir, basename->str, NULL);
+	g_string_free(basename, TRUE);
+	return path;
+}
+
+BT_HIDDEN
+gchar *ctf_metadata_ir_cache_get_key(const char *metadata, size_t len,
+		int64_t clock_class_offset_ns)
+{
+	GChecksum *checksum;
+	gchar *key = NULL;
+	const uint32_t version = IR_CACHE_VERSION;
+
+	checksum = g_checksum_new(G_CHECKSUM_SHA256);
+	if (!checksum) {
+		goto end;
+	}
+
+	g_checksum_update(checksum, (const guchar *) &version,
+		sizeof(version));
+	g_checksum_update(checksum, (const guchar *) &clock_class_offset_ns,
+		sizeof(clock_class_offset_ns));
+	g_checksum_update(checksum, (const guchar *) metadata, len);
+	key = g_strdup(g_checksum_get_string(checksum));
+	g_checksum_free(checksum);
+
+end:
+	return key;
+}
+
+BT_HIDDEN
+GByteArray *ctf_metadata_ir_cache_encode(struct bt_ctf_trace *trace)
+{
+	GByteArray *buf;
+
+	assert(trace);
+	buf = g_byte_array_new();
+	if (!buf) {
+		goto end;
+	}
+
+	if (write_trace(buf, trace)) {
+		BT_LOGD("Cannot serialize CTF IR trace: trace-addr=%p", trace);
+		g_byte_array_free(buf, TRUE);
+		buf = NULL;
+	}
+
+end:
+	return buf;
+}
+
+BT_HIDDEN
+struct bt_ctf_trace *ctf_metadata_ir_cache_decode(const uint8_t *buf,
+		size_t len, const char *name)
+{
+	struct bt_common_bin_reader reader;
+
+	assert(buf);
+	reader.buf = buf;
+	reader.len = len;
+	reader.at = 0;
+	return read_trace(&reader, name);
+}
+
+BT_HIDDEN
+struct bt_ctf_trace *ctf_metadata_ir_cache_share(struct bt_ctf_trace *trace,
+		const char *name)
+{
+	int ret;
+	int64_t count;
+	int64_t i;
+	const unsigned char *uuid;
+	struct bt_ctf_field_type *ft = NULL;
+	struct bt_ctf_trace *new_trace;
+
+	assert(trace);
+	new_trace = bt_ctf_trace_create();
+	if (!new_trace) {
+		goto error;
+	}
+
+	ret = bt_ctf_trace_set_native_byte_order(new_trace,
+		bt_ctf_trace_get_native_byte_order(trace));
+	if (ret) {
+		goto error;
+	}
+
+	uuid = bt_ctf_trace_get_uuid(trace);
+	if (uuid) {
+		ret = bt_ctf_trace_set_uuid(new_trace, uuid);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	count = bt_ctf_trace_get_environment_field_count(trace);
+	if (count < 0) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_value *value =
+			bt_ctf_trace_get_environment_field_value_by_index(
+				trace, i);
+
+		ret = bt_ctf_trace_set_environment_field(new_trace,
+			bt_ctf_trace_get_environment_field_name_by_index(
+				trace, i), value);
+		bt_put(value);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	/*
+	 * The shared field types can be mapped to those clock classes,
+	 * so they are shared too.
+	 */
+	count = bt_ctf_trace_get_clock_class_count(trace);
+	if (count < 0) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_clock_class *clock_class =
+			bt_ctf_trace_get_clock_class_by_index(trace, i);
+
+		ret = bt_ctf_trace_add_clock_class(new_trace, clock_class);
+		bt_put(clock_class);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	ft = bt_ctf_trace_get_packet_header_type(trace);
+	ret = bt_ctf_trace_set_packet_header_type(new_trace, ft);
+	if (ret) {
+		goto error;
+	}
+
+	ret = set_trace_name(new_trace, name);
+	if (ret) {
+		goto error;
+	}
+
+	count = bt_ctf_trace_get_stream_class_count(trace);
+	if (count < 0) {
+		goto error;
+	}
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_stream_class *stream_class =
+			bt_ctf_trace_get_stream_class_by_index(trace, i);
+		struct bt_ctf_stream_class *new_stream_class =
+			share_stream_class(stream_class);
+
+		bt_put(stream_class);
+		if (!new_stream_class) {
+			goto error;
+		}
+
+		/*
+		 * The field types of `trace` are already resolved the
+		 * same way, so this validates them without copying them.
+		 */
+		ret = bt_ctf_trace_add_stream_class(new_trace,
+			new_stream_class);
+		bt_put(new_stream_class);
+		if (ret) {
+			goto error;
+		}
+	}
+
+	BT_LOGD("Created CTF IR trace sharing the field types of another: "
+		"trace-addr=%p, new-trace-addr=%p", trace, new_trace);
+	goto end;
+
+error:
+	BT_LOGD("Cannot create CTF IR trace sharing the field types of another: "
+		"trace-addr=%p", trace);
+	BT_PUT(new_trace);
+
+end:
+	bt_put(ft);
+	return new_trace;
+}
+
+BT_HIDDEN
+struct bt_ctf_trace *ctf_metadata_ir_cache_load(const char *cache_dir,
+		const char *key, const char *name)
+{
+	gchar *path;
+	gchar *contents = NULL;
+	gsize len;
+	struct bt_ctf_trace *trace = NULL;
+
+	assert(cache_dir);
+	assert(key);
+	path = get_entry_path(cache_dir, key);
+	if (!path) {
+		goto end;
+	}
+
+	if (!g_file_get_contents(path, &contents, &len, NULL)) {
+		BT_LOGD("No CTF IR cache entry: path=\"%s\"", path);
+		goto end;
+	}
+
+	trace = ctf_metadata_ir_cache_decode((const uint8_t *) contents, len,
+		name);
+	if (!trace) {
+		BT_LOGW("Cannot load CTF IR cache entry: path=\"%s\"", path);
+		goto end;
+	}
+
+	BT_LOGD("Loaded CTF IR trace from cache entry: path=\"%s\", "
+		"trace-addr=%p", path, trace);
+
+end:
+	g_free(contents);
+	g_free(path);
+	return trace;
+}
+
+BT_HIDDEN
+int ctf_metadata_ir_cache_store(const char *cache_dir, const char *key,
+		struct bt_ctf_trace *trace)
+{
+	int ret;
+	gchar *path = NULL;
+	GByteArray *buf = NULL;
+
+	assert(cache_dir);
+	assert(key);
+	assert(trace);
+	buf = ctf_metadata_ir_cache_encode(trace);
+	if (!buf) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = g_mkdir_with_parents(cache_dir, 0755);
+	if (ret) {
+		BT_LOGW("Cannot create CTF IR cache directory: path=\"%s\"",
+			cache_dir);
+		goto end;
+	}
+
+	path = get_entry_path(cache_dir, key);
+	if (!path) {
+		ret = -1;
+		goto end;
+	}
+
+	/* g_file_set_contents() atomically replaces the entry */
+	if (!g_file_set_contents(path, (const gchar *) buf->data, buf->len,
+			NULL)) {
+		BT_LOGW("Cannot write CTF IR cache entry: path=\"%s\"", path);
+		ret = -1;
+		goto end;
+	}
+
+	BT_LOGD("Stored CTF IR trace in cache entry: path=\"%s\", "
+		"size=%u", path, buf->len);
+
+end:
+	g_free(path);
+	if (buf) {
+		g_byte_array_free(buf, TRUE);
+	}
+
+	return ret;
+}
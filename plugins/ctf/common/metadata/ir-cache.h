@@ -0,0 +1,111 @@
+#ifndef _METADATA_IR_CACHE_H
+#define _METADATA_IR_CACHE_H
+
+/*
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <glib.h>
+#include <babeltrace/babeltrace-internal.h>
+
+struct bt_ctf_trace;
+
+/*
+ * The CTF IR cache keeps, in a directory, a compact binary
+ * representation of the CTF IR traces built from CTF metadata texts.
+ * Loading a trace from this cache skips the metadata parsing and the
+ * AST to CTF IR conversion steps. A digest of an entry's contents
+ * guards against corruption, and its classes are validated again when
+ * they are added to their trace, like any other classes.
+ *
+ * A cache entry is identified by a key computed from the complete
+ * metadata file contents (packetized or not) and the clock class
+ * offset given to ctf_metadata_decoder_create().
+ */
+
+/*
+ * Computes the cache key of the metadata file contents `metadata` of
+ * `len` bytes with the clock class offset `clock_class_offset_ns`.
+ *
+ * Returns a new string which you must free with g_free(), or `NULL`
+ * on error.
+ */
+BT_HIDDEN
+gchar *ctf_metadata_ir_cache_get_key(const char *metadata, size_t len,
+		int64_t clock_class_offset_ns);
+
+/*
+ * Encodes the CTF IR trace `trace` as a cache entry.
+ *
+ * Returns a new byte array which you must free with
+ * g_byte_array_free(), or `NULL` on error.
+ */
+BT_HIDDEN
+GByteArray *ctf_metadata_ir_cache_encode(struct bt_ctf_trace *trace);
+
+/*
+ * Creates a new CTF IR trace from the cache entry of `len` bytes at
+ * `buf`, as encoded by ctf_metadata_ir_cache_encode(). `name` is the
+ * name suffix of the created trace, as given to
+ * ctf_metadata_decoder_create().
+ *
+ * Each call creates a distinct trace with its own classes. This is
+ * much cheaper than decoding the original metadata again.
+ *
+ * Returns `NULL` if the entry is invalid.
+ */
+BT_HIDDEN
+struct bt_ctf_trace *ctf_metadata_ir_cache_decode(const uint8_t *buf,
+		size_t len, const char *name);
+
+/*
+ * Creates a new CTF IR trace with the same properties and classes as
+ * `trace`, which must have valid classes. `name` is the name suffix
+ * of the created trace, as given to ctf_metadata_decoder_create().
+ *
+ * The created trace has its own stream and event classes, but they
+ * share the field types and clock classes of `trace`, so that it
+ * takes little memory compared to a trace decoded on its own.
+ *
+ * Returns `NULL` on error.
+ */
+BT_HIDDEN
+struct bt_ctf_trace *ctf_metadata_ir_cache_share(struct bt_ctf_trace *trace,
+		const char *name);
+
+/*
+ * Loads the CTF IR trace having the cache key `key` from the cache
+ * directory `cache_dir`. `name` is the name suffix of the created
+ * trace, as given to ctf_metadata_decoder_create().
+ *
+ * Returns `NULL` if there's no such cache entry, or if it's invalid
+ * (corrupted, or written by another version or on a machine with
+ * another byte order).
+ */
+BT_HIDDEN
+struct bt_ctf_trace *ctf_metadata_ir_cache_load(const char *cache_dir,
+		const char *key, const char *name);
+
+/*
+ * Stores the CTF IR trace `trace` in the cache directory `cache_dir`
+ * with the cache key `key`, creating the directory if needed.
+ *
+ * Returns 0 on success, or a negative value on error.
+ */
+BT_HIDDEN
+int ctf_metadata_ir_cache_store(const char *cache_dir, const char *key,
+		struct bt_ctf_trace *trace);
+
+#endif /* _METADATA_IR_CACHE_H */
@@ -38,6 +38,7 @@
 #include <inttypes.h>
 #include <errno.h>
 #include <babeltrace/compat/uuid-internal.h>
+#include <babeltrace/common-internal.h>
 #include <babeltrace/endian-internal.h>
 #include <babeltrace/ref.h>
 #include <babeltrace/ctf-ir/trace.h>
@@ -47,6 +48,7 @@
 #include <babeltrace/ctf-ir/field-types.h>
 #include <babeltrace/ctf-ir/field-types-internal.h>
 #include <babeltrace/ctf-ir/clock-class.h>
+#include <babeltrace/object-stats.h>
 
 #include "scanner.h"
 #include "parser.h"
@@ -55,6 +57,15 @@
 #define BT_LOG_TAG "PLUGIN-CTF-METADATA-VISITOR-GENERATE-IR"
 #include "logging.h"
 
+/*
+ * Minimum number of event declarations to build per thread: below
+ * this, creating threads costs more than it saves.
+ */
+#define EVENT_DECL_MIN_JOBS_PER_THREAD	32
+
+/* Maximum number of threads building event declarations */
+#define EVENT_DECL_MAX_THREADS		8
+
 /* Bit value (left shift) */
 #define _BV(_val)		(1 << (_val))
 
@@ -210,6 +221,28 @@ struct ctx {
 	 * int64_t -> struct bt_ctf_stream_class *
 	 */
 	GHashTable *stream_classes;
+
+	/*
+	 * Stream IDs to event classes to add to their stream class,
+	 * all at once, at the end of the visit.
+	 *
+	 * int64_t -> GPtrArray of struct bt_ctf_event_class * (owned)
+	 */
+	GHashTable *event_classes;
+
+	/*
+	 * Clock classes which integer field types are mapped to, or
+	 * NULL to map them to the trace's clock classes.
+	 *
+	 * GQuark (name) -> struct bt_ctf_clock_class * (owned)
+	 */
+	GHashTable *clock_classes;
+
+	/*
+	 * Number of threads with which to build event classes, or 0
+	 * for the number of online CPUs.
+	 */
+	unsigned int thread_count;
 };
 
 /*
@@ -576,6 +609,10 @@ void ctx_destroy(struct ctx *ctx)
 		g_hash_table_destroy(ctx->stream_classes);
 	}
 
+	if (ctx->event_classes) {
+		g_hash_table_destroy(ctx->event_classes);
+	}
+
 	free(ctx->trace_name_suffix);
 	g_free(ctx);
 
@@ -613,6 +650,12 @@ struct ctx *ctx_create(struct bt_ctf_trace *trace,
 		goto error;
 	}
 
+	ctx->event_classes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
+	if (!ctx->event_classes) {
+		goto error;
+	}
+
 	if (trace_name_suffix) {
 		ctx->trace_name_suffix = strdup(trace_name_suffix);
 		if (!ctx->trace_name_suffix) {
@@ -678,6 +721,155 @@ end:
 	return;
 }
 
+/**
+ * Returns the clock class named \p name to which integer field types
+ * are mapped in a visitor context.
+ *
+ * @param ctx	Visitor context
+ * @param name	Clock class name
+ * @returns	Clock class (new reference), or NULL if not found
+ */
+static
+struct bt_ctf_clock_class *ctx_get_clock_class_by_name(struct ctx *ctx,
+		const char *name)
+{
+	GQuark qname;
+	struct bt_ctf_clock_class *clock_class = NULL;
+
+	assert(ctx);
+	assert(name);
+
+	if (!ctx->clock_classes) {
+		clock_class = bt_ctf_trace_get_clock_class_by_name(ctx->trace,
+			name);
+		goto end;
+	}
+
+	qname = g_quark_try_string(name);
+	if (!qname) {
+		goto end;
+	}
+
+	clock_class = g_hash_table_lookup(ctx->clock_classes,
+		GUINT_TO_POINTER(qname));
+	bt_get(clock_class);
+
+end:
+	return clock_class;
+}
+
+/**
+ * Maps the integer field types found in a field type, which are
+ * mapped to a clock class, to the clock class with the same name in a
+ * visitor context (see ctx_get_clock_class_by_name()).
+ *
+ * @param ctx	Visitor context
+ * @param ft	Field type (may be NULL)
+ * @returns	0 on success, or a negative value on error
+ */
+static
+int ctx_map_clock_classes(struct ctx *ctx, struct bt_ctf_field_type *ft)
+{
+	int ret = 0;
+	int64_t i;
+	int64_t count;
+	struct bt_ctf_field_type *child_ft = NULL;
+	struct bt_ctf_clock_class *clock_class = NULL;
+	struct bt_ctf_clock_class *ctx_clock_class = NULL;
+
+	if (!ft) {
+		goto end;
+	}
+
+	switch (bt_ctf_field_type_get_type_id(ft)) {
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+		clock_class = bt_ctf_field_type_integer_get_mapped_clock_class(
+			ft);
+		if (!clock_class) {
+			break;
+		}
+
+		ctx_clock_class = ctx_get_clock_class_by_name(ctx,
+			bt_ctf_clock_class_get_name(clock_class));
+		if (!ctx_clock_class) {
+			BT_LOGE("cannot find clock class \"%s\"",
+				bt_ctf_clock_class_get_name(clock_class));
+			ret = -EINVAL;
+			goto end;
+		}
+
+		if (ctx_clock_class == clock_class) {
+			break;
+		}
+
+		ret = bt_ctf_field_type_integer_set_mapped_clock_class(ft,
+			ctx_clock_class);
+		if (ret) {
+			BT_LOGE("cannot map integer field type to clock class \"%s\"",
+				bt_ctf_clock_class_get_name(clock_class));
+			ret = -EINVAL;
+			goto end;
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+		child_ft = bt_ctf_field_type_enumeration_get_container_type(ft);
+		ret = ctx_map_clock_classes(ctx, child_ft);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+		count = bt_ctf_field_type_structure_get_field_count(ft);
+
+		for (i = 0; i < count; i++) {
+			BT_PUT(child_ft);
+			ret = bt_ctf_field_type_structure_get_field_by_index(ft,
+				NULL, &child_ft, i);
+			if (ret) {
+				ret = -EINVAL;
+				goto end;
+			}
+
+			ret = ctx_map_clock_classes(ctx, child_ft);
+			if (ret) {
+				goto end;
+			}
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_VARIANT:
+		count = bt_ctf_field_type_variant_get_field_count(ft);
+
+		for (i = 0; i < count; i++) {
+			BT_PUT(child_ft);
+			ret = bt_ctf_field_type_variant_get_field_by_index(ft,
+				NULL, &child_ft, i);
+			if (ret) {
+				ret = -EINVAL;
+				goto end;
+			}
+
+			ret = ctx_map_clock_classes(ctx, child_ft);
+			if (ret) {
+				goto end;
+			}
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+		child_ft = bt_ctf_field_type_array_get_element_type(ft);
+		ret = ctx_map_clock_classes(ctx, child_ft);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_SEQUENCE:
+		child_ft = bt_ctf_field_type_sequence_get_element_type(ft);
+		ret = ctx_map_clock_classes(ctx, child_ft);
+		break;
+	default:
+		break;
+	}
+
+end:
+	bt_put(child_ft);
+	bt_put(clock_class);
+	bt_put(ctx_clock_class);
+	return ret;
+}
+
 static
 int visit_type_specifier_list(struct ctx *ctx, struct ctf_node *ts_list,
 	struct bt_ctf_field_type **decl);
@@ -2510,8 +2702,8 @@ int visit_integer_decl(struct ctx *ctx,
 				continue;
 			}
 
-			mapped_clock = bt_ctf_trace_get_clock_class_by_name(
-				ctx->trace, clock_name);
+			mapped_clock = ctx_get_clock_class_by_name(ctx,
+				clock_name);
 			if (!mapped_clock) {
 				BT_LOGE("invalid \"map\" attribute in integer declaration: cannot find clock class \"%s\"",
 					clock_name);
@@ -3325,27 +3517,73 @@ error:
 	return NULL;
 }
 
+/*
+ * Returns the event classes of the visitor's context to add to the
+ * stream class having the ID `stream_id`, creating the array if
+ * needed.
+ */
 static
-int visit_event_decl(struct ctx *ctx, struct ctf_node *node)
+GPtrArray *ctx_get_pending_event_classes(struct ctx *ctx, int64_t stream_id)
+{
+	GPtrArray *event_classes = g_hash_table_lookup(ctx->event_classes,
+		(gpointer) stream_id);
+
+	if (event_classes) {
+		goto end;
+	}
+
+	event_classes = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) bt_put);
+	if (!event_classes) {
+		BT_LOGE_STR("Failed to allocate a GPtrArray.");
+		goto end;
+	}
+
+	g_hash_table_insert(ctx->event_classes, (gpointer) stream_id,
+		event_classes);
+
+end:
+	return event_classes;
+}
+
+/*
+ * Event class built from an event declaration, not added to its
+ * stream class yet.
+ */
+struct event_decl_job {
+	/* Event declaration node */
+	struct ctf_node *node;
+
+	/* Built event class (owned by this) */
+	struct bt_ctf_event_class *event_class;
+
+	/* Stream ID attribute, or -1 if not set */
+	int64_t stream_id;
+
+	/* Attributes found in the declaration */
+	int set;
+
+	/* Result of building the event class */
+	int ret;
+};
+
+/*
+ * Builds the event class of `job`'s event declaration: its attributes
+ * and field types. This only looks up the root declaration scope, the
+ * trace's byte order, and the clock classes of `ctx`, so that event
+ * classes may be built concurrently with private contexts (see
+ * worker_ctx_init()).
+ */
+static
+int build_event_decl(struct ctx *ctx, struct event_decl_job *job)
 {
 	int ret = 0;
-	int set = 0;
-	int64_t event_id;
 	struct ctf_node *iter;
-	int64_t stream_id = -1;
 	char *event_name = NULL;
-	struct bt_ctf_event_class *event_class = NULL;
-	struct bt_ctf_event_class *eevent_class;
-	struct bt_ctf_stream_class *stream_class = NULL;
-	struct bt_list_head *decl_list = &node->u.event.declaration_list;
+	struct bt_list_head *decl_list = &job->node->u.event.declaration_list;
 	bool pop_scope = false;
 
-	if (node->visited) {
-		goto end;
-	}
-
-	node->visited = TRUE;
-	event_name = get_event_decl_name(ctx, node);
+	event_name = get_event_decl_name(ctx, job->node);
 	if (!event_name) {
 		BT_LOGE(
 			"missing \"name\" attribute in event declaration");
@@ -3353,12 +3591,12 @@ int visit_event_decl(struct ctx *ctx, struct ctf_node *node)
 		goto error;
 	}
 
-	event_class = bt_ctf_event_class_create(event_name);
+	job->event_class = bt_ctf_event_class_create(event_name);
 
 	/*
 	 * Unset context and fields to override the default ones.
 	 */
-	ret = reset_event_decl_types(ctx, event_class);
+	ret = reset_event_decl_types(ctx, job->event_class);
 	if (ret) {
 		goto error;
 	}
@@ -3372,14 +3610,64 @@ int visit_event_decl(struct ctx *ctx, struct ctf_node *node)
 	pop_scope = true;
 
 	bt_list_for_each_entry(iter, decl_list, siblings) {
-		ret = visit_event_decl_entry(ctx, iter, event_class,
-			&stream_id, &set);
+		ret = visit_event_decl_entry(ctx, iter, job->event_class,
+			&job->stream_id, &job->set);
 		if (ret) {
 			goto error;
 		}
 	}
 
-	if (!_IS_SET(&set, _EVENT_STREAM_ID_SET)) {
+	goto end;
+
+error:
+	BT_PUT(job->event_class);
+
+end:
+	if (pop_scope) {
+		ctx_pop_scope(ctx);
+	}
+
+	g_free(event_name);
+	return ret;
+}
+
+/*
+ * Moves the event class built by build_event_decl() to the pending
+ * event classes of its stream class, inferring its stream ID and its
+ * ID if needed, and mapping its field types to the trace's clock
+ * classes. Event classes must be registered in declaration order.
+ */
+static
+int register_event_decl(struct ctx *ctx, struct event_decl_job *job)
+{
+	int ret = 0;
+	int64_t event_id;
+	int64_t stream_id = job->stream_id;
+	struct bt_ctf_event_class *eevent_class;
+	struct bt_ctf_stream_class *stream_class = NULL;
+	struct bt_ctf_field_type *ft = NULL;
+	GPtrArray *pending_event_classes;
+
+	assert(job->event_class);
+
+	/*
+	 * If built by a worker thread, the field types are mapped to its
+	 * private clock classes.
+	 */
+	ft = bt_ctf_event_class_get_context_type(job->event_class);
+	ret = ctx_map_clock_classes(ctx, ft);
+	if (ret) {
+		goto end;
+	}
+
+	BT_PUT(ft);
+	ft = bt_ctf_event_class_get_payload_type(job->event_class);
+	ret = ctx_map_clock_classes(ctx, ft);
+	if (ret) {
+		goto end;
+	}
+
+	if (!_IS_SET(&job->set, _EVENT_STREAM_ID_SET)) {
 		GList *keys = NULL;
 		struct bt_ctf_stream_class *new_stream_class;
 		size_t stream_class_count =
@@ -3396,14 +3684,14 @@ int visit_event_decl(struct ctx *ctx, struct ctf_node *node)
 			new_stream_class = create_reset_stream_class(ctx);
 			if (!new_stream_class) {
 				ret = -EINVAL;
-				goto error;
+				goto end;
 			}
 
 			ret = bt_ctf_stream_class_set_id(new_stream_class, 0);
 			if (ret) {
 				BT_LOGE("cannot set stream class's ID");
 				BT_PUT(new_stream_class);
-				goto error;
+				goto end;
 			}
 
 			stream_id = 0;
@@ -3434,7 +3722,7 @@ int visit_event_decl(struct ctx *ctx, struct ctf_node *node)
 		default:
 			BT_LOGE("missing \"stream_id\" attribute in event declaration");
 			ret = -EPERM;
-			goto error;
+			goto end;
 		}
 	}
 
@@ -3451,35 +3739,41 @@ int visit_event_decl(struct ctx *ctx, struct ctf_node *node)
 			BT_LOGE("cannot find stream class with ID %" PRId64,
 				stream_id);
 			ret = -EINVAL;
-			goto error;
+			goto end;
 		}
 	}
 
 	assert(stream_class);
 
-	if (!_IS_SET(&set, _EVENT_ID_SET)) {
+	pending_event_classes = ctx_get_pending_event_classes(ctx, stream_id);
+	if (!pending_event_classes) {
+		ret = -ENOMEM;
+		goto end;
+	}
+
+	if (!_IS_SET(&job->set, _EVENT_ID_SET)) {
 		/* Allow only one event without ID per stream */
 		if (bt_ctf_stream_class_get_event_class_count(stream_class) !=
-				0) {
+				0 || pending_event_classes->len != 0) {
 			BT_LOGE(
 				"missing \"id\" field in event declaration");
 			ret = -EPERM;
-			goto error;
+			goto end;
 		}
 
 		/* Automatic ID */
-		ret = bt_ctf_event_class_set_id(event_class, 0);
+		ret = bt_ctf_event_class_set_id(job->event_class, 0);
 		if (ret) {
 			BT_LOGE("cannot set event's ID");
-			goto error;
+			goto end;
 		}
 	}
 
-	event_id = bt_ctf_event_class_get_id(event_class);
+	event_id = bt_ctf_event_class_get_id(job->event_class);
 	if (event_id < 0) {
 		BT_LOGE("cannot get event's ID");
 		ret = -EINVAL;
-		goto error;
+		goto end;
 	}
 
 	eevent_class = bt_ctf_stream_class_get_event_class_by_id(stream_class,
@@ -3488,28 +3782,309 @@ int visit_event_decl(struct ctx *ctx, struct ctf_node *node)
 		BT_PUT(eevent_class);
 		BT_LOGE("duplicate event with ID %" PRId64 " in same stream", event_id);
 		ret = -EEXIST;
-		goto error;
+		goto end;
 	}
 
-	ret = bt_ctf_stream_class_add_event_class(stream_class, event_class);
-	BT_PUT(event_class);
+	/*
+	 * Move the reference to the visitor's context: the event
+	 * class is added to its stream class, with the other ones, at
+	 * the end of the visit.
+	 */
+	g_ptr_array_add(pending_event_classes, job->event_class);
+	job->event_class = NULL;
+
+end:
+	bt_put(ft);
+	bt_put(stream_class);
+	return ret;
+}
+
+static
+int visit_event_decl(struct ctx *ctx, struct ctf_node *node)
+{
+	int ret = 0;
+	struct event_decl_job job = {
+		.node = node,
+		.stream_id = -1,
+	};
+
+	if (node->visited) {
+		goto end;
+	}
+
+	node->visited = TRUE;
+	ret = build_event_decl(ctx, &job);
 	if (ret) {
-		BT_LOGE("cannot add event class to stream class");
-		goto error;
+		goto end;
 	}
 
-	goto end;
+	ret = register_event_decl(ctx, &job);
 
-error:
-	bt_put(event_class);
+end:
+	bt_put(job.event_class);
+	return ret;
+}
+
+/*
+ * Builds the event class of an event declaration job of
+ * bt_common_run_jobs() with the visitor context `thread_data`.
+ */
+static
+int build_event_decl_job(void *data, void *thread_data)
+{
+	struct event_decl_job *job = data;
+
+	job->ret = build_event_decl(thread_data, job);
+	return job->ret;
+}
+
+/*
+ * Creates the private visitor context `worker_ctx` of a worker thread
+ * from the visiting thread's visitor context `ctx`: its root
+ * declaration scope contains copies of the root declarations, and its
+ * integer field types are mapped to private clock classes named after
+ * the trace's ones, so that the worker thread never gets or puts a
+ * shared object. This must be called by the visiting thread.
+ */
+static
+int worker_ctx_init(struct ctx *worker_ctx, struct ctx *ctx)
+{
+	int ret = 0;
+	int64_t i;
+	int64_t count;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	assert(ctx->current_scope && !ctx->current_scope->parent_scope);
+	*worker_ctx = *ctx;
+	worker_ctx->current_scope = ctx_decl_scope_create(NULL);
+	worker_ctx->clock_classes = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, NULL, (GDestroyNotify) bt_put);
+	if (!worker_ctx->current_scope || !worker_ctx->clock_classes) {
+		ret = -ENOMEM;
+		goto end;
+	}
+
+	count = bt_ctf_trace_get_clock_class_count(ctx->trace);
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_clock_class *clock_class;
+		struct bt_ctf_clock_class *private_clock_class;
+
+		clock_class = bt_ctf_trace_get_clock_class_by_index(ctx->trace,
+			i);
+		assert(clock_class);
+		private_clock_class = bt_ctf_clock_class_create(
+			bt_ctf_clock_class_get_name(clock_class));
+		if (!private_clock_class) {
+			BT_LOGE("cannot create clock class \"%s\"",
+				bt_ctf_clock_class_get_name(clock_class));
+			bt_put(clock_class);
+			ret = -ENOMEM;
+			goto end;
+		}
+
+		g_hash_table_insert(worker_ctx->clock_classes,
+			GUINT_TO_POINTER(g_quark_from_string(
+				bt_ctf_clock_class_get_name(clock_class))),
+			private_clock_class);
+		bt_put(clock_class);
+	}
+
+	g_hash_table_iter_init(&iter, ctx->current_scope->decl_map);
+
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		struct bt_ctf_field_type *decl = bt_ctf_field_type_copy(value);
+
+		if (!decl) {
+			BT_LOGE("cannot copy root declaration");
+			ret = -ENOMEM;
+			goto end;
+		}
+
+		/* Move reference to the private root declaration scope */
+		g_hash_table_insert(worker_ctx->current_scope->decl_map, key,
+			decl);
+		ret = ctx_map_clock_classes(worker_ctx, decl);
+		if (ret) {
+			goto end;
+		}
+	}
 
 end:
-	if (pop_scope) {
-		ctx_pop_scope(ctx);
+	return ret;
+}
+
+/*
+ * Destroys the private visitor context `worker_ctx` of a worker
+ * thread. This must be called by the visiting thread, once the worker
+ * thread is joined.
+ */
+static
+void worker_ctx_fini(struct ctx *worker_ctx)
+{
+	ctx_decl_scope_destroy(worker_ctx->current_scope);
+
+	if (worker_ctx->clock_classes) {
+		g_hash_table_destroy(worker_ctx->clock_classes);
 	}
+}
 
-	g_free(event_name);
-	bt_put(stream_class);
+/*
+ * Returns the number of threads (including the visiting one) with
+ * which to build `job_count` event declarations.
+ */
+static
+size_t get_event_decl_thread_count(struct ctx *ctx, size_t job_count)
+{
+	size_t thread_count;
+
+	/* Object statistics are not updated atomically */
+	if (bt_object_stats_is_enabled()) {
+		thread_count = 1;
+		goto end;
+	}
+
+	if (ctx->thread_count == 0) {
+		thread_count = bt_common_get_job_thread_count(job_count,
+			EVENT_DECL_MIN_JOBS_PER_THREAD, EVENT_DECL_MAX_THREADS);
+		goto end;
+	}
+
+	/* Forced number of threads, instead of the number of online CPUs */
+	thread_count = job_count / EVENT_DECL_MIN_JOBS_PER_THREAD;
+
+	if (thread_count > ctx->thread_count) {
+		thread_count = ctx->thread_count;
+	}
+
+	if (thread_count > EVENT_DECL_MAX_THREADS) {
+		thread_count = EVENT_DECL_MAX_THREADS;
+	}
+
+	if (thread_count == 0) {
+		thread_count = 1;
+	}
+
+end:
+	return thread_count;
+}
+
+/*
+ * Visits the event declarations of `event_list`.
+ *
+ * The event classes are built concurrently when there are enough
+ * event declarations, and always added to their stream class in
+ * declaration order, so that the resulting trace and the reported
+ * errors are the same as with a serial visit.
+ */
+static
+int visit_event_decls(struct ctx *ctx, struct bt_list_head *event_list)
+{
+	int ret = 0;
+	size_t i;
+	size_t job_count = 0;
+	size_t thread_count;
+	size_t worker_ctx_count = 0;
+	struct ctf_node *iter;
+	struct event_decl_job *jobs = NULL;
+	struct ctx *worker_ctxs = NULL;
+	void **thread_data = NULL;
+
+	bt_list_for_each_entry(iter, event_list, siblings) {
+		if (!iter->visited) {
+			job_count++;
+		}
+	}
+
+	thread_count = get_event_decl_thread_count(ctx, job_count);
+	if (thread_count == 1) {
+		bt_list_for_each_entry(iter, event_list, siblings) {
+			ret = visit_event_decl(ctx, iter);
+			if (ret) {
+				BT_LOGE("error while visiting event declaration");
+				goto end;
+			}
+		}
+
+		goto end;
+	}
+
+	jobs = g_new0(struct event_decl_job, job_count);
+	worker_ctxs = g_new0(struct ctx, thread_count - 1);
+	thread_data = g_new0(void *, thread_count);
+	if (!jobs || !worker_ctxs || !thread_data) {
+		BT_LOGE_STR("Failed to allocate event declaration jobs.");
+		ret = -ENOMEM;
+		goto end;
+	}
+
+	/* The visiting thread also builds event declarations */
+	thread_data[0] = ctx;
+
+	for (i = 0; i < thread_count - 1; i++) {
+		ret = worker_ctx_init(&worker_ctxs[i], ctx);
+		worker_ctx_count++;
+		if (ret) {
+			BT_LOGE("cannot create worker thread's visitor context");
+			goto end;
+		}
+
+		thread_data[i + 1] = &worker_ctxs[i];
+	}
+
+	i = 0;
+
+	bt_list_for_each_entry(iter, event_list, siblings) {
+		if (iter->visited) {
+			continue;
+		}
+
+		iter->visited = TRUE;
+		jobs[i].node = iter;
+		jobs[i].stream_id = -1;
+		i++;
+	}
+
+	BT_LOGD("Building event classes concurrently: "
+		"event-decl-count=%zu, thread-count=%zu",
+		job_count, thread_count);
+	(void) bt_common_run_jobs(jobs, job_count, sizeof(*jobs),
+		build_event_decl_job, thread_data, thread_count);
+
+	/*
+	 * Every job preceding the first failed one is built, because
+	 * the jobs are claimed in order.
+	 */
+	for (i = 0; i < job_count; i++) {
+		struct event_decl_job *job = &jobs[i];
+
+		ret = job->ret;
+		if (!ret) {
+			ret = register_event_decl(ctx, job);
+		}
+
+		if (ret) {
+			BT_LOGE("error while visiting event declaration");
+			goto end;
+		}
+	}
+
+end:
+	if (jobs) {
+		for (i = 0; i < job_count; i++) {
+			bt_put(jobs[i].event_class);
+		}
+
+		g_free(jobs);
+	}
+
+	for (i = 0; i < worker_ctx_count; i++) {
+		worker_ctx_fini(&worker_ctxs[i]);
+	}
+
+	g_free(worker_ctxs);
+	g_free(thread_data);
 	return ret;
 }
 
@@ -4653,6 +5228,50 @@ end:
 	return ret;
 }
 
+/*
+ * Adds the pending event classes of the visitor's context to their
+ * stream class, one batch per stream class: this validates each
+ * event class once, whether or not its stream class is already part
+ * of the trace.
+ */
+static
+int add_ctx_event_classes_to_stream_classes(struct ctx *ctx)
+{
+	int ret = 0;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	g_hash_table_iter_init(&iter, ctx->event_classes);
+
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		int64_t stream_id = (int64_t) key;
+		GPtrArray *event_classes = value;
+		struct bt_ctf_stream_class *stream_class;
+
+		stream_class = g_hash_table_lookup(ctx->stream_classes, key);
+		bt_get(stream_class);
+		if (!stream_class) {
+			stream_class = bt_ctf_trace_get_stream_class_by_id(
+				ctx->trace, stream_id);
+		}
+
+		assert(stream_class);
+		ret = bt_ctf_stream_class_add_event_classes(stream_class,
+			(struct bt_ctf_event_class **) event_classes->pdata,
+			event_classes->len);
+		bt_put(stream_class);
+		if (ret) {
+			BT_LOGE("cannot add %u event classes to stream class %" PRId64,
+				event_classes->len, stream_id);
+			goto end;
+		}
+	}
+
+end:
+	g_hash_table_remove_all(ctx->event_classes);
+	return ret;
+}
+
 static
 int move_ctx_stream_classes_to_trace(struct ctx *ctx)
 {
@@ -4733,6 +5352,17 @@ end:
 	return (void *) ctx;
 }
 
+BT_HIDDEN
+void ctf_visitor_generate_ir_set_thread_count(
+		struct ctf_visitor_generate_ir *visitor,
+		unsigned int thread_count)
+{
+	struct ctx *ctx = (void *) visitor;
+
+	assert(ctx);
+	ctx->thread_count = thread_count;
+}
+
 BT_HIDDEN
 void ctf_visitor_generate_ir_destroy(struct ctf_visitor_generate_ir *visitor)
 {
@@ -4885,12 +5515,9 @@ int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 			ctx->current_scope->parent_scope == NULL);
 
 		/* Events */
-		bt_list_for_each_entry(iter, &node->u.root.event, siblings) {
-			ret = visit_event_decl(ctx, iter);
-			if (ret) {
-				BT_LOGE("error while visiting event declaration");
-				goto end;
-			}
+		ret = visit_event_decls(ctx, &node->u.root.event);
+		if (ret) {
+			goto end;
 		}
 
 		assert(ctx->current_scope &&
@@ -4903,6 +5530,13 @@ int ctf_visitor_generate_ir_visit_node(struct ctf_visitor_generate_ir *visitor,
 		goto end;
 	}
 
+	/* Add decoded event classes to their stream class, if any */
+	ret = add_ctx_event_classes_to_stream_classes(ctx);
+	if (ret) {
+		BT_LOGE("cannot add event classes to stream classes");
+		goto end;
+	}
+
 	/* Move decoded stream classes to trace, if any */
 	ret = move_ctx_stream_classes_to_trace(ctx);
 	if (ret) {
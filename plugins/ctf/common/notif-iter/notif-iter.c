@@ -102,6 +102,7 @@ enum state {
 	STATE_DSCOPE_EVENT_PAYLOAD_CONTINUE,
 	STATE_EMIT_NOTIF_EVENT,
 	STATE_EMIT_NOTIF_END_OF_PACKET,
+	STATE_SKIP_PACKET_CONTENT,
 	STATE_SKIP_PACKET_PADDING,
 };
 
@@ -208,6 +209,13 @@ struct bt_ctf_notif_iter {
 
 		/* Current position from addr (bits) */
 		size_t at;
+
+		/*
+		 * Position within the first byte of the next buffer
+		 * (bits), when the buffer was released in the middle of
+		 * a byte (see bt_ctf_notif_iter_release_buffer())
+		 */
+		size_t resume_at;
 	} buf;
 
 	/* Binary type reader */
@@ -287,6 +295,8 @@ const char *state_string(enum state state)
 		return "STATE_EMIT_NOTIF_EVENT";
 	case STATE_EMIT_NOTIF_END_OF_PACKET:
 		return "STATE_EMIT_NOTIF_END_OF_PACKET";
+	case STATE_SKIP_PACKET_CONTENT:
+		return "STATE_SKIP_PACKET_CONTENT";
 	case STATE_SKIP_PACKET_PADDING:
 		return "STATE_SKIP_PACKET_PADDING";
 	default:
@@ -439,7 +449,7 @@ size_t buf_available_bits(struct bt_ctf_notif_iter *notit)
 static inline
 size_t packet_at(struct bt_ctf_notif_iter *notit)
 {
-	return notit->buf.packet_offset + notit->buf.at;
+	return notit->buf.packet_offset + notit->buf.at + notit->buf.resume_at;
 }
 
 static inline
@@ -472,8 +482,13 @@ enum bt_ctf_notif_iter_status request_medium_bytes(
 		/* New packet offset is old one + old size (in bits) */
 		notit->buf.packet_offset += buf_size_bits(notit);
 
-		/* Restart at the beginning of the new medium buffer */
-		notit->buf.at = 0;
+		/*
+		 * Restart at the beginning of the new medium buffer, or
+		 * within its first byte if the previous one was released
+		 * in the middle of a byte.
+		 */
+		notit->buf.at = notit->buf.resume_at;
+		notit->buf.resume_at = 0;
 
 		/* New medium buffer size */
 		notit->buf.sz = buffer_sz;
@@ -1521,6 +1536,57 @@ enum bt_ctf_notif_iter_status read_event_payload_continue_state(
 	return read_dscope_continue_state(notit, STATE_EMIT_NOTIF_EVENT);
 }
 
+static
+enum bt_ctf_notif_iter_status seek_medium_past_buf(
+		struct bt_ctf_notif_iter *notit, size_t bits_to_skip)
+{
+	enum bt_ctf_notif_iter_medium_status m_status;
+	off_t offset;
+
+	assert(notit->medium.medops.seek);
+	assert(bits_to_skip > buf_available_bits(notit));
+
+	/*
+	 * Packet sizes and medium buffer sizes are multiples of 8, so
+	 * the bits to skip past the current buffer (or past the
+	 * medium's position, which is `resume_at` bits behind if the
+	 * buffer was released in the middle of a byte) are whole bytes.
+	 */
+	bits_to_skip += notit->buf.resume_at;
+	assert((bits_to_skip - buf_available_bits(notit)) % CHAR_BIT == 0);
+	offset = (off_t) ((bits_to_skip - buf_available_bits(notit)) /
+		CHAR_BIT);
+	BT_LOGV("Calling user function (seek): notit-addr=%p, "
+		"whence=CUR, offset=%jd", notit, (intmax_t) offset);
+	m_status = notit->medium.medops.seek(BT_CTF_NOTIF_ITER_SEEK_WHENCE_CUR,
+		offset, notit->medium.data);
+	BT_LOGV("User function returned: status=%s",
+		bt_ctf_notif_iter_medium_status_string(m_status));
+	if (m_status != BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK) {
+		if (m_status < 0) {
+			BT_LOGW("User function failed: status=%s",
+				bt_ctf_notif_iter_medium_status_string(m_status));
+		}
+
+		goto end;
+	}
+
+	/*
+	 * The current buffer is released: the next requested buffer
+	 * starts right after the skipped bits.
+	 */
+	notit->buf.packet_offset += buf_size_bits(notit) + offset * CHAR_BIT;
+	notit->buf.addr = NULL;
+	notit->buf.sz = 0;
+	notit->buf.at = 0;
+	notit->buf.resume_at = 0;
+	BT_LOGV("Medium skipped bytes: notit-addr=%p, packet-offset=%zu",
+		notit, notit->buf.packet_offset);
+
+end:
+	return notif_iter_status_from_m_status(m_status);
+}
+
 static
 enum bt_ctf_notif_iter_status skip_packet_padding_state(
 		struct bt_ctf_notif_iter *notit)
@@ -1528,6 +1594,20 @@ enum bt_ctf_notif_iter_status skip_packet_padding_state(
 	enum bt_ctf_notif_iter_status status = BT_CTF_NOTIF_ITER_STATUS_OK;
 	size_t bits_to_skip;
 
+	if (notit->cur_packet_size < 0) {
+		/*
+		 * Skipped packet of unknown size: it spans the rest of
+		 * the medium, so consume everything until the medium
+		 * reports the end of file.
+		 */
+		status = buf_ensure_available_bits(notit);
+		if (status == BT_CTF_NOTIF_ITER_STATUS_OK) {
+			buf_consume_bits(notit, buf_available_bits(notit));
+		}
+
+		goto end;
+	}
+
 	assert(notit->cur_packet_size > 0);
 	bits_to_skip = notit->cur_packet_size - packet_at(notit);
 	if (bits_to_skip == 0) {
@@ -1536,6 +1616,25 @@ enum bt_ctf_notif_iter_status skip_packet_padding_state(
 	} else {
 		size_t bits_to_consume;
 
+		if (notit->medium.medops.seek &&
+				bits_to_skip > buf_available_bits(notit)) {
+			status = seek_medium_past_buf(notit, bits_to_skip);
+			if (status == BT_CTF_NOTIF_ITER_STATUS_OK) {
+				assert(packet_at(notit) ==
+					notit->cur_packet_size);
+				notit->state =
+					STATE_DSCOPE_TRACE_PACKET_HEADER_BEGIN;
+				goto end;
+			} else if (status != BT_CTF_NOTIF_ITER_STATUS_INVAL &&
+					status !=
+					BT_CTF_NOTIF_ITER_STATUS_UNSUPPORTED) {
+				goto end;
+			}
+
+			/* Medium cannot seek there: consume the bits. */
+			status = BT_CTF_NOTIF_ITER_STATUS_OK;
+		}
+
 		BT_LOGV("Trying to skip %zu bits of padding: notit-addr=%p, size=%zu",
 			bits_to_skip, notit, bits_to_skip);
 		status = buf_ensure_available_bits(notit);
@@ -1629,6 +1728,17 @@ enum bt_ctf_notif_iter_status handle_state(struct bt_ctf_notif_iter *notit)
 	case STATE_EMIT_NOTIF_END_OF_PACKET:
 		notit->state = STATE_SKIP_PACKET_PADDING;
 		break;
+	case STATE_SKIP_PACKET_CONTENT:
+		/*
+		 * Notify the end of the skipped packet only if its
+		 * beginning was notified.
+		 */
+		if (notit->packet) {
+			notit->state = STATE_EMIT_NOTIF_END_OF_PACKET;
+		} else {
+			notit->state = STATE_SKIP_PACKET_PADDING;
+		}
+		break;
 	default:
 		BT_LOGD("Unknown CTF plugin notification iterator state: "
 			"notit-addr=%p, state=%d", notit, notit->state);
@@ -1654,14 +1764,32 @@ void bt_ctf_notif_iter_reset(struct bt_ctf_notif_iter *notit)
 	BT_PUT(notit->meta.stream_class);
 	BT_PUT(notit->meta.event_class);
 	BT_PUT(notit->packet);
+	BT_PUT(notit->cur_timestamp_end);
 	put_all_dscopes(notit);
 	notit->buf.addr = NULL;
 	notit->buf.sz = 0;
 	notit->buf.at = 0;
+	notit->buf.resume_at = 0;
 	notit->buf.packet_offset = 0;
 	notit->state = STATE_INIT;
 	notit->cur_content_size = -1;
 	notit->cur_packet_size = -1;
+	notit->cur_sc_field_path_cache = NULL;
+}
+
+static
+void reset_clock_states(GHashTable *clock_states)
+{
+	GHashTableIter iter;
+	uint64_t *clock_state;
+
+	g_hash_table_iter_init(&iter, clock_states);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer) &clock_state)) {
+		if (clock_state) {
+			*clock_state = 0;
+		}
+	}
 }
 
 static
@@ -1696,12 +1824,18 @@ int bt_ctf_notif_iter_switch_packet(struct bt_ctf_notif_iter *notit)
 
 		notit->buf.addr += consumed_bytes;
 		notit->buf.sz -= consumed_bytes;
-		notit->buf.at = 0;
-		notit->buf.packet_offset = 0;
 		BT_LOGV("Adjusted buffer: addr=%p, size=%zu",
 			notit->buf.addr, notit->buf.sz);
 	}
 
+	/*
+	 * Also reset when there's no current buffer, which is the case
+	 * after the medium skipped the previous packet's last bytes.
+	 */
+	notit->buf.at = 0;
+	notit->buf.resume_at = 0;
+	notit->buf.packet_offset = 0;
+
 	notit->cur_content_size = -1;
 	notit->cur_packet_size = -1;
 	notit->cur_sc_field_path_cache = NULL;
@@ -3105,6 +3239,17 @@ enum bt_ctf_notif_iter_status bt_ctf_notif_iter_get_packet_header_context_fields
 		goto set_fields;
 	}
 
+	if (notit->packet && (notit->state == STATE_SKIP_PACKET_CONTENT ||
+			notit->state == STATE_EMIT_NOTIF_END_OF_PACKET)) {
+		/*
+		 * Skipped packet of which the end notification is
+		 * pending: keep it for the next call to
+		 * bt_ctf_notif_iter_get_next_notification(). This
+		 * packet's header and context fields are still decoded.
+		 */
+		goto set_fields;
+	}
+
 	while (true) {
 		status = handle_state(notit);
 		if (status == BT_CTF_NOTIF_ITER_STATUS_AGAIN) {
@@ -3136,8 +3281,17 @@ enum bt_ctf_notif_iter_status bt_ctf_notif_iter_get_packet_header_context_fields
 		case STATE_DSCOPE_STREAM_PACKET_CONTEXT_BEGIN:
 		case STATE_DSCOPE_STREAM_PACKET_CONTEXT_CONTINUE:
 		case STATE_AFTER_STREAM_PACKET_CONTEXT:
-			/* Non-emitting state: continue */
+		case STATE_SKIP_PACKET_CONTENT:
+		case STATE_SKIP_PACKET_PADDING:
+			/*
+			 * Non-emitting state, or skipped packet of
+			 * which the beginning was not notified (see
+			 * bt_ctf_notif_iter_skip_packet()): continue
+			 */
 			break;
+		case STATE_EMIT_NOTIF_END_OF_PACKET:
+			/* Pending packet end notification: keep it. */
+			goto set_fields;
 		default:
 			/*
 			 * We should never get past the
@@ -3161,3 +3315,163 @@ set_fields:
 end:
 	return status;
 }
+
+BT_HIDDEN
+enum bt_ctf_notif_iter_status bt_ctf_notif_iter_skip_packet(
+		struct bt_ctf_notif_iter *notit)
+{
+	enum bt_ctf_notif_iter_status status = BT_CTF_NOTIF_ITER_STATUS_OK;
+
+	assert(notit);
+	BT_LOGV("Skipping current packet: notit-addr=%p, state=%s",
+		notit, state_string(notit->state));
+
+	switch (notit->state) {
+	case STATE_INIT:
+	case STATE_DSCOPE_TRACE_PACKET_HEADER_BEGIN:
+	case STATE_DSCOPE_TRACE_PACKET_HEADER_CONTINUE:
+	case STATE_AFTER_TRACE_PACKET_HEADER:
+	case STATE_DSCOPE_STREAM_PACKET_CONTEXT_BEGIN:
+	case STATE_DSCOPE_STREAM_PACKET_CONTEXT_CONTINUE:
+	case STATE_AFTER_STREAM_PACKET_CONTEXT:
+		/* We need the packet's size: decode its header and context. */
+		status = bt_ctf_notif_iter_get_packet_header_context_fields(
+			notit, NULL, NULL);
+		if (status != BT_CTF_NOTIF_ITER_STATUS_OK) {
+			goto end;
+		}
+
+		break;
+	case STATE_EMIT_NOTIF_END_OF_PACKET:
+	case STATE_SKIP_PACKET_CONTENT:
+	case STATE_SKIP_PACKET_PADDING:
+		/* Already done with this packet's content. */
+		goto end;
+	default:
+		break;
+	}
+
+	/* Discard the partially decoded event, if any. */
+	stack_clear(notit->stack);
+	put_event_dscopes(notit);
+	BT_PUT(notit->meta.event_class);
+	notit->state = STATE_SKIP_PACKET_CONTENT;
+	BT_LOGV("Packet content will be skipped: notit-addr=%p, "
+		"packet-size=%" PRId64 ", content-size=%" PRId64 ", cur=%zu",
+		notit, notit->cur_packet_size, notit->cur_content_size,
+		packet_at(notit));
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+enum bt_ctf_notif_iter_status bt_ctf_notif_iter_seek(
+		struct bt_ctf_notif_iter *notit, off_t offset)
+{
+	enum bt_ctf_notif_iter_status status = BT_CTF_NOTIF_ITER_STATUS_OK;
+	enum bt_ctf_notif_iter_medium_status m_status;
+
+	assert(notit);
+
+	if (offset < 0) {
+		BT_LOGW("Cannot seek to negative offset: notit-addr=%p, "
+			"offset=%jd", notit, (intmax_t) offset);
+		status = BT_CTF_NOTIF_ITER_STATUS_INVAL;
+		goto end;
+	}
+
+	if (!notit->medium.medops.seek) {
+		BT_LOGW("Cannot seek: medium does not support seeking: "
+			"notit-addr=%p", notit);
+		status = BT_CTF_NOTIF_ITER_STATUS_INVAL;
+		goto end;
+	}
+
+	BT_LOGV("Calling user function (seek): notit-addr=%p, "
+		"whence=SET, offset=%jd", notit, (intmax_t) offset);
+	m_status = notit->medium.medops.seek(BT_CTF_NOTIF_ITER_SEEK_WHENCE_SET,
+		offset, notit->medium.data);
+	BT_LOGV("User function returned: status=%s",
+		bt_ctf_notif_iter_medium_status_string(m_status));
+	if (m_status != BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK) {
+		if (m_status < 0) {
+			BT_LOGW("User function failed: status=%s",
+				bt_ctf_notif_iter_medium_status_string(m_status));
+		}
+
+		status = notif_iter_status_from_m_status(m_status);
+		goto end;
+	}
+
+	bt_ctf_notif_iter_reset(notit);
+	reset_clock_states(notit->clock_states);
+	BT_LOGD("Seeked notification iterator to packet: notit-addr=%p, "
+		"offset=%jd", notit, (intmax_t) offset);
+
+end:
+	return status;
+}
+
+BT_HIDDEN
+enum bt_ctf_notif_iter_status bt_ctf_notif_iter_release_buffer(
+		struct bt_ctf_notif_iter *notit)
+{
+	enum bt_ctf_notif_iter_status status = BT_CTF_NOTIF_ITER_STATUS_OK;
+	enum bt_ctf_notif_iter_medium_status m_status;
+	size_t resume_at;
+	off_t offset;
+
+	assert(notit);
+
+	if (!notit->buf.addr) {
+		goto end;
+	}
+
+	if (!notit->medium.medops.seek) {
+		BT_LOGW("Cannot release buffer: medium does not support seeking: "
+			"notit-addr=%p", notit);
+		status = BT_CTF_NOTIF_ITER_STATUS_INVAL;
+		goto end;
+	}
+
+	/*
+	 * Go back to the first byte which is not completely consumed
+	 * yet: with a bit-packed trace, the current position can be in
+	 * the middle of this byte.
+	 */
+	resume_at = notit->buf.at % CHAR_BIT;
+	offset = -(off_t) ((buf_available_bits(notit) + resume_at) /
+		CHAR_BIT);
+	BT_LOGV("Calling user function (seek): notit-addr=%p, "
+		"whence=CUR, offset=%jd", notit, (intmax_t) offset);
+	m_status = notit->medium.medops.seek(BT_CTF_NOTIF_ITER_SEEK_WHENCE_CUR,
+		offset, notit->medium.data);
+	BT_LOGV("User function returned: status=%s",
+		bt_ctf_notif_iter_medium_status_string(m_status));
+	if (m_status != BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK) {
+		if (m_status < 0) {
+			BT_LOGW("User function failed: status=%s",
+				bt_ctf_notif_iter_medium_status_string(m_status));
+		}
+
+		status = notif_iter_status_from_m_status(m_status);
+		goto end;
+	}
+
+	/*
+	 * The position within the packet is unchanged: the next
+	 * requested buffer starts with the current byte, and decoding
+	 * resumes at the current bit within this byte.
+	 */
+	notit->buf.packet_offset += notit->buf.at - resume_at;
+	notit->buf.addr = NULL;
+	notit->buf.sz = 0;
+	notit->buf.at = 0;
+	notit->buf.resume_at = resume_at;
+	BT_LOGV("Released medium buffer: notit-addr=%p, packet-offset=%zu, "
+		"resume-at=%zu", notit, notit->buf.packet_offset, resume_at);
+
+end:
+	return status;
+}
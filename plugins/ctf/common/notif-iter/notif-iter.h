@@ -29,6 +29,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stddef.h>
+#include <sys/types.h>
 #include <babeltrace/ctf-ir/trace.h>
 #include <babeltrace/ctf-ir/fields.h>
 #include <babeltrace/ctf-ir/event.h>
@@ -61,6 +62,9 @@ enum bt_ctf_notif_iter_medium_status {
 	 */
 	BT_CTF_NOTIF_ITER_MEDIUM_STATUS_AGAIN =	11,
 
+	/** Operation not supported by the medium. */
+	BT_CTF_NOTIF_ITER_MEDIUM_STATUS_UNSUPPORTED =	-3,
+
 	/** Invalid argument. */
 	BT_CTF_NOTIF_ITER_MEDIUM_STATUS_INVAL =	-2,
 
@@ -71,6 +75,25 @@ enum bt_ctf_notif_iter_medium_status {
 	BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK = 	0,
 };
 
+/**
+ * Medium seek reference positions.
+ */
+enum bt_ctf_notif_iter_seek_whence {
+	/**
+	 * The offset is an absolute position within the medium, as
+	 * defined by the medium (for example, the offset from the
+	 * beginning of a data stream file).
+	 */
+	BT_CTF_NOTIF_ITER_SEEK_WHENCE_SET,
+
+	/**
+	 * The offset is relative to the end of the last buffer
+	 * returned by bt_ctf_notif_iter_medium_ops::request_bytes(),
+	 * that is, to the byte which would be returned next.
+	 */
+	BT_CTF_NOTIF_ITER_SEEK_WHENCE_CUR,
+};
+
 /**
  * CTF notification iterator API status code.
  */
@@ -94,6 +117,10 @@ enum bt_ctf_notif_iter_status {
 	 */
 	BT_CTF_NOTIF_ITER_STATUS_AGAIN = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_AGAIN,
 
+	/** Operation not supported by the medium. */
+	BT_CTF_NOTIF_ITER_STATUS_UNSUPPORTED =
+		BT_CTF_NOTIF_ITER_MEDIUM_STATUS_UNSUPPORTED,
+
 	/** Invalid argument. */
 	BT_CTF_NOTIF_ITER_STATUS_INVAL = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_INVAL,
 
@@ -181,6 +208,44 @@ struct bt_ctf_notif_iter_medium_ops {
 			size_t request_sz, uint8_t **buffer_addr,
 			size_t *buffer_sz, void *data);
 
+	/**
+	 * Repositions the medium so that the next call to
+	 * bt_ctf_notif_iter_medium_ops::request_bytes() returns a
+	 * buffer starting at the requested byte offset.
+	 *
+	 * This function is optional (it can be \c NULL). When it is
+	 * available, the notification iterator uses it to jump over
+	 * the bytes it does not need to decode (skipped packet content
+	 * and packet padding) instead of requesting them. Any buffer
+	 * previously returned by
+	 * bt_ctf_notif_iter_medium_ops::request_bytes() is considered
+	 * released after a successful call.
+	 *
+	 * This function must return one of the following statuses:
+	 *
+	 *   - <b>#BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK</b>: The medium
+	 *     is repositioned.
+	 *   - <b>#BT_CTF_NOTIF_ITER_MEDIUM_STATUS_INVAL</b>: The
+	 *     requested position is outside the medium, or \p whence
+	 *     is not supported by this medium. The medium's position
+	 *     is unchanged.
+	 *   - <b>#BT_CTF_NOTIF_ITER_MEDIUM_STATUS_UNSUPPORTED</b>:
+	 *     The medium cannot reposition itself there, although the
+	 *     position exists (for example, a medium which only has
+	 *     access to the current packet). The medium's position is
+	 *     unchanged.
+	 *   - <b>#BT_CTF_NOTIF_ITER_MEDIUM_STATUS_ERROR</b>: A fatal
+	 *     error occured during this operation.
+	 *
+	 * @param whence	Reference position of \p offset
+	 * @param offset	Offset (bytes) from \p whence
+	 * @param data		User data
+	 * @returns		Status code (see description above)
+	 */
+	enum bt_ctf_notif_iter_medium_status (* seek)(
+			enum bt_ctf_notif_iter_seek_whence whence,
+			off_t offset, void *data);
+
 	/**
 	 * Returns a stream instance (weak reference) for the given
 	 * stream class.
@@ -289,6 +354,12 @@ enum bt_ctf_notif_iter_status bt_ctf_notif_iter_get_next_notification(
  * never needs to call the `get_stream()` medium operation because
  * it does not create packet or event objects.
  *
+ * If the end notification of a skipped packet is pending (see
+ * bt_ctf_notif_iter_skip_packet()), this function returns the skipped
+ * packet's fields and does not consume this notification: the next
+ * packet's fields are available once
+ * bt_ctf_notif_iter_get_next_notification() returned it.
+ *
  * @param notif_iter		CTF notification iterator
  * @param packet_header_field	Packet header field (\c NULL if there's
  *				no packet header field)
@@ -302,6 +373,84 @@ enum bt_ctf_notif_iter_status bt_ctf_notif_iter_get_packet_header_context_fields
 		struct bt_ctf_field **packet_header_field,
 		struct bt_ctf_field **packet_context_field);
 
+/**
+ * Skips the rest of the current packet.
+ *
+ * If the current packet's header and context fields are not decoded
+ * yet, this function decodes them first, so that the packet's size is
+ * known. The remaining packet content (events) is not decoded: if the
+ * medium implements bt_ctf_notif_iter_medium_ops::seek(), the skipped
+ * bytes are not even requested.
+ *
+ * If a packet beginning notification was already returned for the
+ * current packet, the next call to
+ * bt_ctf_notif_iter_get_next_notification() returns the matching packet
+ * end notification. Otherwise, no notification is created for the
+ * skipped packet. In both cases, the following notifications (and, once
+ * the pending packet end notification is returned, if any, the packet
+ * fields) are the next packet's.
+ *
+ * This is typically used after
+ * bt_ctf_notif_iter_get_packet_header_context_fields() by users which
+ * only need packet-level information.
+ *
+ * If this function returns #BT_CTF_NOTIF_ITER_STATUS_AGAIN, the caller
+ * should make sure that data becomes available to its medium, and
+ * call this function again, until another status is returned.
+ *
+ * @param notif_iter		CTF notification iterator
+ * @returns			One of #bt_ctf_notif_iter_status values
+ */
+BT_HIDDEN
+enum bt_ctf_notif_iter_status bt_ctf_notif_iter_skip_packet(
+		struct bt_ctf_notif_iter *notit);
+
+/**
+ * Repositions a CTF notification iterator at the beginning of the
+ * packet located at \p offset within its medium.
+ *
+ * The medium must implement bt_ctf_notif_iter_medium_ops::seek() and
+ * support #BT_CTF_NOTIF_ITER_SEEK_WHENCE_SET. \p offset must be a
+ * packet boundary, typically taken from a packet index: the
+ * notification iterator cannot validate it.
+ *
+ * On success, the decoding state is reset as if the notification
+ * iterator was just created, except that reading starts at
+ * \p offset. No packet end notification is emitted for the packet
+ * which was being decoded, if any, and the clock values are
+ * reinitialized from the next decoded packet.
+ *
+ * @param notif_iter		CTF notification iterator
+ * @param offset		Packet offset (bytes) within the medium
+ * @returns			One of #bt_ctf_notif_iter_status values
+ */
+BT_HIDDEN
+enum bt_ctf_notif_iter_status bt_ctf_notif_iter_seek(
+		struct bt_ctf_notif_iter *notit, off_t offset);
+
+/**
+ * Releases the medium buffer which a CTF notification iterator is
+ * currently reading, if any, so that the medium can free or unmap it.
+ *
+ * The medium must implement bt_ctf_notif_iter_medium_ops::seek() and
+ * support #BT_CTF_NOTIF_ITER_SEEK_WHENCE_CUR: it is repositioned,
+ * backwards, to the first byte which the notification iterator did not
+ * consume yet, so that decoding continues from there with the next
+ * requested buffer.
+ *
+ * This function must be called between two calls to
+ * bt_ctf_notif_iter_get_next_notification(). If the current position
+ * is not on a byte boundary, the medium seeks back to the byte which
+ * contains it, and decoding resumes at the same bit within the first
+ * byte of the next buffer.
+ *
+ * @param notif_iter		CTF notification iterator
+ * @returns			One of #bt_ctf_notif_iter_status values
+ */
+BT_HIDDEN
+enum bt_ctf_notif_iter_status bt_ctf_notif_iter_release_buffer(
+		struct bt_ctf_notif_iter *notit);
+
 static inline
 const char *bt_ctf_notif_iter_medium_status_string(
 		enum bt_ctf_notif_iter_medium_status status)
@@ -331,6 +480,8 @@ const char *bt_ctf_notif_iter_status_string(
 		return "BT_CTF_NOTIF_ITER_STATUS_EOF";
 	case BT_CTF_NOTIF_ITER_STATUS_AGAIN:
 		return "BT_CTF_NOTIF_ITER_STATUS_AGAIN";
+	case BT_CTF_NOTIF_ITER_STATUS_UNSUPPORTED:
+		return "BT_CTF_NOTIF_ITER_STATUS_UNSUPPORTED";
 	case BT_CTF_NOTIF_ITER_STATUS_INVAL:
 		return "BT_CTF_NOTIF_ITER_STATUS_INVAL";
 	case BT_CTF_NOTIF_ITER_STATUS_ERROR:
@@ -35,6 +35,14 @@
 #include <babeltrace/ctf-ir/fields.h>
 #include <babeltrace/ctf-writer/stream-class.h>
 #include <babeltrace/ctf-writer/stream.h>
+#include <babeltrace/ctf-writer/writer.h>
+#include <babeltrace/ctf-ir/trace.h>
+#include <babeltrace/common-internal.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <errno.h>
 #include <assert.h>
 
 #include <ctfcopytrace.h>
@@ -236,6 +244,88 @@ end:
 	return ret;
 }
 
+static
+const char *get_trace_name(struct writer_component *writer_component,
+		struct bt_ctf_trace *trace)
+{
+	const char *trace_name = bt_ctf_trace_get_name(trace);
+
+	if (!trace_name) {
+		trace_name = writer_component->trace_name_base->str;
+	}
+
+	return trace_name;
+}
+
+BT_HIDDEN
+void checkpoint_trace_destroy(struct checkpoint_trace *checkpoint_trace)
+{
+	if (checkpoint_trace->name) {
+		g_string_free(checkpoint_trace->name, true);
+	}
+
+	if (checkpoint_trace->path) {
+		g_string_free(checkpoint_trace->path, true);
+	}
+
+	g_free(checkpoint_trace);
+}
+
+static
+struct checkpoint_trace *create_checkpoint_trace(
+		struct writer_component *writer_component,
+		struct bt_ctf_trace *trace, const char *trace_path,
+		struct bt_ctf_trace *writer_trace)
+{
+	struct checkpoint_trace *checkpoint_trace;
+	const unsigned char *uuid = bt_ctf_trace_get_uuid(writer_trace);
+
+	assert(uuid);
+	checkpoint_trace = g_new0(struct checkpoint_trace, 1);
+	checkpoint_trace->name = g_string_new(get_trace_name(
+		writer_component, trace));
+	checkpoint_trace->path = g_string_new(trace_path);
+	memcpy(checkpoint_trace->uuid, uuid, sizeof(checkpoint_trace->uuid));
+	return checkpoint_trace;
+}
+
+/*
+ * Removes and returns the first output trace of the resumed checkpoint
+ * which was written from an input trace named like `trace`, or NULL
+ * if there is none.
+ */
+static
+struct checkpoint_trace *take_resume_trace(
+		struct writer_component *writer_component,
+		struct bt_ctf_trace *trace)
+{
+	const char *trace_name = get_trace_name(writer_component, trace);
+	struct checkpoint_trace *resume_trace = NULL;
+	guint i;
+
+	for (i = 0; i < writer_component->resume_traces->len; i++) {
+		resume_trace = g_ptr_array_index(
+			writer_component->resume_traces, i);
+		if (!strcmp(resume_trace->name->str, trace_name)) {
+			break;
+		}
+	}
+
+	if (i == writer_component->resume_traces->len) {
+		resume_trace = NULL;
+		goto end;
+	}
+
+	/* The caller owns the removed entry. */
+	g_ptr_array_set_free_func(writer_component->resume_traces, NULL);
+	g_ptr_array_remove_index(writer_component->resume_traces, i);
+	g_ptr_array_set_free_func(writer_component->resume_traces,
+		(GDestroyNotify) checkpoint_trace_destroy);
+
+end:
+	return resume_trace;
+}
+
 static
 struct fs_writer *insert_new_writer(
 		struct writer_component *writer_component,
@@ -247,16 +337,26 @@ struct fs_writer *insert_new_writer(
 	enum bt_component_status ret;
 	struct bt_ctf_stream *stream = NULL;
 	struct fs_writer *fs_writer = NULL;
+	struct checkpoint_trace *resume_trace = NULL;
 	int nr_stream, i;
 
-	ret = make_trace_path(writer_component, trace, trace_path);
-	if (ret) {
-		fprintf(writer_component->err, "[error] %s in %s:%d\n",
-				__func__, __FILE__, __LINE__);
-		goto error;
+	if (writer_component->resume_traces) {
+		resume_trace = take_resume_trace(writer_component, trace);
 	}
 
-	printf("ctf.fs sink creating trace in %s\n", trace_path);
+	if (resume_trace) {
+		snprintf(trace_path, PATH_MAX, "%s", resume_trace->path->str);
+		printf("ctf.fs sink continuing trace in %s\n", trace_path);
+	} else {
+		ret = make_trace_path(writer_component, trace, trace_path);
+		if (ret) {
+			fprintf(writer_component->err, "[error] %s in %s:%d\n",
+					__func__, __FILE__, __LINE__);
+			goto error;
+		}
+
+		printf("ctf.fs sink creating trace in %s\n", trace_path);
+	}
 
 	ctf_writer = bt_ctf_writer_create(trace_path);
 	if (!ctf_writer) {
@@ -273,6 +373,36 @@ struct fs_writer *insert_new_writer(
 		goto error;
 	}
 
+	if (resume_trace) {
+		/*
+		 * The existing packets of the stream files are kept:
+		 * the new ones follow them and carry the same UUID.
+		 */
+		if (bt_ctf_writer_set_append_stream_files(ctf_writer,
+					BT_TRUE) ||
+				bt_ctf_trace_set_uuid(writer_trace,
+					resume_trace->uuid)) {
+			fprintf(writer_component->err,
+					"[error] Cannot continue trace in %s\n",
+					trace_path);
+			goto error;
+		}
+	}
+
+	if (writer_component->trace_paths) {
+		if (!resume_trace) {
+			resume_trace = create_checkpoint_trace(
+				writer_component, trace, trace_path,
+				writer_trace);
+			if (!resume_trace) {
+				goto error;
+			}
+		}
+
+		g_ptr_array_add(writer_component->trace_paths, resume_trace);
+		resume_trace = NULL;
+	}
+
 	ret = ctf_copy_trace(writer_component->err, trace, writer_trace);
 	if (ret != BT_COMPONENT_STATUS_OK) {
 		fprintf(writer_component->err, "[error] Failed to copy trace\n");
@@ -334,6 +464,14 @@ struct fs_writer *insert_new_writer(
 	g_hash_table_insert(writer_component->trace_map, (gpointer) trace,
 			fs_writer);
 
+	if (writer_component->checkpoint_path) {
+		/*
+		 * Record the new trace directory immediately so that
+		 * resuming cleans it even without a later checkpoint.
+		 */
+		(void) writer_checkpoint(writer_component);
+	}
+
 	goto end;
 
 error:
@@ -342,6 +480,9 @@ error:
 	bt_put(writer_trace);
 	bt_put(stream);
 	BT_PUT(ctf_writer);
+	if (resume_trace) {
+		checkpoint_trace_destroy(resume_trace);
+	}
 end:
 	return fs_writer;
 }
@@ -423,6 +564,69 @@ struct bt_ctf_stream *lookup_stream(struct writer_component *writer_component,
 			fs_writer->stream_map, (gpointer) stream);
 }
 
+static
+gchar *get_stream_checkpoint_key(struct bt_ctf_stream *stream)
+{
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_trace *trace;
+	gchar *key;
+
+	stream_class = bt_ctf_stream_get_class(stream);
+	assert(stream_class);
+	trace = bt_ctf_stream_class_get_trace(stream_class);
+	assert(trace);
+	key = bt_common_checkpoint_stream_key(bt_ctf_trace_get_name(trace),
+		bt_ctf_stream_class_get_id(stream_class),
+		bt_ctf_stream_get_id(stream),
+		bt_ctf_stream_get_name(stream));
+	bt_put(trace);
+	bt_put(stream_class);
+	return key;
+}
+
+/*
+ * Creates the output stream of the input stream `stream`. With
+ * checkpoints, the output stream keeps the ID, and thus the stream
+ * file, recorded for the input stream when resuming.
+ */
+static
+struct bt_ctf_stream *create_writer_stream(
+		struct writer_component *writer_component,
+		struct bt_ctf_writer *ctf_writer,
+		struct bt_ctf_stream_class *writer_stream_class,
+		struct bt_ctf_stream *stream)
+{
+	struct bt_ctf_stream *writer_stream = NULL;
+	gchar *key = NULL;
+	uint64_t *id;
+
+	if (!writer_component->checkpoint_path) {
+		writer_stream = bt_ctf_writer_create_stream(ctf_writer,
+			writer_stream_class);
+		goto end;
+	}
+
+	key = get_stream_checkpoint_key(stream);
+	if (!key) {
+		goto end;
+	}
+
+	id = g_hash_table_lookup(writer_component->stream_ids, key);
+	if (!id) {
+		id = g_new0(uint64_t, 1);
+		*id = writer_component->next_stream_id++;
+		g_hash_table_insert(writer_component->stream_ids, key, id);
+		key = NULL;
+	}
+
+	writer_stream = bt_ctf_writer_create_stream_with_id(ctf_writer,
+		writer_stream_class, *id);
+
+end:
+	g_free(key);
+	return writer_stream;
+}
+
 static
 struct bt_ctf_stream *insert_new_stream(
 		struct writer_component *writer_component,
@@ -447,8 +651,8 @@ struct bt_ctf_stream *insert_new_stream(
 	}
 	bt_get(writer_stream_class);
 
-	writer_stream = bt_ctf_writer_create_stream(ctf_writer,
-			writer_stream_class);
+	writer_stream = create_writer_stream(writer_component, ctf_writer,
+			writer_stream_class, stream);
 	if (!writer_stream) {
 		fprintf(writer_component->err, "[error] %s in %s:%d\n",
 				__func__, __FILE__, __LINE__);
@@ -696,6 +900,459 @@ end:
 	return ret;
 }
 
+static
+int count_flushed_packet(struct writer_component *writer_component,
+		struct bt_ctf_stream *stream)
+{
+	int ret = 0;
+	gchar *key;
+	uint64_t *count;
+
+	key = get_stream_checkpoint_key(stream);
+	if (!key) {
+		ret = -1;
+		goto end;
+	}
+
+	count = g_hash_table_lookup(writer_component->stream_packet_counts,
+		key);
+	if (count) {
+		g_free(key);
+	} else {
+		count = g_new0(uint64_t, 1);
+		g_hash_table_insert(writer_component->stream_packet_counts,
+			key, count);
+	}
+
+	(*count)++;
+
+end:
+	return ret;
+}
+
+static
+void set_checkpoint_uint64(GKeyFile *key_file, const char *group,
+		const char *key, uint64_t value)
+{
+	gchar *str_value = g_strdup_printf("%" PRIu64, value);
+
+	g_key_file_set_value(key_file, group, key, str_value);
+	g_free(str_value);
+}
+
+static
+int get_checkpoint_uint64(GKeyFile *key_file, const char *group,
+		const char *key, uint64_t *value)
+{
+	int ret = 0;
+	gchar *str_value;
+	gchar *endptr;
+
+	str_value = g_key_file_get_value(key_file, group, key, NULL);
+	if (!str_value) {
+		ret = -1;
+		goto end;
+	}
+
+	*value = g_ascii_strtoull(str_value, &endptr, 10);
+	if (*endptr != '\0' || endptr == str_value) {
+		ret = -1;
+	}
+
+end:
+	g_free(str_value);
+	return ret;
+}
+
+/*
+ * Adds the size of each stream file of the trace directory
+ * `trace_path` to the checkpoint group `group` of `update`. The
+ * metadata file is not recorded: it only grows with new types.
+ */
+static
+int add_checkpoint_trace_files(struct writer_component *writer_component,
+		GKeyFile *update, const char *trace_path,
+		uint64_t *file_count)
+{
+	int ret = 0;
+	GDir *dir;
+	const char *basename;
+	const char *group = writer_component->checkpoint_group->str;
+
+	dir = g_dir_open(trace_path, 0, NULL);
+	if (!dir) {
+		fprintf(writer_component->err,
+			"[error] Cannot open trace directory %s\n",
+			trace_path);
+		ret = -1;
+		goto end;
+	}
+
+	while ((basename = g_dir_read_name(dir))) {
+		struct stat st;
+		gchar *file_path;
+		gchar *key;
+
+		if (!strcmp(basename, "metadata")) {
+			continue;
+		}
+
+		file_path = g_build_filename(trace_path, basename, NULL);
+		if (stat(file_path, &st) || !S_ISREG(st.st_mode)) {
+			g_free(file_path);
+			continue;
+		}
+
+		key = g_strdup_printf("file.%" PRIu64 ".path", *file_count);
+		g_key_file_set_string(update, group, key, file_path);
+		g_free(key);
+		key = g_strdup_printf("file.%" PRIu64 ".size", *file_count);
+		set_checkpoint_uint64(update, group, key,
+			(uint64_t) st.st_size);
+		g_free(key);
+		g_free(file_path);
+		(*file_count)++;
+	}
+
+	g_dir_close(dir);
+
+end:
+	return ret;
+}
+
+/*
+ * Adds the name, path, and UUID of the output trace `checkpoint_trace`
+ * as the trace `index` of the checkpoint group of `update`.
+ */
+static
+void add_checkpoint_trace(struct writer_component *writer_component,
+		GKeyFile *update, guint index,
+		struct checkpoint_trace *checkpoint_trace)
+{
+	const char *group = writer_component->checkpoint_group->str;
+	char uuid_str[sizeof(checkpoint_trace->uuid) * 2 + 1];
+	gchar *key;
+	size_t i;
+
+	for (i = 0; i < sizeof(checkpoint_trace->uuid); i++) {
+		sprintf(&uuid_str[i * 2], "%02x", checkpoint_trace->uuid[i]);
+	}
+
+	key = g_strdup_printf("trace.%u.name", index);
+	g_key_file_set_string(update, group, key,
+		checkpoint_trace->name->str);
+	g_free(key);
+	key = g_strdup_printf("trace.%u.path", index);
+	g_key_file_set_string(update, group, key,
+		checkpoint_trace->path->str);
+	g_free(key);
+	key = g_strdup_printf("trace.%u.uuid", index);
+	g_key_file_set_string(update, group, key, uuid_str);
+	g_free(key);
+}
+
+/*
+ * Reads the output trace `index` of the checkpoint group of `state`.
+ * Returns NULL if it is missing or invalid.
+ */
+static
+struct checkpoint_trace *get_checkpoint_trace(
+		struct writer_component *writer_component, GKeyFile *state,
+		uint64_t index)
+{
+	const char *group = writer_component->checkpoint_group->str;
+	struct checkpoint_trace *checkpoint_trace;
+	gchar *name = NULL, *path = NULL, *uuid_str = NULL;
+	gchar *key;
+	size_t i;
+
+	checkpoint_trace = g_new0(struct checkpoint_trace, 1);
+	key = g_strdup_printf("trace.%" PRIu64 ".name", index);
+	name = g_key_file_get_string(state, group, key, NULL);
+	g_free(key);
+	key = g_strdup_printf("trace.%" PRIu64 ".path", index);
+	path = g_key_file_get_string(state, group, key, NULL);
+	g_free(key);
+	key = g_strdup_printf("trace.%" PRIu64 ".uuid", index);
+	uuid_str = g_key_file_get_string(state, group, key, NULL);
+	g_free(key);
+	if (!name || !path || !uuid_str ||
+			strlen(uuid_str) != sizeof(checkpoint_trace->uuid) * 2) {
+		goto error;
+	}
+
+	for (i = 0; i < sizeof(checkpoint_trace->uuid); i++) {
+		if (sscanf(&uuid_str[i * 2], "%2hhx",
+				&checkpoint_trace->uuid[i]) != 1) {
+			goto error;
+		}
+	}
+
+	checkpoint_trace->name = g_string_new(name);
+	checkpoint_trace->path = g_string_new(path);
+	goto end;
+
+error:
+	fprintf(writer_component->err,
+		"[error] Invalid checkpoint trace entry %" PRIu64 "\n", index);
+	checkpoint_trace_destroy(checkpoint_trace);
+	checkpoint_trace = NULL;
+
+end:
+	g_free(name);
+	g_free(path);
+	g_free(uuid_str);
+	return checkpoint_trace;
+}
+
+/*
+ * Writes a checkpoint: the number of packets flushed for each input
+ * stream, and the current size of each output stream file.
+ *
+ * Since the stream files only grow by complete packets, those sizes
+ * and counts describe the same consistent state: when resuming, the
+ * stream files are truncated to the recorded sizes and the sources
+ * restart after the recorded packets.
+ */
+BT_HIDDEN
+int writer_checkpoint(struct writer_component *writer_component)
+{
+	int ret = 0;
+	GKeyFile *update;
+	GHashTableIter iter;
+	gpointer key, value;
+	uint64_t file_count = 0;
+	guint i;
+	const char *group = writer_component->checkpoint_group->str;
+
+	update = g_key_file_new();
+	if (!update) {
+		ret = -1;
+		goto end;
+	}
+
+	/* New event classes can have been added since the last flush. */
+	g_hash_table_iter_init(&iter, writer_component->trace_map);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		struct fs_writer *fs_writer = value;
+
+		bt_ctf_writer_flush_metadata(fs_writer->writer);
+	}
+
+	g_hash_table_iter_init(&iter, writer_component->stream_packet_counts);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		set_checkpoint_uint64(update,
+			BT_COMMON_CHECKPOINT_STREAMS_GROUP, key,
+			*((uint64_t *) value));
+	}
+
+	g_hash_table_iter_init(&iter, writer_component->stream_ids);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		gchar *id_key = g_strdup_printf("stream-id.%s", (gchar *) key);
+
+		set_checkpoint_uint64(update, group, id_key,
+			*((uint64_t *) value));
+		g_free(id_key);
+	}
+
+	set_checkpoint_uint64(update, group, "next-stream-id",
+		writer_component->next_stream_id);
+
+	/*
+	 * The resumed traces which are not continued yet are kept for
+	 * a later resume.
+	 */
+	for (i = 0; i < writer_component->trace_paths->len +
+			writer_component->resume_traces->len; i++) {
+		struct checkpoint_trace *checkpoint_trace;
+
+		if (i < writer_component->trace_paths->len) {
+			checkpoint_trace = g_ptr_array_index(
+				writer_component->trace_paths, i);
+		} else {
+			checkpoint_trace = g_ptr_array_index(
+				writer_component->resume_traces,
+				i - writer_component->trace_paths->len);
+		}
+
+		add_checkpoint_trace(writer_component, update, i,
+			checkpoint_trace);
+		ret = add_checkpoint_trace_files(writer_component, update,
+			checkpoint_trace->path->str, &file_count);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	set_checkpoint_uint64(update, group, "trace-count", (uint64_t) i);
+	set_checkpoint_uint64(update, group, "file-count", file_count);
+	ret = bt_common_checkpoint_save(writer_component->checkpoint_path->str,
+		update);
+	writer_component->checkpoint_packet_count = 0;
+
+end:
+	if (ret) {
+		fprintf(writer_component->err,
+			"[warning] Cannot write checkpoint to %s\n",
+			writer_component->checkpoint_path->str);
+	}
+
+	if (update) {
+		g_key_file_free(update);
+	}
+
+	return ret;
+}
+
+/*
+ * Truncates the stream files of the trace directories recorded in the
+ * checkpoint state `state` to their recorded size (or to 0 if they
+ * were created after the checkpoint), and initializes the flushed
+ * packet counts from the state.
+ *
+ * The recorded trace directories are then continued: each stream
+ * keeps its stream file, and the new packets are appended to it.
+ */
+BT_HIDDEN
+int writer_resume(struct writer_component *writer_component,
+		GKeyFile *state)
+{
+	int ret = 0;
+	uint64_t trace_count = 0, file_count = 0, i;
+	GHashTable *file_sizes;
+	gchar **keys = NULL;
+	const char *group = writer_component->checkpoint_group->str;
+
+	file_sizes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+		g_free);
+	(void) get_checkpoint_uint64(state, group, "trace-count",
+		&trace_count);
+	(void) get_checkpoint_uint64(state, group, "file-count", &file_count);
+
+	for (i = 0; i < file_count; i++) {
+		gchar *key = g_strdup_printf("file.%" PRIu64 ".path", i);
+		gchar *path = g_key_file_get_string(state, group, key, NULL);
+		uint64_t *size = g_new0(uint64_t, 1);
+
+		g_free(key);
+		key = g_strdup_printf("file.%" PRIu64 ".size", i);
+		if (!path || get_checkpoint_uint64(state, group, key, size)) {
+			fprintf(writer_component->err,
+				"[error] Invalid checkpoint entry %s\n", key);
+			g_free(key);
+			g_free(path);
+			g_free(size);
+			goto error;
+		}
+
+		g_free(key);
+		g_hash_table_insert(file_sizes, path, size);
+	}
+
+	for (i = 0; i < trace_count; i++) {
+		struct checkpoint_trace *checkpoint_trace;
+		const char *trace_path;
+		GDir *dir;
+		const char *basename;
+
+		checkpoint_trace = get_checkpoint_trace(writer_component,
+			state, i);
+		if (!checkpoint_trace) {
+			goto error;
+		}
+
+		/* Continued when its input trace is seen again. */
+		g_ptr_array_add(writer_component->resume_traces,
+			checkpoint_trace);
+		trace_path = checkpoint_trace->path->str;
+		dir = g_dir_open(trace_path, 0, NULL);
+		if (!dir) {
+			fprintf(writer_component->err,
+				"[error] Cannot open trace directory %s to continue it\n",
+				trace_path);
+			goto error;
+		}
+
+		while ((basename = g_dir_read_name(dir))) {
+			gchar *file_path;
+			uint64_t *size;
+			struct stat st;
+
+			if (!strcmp(basename, "metadata")) {
+				continue;
+			}
+
+			file_path = g_build_filename(trace_path, basename,
+				NULL);
+			if (stat(file_path, &st) || !S_ISREG(st.st_mode)) {
+				g_free(file_path);
+				continue;
+			}
+
+			size = g_hash_table_lookup(file_sizes, file_path);
+			if (truncate(file_path, size ? (off_t) *size : 0)) {
+				fprintf(writer_component->err,
+					"[error] Cannot truncate %s: %s\n",
+					file_path, strerror(errno));
+				g_free(file_path);
+				g_dir_close(dir);
+				goto error;
+			}
+
+			g_free(file_path);
+		}
+
+		g_dir_close(dir);
+	}
+
+	(void) get_checkpoint_uint64(state, group, "next-stream-id",
+		&writer_component->next_stream_id);
+	keys = g_key_file_get_keys(state, group, NULL, NULL);
+	for (i = 0; keys && keys[i]; i++) {
+		uint64_t *id;
+
+		if (!g_str_has_prefix(keys[i], "stream-id.")) {
+			continue;
+		}
+
+		id = g_new0(uint64_t, 1);
+		if (get_checkpoint_uint64(state, group, keys[i], id)) {
+			g_free(id);
+			continue;
+		}
+
+		g_hash_table_insert(writer_component->stream_ids,
+			g_strdup(keys[i] + strlen("stream-id.")), id);
+	}
+
+	g_strfreev(keys);
+	keys = g_key_file_get_keys(state, BT_COMMON_CHECKPOINT_STREAMS_GROUP,
+		NULL, NULL);
+	for (i = 0; keys && keys[i]; i++) {
+		uint64_t *count = g_new0(uint64_t, 1);
+
+		if (get_checkpoint_uint64(state,
+				BT_COMMON_CHECKPOINT_STREAMS_GROUP, keys[i],
+				count)) {
+			g_free(count);
+			continue;
+		}
+
+		g_hash_table_insert(writer_component->stream_packet_counts,
+			g_strdup(keys[i]), count);
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	g_strfreev(keys);
+	g_hash_table_destroy(file_sizes);
+	return ret;
+}
+
 BT_HIDDEN
 enum bt_component_status writer_close_packet(
 		struct writer_component *writer_component,
@@ -717,7 +1374,6 @@ enum bt_component_status writer_close_packet(
 				__func__, __FILE__, __LINE__);
 		goto error;
 	}
-	BT_PUT(stream);
 
 	bt_get(writer_stream);
 
@@ -729,6 +1385,20 @@ enum bt_component_status writer_close_packet(
 	}
 	BT_PUT(writer_stream);
 
+	if (writer_component->checkpoint_path) {
+		if (count_flushed_packet(writer_component, stream)) {
+			goto error;
+		}
+
+		writer_component->checkpoint_packet_count++;
+		if (writer_component->checkpoint_packet_count >=
+				writer_component->checkpoint_interval) {
+			/* A failed checkpoint does not stop the conversion. */
+			(void) writer_checkpoint(writer_component);
+		}
+	}
+	BT_PUT(stream);
+
 	ret = BT_COMPONENT_STATUS_OK;
 	goto end;
 
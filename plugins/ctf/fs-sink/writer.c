@@ -40,9 +40,11 @@
 #include <babeltrace/graph/notification-event.h>
 #include <babeltrace/graph/notification-packet.h>
 #include <babeltrace/graph/notification-stream.h>
+#include <babeltrace/common-internal.h>
 #include <plugins-common.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <glib.h>
 #include "writer.h"
 #include <assert.h>
@@ -70,6 +72,30 @@ void destroy_writer_component_data(struct writer_component *writer_component)
 
 	g_string_free(writer_component->base_path, true);
 	g_string_free(writer_component->trace_name_base, true);
+
+	if (writer_component->checkpoint_path) {
+		g_string_free(writer_component->checkpoint_path, true);
+	}
+
+	if (writer_component->checkpoint_group) {
+		g_string_free(writer_component->checkpoint_group, true);
+	}
+
+	if (writer_component->stream_packet_counts) {
+		g_hash_table_destroy(writer_component->stream_packet_counts);
+	}
+
+	if (writer_component->stream_ids) {
+		g_hash_table_destroy(writer_component->stream_ids);
+	}
+
+	if (writer_component->trace_paths) {
+		g_ptr_array_free(writer_component->trace_paths, TRUE);
+	}
+
+	if (writer_component->resume_traces) {
+		g_ptr_array_free(writer_component->resume_traces, TRUE);
+	}
 }
 
 BT_HIDDEN
@@ -262,6 +288,9 @@ enum bt_component_status writer_run(struct bt_private_component *component)
 	case BT_NOTIFICATION_ITERATOR_STATUS_END:
 		ret = BT_COMPONENT_STATUS_END;
 		BT_PUT(writer_component->input_iterator);
+		if (writer_component->checkpoint_path) {
+			(void) writer_checkpoint(writer_component);
+		}
 		goto end;
 	case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
 		ret = BT_COMPONENT_STATUS_AGAIN;
@@ -281,6 +310,105 @@ end:
 	return ret;
 }
 
+static
+enum bt_component_status parse_checkpoint_params(
+		struct bt_private_component *component,
+		struct writer_component *writer_component,
+		struct bt_value *params)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_value *value = NULL;
+	struct bt_component *comp = NULL;
+	GKeyFile *state = NULL;
+	const char *checkpoint_path;
+	const char *name;
+	int64_t interval = 1;
+	bt_bool resume = BT_FALSE;
+
+	value = bt_value_map_get(params, "checkpoint-path");
+	if (!value) {
+		goto end;
+	}
+
+	if (bt_value_string_get(value, &checkpoint_path) !=
+			BT_VALUE_STATUS_OK) {
+		fprintf(writer_component->err,
+			"[error] checkpoint-path parameter must be a string\n");
+		goto error;
+	}
+
+	BT_PUT(value);
+	value = bt_value_map_get(params, "checkpoint-interval");
+	if (value && (bt_value_integer_get(value, &interval) !=
+			BT_VALUE_STATUS_OK || interval <= 0)) {
+		fprintf(writer_component->err,
+			"[error] checkpoint-interval parameter must be a positive integer\n");
+		goto error;
+	}
+
+	BT_PUT(value);
+	value = bt_value_map_get(params, "resume");
+	if (value && bt_value_bool_get(value, &resume) != BT_VALUE_STATUS_OK) {
+		fprintf(writer_component->err,
+			"[error] resume parameter must be a boolean\n");
+		goto error;
+	}
+
+	comp = bt_component_from_private_component(component);
+	name = bt_component_get_name(comp);
+	if (!name) {
+		fprintf(writer_component->err,
+			"[error] Cannot write checkpoints for an unnamed component\n");
+		goto error;
+	}
+
+	writer_component->checkpoint_path = g_string_new(checkpoint_path);
+	writer_component->checkpoint_group = g_string_new(name);
+	writer_component->checkpoint_interval = (uint64_t) interval;
+	writer_component->stream_packet_counts = g_hash_table_new_full(
+		g_str_hash, g_str_equal, g_free, g_free);
+	writer_component->stream_ids = g_hash_table_new_full(g_str_hash,
+		g_str_equal, g_free, g_free);
+	writer_component->trace_paths = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) checkpoint_trace_destroy);
+	writer_component->resume_traces = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) checkpoint_trace_destroy);
+	if (!writer_component->checkpoint_path ||
+			!writer_component->checkpoint_group ||
+			!writer_component->stream_packet_counts ||
+			!writer_component->stream_ids ||
+			!writer_component->trace_paths ||
+			!writer_component->resume_traces) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto end;
+	}
+
+	if (resume) {
+		state = bt_common_checkpoint_load(checkpoint_path);
+		if (!state) {
+			goto error;
+		}
+
+		if (writer_resume(writer_component, state)) {
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	ret = BT_COMPONENT_STATUS_INVALID;
+
+end:
+	if (state) {
+		g_key_file_free(state);
+	}
+
+	bt_put(comp);
+	bt_put(value);
+	return ret;
+}
+
 BT_HIDDEN
 enum bt_component_status writer_component_init(
 	struct bt_private_component *component, struct bt_value *params,
@@ -324,6 +452,11 @@ enum bt_component_status writer_component_init(
 		goto error;
 	}
 
+	ret = parse_checkpoint_params(component, writer_component, params);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
 	ret = bt_private_component_set_user_data(component, writer_component);
 	if (ret != BT_COMPONENT_STATUS_OK) {
 		goto error;
@@ -336,3 +469,17 @@ error:
 	g_free(writer_component);
 	return ret;
 }
+
+BT_HIDDEN
+struct bt_value *writer_query(struct bt_component_class *comp_class,
+		const char *object, struct bt_value *params)
+{
+	struct bt_value *result = NULL;
+
+	if (!strcmp(object, "checkpoint-support")) {
+		/* See parse_checkpoint_params() */
+		result = bt_value_bool_create_init(BT_TRUE);
+	}
+
+	return result;
+}
@@ -28,8 +28,12 @@
  */
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/graph/component.h>
+#include <babeltrace/graph/component-class.h>
+#include <babeltrace/values.h>
 #include <babeltrace/ctf-writer/writer.h>
 
 struct writer_component {
@@ -42,6 +46,43 @@ struct writer_component {
 	FILE *err;
 	struct bt_notification_iterator *input_iterator;
 	bool error;
+	/* Checkpoint state file path, or NULL if disabled. */
+	GString *checkpoint_path;
+	/* Name of this component's group in the checkpoint state file. */
+	GString *checkpoint_group;
+	uint64_t checkpoint_interval;
+	/* Number of packets flushed since the last checkpoint. */
+	uint64_t checkpoint_packet_count;
+	/*
+	 * Map between the checkpoint key of an input stream (gchar *)
+	 * and the number of its packets flushed to disk (uint64_t *).
+	 */
+	GHashTable *stream_packet_counts;
+	/*
+	 * Map between the checkpoint key of an input stream (gchar *)
+	 * and the ID of its output stream (uint64_t *), which names
+	 * its stream file.
+	 */
+	GHashTable *stream_ids;
+	/* ID of the next output stream which is not in `stream_ids`. */
+	uint64_t next_stream_id;
+	/* Created output traces (struct checkpoint_trace *). */
+	GPtrArray *trace_paths;
+	/*
+	 * Output traces recorded in the resumed checkpoint which are
+	 * not created yet (struct checkpoint_trace *).
+	 */
+	GPtrArray *resume_traces;
+};
+
+/* Output trace recorded in a checkpoint. */
+struct checkpoint_trace {
+	/* Name of the input trace. */
+	GString *name;
+	/* Path of the output trace directory. */
+	GString *path;
+	/* UUID of the output trace, found in each packet header. */
+	unsigned char uuid[16];
 };
 
 enum fs_writer_stream_state {
@@ -89,6 +130,19 @@ BT_HIDDEN
 enum bt_component_status writer_stream_end(struct writer_component *writer,
 		struct bt_ctf_stream *stream);
 
+BT_HIDDEN
+int writer_checkpoint(struct writer_component *writer_component);
+BT_HIDDEN
+int writer_resume(struct writer_component *writer_component,
+		GKeyFile *state);
+
+BT_HIDDEN
+void checkpoint_trace_destroy(struct checkpoint_trace *checkpoint_trace);
+
+BT_HIDDEN
+struct bt_value *writer_query(struct bt_component_class *comp_class,
+		const char *object, struct bt_value *params);
+
 BT_HIDDEN
 enum bt_component_status writer_component_init(
 	struct bt_private_component *component, struct bt_value *params,
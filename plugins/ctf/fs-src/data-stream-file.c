@@ -32,6 +32,7 @@
 #include <babeltrace/compat/mman-internal.h>
 #include <babeltrace/endian-internal.h>
 #include <babeltrace/ctf-ir/stream.h>
+#include <babeltrace/ctf-ir/packet.h>
 #include <babeltrace/graph/notification-iterator.h>
 #include <babeltrace/graph/notification-stream.h>
 #include <babeltrace/graph/notification-event.h>
@@ -47,12 +48,40 @@
 #define BT_LOG_TAG "PLUGIN-CTF-FS-SRC-DS"
 #include "logging.h"
 
+/*
+ * Default maximum length, in pages, of a mapping.
+ */
+#define DEFAULT_MMAP_MAX_PAGES	2048
+
+#define CTF_PACKET_MAGIC	0xC1FC1FC1
+
 static inline
 size_t remaining_mmap_bytes(struct ctf_fs_ds_file *ds_file)
 {
 	return ds_file->mmap_valid_len - ds_file->request_offset;
 }
 
+/*
+ * Removes the current mapping of a data stream file from its mapping
+ * pool and releases its memory budget reservation.
+ */
+static
+void remove_mmap_from_pool(struct ctf_fs_ds_file *ds_file)
+{
+	if (ds_file->mmap_pool && ds_file->mmap_pool_link.data) {
+		g_queue_unlink(&ds_file->mmap_pool->lru,
+			&ds_file->mmap_pool_link);
+		ds_file->mmap_pool_link.data = NULL;
+	}
+
+	if (ds_file->mmap_reserved_len > 0) {
+		assert(ds_file->mmap_pool && ds_file->mmap_pool->graph);
+		(void) bt_graph_release_memory(ds_file->mmap_pool->graph,
+			ds_file->mmap_reserved_len);
+		ds_file->mmap_reserved_len = 0;
+	}
+}
+
 static
 int ds_file_munmap(struct ctf_fs_ds_file *ds_file)
 {
@@ -72,14 +101,345 @@ int ds_file_munmap(struct ctf_fs_ds_file *ds_file)
 	}
 
 	ds_file->mmap_addr = NULL;
+	remove_mmap_from_pool(ds_file);
 
 end:
 	return ret;
 }
 
+/*
+ * Marks the current mapping of a data stream file as the most recently
+ * used one of its mapping pool.
+ */
 static
-enum bt_ctf_notif_iter_medium_status ds_file_mmap_next(
-		struct ctf_fs_ds_file *ds_file)
+void touch_mmap(struct ctf_fs_ds_file *ds_file)
+{
+	if (!ds_file->mmap_pool || !ds_file->mmap_pool_link.data) {
+		return;
+	}
+
+	g_queue_unlink(&ds_file->mmap_pool->lru, &ds_file->mmap_pool_link);
+	g_queue_push_tail_link(&ds_file->mmap_pool->lru,
+		&ds_file->mmap_pool_link);
+}
+
+/*
+ * Removes the open file of a data stream file from its mapping pool.
+ */
+static
+void remove_file_from_pool(struct ctf_fs_ds_file *ds_file)
+{
+	if (ds_file->mmap_pool && ds_file->open_link.data) {
+		g_queue_unlink(&ds_file->mmap_pool->open_lru,
+			&ds_file->open_link);
+		ds_file->open_link.data = NULL;
+	}
+}
+
+/*
+ * Marks the open file of a data stream file as the most recently used
+ * one of its mapping pool.
+ */
+static
+void touch_file(struct ctf_fs_ds_file *ds_file)
+{
+	if (!ds_file->mmap_pool || !ds_file->open_link.data) {
+		return;
+	}
+
+	g_queue_unlink(&ds_file->mmap_pool->open_lru, &ds_file->open_link);
+	g_queue_push_tail_link(&ds_file->mmap_pool->open_lru,
+		&ds_file->open_link);
+}
+
+/*
+ * Closes the file of a data stream file, releasing its current mapping
+ * first. The data stream file reopens the file, and remaps the data at
+ * its current position, on the next request.
+ */
+static
+int ds_file_close(struct ctf_fs_ds_file *ds_file)
+{
+	int ret;
+
+	ret = ctf_fs_ds_file_release_mapping(ds_file);
+	if (ret) {
+		goto end;
+	}
+
+	remove_file_from_pool(ds_file);
+	ret = ctf_fs_file_close(ds_file->file);
+
+end:
+	return ret;
+}
+
+/*
+ * Opens the file of a data stream file if it's not open, first closing
+ * the least recently used open files of the other data stream files of
+ * its mapping pool to stay under the maximum number of open files.
+ * If none of them can be closed, the file is opened anyway, going over
+ * the maximum: reading the trace matters more than the limit.
+ */
+static
+int ds_file_open(struct ctf_fs_ds_file *ds_file)
+{
+	int ret = 0;
+	struct ctf_fs_ds_mmap_pool *pool = ds_file->mmap_pool;
+
+	if (ds_file->file->fp) {
+		goto end;
+	}
+
+	if (pool && pool->max_open_files > 0) {
+		GList *link = pool->open_lru.head;
+
+		while (link && pool->open_lru.length >= pool->max_open_files) {
+			struct ctf_fs_ds_file *victim = link->data;
+
+			/* Closing `victim` unlinks it */
+			link = link->next;
+			BT_LOGD("Closing file \"%s\" (%p) to stay under the "
+				"maximum number of open files: max=%" PRIu64,
+				victim->file->path->str, victim->file->fp,
+				pool->max_open_files);
+			if (ds_file_close(victim)) {
+				/* Try the next least recently used one */
+				BT_LOGW("Cannot close file \"%s\"",
+					victim->file->path->str);
+			}
+		}
+
+		if (pool->open_lru.length >= pool->max_open_files) {
+			BT_LOGW("Cannot close any open file to stay under the "
+				"maximum number of open files: opening the file anyway: "
+				"max=%" PRIu64 ", open-count=%u, path=\"%s\"",
+				pool->max_open_files, pool->open_lru.length,
+				ds_file->file->path->str);
+		}
+	}
+
+	ret = ctf_fs_file_open(ds_file->file, "rb");
+	if (ret) {
+		goto end;
+	}
+
+	if (pool) {
+		ds_file->open_link.data = ds_file;
+		g_queue_push_tail_link(&pool->open_lru, &ds_file->open_link);
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Releases the least recently used mapping of the mapping pool of a
+ * data stream file, other than its own. Returns 0 if a mapping was
+ * released.
+ */
+static
+int reclaim_mmap(struct ctf_fs_ds_file *ds_file)
+{
+	GList *link;
+
+	for (link = ds_file->mmap_pool->lru.head; link; link = link->next) {
+		struct ctf_fs_ds_file *victim = link->data;
+
+		if (victim == ds_file || victim->mmap_reserved_len == 0) {
+			continue;
+		}
+
+		BT_LOGD("Releasing mapping of file \"%s\" (%p) to stay within "
+			"the memory budget: size=%zu",
+			victim->file->path->str, victim->file->fp,
+			victim->mmap_reserved_len);
+		if (ctf_fs_ds_file_release_mapping(victim) == 0) {
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Reserves up to `*len` bytes (a multiple of the page size) in the
+ * graph's memory budget for a new mapping of a data stream file,
+ * shrinking the mapping or releasing the least recently used mappings
+ * of the other data stream files when the budget is exhausted.
+ *
+ * `*len` is set to the length to map. If the budget is too small for
+ * a single page, the mapping is not accounted.
+ */
+static
+void reserve_mmap_len(struct ctf_fs_ds_file *ds_file, size_t *len)
+{
+	const size_t page_size = bt_common_get_page_size();
+	struct ctf_fs_ds_mmap_pool *pool = ds_file->mmap_pool;
+	const size_t min_len = MIN(*len, page_size);
+	uint64_t budget;
+	uint64_t fair_len;
+
+	assert(ds_file->mmap_reserved_len == 0);
+	(void) bt_graph_get_memory_budget(pool->graph, &budget);
+
+	/* Do not take more than a fair share of the budget. */
+	fair_len = (budget / (pool->lru.length + 1)) & ~((uint64_t) page_size - 1);
+	if (fair_len < *len) {
+		*len = MAX(fair_len, min_len);
+	}
+
+	while (true) {
+		enum bt_graph_status status;
+
+		status = bt_graph_reserve_memory(pool->graph, *len);
+		if (status == BT_GRAPH_STATUS_OK) {
+			ds_file->mmap_reserved_len = *len;
+			break;
+		}
+
+		if (*len > min_len) {
+			*len = MAX((*len / 2) & ~(page_size - 1), min_len);
+			continue;
+		}
+
+		if (reclaim_mmap(ds_file)) {
+			BT_LOGD("Memory budget is exhausted: mapping %zu bytes "
+				"of file \"%s\" (%p) anyway",
+				*len, ds_file->file->path->str,
+				ds_file->file->fp);
+			break;
+		}
+	}
+}
+
+static inline
+bool should_advise(struct ctf_fs_ds_file *ds_file)
+{
+	return !ds_file->mmap_pool || ds_file->mmap_pool->advise;
+}
+
+/*
+ * Returns the maximum length of the next mapping of a data stream
+ * file.
+ *
+ * This is the mapping pool's window length, or DEFAULT_MMAP_MAX_PAGES
+ * pages by default, rounded to a multiple of the largest known packet
+ * size so that the mapping ends on a packet boundary. If the mapping
+ * pool's window length is `SIZE_MAX`, the rest of the file is mapped
+ * at once (the mapping pool keeps the mappings within the graph's
+ * memory budget, if any).
+ */
+static
+size_t get_mmap_max_len(struct ctf_fs_ds_file *ds_file)
+{
+	const size_t page_size = bt_common_get_page_size();
+	size_t len;
+
+	if (ds_file->max_packet_size == 0 && ds_file->index) {
+		guint i;
+
+		for (i = 0; i < ds_file->index->entries->len; i++) {
+			struct ctf_fs_ds_index_entry *entry = &g_array_index(
+				ds_file->index->entries,
+				struct ctf_fs_ds_index_entry, i);
+
+			ds_file->max_packet_size = MAX(
+				ds_file->max_packet_size, entry->packet_size);
+		}
+	}
+
+	if (!ds_file->mmap_pool || ds_file->mmap_pool->window_len == 0) {
+		len = page_size * DEFAULT_MMAP_MAX_PAGES;
+	} else if (ds_file->mmap_pool->window_len == SIZE_MAX) {
+		len = (uint64_t) ds_file->file->size > SIZE_MAX ?
+			SIZE_MAX : (size_t) ds_file->file->size;
+		goto end;
+	} else {
+		len = ds_file->mmap_pool->window_len;
+	}
+
+	if (ds_file->max_packet_size > 0 &&
+			ds_file->max_packet_size <= SIZE_MAX) {
+		if (len < ds_file->max_packet_size) {
+			len = (size_t) ds_file->max_packet_size;
+		} else {
+			len -= len % ds_file->max_packet_size;
+		}
+	}
+
+end:
+	return MAX(len, page_size);
+}
+
+/*
+ * Tells the kernel that the current mapping of a data stream file is
+ * read sequentially.
+ */
+static
+void advise_mmap(struct ctf_fs_ds_file *ds_file)
+{
+#ifdef MADV_SEQUENTIAL
+	if (should_advise(ds_file)) {
+		(void) madvise(ds_file->mmap_addr, ds_file->mmap_len,
+			MADV_SEQUENTIAL);
+	}
+#endif
+}
+
+/*
+ * Called when the notification iterator of a data stream file begins a
+ * packet of `packet_size` bytes: tells the kernel that the pages of the
+ * current mapping before this packet are not needed anymore, and to
+ * read the next packet ahead, assuming it has the same size.
+ */
+static
+void advise_packet(struct ctf_fs_ds_file *ds_file, int64_t packet_size)
+{
+	const off_t page_mask = ~((off_t) bt_common_get_page_size() - 1);
+	uint8_t *addr = ds_file->mmap_addr;
+
+	if (!addr || !should_advise(ds_file)) {
+		return;
+	}
+
+#ifdef MADV_DONTNEED
+	{
+		off_t end = ds_file->cur_packet_offset - ds_file->mmap_offset;
+
+		end = MIN(end, (off_t) ds_file->mmap_len) & page_mask;
+		if (end > (off_t) ds_file->mmap_released_len) {
+			(void) madvise(addr + ds_file->mmap_released_len,
+				end - ds_file->mmap_released_len,
+				MADV_DONTNEED);
+			ds_file->mmap_released_len = end;
+		}
+	}
+#endif
+
+#ifdef MADV_WILLNEED
+	if (packet_size > 0) {
+		off_t begin = ds_file->next_packet_offset -
+			ds_file->mmap_offset;
+		off_t end = MIN(begin + packet_size,
+			(off_t) ds_file->mmap_valid_len);
+
+		begin &= page_mask;
+		if (begin >= 0 && begin < end) {
+			(void) madvise(addr + begin, end - begin,
+				MADV_WILLNEED);
+		}
+	}
+#endif
+}
+
+/*
+ * Maps the region of the data stream file starting at `offset` (bytes),
+ * aligned down on a page boundary, replacing the current mapping.
+ */
+static
+enum bt_ctf_notif_iter_medium_status ds_file_mmap(
+		struct ctf_fs_ds_file *ds_file, off_t offset)
 {
 	const size_t page_size = bt_common_get_page_size();
 	enum bt_ctf_notif_iter_medium_status ret =
@@ -90,20 +450,31 @@ enum bt_ctf_notif_iter_medium_status ds_file_mmap_next(
 		if (ds_file_munmap(ds_file)) {
 			goto error;
 		}
-
-		ds_file->mmap_offset += ds_file->mmap_valid_len;
-		ds_file->request_offset = 0;
 	}
 
+	ds_file->mmap_offset = offset & ~((off_t) page_size - 1);
+	ds_file->request_offset = offset - ds_file->mmap_offset;
+	ds_file->mmap_max_len = get_mmap_max_len(ds_file);
 	ds_file->mmap_valid_len = MIN(ds_file->file->size - ds_file->mmap_offset,
 			ds_file->mmap_max_len);
 	if (ds_file->mmap_valid_len == 0) {
 		ret = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_EOF;
 		goto end;
 	}
+
+	if (ds_file_open(ds_file)) {
+		goto error;
+	}
+
 	/* Round up to next page, assuming page size being a power of 2. */
 	ds_file->mmap_len = (ds_file->mmap_valid_len + page_size - 1)
 			& ~(page_size - 1);
+
+	if (ds_file->mmap_pool && ds_file->mmap_pool->graph) {
+		reserve_mmap_len(ds_file, &ds_file->mmap_len);
+		ds_file->mmap_valid_len = MIN(ds_file->mmap_valid_len,
+			ds_file->mmap_len);
+	}
 	/* Map new region */
 	assert(ds_file->mmap_len);
 	ds_file->mmap_addr = mmap((void *) 0, ds_file->mmap_len,
@@ -114,9 +485,20 @@ enum bt_ctf_notif_iter_medium_status ds_file_mmap_next(
 				ds_file->mmap_len, ds_file->file->path->str,
 				ds_file->file->fp, ds_file->mmap_offset,
 				strerror(errno));
+		ds_file->mmap_addr = NULL;
+		remove_mmap_from_pool(ds_file);
 		goto error;
 	}
 
+	if (ds_file->mmap_pool) {
+		ds_file->mmap_pool_link.data = ds_file;
+		g_queue_push_tail_link(&ds_file->mmap_pool->lru,
+			&ds_file->mmap_pool_link);
+	}
+
+	ds_file->mmap_released_len = 0;
+	advise_mmap(ds_file);
+
 	goto end;
 error:
 	ds_file_munmap(ds_file);
@@ -125,6 +507,19 @@ end:
 	return ret;
 }
 
+static
+enum bt_ctf_notif_iter_medium_status ds_file_mmap_next(
+		struct ctf_fs_ds_file *ds_file)
+{
+	off_t next_offset = ds_file->mmap_offset;
+
+	if (ds_file->mmap_addr) {
+		next_offset += ds_file->mmap_valid_len;
+	}
+
+	return ds_file_mmap(ds_file, next_offset);
+}
+
 static
 enum bt_ctf_notif_iter_medium_status medop_request_bytes(
 		size_t request_sz, uint8_t **buffer_addr,
@@ -174,6 +569,59 @@ end:
 	return status;
 }
 
+static
+enum bt_ctf_notif_iter_medium_status medop_seek(
+		enum bt_ctf_notif_iter_seek_whence whence, off_t offset,
+		void *data)
+{
+	enum bt_ctf_notif_iter_medium_status status =
+		BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK;
+	struct ctf_fs_ds_file *ds_file = data;
+	off_t file_offset;
+
+	switch (whence) {
+	case BT_CTF_NOTIF_ITER_SEEK_WHENCE_SET:
+		file_offset = offset;
+		break;
+	case BT_CTF_NOTIF_ITER_SEEK_WHENCE_CUR:
+		file_offset = ds_file->mmap_offset + ds_file->request_offset +
+			offset;
+		break;
+	default:
+		status = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_INVAL;
+		goto end;
+	}
+
+	if (file_offset < 0 || file_offset > ds_file->file->size) {
+		BT_LOGW("Cannot seek outside of file \"%s\" (%p): "
+			"offset=%jd, file-size=%jd",
+			ds_file->file->path->str, ds_file->file->fp,
+			(intmax_t) file_offset, (intmax_t) ds_file->file->size);
+		status = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_INVAL;
+		goto end;
+	}
+
+	if (ds_file->mmap_addr && file_offset >= ds_file->mmap_offset &&
+			file_offset <= ds_file->mmap_offset +
+				(off_t) ds_file->mmap_valid_len) {
+		/* Within the current mapping: just move the cursor. */
+		ds_file->request_offset = file_offset - ds_file->mmap_offset;
+		goto end;
+	}
+
+	BT_LOGD("Seeking outside of current mapping of file \"%s\" (%p): "
+		"offset=%jd", ds_file->file->path->str, ds_file->file->fp,
+		(intmax_t) file_offset);
+	status = ds_file_mmap(ds_file, file_offset);
+	if (status == BT_CTF_NOTIF_ITER_MEDIUM_STATUS_EOF) {
+		/* Seeking right at the end of the file is valid. */
+		status = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK;
+	}
+
+end:
+	return status;
+}
+
 static
 struct bt_ctf_stream *medop_get_stream(
 		struct bt_ctf_stream_class *stream_class, void *data)
@@ -201,6 +649,7 @@ end:
 
 static struct bt_ctf_notif_iter_medium_ops medops = {
 	.request_bytes = medop_request_bytes,
+	.seek = medop_seek,
 	.get_stream = medop_get_stream,
 };
 static
@@ -337,90 +786,150 @@ end:
 	return ret;
 }
 
+/*
+ * Returns the path of the LTTng index file of a data stream file, that
+ * is, `index/NAME.idx` relative to the data stream file's directory.
+ */
 static
-struct ctf_fs_ds_index *build_index_from_idx_file(
-		struct ctf_fs_ds_file *ds_file)
+gchar *get_idx_file_path(struct ctf_fs_ds_file *ds_file)
 {
-	int ret;
 	gchar *directory = NULL;
 	gchar *basename = NULL;
 	GString *index_basename = NULL;
 	gchar *index_file_path = NULL;
-	GMappedFile *mapped_file = NULL;
-	gsize filesize;
-	const char *mmap_begin = NULL, *file_pos = NULL;
-	const struct ctf_packet_index_file_hdr *header = NULL;
-	struct ctf_fs_ds_index *index = NULL;
-	struct ctf_fs_ds_index_entry *index_entry = NULL;
-	uint64_t total_packets_size = 0;
-	size_t file_index_entry_size;
-	size_t file_entry_count;
-	size_t i;
-	struct bt_ctf_clock_class *timestamp_begin_cc = NULL;
-	struct bt_ctf_clock_class *timestamp_end_cc = NULL;
-
-	BT_LOGD("Building index from .idx file of stream file %s",
-			ds_file->file->path->str);
-
-	ret = get_ds_file_packet_bounds_clock_classes(ds_file,
-			&timestamp_begin_cc, &timestamp_end_cc);
-	if (ret) {
-		BT_LOGD("Cannot get clock classes of \"timestamp_begin\" and \"timestamp_end\" fields");
-		goto error;
-	}
 
-	/* Look for index file in relative path index/name.idx. */
 	basename = g_path_get_basename(ds_file->file->path->str);
 	if (!basename) {
 		BT_LOGE("Cannot get the basename of datastream file %s",
 				ds_file->file->path->str);
-		goto error;
+		goto end;
 	}
 
 	directory = g_path_get_dirname(ds_file->file->path->str);
 	if (!directory) {
 		BT_LOGE("Cannot get dirname of datastream file %s",
 				ds_file->file->path->str);
-		goto error;
+		goto end;
 	}
 
 	index_basename = g_string_new(basename);
 	if (!index_basename) {
 		BT_LOGE("Cannot allocate index file basename string");
-		goto error;
+		goto end;
 	}
 
 	g_string_append(index_basename, ".idx");
 	index_file_path = g_build_filename(directory, "index",
 			index_basename->str, NULL);
-	mapped_file = g_mapped_file_new(index_file_path, FALSE, NULL);
-	if (!mapped_file) {
-		BT_LOGD("Cannot create new mapped file %s",
-				index_file_path);
-		goto error;
-	}
-	filesize = g_mapped_file_get_length(mapped_file);
-	if (filesize < sizeof(*header)) {
-		BT_LOGW("Invalid LTTng trace index file: file size < header size");
-		goto error;
+
+end:
+	g_free(directory);
+	g_free(basename);
+	if (index_basename) {
+		g_string_free(index_basename, TRUE);
 	}
+	return index_file_path;
+}
 
-	mmap_begin = g_mapped_file_get_contents(mapped_file);
-	header = (struct ctf_packet_index_file_hdr *) mmap_begin;
+/*
+ * Maps the LTTng index file of a data stream file and validates its
+ * header. On success, returns the mapped file and sets `entries`,
+ * `entry_size` and `entry_count`.
+ */
+static
+GMappedFile *map_idx_file(struct ctf_fs_ds_file *ds_file,
+		const char **entries, size_t *entry_size, size_t *entry_count)
+{
+	gchar *index_file_path = NULL;
+	GMappedFile *mapped_file = NULL;
+	gsize filesize;
+	const struct ctf_packet_index_file_hdr *header;
 
-	file_pos = g_mapped_file_get_contents(mapped_file) + sizeof(*header);
+	index_file_path = get_idx_file_path(ds_file);
+	if (!index_file_path) {
+		goto error;
+	}
+
+	mapped_file = g_mapped_file_new(index_file_path, FALSE, NULL);
+	if (!mapped_file) {
+		BT_LOGD("Cannot create new mapped file %s",
+				index_file_path);
+		goto error;
+	}
+	filesize = g_mapped_file_get_length(mapped_file);
+	if (filesize < sizeof(*header)) {
+		BT_LOGW("Invalid LTTng trace index file: file size < header size");
+		goto error;
+	}
+
+	header = (struct ctf_packet_index_file_hdr *)
+		g_mapped_file_get_contents(mapped_file);
 	if (be32toh(header->magic) != CTF_INDEX_MAGIC) {
 		BT_LOGW("Invalid LTTng trace index: \"magic\" validation failed");
 		goto error;
 	}
 
-	file_index_entry_size = be32toh(header->packet_index_len);
-	file_entry_count = (filesize - sizeof(*header)) / file_index_entry_size;
-	if ((filesize - sizeof(*header)) % file_index_entry_size) {
+	*entry_size = be32toh(header->packet_index_len);
+	if (*entry_size < sizeof(struct ctf_packet_index) -
+			2 * sizeof(uint64_t)) {
+		/* Must at least contain the CTF_INDEX 1.0 fields. */
+		BT_LOGW("Invalid LTTng trace index: index entry size is too small");
+		goto error;
+	}
+
+	*entry_count = (filesize - sizeof(*header)) / *entry_size;
+	if ((filesize - sizeof(*header)) % *entry_size) {
 		BT_LOGW("Invalid index file size; not a multiple of index entry size");
 		goto error;
 	}
 
+	*entries = g_mapped_file_get_contents(mapped_file) + sizeof(*header);
+	goto end;
+
+error:
+	if (mapped_file) {
+		g_mapped_file_unref(mapped_file);
+		mapped_file = NULL;
+	}
+
+end:
+	g_free(index_file_path);
+	return mapped_file;
+}
+
+static
+struct ctf_fs_ds_index *build_index_from_idx_file(
+		struct ctf_fs_ds_file *ds_file)
+{
+	int ret;
+	GMappedFile *mapped_file = NULL;
+	const char *file_pos = NULL;
+	struct ctf_fs_ds_index *index = NULL;
+	struct ctf_fs_ds_index_entry *index_entry = NULL;
+	uint64_t total_packets_size = 0;
+	size_t file_index_entry_size;
+	size_t file_entry_count;
+	size_t i;
+	struct bt_ctf_clock_class *timestamp_begin_cc = NULL;
+	struct bt_ctf_clock_class *timestamp_end_cc = NULL;
+
+	BT_LOGD("Building index from .idx file of stream file %s",
+			ds_file->file->path->str);
+
+	ret = get_ds_file_packet_bounds_clock_classes(ds_file,
+			&timestamp_begin_cc, &timestamp_end_cc);
+	if (ret) {
+		BT_LOGD("Cannot get clock classes of \"timestamp_begin\" and \"timestamp_end\" fields");
+		goto error;
+	}
+
+	/* Look for index file in relative path index/name.idx. */
+	mapped_file = map_idx_file(ds_file, &file_pos, &file_index_entry_size,
+		&file_entry_count);
+	if (!mapped_file) {
+		goto error;
+	}
+
 	index = ctf_fs_ds_index_create(file_entry_count);
 	if (!index) {
 		goto error;
@@ -480,12 +989,6 @@ struct ctf_fs_ds_index *build_index_from_idx_file(
 		goto error;
 	}
 end:
-	g_free(directory);
-	g_free(basename);
-	g_free(index_file_path);
-	if (index_basename) {
-		g_string_free(index_basename, TRUE);
-	}
 	if (mapped_file) {
 		g_mapped_file_unref(mapped_file);
 	}
@@ -498,6 +1001,324 @@ error:
 	goto end;
 }
 
+/*
+ * Gets a data stream file's time range from the first and last entries
+ * of its LTTng index file, without reading the other entries.
+ */
+static
+int get_range_from_idx_file(struct ctf_fs_ds_file *ds_file,
+		int64_t *begin_ns, int64_t *end_ns)
+{
+	int ret;
+	GMappedFile *mapped_file = NULL;
+	const char *entries;
+	size_t entry_size;
+	size_t entry_count;
+	const struct ctf_packet_index *first_entry;
+	const struct ctf_packet_index *last_entry;
+	struct bt_ctf_clock_class *timestamp_begin_cc = NULL;
+	struct bt_ctf_clock_class *timestamp_end_cc = NULL;
+
+	ret = get_ds_file_packet_bounds_clock_classes(ds_file,
+			&timestamp_begin_cc, &timestamp_end_cc);
+	if (ret) {
+		BT_LOGD("Cannot get clock classes of \"timestamp_begin\" and \"timestamp_end\" fields");
+		goto error;
+	}
+
+	mapped_file = map_idx_file(ds_file, &entries, &entry_size,
+		&entry_count);
+	if (!mapped_file) {
+		goto error;
+	}
+
+	if (entry_count == 0) {
+		BT_LOGW("Invalid LTTng trace index: no index entries");
+		goto error;
+	}
+
+	first_entry = (const struct ctf_packet_index *) entries;
+	last_entry = (const struct ctf_packet_index *)
+		(entries + (entry_count - 1) * entry_size);
+
+	/*
+	 * We don't validate the complete index here (this is what
+	 * makes this fast), but the last entry must at least describe
+	 * the packet which ends the data stream file.
+	 */
+	if (be64toh(last_entry->offset) +
+			be64toh(last_entry->packet_size) / CHAR_BIT !=
+			ds_file->file->size) {
+		BT_LOGW("Invalid index; last indexed packet does not end the stream file");
+		goto error;
+	}
+
+	ret = convert_cycles_to_ns(timestamp_begin_cc,
+		be64toh(first_entry->timestamp_begin), begin_ns);
+	if (ret) {
+		goto error;
+	}
+
+	ret = convert_cycles_to_ns(timestamp_end_cc,
+		be64toh(last_entry->timestamp_end), end_ns);
+	if (ret) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	if (mapped_file) {
+		g_mapped_file_unref(mapped_file);
+	}
+	bt_put(timestamp_begin_cc);
+	bt_put(timestamp_end_cc);
+	return ret;
+}
+
+struct packet_bounds {
+	/* Size of the packet, in bytes (-1 if unknown). */
+	int64_t packet_size;
+
+	/* True if the packet header has a valid CTF magic number. */
+	bool has_valid_magic;
+
+	/* Converted from the packet context (ns since EPOCH). */
+	int64_t timestamp_begin_ns, timestamp_end_ns;
+};
+
+static
+int get_packet_context_timestamp_ns(struct bt_ctf_field *packet_context_field,
+		const char *name, int64_t *ns)
+{
+	int ret;
+	uint64_t cycles;
+	struct bt_ctf_field *timestamp_field = NULL;
+	struct bt_ctf_clock_class *clock_class = NULL;
+
+	timestamp_field = bt_ctf_field_structure_get_field_by_name(
+			packet_context_field, name);
+	if (!timestamp_field) {
+		ret = -1;
+		goto end;
+	}
+
+	clock_class = get_field_mapped_clock_class(timestamp_field);
+	if (!clock_class) {
+		ret = -1;
+		goto end;
+	}
+
+	ret = bt_ctf_field_unsigned_integer_get_value(timestamp_field,
+		&cycles);
+	if (ret) {
+		goto end;
+	}
+
+	ret = convert_cycles_to_ns(clock_class, cycles, ns);
+
+end:
+	bt_put(timestamp_field);
+	bt_put(clock_class);
+	return ret;
+}
+
+/*
+ * Sets `*packet_size` to the size (bytes) of a packet from its context
+ * field, or to -1 if the packet context has no `packet_size` field.
+ */
+static
+int get_packet_context_packet_size(struct bt_ctf_field *packet_context_field,
+		int64_t *packet_size)
+{
+	int ret = 0;
+	uint64_t packet_size_bits;
+	struct bt_ctf_field *packet_size_field = NULL;
+
+	*packet_size = -1;
+	if (!packet_context_field) {
+		goto end;
+	}
+
+	packet_size_field = bt_ctf_field_structure_get_field_by_name(
+		packet_context_field, "packet_size");
+	if (!packet_size_field) {
+		goto end;
+	}
+
+	ret = bt_ctf_field_unsigned_integer_get_value(packet_size_field,
+		&packet_size_bits);
+	if (ret) {
+		goto end;
+	}
+
+	*packet_size = (int64_t) (packet_size_bits / CHAR_BIT);
+
+end:
+	bt_put(packet_size_field);
+	return ret;
+}
+
+/*
+ * Returns whether or not a packet header field has a `magic` field
+ * with the CTF magic number.
+ */
+static
+bool packet_header_has_valid_magic(struct bt_ctf_field *packet_header_field)
+{
+	bool valid = false;
+	uint64_t magic;
+	struct bt_ctf_field *magic_field = NULL;
+
+	if (!packet_header_field) {
+		goto end;
+	}
+
+	magic_field = bt_ctf_field_structure_get_field_by_name(
+		packet_header_field, "magic");
+	if (!magic_field) {
+		goto end;
+	}
+
+	if (bt_ctf_field_unsigned_integer_get_value(magic_field, &magic)) {
+		goto end;
+	}
+
+	valid = magic == CTF_PACKET_MAGIC;
+
+end:
+	bt_put(magic_field);
+	return valid;
+}
+
+/*
+ * Decodes the header and context of the packet starting at `offset`
+ * (bytes) in the data stream file, without decoding its events.
+ */
+static
+int read_packet_bounds(struct ctf_fs_ds_file *ds_file, off_t offset,
+		struct packet_bounds *bounds)
+{
+	int ret;
+	enum bt_ctf_notif_iter_status notif_iter_status;
+	struct bt_ctf_field *packet_header_field = NULL;
+	struct bt_ctf_field *packet_context_field = NULL;
+
+	notif_iter_status = bt_ctf_notif_iter_seek(ds_file->notif_iter, offset);
+	if (notif_iter_status != BT_CTF_NOTIF_ITER_STATUS_OK) {
+		BT_LOGD("Cannot seek to packet at offset %jd of stream file \"%s\"",
+			(intmax_t) offset, ds_file->file->path->str);
+		ret = -1;
+		goto end;
+	}
+
+	ret = ctf_fs_ds_file_get_packet_header_context_fields(ds_file,
+		&packet_header_field, &packet_context_field);
+	if (ret || !packet_context_field) {
+		BT_LOGD("Cannot decode context of packet at offset %jd of stream file \"%s\"",
+			(intmax_t) offset, ds_file->file->path->str);
+		ret = -1;
+		goto end;
+	}
+
+	bounds->has_valid_magic =
+		packet_header_has_valid_magic(packet_header_field);
+
+	ret = get_packet_context_packet_size(packet_context_field,
+		&bounds->packet_size);
+	if (ret) {
+		goto end;
+	}
+
+	ret = get_packet_context_timestamp_ns(packet_context_field,
+		"timestamp_begin", &bounds->timestamp_begin_ns);
+	if (ret) {
+		BT_LOGD("Cannot get \"timestamp_begin\" of packet at offset %jd of stream file \"%s\"",
+			(intmax_t) offset, ds_file->file->path->str);
+		goto end;
+	}
+
+	ret = get_packet_context_timestamp_ns(packet_context_field,
+		"timestamp_end", &bounds->timestamp_end_ns);
+	if (ret) {
+		BT_LOGD("Cannot get \"timestamp_end\" of packet at offset %jd of stream file \"%s\"",
+			(intmax_t) offset, ds_file->file->path->str);
+		goto end;
+	}
+
+end:
+	bt_put(packet_header_field);
+	bt_put(packet_context_field);
+	return ret;
+}
+
+/*
+ * Gets a data stream file's time range by decoding the context of its
+ * first and last packets only.
+ */
+static
+int get_range_from_packets(struct ctf_fs_ds_file *ds_file,
+		int64_t *begin_ns, int64_t *end_ns)
+{
+	int ret;
+	off_t offset = 0;
+	const off_t file_size = ds_file->file->size;
+	struct packet_bounds first;
+	struct packet_bounds last;
+
+	ret = read_packet_bounds(ds_file, 0, &first);
+	if (ret) {
+		goto end;
+	}
+
+	last = first;
+	if (first.packet_size <= 0 || first.packet_size >= file_size) {
+		/* Single packet. */
+		goto set_range;
+	}
+
+	if (first.has_valid_magic && file_size % first.packet_size == 0) {
+		/*
+		 * The packet size is probably constant (for example,
+		 * LTTng's sub-buffer size): try the last packet
+		 * directly. Its timestamps are only used if it really
+		 * is a packet (valid magic number) of the same size,
+		 * which ends the file.
+		 */
+		ret = read_packet_bounds(ds_file,
+			file_size - first.packet_size, &last);
+		if (!ret && last.has_valid_magic &&
+				last.packet_size == first.packet_size) {
+			goto set_range;
+		}
+
+		BT_LOGD("Packet size is not constant in stream file \"%s\": "
+			"following the packet size chain",
+			ds_file->file->path->str);
+		last = first;
+	}
+
+	/* Follow the packet size chain up to the last packet. */
+	while (last.packet_size > 0 && offset + last.packet_size < file_size) {
+		offset += last.packet_size;
+		ret = read_packet_bounds(ds_file, offset, &last);
+		if (ret) {
+			goto end;
+		}
+	}
+
+set_range:
+	*begin_ns = first.timestamp_begin_ns;
+	*end_ns = last.timestamp_end_ns;
+	ret = 0;
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		struct ctf_fs_trace *ctf_fs_trace,
@@ -519,7 +1340,8 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 	ds_file->stream = bt_get(stream);
 	ds_file->cc_prio_map = bt_get(ctf_fs_trace->cc_prio_map);
 	g_string_assign(ds_file->file->path, path);
-	ret = ctf_fs_file_open(ds_file->file, "rb");
+	/* The file is opened when its data is first mapped. */
+	ret = ctf_fs_file_stat(ds_file->file);
 	if (ret) {
 		goto error;
 	}
@@ -530,8 +1352,6 @@ struct ctf_fs_ds_file *ctf_fs_ds_file_create(
 		goto error;
 	}
 
-	ds_file->mmap_max_len = page_size * 2048;
-
 	goto end;
 
 error:
@@ -550,6 +1370,33 @@ struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 	return build_index_from_idx_file(ds_file);
 }
 
+BT_HIDDEN
+int ctf_fs_ds_file_get_range_ns(struct ctf_fs_ds_file *ds_file,
+		int64_t *begin_ns, int64_t *end_ns)
+{
+	int ret;
+
+	assert(ds_file);
+	assert(begin_ns);
+	assert(end_ns);
+	ret = get_range_from_idx_file(ds_file, begin_ns, end_ns);
+	if (!ret) {
+		goto end;
+	}
+
+	BT_LOGD("Cannot get range of stream file \"%s\" from its index: "
+		"reading its first and last packets",
+		ds_file->file->path->str);
+	ret = get_range_from_packets(ds_file, begin_ns, end_ns);
+	if (ret) {
+		BT_LOGW("Cannot get range of stream file \"%s\"",
+			ds_file->file->path->str);
+	}
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *ds_file)
 {
@@ -562,6 +1409,7 @@ void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *ds_file)
 	(void) ds_file_munmap(ds_file);
 
 	if (ds_file->file) {
+		remove_file_from_pool(ds_file);
 		ctf_fs_file_destroy(ds_file->file);
 	}
 
@@ -572,6 +1420,260 @@ void ctf_fs_ds_file_destroy(struct ctf_fs_ds_file *ds_file)
 	g_free(ds_file);
 }
 
+/*
+ * Updates the current and next packet offsets of a data stream file
+ * when its notification iterator starts a new packet.
+ */
+static
+int update_packet_offsets(struct ctf_fs_ds_file *ds_file,
+		struct bt_notification *notification)
+{
+	int ret;
+	int64_t packet_size;
+	struct bt_ctf_packet *packet = NULL;
+	struct bt_ctf_field *packet_context_field = NULL;
+
+	packet = bt_notification_packet_begin_get_packet(notification);
+	if (!packet) {
+		ret = -1;
+		goto end;
+	}
+
+	packet_context_field = bt_ctf_packet_get_context(packet);
+	ret = get_packet_context_packet_size(packet_context_field,
+		&packet_size);
+	if (ret) {
+		goto end;
+	}
+
+	ds_file->cur_packet_offset = ds_file->next_packet_offset;
+
+	if (packet_size <= 0) {
+		/* No packet size: the packet spans the whole file. */
+		ds_file->next_packet_offset = ds_file->file->size;
+	} else {
+		ds_file->next_packet_offset += packet_size;
+		ds_file->max_packet_size = MAX(ds_file->max_packet_size,
+			(uint64_t) packet_size);
+	}
+
+	advise_packet(ds_file, packet_size);
+
+end:
+	bt_put(packet_context_field);
+	bt_put(packet);
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_ds_file_seek_packet(struct ctf_fs_ds_file *ds_file, off_t offset)
+{
+	int ret = 0;
+	enum bt_ctf_notif_iter_status notif_iter_status;
+
+	assert(ds_file);
+	notif_iter_status = bt_ctf_notif_iter_seek(ds_file->notif_iter, offset);
+	if (notif_iter_status != BT_CTF_NOTIF_ITER_STATUS_OK) {
+		BT_LOGW("Cannot seek to packet at offset %jd of stream file \"%s\"",
+			(intmax_t) offset, ds_file->file->path->str);
+		ret = -1;
+		goto end;
+	}
+
+	ds_file->next_packet_offset = offset;
+
+end:
+	return ret;
+}
+
+/*
+ * Returns the position, within the index of a data stream file, of the
+ * entry of its current packet boundary.
+ */
+static
+size_t get_next_packet_index_entry_pos(struct ctf_fs_ds_file *ds_file)
+{
+	GArray *entries = ds_file->index->entries;
+	struct ctf_fs_ds_index_entry *entry;
+	size_t low = 0, high = entries->len;
+
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+
+		entry = &g_array_index(entries, struct ctf_fs_ds_index_entry,
+			mid);
+		if (entry->offset < (uint64_t) ds_file->next_packet_offset) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+static
+int skip_packets_with_index(struct ctf_fs_ds_file *ds_file, uint64_t *count)
+{
+	GArray *entries = ds_file->index->entries;
+	struct ctf_fs_ds_index_entry *entry;
+	uint64_t remaining;
+	off_t offset;
+	size_t low = get_next_packet_index_entry_pos(ds_file);
+
+	remaining = entries->len - low;
+	if (*count < remaining) {
+		entry = &g_array_index(entries, struct ctf_fs_ds_index_entry,
+			low + *count);
+		offset = (off_t) entry->offset;
+		*count = 0;
+	} else {
+		offset = ds_file->file->size;
+		*count -= remaining;
+	}
+
+	return ctf_fs_ds_file_seek_packet(ds_file, offset);
+}
+
+BT_HIDDEN
+int ctf_fs_ds_file_skip_packets(struct ctf_fs_ds_file *ds_file,
+		uint64_t *count)
+{
+	int ret = 0;
+	int64_t packet_size;
+	struct bt_ctf_field *packet_context_field = NULL;
+
+	assert(ds_file);
+	assert(count);
+
+	if (ds_file->index && *count > 0) {
+		ret = skip_packets_with_index(ds_file, count);
+		goto end;
+	}
+
+	while (*count > 0 && ds_file->next_packet_offset < ds_file->file->size) {
+		ret = ctf_fs_ds_file_seek_packet(ds_file,
+			ds_file->next_packet_offset);
+		if (ret) {
+			goto end;
+		}
+
+		ret = ctf_fs_ds_file_get_packet_header_context_fields(ds_file,
+			NULL, &packet_context_field);
+		if (ret) {
+			BT_LOGW("Cannot decode context of packet at offset %jd of stream file \"%s\"",
+				(intmax_t) ds_file->next_packet_offset,
+				ds_file->file->path->str);
+			goto end;
+		}
+
+		ret = get_packet_context_packet_size(packet_context_field,
+			&packet_size);
+		BT_PUT(packet_context_field);
+		if (ret) {
+			goto end;
+		}
+
+		if (packet_size <= 0) {
+			ds_file->next_packet_offset = ds_file->file->size;
+		} else {
+			ds_file->next_packet_offset += packet_size;
+		}
+
+		(*count)--;
+	}
+
+	/* Be ready to decode the next packet (or the end of the file). */
+	ret = ctf_fs_ds_file_seek_packet(ds_file,
+		MIN(ds_file->next_packet_offset, ds_file->file->size));
+
+end:
+	bt_put(packet_context_field);
+	return ret;
+}
+
+static
+int skip_packets_before_with_index(struct ctf_fs_ds_file *ds_file,
+		int64_t begin_ns, uint64_t *count)
+{
+	GArray *entries = ds_file->index->entries;
+	struct ctf_fs_ds_index_entry *entry;
+	size_t first = get_next_packet_index_entry_pos(ds_file);
+	size_t low = first, high = entries->len;
+	off_t offset;
+
+	/* Find the first entry which ends at or after `begin_ns`. */
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+
+		entry = &g_array_index(entries, struct ctf_fs_ds_index_entry,
+			mid);
+		if (entry->timestamp_end_ns < begin_ns) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	*count = low - first;
+	if (low < entries->len) {
+		entry = &g_array_index(entries, struct ctf_fs_ds_index_entry,
+			low);
+		offset = (off_t) entry->offset;
+	} else {
+		offset = ds_file->file->size;
+	}
+
+	return ctf_fs_ds_file_seek_packet(ds_file, offset);
+}
+
+BT_HIDDEN
+int ctf_fs_ds_file_skip_packets_before(struct ctf_fs_ds_file *ds_file,
+		int64_t begin_ns, uint64_t *count)
+{
+	int ret = 0;
+	struct packet_bounds bounds;
+
+	assert(ds_file);
+	assert(count);
+	*count = 0;
+
+	if (ds_file->index) {
+		ret = skip_packets_before_with_index(ds_file, begin_ns, count);
+		goto end;
+	}
+
+	while (ds_file->next_packet_offset < ds_file->file->size) {
+		if (read_packet_bounds(ds_file, ds_file->next_packet_offset,
+				&bounds)) {
+			/*
+			 * Without timestamps, the packet cannot be
+			 * proven to end before `begin_ns`: keep it.
+			 */
+			break;
+		}
+
+		if (bounds.timestamp_end_ns >= begin_ns) {
+			break;
+		}
+
+		if (bounds.packet_size <= 0) {
+			ds_file->next_packet_offset = ds_file->file->size;
+		} else {
+			ds_file->next_packet_offset += bounds.packet_size;
+		}
+
+		(*count)++;
+	}
+
+	/* Be ready to decode the next packet (or the end of the file). */
+	ret = ctf_fs_ds_file_seek_packet(ds_file,
+		MIN(ds_file->next_packet_offset, ds_file->file->size));
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 struct bt_notification_iterator_next_return ctf_fs_ds_file_next(
 		struct ctf_fs_ds_file *ds_file)
@@ -582,6 +1684,8 @@ struct bt_notification_iterator_next_return ctf_fs_ds_file_next(
 		.notification = NULL,
 	};
 
+	touch_mmap(ds_file);
+	touch_file(ds_file);
 	notif_iter_status = bt_ctf_notif_iter_get_next_notification(
 		ds_file->notif_iter, ds_file->cc_prio_map, &ret.notification);
 
@@ -591,6 +1695,14 @@ struct bt_notification_iterator_next_return ctf_fs_ds_file_next(
 		break;
 	case BT_CTF_NOTIF_ITER_STATUS_OK:
 		ret.status = BT_NOTIFICATION_ITERATOR_STATUS_OK;
+
+		if (bt_notification_get_type(ret.notification) ==
+				BT_NOTIFICATION_TYPE_PACKET_BEGIN) {
+			if (update_packet_offsets(ds_file, ret.notification)) {
+				BT_PUT(ret.notification);
+				ret.status = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+			}
+		}
 		break;
 	case BT_CTF_NOTIF_ITER_STATUS_AGAIN:
 		/*
@@ -609,6 +1721,39 @@ struct bt_notification_iterator_next_return ctf_fs_ds_file_next(
 	return ret;
 }
 
+BT_HIDDEN
+int ctf_fs_ds_file_release_mapping(struct ctf_fs_ds_file *ds_file)
+{
+	int ret = 0;
+	off_t cursor;
+
+	assert(ds_file);
+
+	if (!ds_file->mmap_addr) {
+		goto end;
+	}
+
+	if (bt_ctf_notif_iter_release_buffer(ds_file->notif_iter) !=
+			BT_CTF_NOTIF_ITER_STATUS_OK) {
+		ret = -1;
+		goto end;
+	}
+
+	cursor = ds_file->mmap_offset + ds_file->request_offset;
+	ret = ds_file_munmap(ds_file);
+	if (ret) {
+		goto end;
+	}
+
+	/* Remap from the cursor on the next request. */
+	ds_file->mmap_offset = cursor;
+	ds_file->mmap_valid_len = 0;
+	ds_file->request_offset = 0;
+
+end:
+	return ret;
+}
+
 BT_HIDDEN
 int ctf_fs_ds_file_get_packet_header_context_fields(
 		struct ctf_fs_ds_file *ds_file,
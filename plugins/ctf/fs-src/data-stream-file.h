@@ -28,6 +28,7 @@
 #include <glib.h>
 #include <babeltrace/babeltrace-internal.h>
 #include <babeltrace/ctf-ir/trace.h>
+#include <babeltrace/graph/graph.h>
 
 #include "../common/notif-iter/notif-iter.h"
 #include "lttng-index.h"
@@ -84,8 +85,47 @@ struct ctf_fs_ds_file_info {
 	uint64_t begin_ns;
 };
 
+/*
+ * Pool of the open files and current mappings of the data stream files
+ * of a component, used to keep the total size of the mappings within
+ * the graph's memory budget, and the number of open files (and
+ * therefore of mappings) under a maximum.
+ */
+struct ctf_fs_ds_mmap_pool {
+	/* Weak, NULL if the graph has no memory budget */
+	struct bt_graph *graph;
+
+	/*
+	 * Data stream files which have a current mapping
+	 * (struct ctf_fs_ds_file *), least recently used first.
+	 */
+	GQueue lru;
+
+	/*
+	 * Maximum length of a mapping, in bytes (0: default, `SIZE_MAX`:
+	 * rest of the file, see struct ctf_fs_ds_file::mmap_max_len).
+	 */
+	size_t window_len;
+
+	/* Give the kernel access pattern hints for the mappings */
+	bool advise;
+
+	/* Maximum number of open data stream files (0: no maximum) */
+	uint64_t max_open_files;
+
+	/*
+	 * Data stream files which have an open file
+	 * (struct ctf_fs_ds_file *), least recently used first.
+	 */
+	GQueue open_lru;
+};
+
 struct ctf_fs_ds_file {
-	/* Owned by this */
+	/*
+	 * Owned by this. The file is only opened when its data is
+	 * mapped, and can be closed by the mapping pool between two
+	 * notifications: it is reopened on the next request.
+	 */
 	struct ctf_fs_file *file;
 
 	/* Owned by this */
@@ -99,15 +139,47 @@ struct ctf_fs_ds_file {
 
 	void *mmap_addr;
 
-	/* Max length of chunk to mmap() when updating the current mapping. */
+	/*
+	 * Max length of chunk to mmap() when updating the current mapping,
+	 * updated before each mapping: a multiple of the largest packet
+	 * size, if known, close to the mapping pool's window length, or
+	 * the rest of the file if the mapping pool asks for it.
+	 */
 	size_t mmap_max_len;
 
+	/*
+	 * Length, from the beginning of the current mapping, of the
+	 * pages which were advised as not needed anymore.
+	 */
+	size_t mmap_released_len;
+
+	/*
+	 * Largest packet size (bytes) of the index or of the packets
+	 * decoded so far, 0 if unknown.
+	 */
+	uint64_t max_packet_size;
+
 	/* Length of the current mapping. */
 	size_t mmap_len;
 
 	/* Length of the current mapping which *exists* in the backing file. */
 	size_t mmap_valid_len;
 
+	/*
+	 * Weak, may be NULL: mapping pool of the component. Set before
+	 * the first mapping.
+	 */
+	struct ctf_fs_ds_mmap_pool *mmap_pool;
+
+	/* Link in the mapping pool's LRU queue, while mapped */
+	GList mmap_pool_link;
+
+	/* Link in the mapping pool's open file LRU queue, while open */
+	GList open_link;
+
+	/* Size reserved in the graph's memory budget for the mapping */
+	size_t mmap_reserved_len;
+
 	/* Offset in the file where the current mapping starts. */
 	off_t mmap_offset;
 
@@ -118,6 +190,22 @@ struct ctf_fs_ds_file {
 	off_t request_offset;
 
 	bool end_reached;
+
+	/*
+	 * Offset, in the file, of the packet for which
+	 * ctf_fs_ds_file_next() returned the last packet beginning
+	 * notification.
+	 */
+	off_t cur_packet_offset;
+
+	/* Offset, in the file, of the next packet to decode. */
+	off_t next_packet_offset;
+
+	/*
+	 * Weak, may be NULL: index of this stream file, used to skip
+	 * packets without decoding their contexts.
+	 */
+	struct ctf_fs_ds_index *index;
 };
 
 BT_HIDDEN
@@ -142,6 +230,55 @@ BT_HIDDEN
 struct ctf_fs_ds_index *ctf_fs_ds_file_build_index(
 		struct ctf_fs_ds_file *ds_file);
 
+/*
+ * Gets the time range (ns since EPOCH) of a data stream file, from the
+ * first packet's beginning time to the last packet's end time.
+ *
+ * This uses the first and last entries of the stream file's index if
+ * available, otherwise only the first and last packets' contexts are
+ * decoded. The data stream file's notification iterator is moved
+ * around: use a dedicated data stream file.
+ */
+BT_HIDDEN
+int ctf_fs_ds_file_get_range_ns(struct ctf_fs_ds_file *ds_file,
+		int64_t *begin_ns, int64_t *end_ns);
+
+/*
+ * Repositions a data stream file at the beginning of the packet
+ * located at `offset` (bytes), which must be a packet boundary.
+ */
+BT_HIDDEN
+int ctf_fs_ds_file_seek_packet(struct ctf_fs_ds_file *ds_file, off_t offset);
+
+/*
+ * Skips up to `*count` packets from the current packet boundary of a
+ * data stream file, using its index if set, otherwise only decoding
+ * the packet headers and contexts. `*count` is decremented by the
+ * number of skipped packets: it's not 0 on return if the end of the
+ * file is reached first.
+ */
+BT_HIDDEN
+int ctf_fs_ds_file_skip_packets(struct ctf_fs_ds_file *ds_file,
+		uint64_t *count);
+
+/*
+ * Skips the packets which end before `begin_ns` (ns since EPOCH) from
+ * the current packet boundary of a data stream file, using its index
+ * if set, otherwise only decoding the packet contexts. `*count` is set
+ * to the number of skipped packets.
+ */
+BT_HIDDEN
+int ctf_fs_ds_file_skip_packets_before(struct ctf_fs_ds_file *ds_file,
+		int64_t begin_ns, uint64_t *count);
+
+/*
+ * Unmaps the current mapping of a data stream file, releasing its
+ * memory budget reservation. The data stream file remaps the data at
+ * its current position on the next notification request.
+ */
+BT_HIDDEN
+int ctf_fs_ds_file_release_mapping(struct ctf_fs_ds_file *ds_file);
+
 BT_HIDDEN
 void ctf_fs_ds_index_destroy(struct ctf_fs_ds_index *index);
 
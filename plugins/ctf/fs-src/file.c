@@ -21,6 +21,7 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -112,8 +113,54 @@ error:
 			BT_LOGE("Cannot close file \"%s\": %s", file->path->str,
 				strerror(errno));
 		}
+
+		file->fp = NULL;
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_file_close(struct ctf_fs_file *file)
+{
+	int ret = 0;
+
+	if (!file->fp) {
+		goto end;
 	}
 
+	BT_LOGD("Closing file \"%s\" (%p)", file->path->str, file->fp);
+
+	if (fclose(file->fp)) {
+		BT_LOGE("Cannot close file \"%s\": %s", file->path->str,
+			strerror(errno));
+		ret = -1;
+	}
+
+	file->fp = NULL;
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_file_stat(struct ctf_fs_file *file)
+{
+	int ret = 0;
+	struct stat stat_buf;
+
+	if (stat(file->path->str, &stat_buf)) {
+		BT_LOGE("Cannot get informations of file \"%s\": %s",
+			file->path->str, strerror(errno));
+		ret = -1;
+		goto end;
+	}
+
+	file->size = stat_buf.st_size;
+	BT_LOGD("File \"%s\" is %jd bytes", file->path->str,
+		(intmax_t) file->size);
+
 end:
 	return ret;
 }
@@ -37,4 +37,15 @@ struct ctf_fs_file *ctf_fs_file_create(void);
 BT_HIDDEN
 int ctf_fs_file_open(struct ctf_fs_file *file, const char *mode);
 
+/*
+ * Closes the file, if open, keeping its path and size: it can be
+ * opened again with ctf_fs_file_open().
+ */
+BT_HIDDEN
+int ctf_fs_file_close(struct ctf_fs_file *file);
+
+/* Sets the size of the file from its path, without opening it. */
+BT_HIDDEN
+int ctf_fs_file_stat(struct ctf_fs_file *file);
+
 #endif /* CTF_FS_FILE_H */
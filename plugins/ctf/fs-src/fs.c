@@ -29,13 +29,18 @@
 #include <babeltrace/ctf-ir/packet.h>
 #include <babeltrace/ctf-ir/clock-class.h>
 #include <babeltrace/ctf-ir/stream.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/trace.h>
 #include <babeltrace/ctf-ir/fields.h>
+#include <babeltrace/ctf-ir/packet.h>
 #include <babeltrace/graph/private-port.h>
 #include <babeltrace/graph/private-component.h>
 #include <babeltrace/graph/private-component-source.h>
 #include <babeltrace/graph/private-notification-iterator.h>
 #include <babeltrace/graph/component.h>
+#include <babeltrace/graph/graph.h>
 #include <babeltrace/graph/notification-iterator.h>
+#include <babeltrace/graph/notification-packet.h>
 #include <babeltrace/graph/clock-class-priority-map.h>
 #include <plugins-common.h>
 #include <glib.h>
@@ -52,9 +57,55 @@
 #define BT_LOG_TAG "PLUGIN-CTF-FS-SRC"
 #include "logging.h"
 
+/*
+ * Default maximum number of open data stream files of a component,
+ * well under the usual default limits of open file descriptors (1024)
+ * and of memory mappings (65530) of a process.
+ */
+#define CTF_FS_DEFAULT_MAX_OPEN_FILES	512
+
 BT_HIDDEN
 bool ctf_fs_debug;
 
+static
+bool is_sampling(struct ctf_fs_component *ctf_fs)
+{
+	return ctf_fs->options.sample_every > 0 ||
+		ctf_fs->options.sample_ratio > 0;
+}
+
+/*
+ * Makes the data stream file mapping pool of a component follow its
+ * graph's memory budget, if any. The graph's memory budget is set
+ * before it runs, so this is done when an iterator is initialized.
+ */
+static
+void set_mmap_pool_graph(struct ctf_fs_component *ctf_fs)
+{
+	struct bt_component *comp;
+	struct bt_graph *graph;
+	uint64_t budget = 0;
+
+	if (ctf_fs->mmap_pool.graph) {
+		return;
+	}
+
+	comp = bt_component_from_private_component(ctf_fs->priv_comp);
+	graph = bt_component_get_graph(comp);
+	(void) bt_graph_get_memory_budget(graph, &budget);
+	if (budget > 0) {
+		BT_LOGD("Keeping the stream file mappings within the graph's "
+			"memory budget: comp-name=\"%s\", budget=%" PRIu64,
+			bt_component_get_name(comp), budget);
+
+		/* Weak: the graph outlives its components */
+		ctf_fs->mmap_pool.graph = graph;
+	}
+
+	bt_put(graph);
+	bt_put(comp);
+}
+
 static
 int notif_iter_data_set_current_ds_file(struct ctf_fs_notif_iter_data *notif_iter_data)
 {
@@ -74,8 +125,566 @@ int notif_iter_data_set_current_ds_file(struct ctf_fs_notif_iter_data *notif_ite
 		ds_file_info->path->str);
 	if (!notif_iter_data->ds_file) {
 		ret = -1;
+		goto end;
+	}
+
+	notif_iter_data->ds_file->mmap_pool = &notif_iter_data->ctf_fs->mmap_pool;
+
+	if (is_sampling(notif_iter_data->ctf_fs)) {
+		/*
+		 * Skipping packets with the stream file's index (if
+		 * any) avoids decoding their contexts.
+		 */
+		if (!ds_file_info->index) {
+			ds_file_info->index = ctf_fs_ds_file_build_index(
+				notif_iter_data->ds_file);
+			ret = ctf_fs_ds_file_seek_packet(
+				notif_iter_data->ds_file, 0);
+			if (ret) {
+				goto end;
+			}
+		}
+
+		notif_iter_data->ds_file->index = ds_file_info->index;
+	}
+
+end:
+	return ret;
+}
+
+/*
+ * Skips up to `*count` packets from the current packet boundary of a
+ * notification iterator, opening the next stream files of its group
+ * as needed. `*count` is not 0 on return if the end of the group is
+ * reached first, in which case the current stream file is NULL.
+ */
+static
+int notif_iter_data_skip_packets(struct ctf_fs_notif_iter_data *notif_iter_data,
+		uint64_t *count)
+{
+	int ret = 0;
+	struct ctf_fs_ds_file_group *ds_file_group =
+		notif_iter_data->ds_file_group;
+
+	while (true) {
+		ret = ctf_fs_ds_file_skip_packets(notif_iter_data->ds_file,
+			count);
+		if (ret || *count == 0) {
+			break;
+		}
+
+		notif_iter_data->ds_file_info_index++;
+		if (notif_iter_data->ds_file_info_index ==
+				ds_file_group->ds_file_infos->len) {
+			ctf_fs_ds_file_destroy(notif_iter_data->ds_file);
+			notif_iter_data->ds_file = NULL;
+			break;
+		}
+
+		ret = notif_iter_data_set_current_ds_file(notif_iter_data);
+		if (ret) {
+			break;
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * Skips the packets which are not part of the sample before the next
+ * packet to decode.
+ */
+static
+int notif_iter_data_skip_sampled_out_packets(
+		struct ctf_fs_notif_iter_data *notif_iter_data)
+{
+	struct ctf_fs_component_options *options =
+		&notif_iter_data->ctf_fs->options;
+	uint64_t count = 0;
+
+	if (options->sample_every > 0) {
+		count = options->sample_every - 1;
+	} else {
+		/* Geometric distribution: each packet is independent. */
+		while (g_rand_double(notif_iter_data->sample_rand) >=
+				options->sample_ratio) {
+			count++;
+		}
+	}
+
+	return notif_iter_data_skip_packets(notif_iter_data, &count);
+}
+
+/*
+ * Returns the intersection of the time ranges of the stream file groups
+ * of a trace, computing it on first use only.
+ */
+static
+const struct ctf_fs_trace_intersection *get_trace_intersection(
+		struct ctf_fs_trace *ctf_fs_trace)
+{
+	struct ctf_fs_trace_intersection *intersection =
+		&ctf_fs_trace->intersection;
+	size_t i;
+
+	if (intersection->is_computed) {
+		goto end;
+	}
+
+	intersection->begin_ns = INT64_MIN;
+	intersection->end_ns = INT64_MAX;
+
+	for (i = 0; i < ctf_fs_trace->ds_file_groups->len; i++) {
+		struct ctf_fs_ds_file_group *ds_file_group =
+			g_ptr_array_index(ctf_fs_trace->ds_file_groups, i);
+		int64_t begin_ns, end_ns;
+
+		if (ctf_fs_ds_file_group_get_range_ns(ds_file_group,
+				&begin_ns, &end_ns)) {
+			/* This stream does not restrict the intersection. */
+			BT_LOGW("Cannot get time range of stream file group: "
+				"trace-path=\"%s\", first-path=\"%s\"",
+				ctf_fs_trace->path->str,
+				((struct ctf_fs_ds_file_info *) g_ptr_array_index(
+					ds_file_group->ds_file_infos, 0))->path->str);
+			continue;
+		}
+
+		intersection->begin_ns = MAX(intersection->begin_ns, begin_ns);
+		intersection->end_ns = MIN(intersection->end_ns, end_ns);
+		intersection->is_set = true;
+	}
+
+	intersection->is_computed = true;
+
+	if (intersection->is_set) {
+		BT_LOGI("Computed trace's stream intersection: path=\"%s\", "
+			"begin-ns=%" PRId64 ", end-ns=%" PRId64,
+			ctf_fs_trace->path->str, intersection->begin_ns,
+			intersection->end_ns);
+	}
+
+end:
+	return intersection;
+}
+
+/*
+ * Positions a new notification iterator on the first packet of its
+ * stream file group which intersects with the stream intersection of
+ * its trace. Whole stream files are skipped using their beginning
+ * times, and the packets of the remaining one are skipped using its
+ * index if available, otherwise only decoding their contexts.
+ */
+static
+int notif_iter_data_seek_intersection(
+		struct ctf_fs_notif_iter_data *notif_iter_data)
+{
+	int ret = 0;
+	uint64_t count;
+	size_t file_index = 0;
+	struct ctf_fs_ds_file_group *ds_file_group =
+		notif_iter_data->ds_file_group;
+	const struct ctf_fs_trace_intersection *intersection =
+		get_trace_intersection(ds_file_group->ctf_fs_trace);
+
+	if (!intersection->is_set) {
+		goto end;
+	}
+
+	if (intersection->begin_ns > intersection->end_ns) {
+		/* Empty intersection: nothing to decode. */
+		ctf_fs_ds_file_destroy(notif_iter_data->ds_file);
+		notif_iter_data->ds_file = NULL;
+		goto end;
+	}
+
+	/*
+	 * The stream files of a group are sorted by beginning time: a
+	 * stream file ends before the next one begins.
+	 */
+	while (file_index + 1 < ds_file_group->ds_file_infos->len) {
+		struct ctf_fs_ds_file_info *next_info = g_ptr_array_index(
+			ds_file_group->ds_file_infos, file_index + 1);
+
+		if (next_info->begin_ns == -1ULL ||
+				(int64_t) next_info->begin_ns >=
+				intersection->begin_ns) {
+			break;
+		}
+
+		file_index++;
 	}
 
+	if (file_index != notif_iter_data->ds_file_info_index) {
+		notif_iter_data->ds_file_info_index = file_index;
+		ret = notif_iter_data_set_current_ds_file(notif_iter_data);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	ret = ctf_fs_ds_file_skip_packets_before(notif_iter_data->ds_file,
+		intersection->begin_ns, &count);
+	if (ret) {
+		goto end;
+	}
+
+	BT_LOGD("Sought stream intersection: first-path=\"%s\", "
+		"file-index=%zu, skipped-packet-count=%" PRIu64,
+		((struct ctf_fs_ds_file_info *) g_ptr_array_index(
+			ds_file_group->ds_file_infos, 0))->path->str,
+		file_index, count);
+
+end:
+	return ret;
+}
+
+static
+uint64_t get_packet_context_timestamp_begin_ns(
+		struct ctf_fs_trace *ctf_fs_trace,
+		struct bt_ctf_field *packet_context_field)
+{
+	int ret;
+	struct bt_ctf_field *timestamp_begin_field = NULL;
+	struct bt_ctf_field_type *timestamp_begin_ft = NULL;
+	uint64_t timestamp_begin_raw_value = -1ULL;
+	uint64_t timestamp_begin_ns = -1ULL;
+	int64_t timestamp_begin_ns_signed;
+	struct bt_ctf_clock_class *timestamp_begin_clock_class = NULL;
+	struct bt_ctf_clock_value *clock_value = NULL;
+
+	if (!packet_context_field) {
+		goto end;
+	}
+
+	timestamp_begin_field = bt_ctf_field_structure_get_field_by_name(
+		packet_context_field, "timestamp_begin");
+	if (!timestamp_begin_field) {
+		goto end;
+	}
+
+	timestamp_begin_ft = bt_ctf_field_get_type(timestamp_begin_field);
+	assert(timestamp_begin_ft);
+	timestamp_begin_clock_class =
+		bt_ctf_field_type_integer_get_mapped_clock_class(timestamp_begin_ft);
+	if (!timestamp_begin_clock_class) {
+		goto end;
+	}
+
+	ret = bt_ctf_field_unsigned_integer_get_value(timestamp_begin_field,
+		&timestamp_begin_raw_value);
+	if (ret) {
+		goto end;
+	}
+
+	clock_value = bt_ctf_clock_value_create(timestamp_begin_clock_class,
+		timestamp_begin_raw_value);
+	if (!clock_value) {
+		goto end;
+	}
+
+	ret = bt_ctf_clock_value_get_value_ns_from_epoch(clock_value,
+		&timestamp_begin_ns_signed);
+	if (ret) {
+		goto end;
+	}
+
+	timestamp_begin_ns = (uint64_t) timestamp_begin_ns_signed;
+
+end:
+	bt_put(timestamp_begin_field);
+	bt_put(timestamp_begin_ft);
+	bt_put(timestamp_begin_clock_class);
+	bt_put(clock_value);
+	return timestamp_begin_ns;
+}
+
+/*
+ * Returns whether the packet of a packet beginning notification begins
+ * after the end of the stream intersection of its trace, in which
+ * case this packet and the next ones of the group are not decoded.
+ */
+static
+bool packet_begins_after_intersection(
+		struct ctf_fs_notif_iter_data *notif_iter_data,
+		struct bt_notification *notification)
+{
+	struct ctf_fs_trace *ctf_fs_trace =
+		notif_iter_data->ds_file_group->ctf_fs_trace;
+	const struct ctf_fs_trace_intersection *intersection =
+		&ctf_fs_trace->intersection;
+	struct bt_ctf_packet *packet;
+	struct bt_ctf_field *packet_context_field;
+	uint64_t begin_ns;
+
+	if (!intersection->is_set) {
+		return false;
+	}
+
+	packet = bt_notification_packet_begin_get_packet(notification);
+	assert(packet);
+	packet_context_field = bt_ctf_packet_get_context(packet);
+	begin_ns = get_packet_context_timestamp_begin_ns(ctf_fs_trace,
+		packet_context_field);
+	bt_put(packet_context_field);
+	bt_put(packet);
+	return begin_ns != -1ULL && (int64_t) begin_ns > intersection->end_ns;
+}
+
+static
+gchar *get_ds_file_group_checkpoint_key(
+		struct ctf_fs_ds_file_group *ds_file_group)
+{
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_trace *trace;
+	gchar *key;
+
+	stream_class = bt_ctf_stream_get_class(ds_file_group->stream);
+	assert(stream_class);
+	trace = bt_ctf_stream_class_get_trace(stream_class);
+	assert(trace);
+	key = bt_common_checkpoint_stream_key(bt_ctf_trace_get_name(trace),
+		bt_ctf_stream_class_get_id(stream_class),
+		bt_ctf_stream_get_id(ds_file_group->stream),
+		bt_ctf_stream_get_name(ds_file_group->stream));
+	bt_put(trace);
+	bt_put(stream_class);
+	return key;
+}
+
+static
+const char *get_checkpoint_group_name(struct ctf_fs_component *ctf_fs)
+{
+	struct bt_component *comp;
+	const char *name;
+
+	comp = bt_component_from_private_component(ctf_fs->priv_comp);
+	name = bt_component_get_name(comp);
+	bt_put(comp);
+	return name;
+}
+
+static
+void set_checkpoint_uint64(GKeyFile *key_file, const char *group,
+		const char *key, const char *suffix, uint64_t value)
+{
+	gchar *full_key = g_strdup_printf("%s.%s", key, suffix);
+	gchar *str_value = g_strdup_printf("%" PRIu64, value);
+
+	g_key_file_set_value(key_file, group, full_key, str_value);
+	g_free(full_key);
+	g_free(str_value);
+}
+
+static
+int get_checkpoint_uint64(GKeyFile *key_file, const char *group,
+		const char *key, const char *suffix, uint64_t *value)
+{
+	int ret = 0;
+	gchar *full_key;
+	gchar *str_value;
+	gchar *endptr;
+
+	if (suffix) {
+		full_key = g_strdup_printf("%s.%s", key, suffix);
+	} else {
+		full_key = g_strdup(key);
+	}
+
+	str_value = g_key_file_get_value(key_file, group, full_key, NULL);
+	if (!str_value) {
+		ret = -1;
+		goto end;
+	}
+
+	*value = g_ascii_strtoull(str_value, &endptr, 10);
+	if (*endptr != '\0' || endptr == str_value) {
+		BT_LOGW("Invalid checkpoint value: group=\"%s\", key=\"%s\", "
+			"value=\"%s\"", group, full_key, str_value);
+		ret = -1;
+	}
+
+end:
+	g_free(full_key);
+	g_free(str_value);
+	return ret;
+}
+
+/*
+ * Writes the position of the last packet which began in each stream
+ * file group to the checkpoint state file.
+ *
+ * Those positions are only hints to avoid reading the packets from
+ * the beginning of their group when resuming: the sinks record the
+ * number of packets they completely wrote.
+ */
+static
+int write_checkpoint(struct ctf_fs_component *ctf_fs)
+{
+	int ret;
+	size_t i, j;
+	const char *group = get_checkpoint_group_name(ctf_fs);
+	GKeyFile *update = g_key_file_new();
+
+	if (!group || !update) {
+		ret = -1;
+		goto end;
+	}
+
+	for (i = 0; i < ctf_fs->traces->len; i++) {
+		struct ctf_fs_trace *ctf_fs_trace =
+			g_ptr_array_index(ctf_fs->traces, i);
+
+		for (j = 0; j < ctf_fs_trace->ds_file_groups->len; j++) {
+			struct ctf_fs_ds_file_group *ds_file_group =
+				g_ptr_array_index(
+					ctf_fs_trace->ds_file_groups, j);
+			struct ctf_fs_ds_file_group_pos *pos =
+				&ds_file_group->last_packet_pos;
+			gchar *key;
+
+			if (!ds_file_group->has_last_packet_pos) {
+				continue;
+			}
+
+			key = get_ds_file_group_checkpoint_key(ds_file_group);
+			set_checkpoint_uint64(update, group, key,
+				"packet-index", pos->packet_index);
+			set_checkpoint_uint64(update, group, key,
+				"file-index", pos->ds_file_info_index);
+			set_checkpoint_uint64(update, group, key,
+				"offset", (uint64_t) pos->offset);
+			g_free(key);
+		}
+	}
+
+	ret = bt_common_checkpoint_save(ctf_fs->options.checkpoint_path,
+		update);
+
+end:
+	if (ret) {
+		BT_LOGW("Cannot write checkpoint: path=\"%s\"",
+			ctf_fs->options.checkpoint_path);
+	}
+
+	if (update) {
+		g_key_file_free(update);
+	}
+
+	return ret;
+}
+
+static
+void notif_iter_data_packet_begins(
+		struct ctf_fs_notif_iter_data *notif_iter_data)
+{
+	struct ctf_fs_component *ctf_fs = notif_iter_data->ctf_fs;
+	struct ctf_fs_ds_file_group *ds_file_group =
+		notif_iter_data->ds_file_group;
+
+	ds_file_group->last_packet_pos.packet_index =
+		notif_iter_data->packet_index;
+	ds_file_group->last_packet_pos.ds_file_info_index =
+		notif_iter_data->ds_file_info_index;
+	ds_file_group->last_packet_pos.offset =
+		notif_iter_data->ds_file->cur_packet_offset;
+	ds_file_group->has_last_packet_pos = true;
+	notif_iter_data->packet_index++;
+
+	if (!ctf_fs->options.checkpoint_path) {
+		return;
+	}
+
+	ctf_fs->checkpoint_packet_count++;
+	if (ctf_fs->checkpoint_packet_count >=
+			ctf_fs->options.checkpoint_interval) {
+		/* A failed checkpoint does not stop the conversion. */
+		(void) write_checkpoint(ctf_fs);
+		ctf_fs->checkpoint_packet_count = 0;
+	}
+}
+
+/*
+ * Positions a new notification iterator on the first packet of its
+ * stream file group which the sinks did not completely write before
+ * the checkpoint, skipping the previous packets.
+ */
+static
+int notif_iter_data_resume(struct ctf_fs_notif_iter_data *notif_iter_data)
+{
+	int ret;
+	uint64_t target = 0;
+	uint64_t to_skip;
+	struct ctf_fs_ds_file_group_pos hint;
+	uint64_t hint_file_index, hint_offset;
+	struct ctf_fs_component *ctf_fs = notif_iter_data->ctf_fs;
+	struct ctf_fs_ds_file_group *ds_file_group =
+		notif_iter_data->ds_file_group;
+	const char *group = get_checkpoint_group_name(ctf_fs);
+	gchar *key = get_ds_file_group_checkpoint_key(ds_file_group);
+	bool use_hint = false;
+
+	(void) get_checkpoint_uint64(ctf_fs->resume_state,
+		BT_COMMON_CHECKPOINT_STREAMS_GROUP, key, NULL, &target);
+
+	if (group && target > 0 &&
+			!get_checkpoint_uint64(ctf_fs->resume_state, group, key,
+				"packet-index", &hint.packet_index) &&
+			!get_checkpoint_uint64(ctf_fs->resume_state, group, key,
+				"file-index", &hint_file_index) &&
+			!get_checkpoint_uint64(ctf_fs->resume_state, group, key,
+				"offset", &hint_offset)) {
+		/*
+		 * The hint can be more recent than what the sinks
+		 * wrote: only use it if it's not past the target.
+		 */
+		hint.ds_file_info_index = (size_t) hint_file_index;
+		hint.offset = (off_t) hint_offset;
+		use_hint = hint.packet_index <= target &&
+			hint_file_index < ds_file_group->ds_file_infos->len;
+	}
+
+	if (use_hint) {
+		notif_iter_data->ds_file_info_index = hint.ds_file_info_index;
+		notif_iter_data->packet_index = hint.packet_index;
+	}
+
+	ret = notif_iter_data_set_current_ds_file(notif_iter_data);
+	if (ret) {
+		goto end;
+	}
+
+	if (target == 0) {
+		goto end;
+	}
+
+	if (use_hint) {
+		ret = ctf_fs_ds_file_seek_packet(notif_iter_data->ds_file,
+			hint.offset);
+		if (ret) {
+			goto end;
+		}
+	}
+
+	BT_LOGI("Resuming stream file group: first-path=\"%s\", "
+		"packet-index=%" PRIu64 ", hint-packet-index=%" PRIu64,
+		((struct ctf_fs_ds_file_info *) g_ptr_array_index(
+			ds_file_group->ds_file_infos, 0))->path->str,
+		target, notif_iter_data->packet_index);
+	to_skip = target - notif_iter_data->packet_index;
+	ret = notif_iter_data_skip_packets(notif_iter_data, &to_skip);
+	if (ret) {
+		goto end;
+	}
+
+	notif_iter_data->packet_index = target - to_skip;
+	if (to_skip > 0) {
+		BT_LOGW("Checkpoint is past the end of the stream file group: "
+			"missing-packet-count=%" PRIu64, to_skip);
+	}
+
+end:
+	g_free(key);
 	return ret;
 }
 
@@ -88,6 +697,11 @@ void ctf_fs_notif_iter_data_destroy(
 	}
 
 	ctf_fs_ds_file_destroy(notif_iter_data->ds_file);
+
+	if (notif_iter_data->sample_rand) {
+		g_rand_free(notif_iter_data->sample_rand);
+	}
+
 	g_free(notif_iter_data);
 }
 
@@ -99,7 +713,26 @@ struct bt_notification_iterator_next_return ctf_fs_iterator_next(
 		bt_private_notification_iterator_get_user_data(iterator);
 	int ret;
 
-	assert(notif_iter_data->ds_file);
+	if (notif_iter_data->sample_skip_pending) {
+		notif_iter_data->sample_skip_pending = false;
+		ret = notif_iter_data_skip_sampled_out_packets(notif_iter_data);
+		if (ret) {
+			next_ret.status = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+			next_ret.notification = NULL;
+			goto end;
+		}
+	}
+
+	if (!notif_iter_data->ds_file) {
+		/*
+		 * Resumed or sampled after the last packet of the
+		 * group, or past the stream intersection.
+		 */
+		next_ret.status = BT_NOTIFICATION_ITERATOR_STATUS_END;
+		next_ret.notification = NULL;
+		goto end;
+	}
+
 	next_ret = ctf_fs_ds_file_next(notif_iter_data->ds_file);
 	if (next_ret.status == BT_NOTIFICATION_ITERATOR_STATUS_END) {
 		assert(!next_ret.notification);
@@ -137,6 +770,32 @@ struct bt_notification_iterator_next_return ctf_fs_iterator_next(
 		assert(next_ret.status != BT_NOTIFICATION_ITERATOR_STATUS_END);
 	}
 
+	if (next_ret.status == BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		switch (bt_notification_get_type(next_ret.notification)) {
+		case BT_NOTIFICATION_TYPE_PACKET_BEGIN:
+			if (notif_iter_data->ctf_fs->options.stream_intersection &&
+					packet_begins_after_intersection(
+						notif_iter_data,
+						next_ret.notification)) {
+				BT_PUT(next_ret.notification);
+				ctf_fs_ds_file_destroy(notif_iter_data->ds_file);
+				notif_iter_data->ds_file = NULL;
+				next_ret.status =
+					BT_NOTIFICATION_ITERATOR_STATUS_END;
+				break;
+			}
+
+			notif_iter_data_packet_begins(notif_iter_data);
+			break;
+		case BT_NOTIFICATION_TYPE_PACKET_END:
+			notif_iter_data->sample_skip_pending =
+				is_sampling(notif_iter_data->ctf_fs);
+			break;
+		default:
+			break;
+		}
+	}
+
 end:
 	return next_ret;
 }
@@ -171,13 +830,46 @@ enum bt_notification_iterator_status ctf_fs_iterator_init(
 		goto error;
 	}
 
+	notif_iter_data->ctf_fs = port_data->ctf_fs;
 	notif_iter_data->ds_file_group = port_data->ds_file_group;
-	iret = notif_iter_data_set_current_ds_file(notif_iter_data);
+	set_mmap_pool_graph(port_data->ctf_fs);
+
+	if (port_data->ctf_fs->resume_state) {
+		iret = notif_iter_data_resume(notif_iter_data);
+	} else {
+		iret = notif_iter_data_set_current_ds_file(notif_iter_data);
+	}
+
+	if (!iret && port_data->ctf_fs->options.stream_intersection) {
+		iret = notif_iter_data_seek_intersection(notif_iter_data);
+	}
+
 	if (iret) {
 		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
 		goto error;
 	}
 
+	if (port_data->ctf_fs->options.sample_ratio > 0) {
+		struct ctf_fs_ds_file_info *first_ds_file_info =
+			g_ptr_array_index(
+				port_data->ds_file_group->ds_file_infos, 0);
+
+		/*
+		 * Different, but reproducible, selections for the
+		 * different stream file groups.
+		 */
+		notif_iter_data->sample_rand = g_rand_new_with_seed(
+			(guint32) port_data->ctf_fs->options.sample_seed ^
+			g_str_hash(first_ds_file_info->path->str));
+		if (!notif_iter_data->sample_rand) {
+			ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+			goto error;
+		}
+
+		/* The first packet can also be sampled out. */
+		notif_iter_data->sample_skip_pending = true;
+	}
+
 	ret = bt_private_notification_iterator_set_user_data(it, notif_iter_data);
 	if (ret) {
 		goto error;
@@ -213,6 +905,12 @@ void ctf_fs_destroy(struct ctf_fs_component *ctf_fs)
 		g_ptr_array_free(ctf_fs->port_data, TRUE);
 	}
 
+	if (ctf_fs->resume_state) {
+		g_key_file_free(ctf_fs->resume_state);
+	}
+
+	g_free(ctf_fs->options.ir_cache_dir);
+	g_free(ctf_fs->options.checkpoint_path);
 	g_free(ctf_fs);
 }
 
@@ -301,6 +999,7 @@ int create_one_port_for_trace(struct ctf_fs_component *ctf_fs,
 		goto error;
 	}
 
+	port_data->ctf_fs = ctf_fs;
 	port_data->ds_file_group = ds_file_group;
 	ret = bt_private_component_source_add_output_private_port(
 		ctf_fs->priv_comp, port_name->str, port_data, NULL);
@@ -422,65 +1121,6 @@ end:
 	return stream_class;
 }
 
-uint64_t get_packet_context_timestamp_begin_ns(
-		struct ctf_fs_trace *ctf_fs_trace,
-		struct bt_ctf_field *packet_context_field)
-{
-	int ret;
-	struct bt_ctf_field *timestamp_begin_field = NULL;
-	struct bt_ctf_field_type *timestamp_begin_ft = NULL;
-	uint64_t timestamp_begin_raw_value = -1ULL;
-	uint64_t timestamp_begin_ns = -1ULL;
-	int64_t timestamp_begin_ns_signed;
-	struct bt_ctf_clock_class *timestamp_begin_clock_class = NULL;
-	struct bt_ctf_clock_value *clock_value = NULL;
-
-	if (!packet_context_field) {
-		goto end;
-	}
-
-	timestamp_begin_field = bt_ctf_field_structure_get_field_by_name(
-		packet_context_field, "timestamp_begin");
-	if (!timestamp_begin_field) {
-		goto end;
-	}
-
-	timestamp_begin_ft = bt_ctf_field_get_type(timestamp_begin_field);
-	assert(timestamp_begin_ft);
-	timestamp_begin_clock_class =
-		bt_ctf_field_type_integer_get_mapped_clock_class(timestamp_begin_ft);
-	if (!timestamp_begin_clock_class) {
-		goto end;
-	}
-
-	ret = bt_ctf_field_unsigned_integer_get_value(timestamp_begin_field,
-		&timestamp_begin_raw_value);
-	if (ret) {
-		goto end;
-	}
-
-	clock_value = bt_ctf_clock_value_create(timestamp_begin_clock_class,
-		timestamp_begin_raw_value);
-	if (!clock_value) {
-		goto end;
-	}
-
-	ret = bt_ctf_clock_value_get_value_ns_from_epoch(clock_value,
-		&timestamp_begin_ns_signed);
-	if (ret) {
-		goto end;
-	}
-
-	timestamp_begin_ns = (uint64_t) timestamp_begin_ns_signed;
-
-end:
-	bt_put(timestamp_begin_field);
-	bt_put(timestamp_begin_ft);
-	bt_put(timestamp_begin_clock_class);
-	bt_put(clock_value);
-	return timestamp_begin_ns;
-}
-
 static
 void ctf_fs_ds_file_info_destroy(struct ctf_fs_ds_file_info *ds_file_info)
 {
@@ -498,7 +1138,7 @@ void ctf_fs_ds_file_info_destroy(struct ctf_fs_ds_file_info *ds_file_info)
 
 static
 struct ctf_fs_ds_file_info *ctf_fs_ds_file_info_create(const char *path,
-		uint64_t begin_ns, struct ctf_fs_ds_index *index)
+		uint64_t begin_ns)
 {
 	struct ctf_fs_ds_file_info *ds_file_info;
 
@@ -515,11 +1155,8 @@ struct ctf_fs_ds_file_info *ctf_fs_ds_file_info_create(const char *path,
 	}
 
 	ds_file_info->begin_ns = begin_ns;
-	ds_file_info->index = index;
-	index = NULL;
 
 end:
-	ctf_fs_ds_index_destroy(index);
 	return ds_file_info;
 }
 
@@ -542,7 +1179,7 @@ static
 struct ctf_fs_ds_file_group *ctf_fs_ds_file_group_create(
 		struct ctf_fs_trace *ctf_fs_trace,
 		struct bt_ctf_stream_class *stream_class,
-		uint64_t stream_instance_id)
+		uint64_t stream_instance_id, const char *stream_name)
 {
 	struct ctf_fs_ds_file_group *ds_file_group;
 
@@ -560,7 +1197,7 @@ struct ctf_fs_ds_file_group *ctf_fs_ds_file_group_create(
 
 	if (stream_instance_id == -1ULL) {
 		ds_file_group->stream = bt_ctf_stream_create(
-			stream_class, NULL);
+			stream_class, stream_name);
 	} else {
 		ds_file_group->stream = bt_ctf_stream_create_with_id(
 			stream_class, NULL, stream_instance_id);
@@ -585,16 +1222,13 @@ end:
 static
 int ctf_fs_ds_file_group_add_ds_file_info(
 		struct ctf_fs_ds_file_group *ds_file_group,
-		const char *path, uint64_t begin_ns,
-		struct ctf_fs_ds_index *index)
+		const char *path, uint64_t begin_ns)
 {
 	struct ctf_fs_ds_file_info *ds_file_info;
 	gint i = 0;
 	int ret = 0;
 
-	/* Onwership of index is transferred. */
-	ds_file_info = ctf_fs_ds_file_info_create(path, begin_ns, index);
-	index = NULL;
+	ds_file_info = ctf_fs_ds_file_info_create(path, begin_ns);
 	if (!ds_file_info) {
 		goto error;
 	}
@@ -604,24 +1238,66 @@ int ctf_fs_ds_file_group_add_ds_file_info(
 		struct ctf_fs_ds_file_info *other_ds_file_info =
 			g_ptr_array_index(ds_file_group->ds_file_infos, i);
 
-		if (begin_ns < other_ds_file_info->begin_ns) {
-			break;
-		}
+		if (begin_ns < other_ds_file_info->begin_ns) {
+			break;
+		}
+	}
+
+	if (i == ds_file_group->ds_file_infos->len) {
+		/* Append instead */
+		i = -1;
+	}
+
+	g_ptr_array_insert(ds_file_group->ds_file_infos, i, ds_file_info);
+	ds_file_info = NULL;
+	goto end;
+
+error:
+	ctf_fs_ds_file_info_destroy(ds_file_info);
+	ret = -1;
+end:
+	return ret;
+}
+
+BT_HIDDEN
+int ctf_fs_ds_file_group_get_range_ns(
+		struct ctf_fs_ds_file_group *ds_file_group,
+		int64_t *begin_ns, int64_t *end_ns)
+{
+	int ret = 0;
+	int64_t last_begin_ns;
+	struct ctf_fs_ds_file *ds_file;
+	struct ctf_fs_ds_file_info *first_info;
+	struct ctf_fs_ds_file_info *last_info;
+
+	assert(ds_file_group->ds_file_infos->len > 0);
+	first_info = g_ptr_array_index(ds_file_group->ds_file_infos, 0);
+	last_info = g_ptr_array_index(ds_file_group->ds_file_infos,
+		ds_file_group->ds_file_infos->len - 1);
+
+	ds_file = ctf_fs_ds_file_create(ds_file_group->ctf_fs_trace, NULL,
+		last_info->path->str);
+	if (!ds_file) {
+		ret = -1;
+		goto end;
 	}
 
-	if (i == ds_file_group->ds_file_infos->len) {
-		/* Append instead */
-		i = -1;
+	ret = ctf_fs_ds_file_get_range_ns(ds_file, &last_begin_ns, end_ns);
+	ctf_fs_ds_file_destroy(ds_file);
+	if (ret) {
+		goto end;
 	}
 
-	g_ptr_array_insert(ds_file_group->ds_file_infos, i, ds_file_info);
-	ds_file_info = NULL;
-	goto end;
+	/*
+	 * A stream file without a beginning time is alone in its
+	 * group: its range is the one which was just read.
+	 */
+	if (first_info->begin_ns == -1ULL) {
+		*begin_ns = last_begin_ns;
+	} else {
+		*begin_ns = (int64_t) first_info->begin_ns;
+	}
 
-error:
-	ctf_fs_ds_file_info_destroy(ds_file_info);
-	ctf_fs_ds_index_destroy(index);
-	ret = -1;
 end:
 	return ret;
 }
@@ -640,7 +1316,6 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 	int ret;
 	size_t i;
 	struct ctf_fs_ds_file *ds_file;
-	struct ctf_fs_ds_index *index = NULL;
 
 	ds_file = ctf_fs_ds_file_create(ctf_fs_trace, NULL, path);
 	if (!ds_file) {
@@ -665,11 +1340,12 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		goto error;
 	}
 
-	index = ctf_fs_ds_file_build_index(ds_file);
-	if (!index) {
-		BT_LOGW("Failed to index CTF stream file \'%s\'",
-			ds_file->file->path->str);
-	}
+	/*
+	 * Stream files are not indexed here: reading the complete
+	 * index of every stream file is needlessly expensive for large
+	 * traces. Users which need a stream file's range get it with
+	 * ctf_fs_ds_file_get_range_ns() instead.
+	 */
 
 	if (begin_ns == -1ULL) {
 		/*
@@ -689,16 +1365,21 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 		 * group.
 		 */
 
+		gchar *stream_name = g_path_get_basename(path);
+
+		/*
+		 * Name the stream after its file to distinguish it
+		 * from the other streams without an ID (checkpoints).
+		 */
 		ds_file_group = ctf_fs_ds_file_group_create(ctf_fs_trace,
-			stream_class, stream_instance_id);
+			stream_class, stream_instance_id, stream_name);
+		g_free(stream_name);
 		if (!ds_file_group) {
 			goto error;
 		}
 
 		ret = ctf_fs_ds_file_group_add_ds_file_info(ds_file_group,
-				path, begin_ns, index);
-		/* Ownership of index is transferred. */
-		index = NULL;
+				path, begin_ns);
 		if (ret) {
 			goto error;
 		}
@@ -734,7 +1415,7 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 
 	if (!ds_file_group) {
 		ds_file_group = ctf_fs_ds_file_group_create(ctf_fs_trace,
-			stream_class, stream_instance_id);
+			stream_class, stream_instance_id, NULL);
 		if (!ds_file_group) {
 			goto error;
 		}
@@ -743,8 +1424,7 @@ int add_ds_file_to_ds_file_group(struct ctf_fs_trace *ctf_fs_trace,
 	}
 
 	ret = ctf_fs_ds_file_group_add_ds_file_info(ds_file_group,
-			path, begin_ns, index);
-	index = NULL;
+			path, begin_ns);
 	if (ret) {
 		goto error;
 	}
@@ -760,7 +1440,6 @@ end:
 		g_ptr_array_add(ctf_fs_trace->ds_file_groups, ds_file_group);
 	}
 	ctf_fs_ds_file_destroy(ds_file);
-	ctf_fs_ds_index_destroy(index);
 	bt_put(packet_header_field);
 	bt_put(packet_context_field);
 	bt_put(stream_class);
@@ -819,9 +1498,10 @@ int create_ds_file_groups(struct ctf_fs_trace *ctf_fs_trace)
 			continue;
 		}
 
-		ret = ctf_fs_file_open(file, "rb");
+		ret = ctf_fs_file_stat(file);
 		if (ret) {
-			BT_LOGE("Cannot open stream file `%s`", file->path->str);
+			BT_LOGE("Cannot get size of stream file `%s`",
+				file->path->str);
 			goto error;
 		}
 
@@ -947,13 +1627,6 @@ struct ctf_fs_trace *ctf_fs_trace_create(const char *path, const char *name,
 		goto error;
 	}
 
-	/*
-	 * create_ds_file_groups() created all the streams that this
-	 * trace needs. There won't be any more. Therefore it is safe to
-	 * make this trace static.
-	 */
-	(void) bt_ctf_trace_set_is_static(ctf_fs_trace->metadata->trace);
-
 	goto end;
 
 error:
@@ -1141,6 +1814,53 @@ GList *ctf_fs_create_trace_names(GList *trace_paths, const char *base_path) {
 	return trace_names;
 }
 
+/*
+ * Records, in the environment of the CTF IR trace of `ctf_fs_trace`,
+ * the ratio of its packets which this component decodes.
+ */
+static
+int set_trace_sampling_ratio(struct ctf_fs_component *ctf_fs,
+		struct ctf_fs_trace *ctf_fs_trace)
+{
+	int ret = 0;
+	struct bt_ctf_trace *trace = ctf_fs_trace->metadata->trace;
+	struct bt_value *value;
+	gchar *ratio;
+	char ratio_buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+	if (!is_sampling(ctf_fs)) {
+		goto end;
+	}
+
+	value = bt_ctf_trace_get_environment_field_value_by_name(trace,
+		"sampling_ratio");
+	if (value) {
+		/* Already sampled by its producer */
+		bt_put(value);
+		goto end;
+	}
+
+	if (ctf_fs->options.sample_every > 0) {
+		ratio = g_strdup_printf("1/%" PRIu64,
+			ctf_fs->options.sample_every);
+	} else {
+		ratio = g_strdup(g_ascii_dtostr(ratio_buf, sizeof(ratio_buf),
+			ctf_fs->options.sample_ratio));
+	}
+
+	ret = bt_ctf_trace_set_environment_field_string(trace,
+		"sampling_ratio", ratio);
+	if (ret) {
+		BT_LOGE("Cannot set trace's sampling ratio: path=\"%s\", "
+			"ratio=\"%s\"", ctf_fs_trace->path->str, ratio);
+	}
+
+	g_free(ratio);
+
+end:
+	return ret;
+}
+
 static
 int create_ctf_fs_traces(struct ctf_fs_component *ctf_fs,
 		const char *path_param)
@@ -1155,8 +1875,23 @@ int create_ctf_fs_traces(struct ctf_fs_component *ctf_fs,
 	struct metadata_overrides metadata_overrides = {
 		.clock_offset_s = ctf_fs->options.clock_offset,
 		.clock_offset_ns = ctf_fs->options.clock_offset_ns,
+		.ir_cache_dir = ctf_fs->options.ir_cache_dir,
 	};
 
+	if (ctf_fs->options.share_metadata) {
+		/*
+		 * Only needed while creating the traces: each trace
+		 * has its own CTF IR trace, which keeps the shared
+		 * field types alive.
+		 */
+		metadata_overrides.shared_metadata = g_hash_table_new_full(
+			g_str_hash, g_str_equal, g_free,
+			(GDestroyNotify) bt_put);
+		if (!metadata_overrides.shared_metadata) {
+			goto error;
+		}
+	}
+
 	norm_path = bt_common_normalize_path(path_param, NULL);
 	if (!norm_path) {
 		BT_LOGE("Failed to normalize path: `%s`.",
@@ -1195,6 +1930,19 @@ int create_ctf_fs_traces(struct ctf_fs_component *ctf_fs,
 			goto error;
 		}
 
+		ret = set_trace_sampling_ratio(ctf_fs, ctf_fs_trace);
+		if (ret) {
+			goto error;
+		}
+
+		/*
+		 * ctf_fs_trace_create() created all the streams that
+		 * this trace needs. There won't be any more. Therefore
+		 * it is safe to make this trace static.
+		 */
+		(void) bt_ctf_trace_set_is_static(
+			ctf_fs_trace->metadata->trace);
+
 		ret = create_ports_for_trace(ctf_fs, ctf_fs_trace);
 		if (ret) {
 			goto error;
@@ -1235,6 +1983,181 @@ end:
 		g_string_free(norm_path, TRUE);
 	}
 
+	if (metadata_overrides.shared_metadata) {
+		g_hash_table_destroy(metadata_overrides.shared_metadata);
+	}
+
+	return ret;
+}
+
+static
+int parse_checkpoint_params(struct ctf_fs_component *ctf_fs,
+		struct bt_value *params)
+{
+	int ret = 0;
+	struct bt_value *value = NULL;
+	const char *checkpoint_path;
+	int64_t interval = 1;
+	bt_bool resume = BT_FALSE;
+
+	value = bt_value_map_get(params, "checkpoint-path");
+	if (!value) {
+		goto end;
+	}
+
+	if (!bt_value_is_string(value)) {
+		BT_LOGE("checkpoint-path should be a string");
+		goto error;
+	}
+
+	ret = bt_value_string_get(value, &checkpoint_path);
+	assert(ret == 0);
+	BT_PUT(value);
+
+	value = bt_value_map_get(params, "checkpoint-interval");
+	if (value) {
+		if (!bt_value_is_integer(value)) {
+			BT_LOGE("checkpoint-interval should be an integer");
+			goto error;
+		}
+
+		ret = bt_value_integer_get(value, &interval);
+		assert(ret == 0);
+		if (interval <= 0) {
+			BT_LOGE("checkpoint-interval should be greater than 0");
+			goto error;
+		}
+
+		BT_PUT(value);
+	}
+
+	value = bt_value_map_get(params, "resume");
+	if (value) {
+		if (!bt_value_is_bool(value)) {
+			BT_LOGE("resume should be a boolean");
+			goto error;
+		}
+
+		ret = bt_value_bool_get(value, &resume);
+		assert(ret == 0);
+		BT_PUT(value);
+	}
+
+	if (!get_checkpoint_group_name(ctf_fs)) {
+		BT_LOGE_STR("Cannot write checkpoints for an unnamed component");
+		goto error;
+	}
+
+	ctf_fs->options.checkpoint_path = g_strdup(checkpoint_path);
+	ctf_fs->options.checkpoint_interval = (uint64_t) interval;
+	ctf_fs->options.resume = resume;
+
+	if (resume) {
+		ctf_fs->resume_state = bt_common_checkpoint_load(
+			checkpoint_path);
+		if (!ctf_fs->resume_state) {
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	bt_put(value);
+	return ret;
+}
+
+static
+int parse_sampling_params(struct ctf_fs_component *ctf_fs,
+		struct bt_value *params)
+{
+	int ret = 0;
+	struct bt_value *value = NULL;
+
+	value = bt_value_map_get(params, "sample-every");
+	if (value) {
+		int64_t every;
+
+		if (!bt_value_is_integer(value)) {
+			BT_LOGE("sample-every should be an integer");
+			goto error;
+		}
+
+		ret = bt_value_integer_get(value, &every);
+		assert(ret == 0);
+		if (every <= 0) {
+			BT_LOGE("sample-every should be greater than 0");
+			goto error;
+		}
+
+		ctf_fs->options.sample_every = (uint64_t) every;
+		BT_PUT(value);
+	}
+
+	value = bt_value_map_get(params, "sample-percent");
+	if (value) {
+		double percent;
+
+		if (bt_value_is_integer(value)) {
+			int64_t int_percent;
+
+			ret = bt_value_integer_get(value, &int_percent);
+			assert(ret == 0);
+			percent = (double) int_percent;
+		} else if (bt_value_is_float(value)) {
+			ret = bt_value_float_get(value, &percent);
+			assert(ret == 0);
+		} else {
+			BT_LOGE("sample-percent should be a number");
+			goto error;
+		}
+
+		if (percent <= 0 || percent > 100) {
+			BT_LOGE("sample-percent should be in ]0, 100]");
+			goto error;
+		}
+
+		ctf_fs->options.sample_ratio = percent / 100;
+		BT_PUT(value);
+	}
+
+	value = bt_value_map_get(params, "sample-seed");
+	if (value) {
+		int64_t seed;
+
+		if (!bt_value_is_integer(value)) {
+			BT_LOGE("sample-seed should be an integer");
+			goto error;
+		}
+
+		ret = bt_value_integer_get(value, &seed);
+		assert(ret == 0);
+		ctf_fs->options.sample_seed = (uint64_t) seed;
+		BT_PUT(value);
+	}
+
+	if (ctf_fs->options.sample_every > 0 &&
+			ctf_fs->options.sample_ratio > 0) {
+		BT_LOGE_STR("sample-every and sample-percent are mutually exclusive");
+		goto error;
+	}
+
+	if (is_sampling(ctf_fs) && ctf_fs->options.checkpoint_path) {
+		/* Checkpoints count all the packets of each stream. */
+		BT_LOGE_STR("Cannot sample packets with checkpoints");
+		goto error;
+	}
+
+	goto end;
+
+error:
+	ret = -1;
+
+end:
+	bt_put(value);
 	return ret;
 }
 
@@ -1252,6 +2175,11 @@ struct ctf_fs_component *ctf_fs_create(struct bt_private_component *priv_comp,
 		goto end;
 	}
 
+	g_queue_init(&ctf_fs->mmap_pool.lru);
+	g_queue_init(&ctf_fs->mmap_pool.open_lru);
+	ctf_fs->mmap_pool.max_open_files = CTF_FS_DEFAULT_MAX_OPEN_FILES;
+	ctf_fs->mmap_pool.advise = true;
+
 	ret = bt_private_component_set_user_data(priv_comp, ctf_fs);
 	assert(ret == 0);
 
@@ -1297,6 +2225,131 @@ struct ctf_fs_component *ctf_fs_create(struct bt_private_component *priv_comp,
 		BT_PUT(value);
 	}
 
+	value = bt_value_map_get(params, "ir-cache-dir");
+	if (value) {
+		const char *ir_cache_dir;
+
+		if (!bt_value_is_string(value)) {
+			BT_LOGE("ir-cache-dir should be a string");
+			goto error;
+		}
+		ret = bt_value_string_get(value, &ir_cache_dir);
+		assert(ret == 0);
+		ctf_fs->options.ir_cache_dir = g_strdup(ir_cache_dir);
+		BT_PUT(value);
+	}
+
+	value = bt_value_map_get(params, "share-metadata");
+	if (value) {
+		bt_bool share_metadata;
+
+		if (!bt_value_is_bool(value)) {
+			BT_LOGE("share-metadata should be a boolean");
+			goto error;
+		}
+
+		ret = bt_value_bool_get(value, &share_metadata);
+		assert(ret == 0);
+		ctf_fs->options.share_metadata = share_metadata;
+		BT_PUT(value);
+	}
+
+	value = bt_value_map_get(params, "max-open-files");
+	if (value) {
+		int64_t max_open_files;
+
+		if (!bt_value_is_integer(value)) {
+			BT_LOGE("max-open-files should be an integer");
+			goto error;
+		}
+
+		ret = bt_value_integer_get(value, &max_open_files);
+		assert(ret == 0);
+		if (max_open_files < 0) {
+			BT_LOGE("max-open-files should be positive or 0 "
+				"(no maximum): value=%" PRId64, max_open_files);
+			goto error;
+		}
+
+		ctf_fs->mmap_pool.max_open_files = (uint64_t) max_open_files;
+		BT_PUT(value);
+	}
+
+	value = bt_value_map_get(params, "mmap-window-size");
+	if (value) {
+		int64_t window_size;
+
+		if (!bt_value_is_integer(value)) {
+			BT_LOGE("mmap-window-size should be an integer");
+			goto error;
+		}
+
+		ret = bt_value_integer_get(value, &window_size);
+		assert(ret == 0);
+		if (window_size < -1 || (window_size > 0 &&
+				(uint64_t) window_size >= SIZE_MAX)) {
+			BT_LOGE("mmap-window-size should be a size in bytes, "
+				"0 (default), or -1 (whole file): "
+				"value=%" PRId64, window_size);
+			goto error;
+		}
+
+		/* Map the rest of each file at once */
+		if (window_size == -1) {
+			ctf_fs->mmap_pool.window_len = SIZE_MAX;
+		} else {
+			ctf_fs->mmap_pool.window_len = (size_t) window_size;
+		}
+		BT_PUT(value);
+	}
+
+	value = bt_value_map_get(params, "mmap-advise");
+	if (value) {
+		bt_bool advise;
+
+		if (!bt_value_is_bool(value)) {
+			BT_LOGE("mmap-advise should be a boolean");
+			goto error;
+		}
+
+		ret = bt_value_bool_get(value, &advise);
+		assert(ret == 0);
+		ctf_fs->mmap_pool.advise = advise;
+		BT_PUT(value);
+	}
+
+	ret = parse_checkpoint_params(ctf_fs, params);
+	if (ret) {
+		goto error;
+	}
+
+	ret = parse_sampling_params(ctf_fs, params);
+	if (ret) {
+		goto error;
+	}
+
+	value = bt_value_map_get(params, "stream-intersection");
+	if (value) {
+		bt_bool stream_intersection;
+
+		if (!bt_value_is_bool(value)) {
+			BT_LOGE("stream-intersection should be a boolean");
+			goto error;
+		}
+
+		ret = bt_value_bool_get(value, &stream_intersection);
+		assert(ret == 0);
+		ctf_fs->options.stream_intersection = stream_intersection;
+		BT_PUT(value);
+	}
+
+	if (ctf_fs->options.stream_intersection &&
+			ctf_fs->options.checkpoint_path) {
+		/* Checkpoints count all the packets of each stream. */
+		BT_LOGE_STR("Cannot apply the stream intersection with checkpoints");
+		goto error;
+	}
+
 	ctf_fs->port_data = g_ptr_array_new_with_free_func(port_data_destroy);
 	if (!ctf_fs->port_data) {
 		goto error;
@@ -1352,6 +2405,9 @@ struct bt_value *ctf_fs_query(struct bt_component_class *comp_class,
 		result = metadata_info_query(comp_class, params);
 	} else if (!strcmp(object, "trace-info")) {
 		result = trace_info_query(comp_class, params);
+	} else if (!strcmp(object, "checkpoint-support")) {
+		/* See the `checkpoint-path` and `resume` parameters */
+		result = bt_value_bool_create_init(BT_TRUE);
 	} else {
 		BT_LOGE("Unknown query object `%s`", object);
 		goto end;
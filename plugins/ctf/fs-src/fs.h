@@ -63,6 +63,40 @@ struct ctf_fs_metadata {
 struct ctf_fs_component_options {
 	int64_t clock_offset;
 	int64_t clock_offset_ns;
+
+	/* Owned by this, `NULL` if the CTF IR cache is disabled */
+	char *ir_cache_dir;
+
+	/*
+	 * Decode identical metadata only once, sharing its field types
+	 * between traces (see `struct metadata_overrides`)
+	 */
+	bool share_metadata;
+
+	/* Owned by this, `NULL` if checkpoints are disabled */
+	char *checkpoint_path;
+
+	/* Number of packets between two checkpoints */
+	uint64_t checkpoint_interval;
+
+	/* Resume from the checkpoint state file */
+	bool resume;
+
+	/* Only decode one packet out of `sample_every` (0: disabled) */
+	uint64_t sample_every;
+
+	/*
+	 * Probability, in ]0, 1], to decode each packet (0: disabled),
+	 * and seed of the pseudorandom packet selection.
+	 */
+	double sample_ratio;
+	uint64_t sample_seed;
+
+	/*
+	 * Only decode the packets which intersect with the time range
+	 * during which all the streams of their trace are active.
+	 */
+	bool stream_intersection;
 };
 
 struct ctf_fs_component {
@@ -75,9 +109,34 @@ struct ctf_fs_component {
 	/* Array of struct ctf_fs_trace *, owned by this */
 	GPtrArray *traces;
 
+	/* Owned by this, `NULL` if not resuming */
+	GKeyFile *resume_state;
+
+	/* Packets which began since the last checkpoint */
+	uint64_t checkpoint_packet_count;
+
+	/* Open files and current mappings of the data stream files */
+	struct ctf_fs_ds_mmap_pool mmap_pool;
+
 	struct ctf_fs_component_options options;
 };
 
+/*
+ * Intersection of the time ranges of the stream file groups of a
+ * trace.
+ */
+struct ctf_fs_trace_intersection {
+	/* True once computed (on first use) */
+	bool is_computed;
+
+	/* False if no stream file group has a known time range */
+	bool is_set;
+
+	/* ns since EPOCH; empty if `begin_ns` > `end_ns` */
+	int64_t begin_ns;
+	int64_t end_ns;
+};
+
 struct ctf_fs_trace {
 	/* Owned by this */
 	struct ctf_fs_metadata *metadata;
@@ -93,6 +152,22 @@ struct ctf_fs_trace {
 
 	/* Owned by this */
 	GString *name;
+
+	struct ctf_fs_trace_intersection intersection;
+};
+
+/*
+ * Position of a packet within a stream file group.
+ */
+struct ctf_fs_ds_file_group_pos {
+	/* Index of the packet within the group (all files) */
+	uint64_t packet_index;
+
+	/* Index of the stream file within the group */
+	size_t ds_file_info_index;
+
+	/* Offset (bytes) of the packet within its stream file */
+	off_t offset;
 };
 
 struct ctf_fs_ds_file_group {
@@ -112,14 +187,27 @@ struct ctf_fs_ds_file_group {
 
 	/* Weak, belongs to component */
 	struct ctf_fs_trace *ctf_fs_trace;
+
+	/*
+	 * Position of the last packet which began, recorded in
+	 * checkpoints; valid if `has_last_packet_pos` is true.
+	 */
+	struct ctf_fs_ds_file_group_pos last_packet_pos;
+	bool has_last_packet_pos;
 };
 
 struct ctf_fs_port_data {
+	/* Weak, guaranteed to exist */
+	struct ctf_fs_component *ctf_fs;
+
 	/* Weak, belongs to ctf_fs_trace */
 	struct ctf_fs_ds_file_group *ds_file_group;
 };
 
 struct ctf_fs_notif_iter_data {
+	/* Weak, guaranteed to exist */
+	struct ctf_fs_component *ctf_fs;
+
 	/* Weak, belongs to ctf_fs_trace */
 	struct ctf_fs_ds_file_group *ds_file_group;
 
@@ -128,6 +216,15 @@ struct ctf_fs_notif_iter_data {
 
 	/* Which file the iterator is _currently_ operating on */
 	size_t ds_file_info_index;
+
+	/* Index, within the group, of the next packet to begin */
+	uint64_t packet_index;
+
+	/* Owned by this, `NULL` if not sampling packets randomly */
+	GRand *sample_rand;
+
+	/* Packets to skip before decoding the next one (sampling) */
+	bool sample_skip_pending;
 };
 
 BT_HIDDEN
@@ -148,6 +245,17 @@ struct ctf_fs_trace *ctf_fs_trace_create(const char *path, const char *name,
 BT_HIDDEN
 void ctf_fs_trace_destroy(struct ctf_fs_trace *trace);
 
+/*
+ * Gets the time range (ns since EPOCH) of a stream file group from the
+ * beginning time of its first stream file and from the range of its
+ * last stream file (see ctf_fs_ds_file_get_range_ns()), without
+ * reading the other stream files.
+ */
+BT_HIDDEN
+int ctf_fs_ds_file_group_get_range_ns(
+		struct ctf_fs_ds_file_group *ds_file_group,
+		int64_t *begin_ns, int64_t *end_ns);
+
 BT_HIDDEN
 int ctf_fs_find_traces(GList **trace_paths, const char *start_path);
 
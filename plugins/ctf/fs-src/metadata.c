@@ -36,6 +36,7 @@
 #include "file.h"
 #include "metadata.h"
 #include "../common/metadata/decoder.h"
+#include "../common/metadata/ir-cache.h"
 
 #define BT_LOG_TAG "PLUGIN-CTF-FS-METADATA-SRC"
 #include "logging.h"
@@ -105,6 +106,12 @@ int ctf_fs_metadata_set_trace(struct ctf_fs_trace *ctf_fs_trace,
 	struct ctf_fs_file *file = NULL;
 	struct ctf_metadata_decoder *metadata_decoder = NULL;
 	int64_t clock_offset_adjustment = 0;
+	const char *ir_cache_dir = NULL;
+	GHashTable *shared_metadata = NULL;
+	gchar *metadata_key = NULL;
+	gchar *contents = NULL;
+	gsize len;
+	FILE *fp;
 
 	file = get_file(ctf_fs_trace->path->str);
 	if (!file) {
@@ -113,11 +120,63 @@ int ctf_fs_metadata_set_trace(struct ctf_fs_trace *ctf_fs_trace,
 		goto end;
 	}
 
+	fp = file->fp;
+
 	if (overrides) {
 		clock_offset_adjustment =
 			overrides->clock_offset_s * NSEC_PER_SEC +
 			overrides->clock_offset_ns;
+		ir_cache_dir = overrides->ir_cache_dir;
+		shared_metadata = overrides->shared_metadata;
+	}
+
+	if (ir_cache_dir || shared_metadata) {
+		/*
+		 * The key is computed from the complete file contents:
+		 * read them once and decode them from memory on a cache
+		 * miss instead of reading the file again.
+		 */
+		if (g_file_get_contents(file->path->str, &contents, &len,
+				NULL)) {
+			metadata_key = ctf_metadata_ir_cache_get_key(contents,
+				len, clock_offset_adjustment);
+		} else {
+			BT_LOGW("Cannot read metadata file \"%s\"",
+				file->path->str);
+		}
+	}
+
+	if (metadata_key && shared_metadata) {
+		struct bt_ctf_trace *shared_trace =
+			g_hash_table_lookup(shared_metadata, metadata_key);
+
+		if (shared_trace) {
+			/*
+			 * Each trace has its own CTF IR trace: the same
+			 * stream IDs can exist in many trace directories
+			 * (rotated chunks, for example), and each one
+			 * keeps its own name. Only the field types and
+			 * clock classes are shared.
+			 */
+			ctf_fs_trace->metadata->trace =
+				ctf_metadata_ir_cache_share(shared_trace,
+					ctf_fs_trace->name->str);
+			if (ctf_fs_trace->metadata->trace) {
+				BT_LOGD("Created CTF IR trace sharing the field types of identical decoded metadata: "
+					"path=\"%s\"", ctf_fs_trace->path->str);
+				goto end;
+			}
+		}
 	}
+
+	if (metadata_key && ir_cache_dir) {
+		ctf_fs_trace->metadata->trace = ctf_metadata_ir_cache_load(
+			ir_cache_dir, metadata_key, ctf_fs_trace->name->str);
+		if (ctf_fs_trace->metadata->trace) {
+			goto share;
+		}
+	}
+
 	metadata_decoder = ctf_metadata_decoder_create(clock_offset_adjustment,
 		ctf_fs_trace->name->str);
 	if (!metadata_decoder) {
@@ -126,7 +185,21 @@ int ctf_fs_metadata_set_trace(struct ctf_fs_trace *ctf_fs_trace,
 		goto end;
 	}
 
-	ret = ctf_metadata_decoder_decode(metadata_decoder, file->fp);
+	if (contents) {
+		fp = bt_fmemopen(contents, len, "rb");
+		if (!fp) {
+			BT_LOGE("Cannot open memory stream of metadata file \"%s\"",
+				file->path->str);
+			ret = -1;
+			goto end;
+		}
+	}
+
+	ret = ctf_metadata_decoder_decode(metadata_decoder, fp);
+	if (fp != file->fp) {
+		fclose(fp);
+	}
+
 	if (ret) {
 		BT_LOGE("Cannot decode metadata file");
 		goto end;
@@ -136,7 +209,24 @@ int ctf_fs_metadata_set_trace(struct ctf_fs_trace *ctf_fs_trace,
 		metadata_decoder);
 	assert(ctf_fs_trace->metadata->trace);
 
+	if (metadata_key && ir_cache_dir) {
+		/* Failing to populate the cache is not fatal */
+		(void) ctf_metadata_ir_cache_store(ir_cache_dir, metadata_key,
+			ctf_fs_trace->metadata->trace);
+	}
+
+share:
+	if (metadata_key && shared_metadata &&
+			!g_hash_table_lookup(shared_metadata, metadata_key)) {
+		/* Ownership of the key is transferred */
+		g_hash_table_insert(shared_metadata, metadata_key,
+			bt_get(ctf_fs_trace->metadata->trace));
+		metadata_key = NULL;
+	}
+
 end:
+	g_free(metadata_key);
+	g_free(contents);
 	ctf_fs_file_destroy(file);
 	ctf_metadata_decoder_destroy(metadata_decoder);
 	return ret;
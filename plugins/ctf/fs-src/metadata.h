@@ -36,6 +36,19 @@ struct ctf_fs_metadata;
 struct metadata_overrides {
 	int64_t clock_offset_s;
 	int64_t clock_offset_ns;
+
+	/* CTF IR cache directory (`NULL` to disable the cache) */
+	const char *ir_cache_dir;
+
+	/*
+	 * Weak: CTF IR traces (struct bt_ctf_trace *) of the metadata
+	 * already decoded, keyed by metadata key (`NULL` to disable
+	 * sharing). A trace having the same metadata as an already
+	 * decoded one still gets its own CTF IR trace, stream classes,
+	 * and event classes, but they share the field types and clock
+	 * classes of this trace instead of decoding the metadata again.
+	 */
+	GHashTable *shared_metadata;
 };
 
 BT_HIDDEN
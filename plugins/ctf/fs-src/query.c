@@ -39,6 +39,9 @@
 
 #define METADATA_TEXT_SIG	"/* CTF 1.8"
 
+/* Maximum number of threads populating trace infos */
+#define TRACE_INFO_MAX_THREADS	8
+
 struct range {
 	int64_t begin_ns;
 	int64_t end_ns;
@@ -257,9 +260,6 @@ int populate_stream_info(struct ctf_fs_ds_file_group *group,
 	enum bt_value_status status;
 	struct bt_value *file_paths;
 
-	stream_range->begin_ns = INT64_MAX;
-	stream_range->end_ns = 0;
-
 	file_paths = bt_value_array_create();
 	if (!file_paths) {
 		ret = -1;
@@ -267,44 +267,36 @@ int populate_stream_info(struct ctf_fs_ds_file_group *group,
 	}
 
 	for (file_idx = 0; file_idx < group->ds_file_infos->len; file_idx++) {
-		int64_t file_begin_epoch, file_end_epoch;
 		struct ctf_fs_ds_file_info *info =
 				g_ptr_array_index(group->ds_file_infos,
 					file_idx);
 
-		if (!info->index || info->index->entries->len == 0) {
-			BT_LOGW("Cannot determine range of unindexed stream file \'%s\'",
-				info->path->str);
-			ret = -1;
-			goto end;
-		}
-
 		status = bt_value_array_append_string(file_paths,
 				info->path->str);
 		if (status != BT_VALUE_STATUS_OK) {
 			ret = -1;
 			goto end;
 		}
+	}
 
-		/*
-		 * file range is from timestamp_begin of the first entry to the
-		 * timestamp_end of the last entry.
-		 */
-		file_begin_epoch = ((struct ctf_fs_ds_index_entry *) &g_array_index(info->index->entries,
-				struct ctf_fs_ds_index_entry, 0))->timestamp_begin_ns;
-		file_end_epoch = ((struct ctf_fs_ds_index_entry *) &g_array_index(info->index->entries,
-				struct ctf_fs_ds_index_entry, info->index->entries->len - 1))->timestamp_end_ns;
-
-		stream_range->begin_ns = min(stream_range->begin_ns, file_begin_epoch);
-		stream_range->end_ns = max(stream_range->end_ns, file_end_epoch);
-		stream_range->set = true;
+	/*
+	 * The stream files of a group are sorted by time: only the
+	 * first and last ones are needed to get the group's range.
+	 */
+	ret = ctf_fs_ds_file_group_get_range_ns(group,
+		&stream_range->begin_ns, &stream_range->end_ns);
+	if (ret) {
+		BT_LOGW("Cannot determine range of stream file group: "
+			"first-path=\"%s\"",
+			((struct ctf_fs_ds_file_info *) g_ptr_array_index(
+				group->ds_file_infos, 0))->path->str);
+		goto end;
 	}
 
-	if (stream_range->set) {
-		ret = add_range(group_info, stream_range, "range-ns");
-		if (ret) {
-			goto end;
-		}
+	stream_range->set = true;
+	ret = add_range(group_info, stream_range, "range-ns");
+	if (ret) {
+		goto end;
 	}
 
 	status = bt_value_map_insert(group_info, "paths", file_paths);
@@ -437,6 +429,31 @@ end:
 	return ret;
 }
 
+/* Trace info populated by bt_common_run_jobs(), one trace per job */
+struct trace_info_job {
+	/* Weak */
+	const char *trace_path;
+	const char *trace_name;
+
+	/* Owned by this */
+	struct bt_value *trace_info;
+};
+
+static
+int populate_trace_info_job(void *data, void *thread_data)
+{
+	struct trace_info_job *job = data;
+
+	job->trace_info = bt_value_map_create();
+	if (!job->trace_info) {
+		BT_LOGE_STR("Failed to create trace info map.");
+		return -1;
+	}
+
+	return populate_trace_info(job->trace_path, job->trace_name,
+		job->trace_info);
+}
+
 BT_HIDDEN
 struct bt_value *trace_info_query(struct bt_component_class *comp_class,
 		struct bt_value *params)
@@ -450,6 +467,10 @@ struct bt_value *trace_info_query(struct bt_component_class *comp_class,
 	GList *tp_node = NULL;
 	GList *tn_node = NULL;
 	GString *normalized_path = NULL;
+	struct trace_info_job *jobs = NULL;
+	size_t job_count = 0;
+	size_t thread_count;
+	size_t i;
 
 	if (!bt_value_is_map(params)) {
 		BT_LOGE("Query parameters is not a map value object.");
@@ -487,30 +508,41 @@ struct bt_value *trace_info_query(struct bt_component_class *comp_class,
 		goto error;
 	}
 
+	job_count = g_list_length(trace_paths);
+	jobs = g_new0(struct trace_info_job, job_count);
+	if (!jobs && job_count > 0) {
+		BT_LOGE_STR("Failed to allocate trace info jobs.");
+		goto error;
+	}
+
 	/* Iterates over both trace paths and names simultaneously. */
-	for (tp_node = trace_paths, tn_node = trace_names; tp_node;
+	for (tp_node = trace_paths, tn_node = trace_names, i = 0; tp_node;
 			tp_node = g_list_next(tp_node),
-			tn_node = g_list_next(tn_node)) {
+			tn_node = g_list_next(tn_node), i++) {
 		GString *trace_path = tp_node->data;
 		GString *trace_name = tn_node->data;
-		enum bt_value_status status;
-		struct bt_value *trace_info;
 
-		trace_info = bt_value_map_create();
-		if (!trace_info) {
-			BT_LOGE("Failed to create trace info map.");
-			goto error;
-		}
+		jobs[i].trace_path = trace_path->str;
+		jobs[i].trace_name = trace_name->str;
+	}
 
-		ret = populate_trace_info(trace_path->str, trace_name->str,
-			trace_info);
-		if (ret) {
-			bt_put(trace_info);
-			goto error;
-		}
+	/* Each trace is independent from the others. */
+	thread_count = bt_common_get_job_thread_count(job_count, 1,
+		TRACE_INFO_MAX_THREADS);
+	BT_LOGD("Populating trace infos: trace-count=%zu, thread-count=%zu",
+		job_count, thread_count);
+	ret = bt_common_run_jobs(jobs, job_count, sizeof(*jobs),
+		populate_trace_info_job, NULL, thread_count);
+	if (ret) {
+		goto error;
+	}
 
-		status = bt_value_array_append(trace_infos, trace_info);
-		bt_put(trace_info);
+	/* Keep the trace path order, whatever the completion order. */
+	for (i = 0; i < job_count; i++) {
+		enum bt_value_status status;
+
+		status = bt_value_array_append(trace_infos,
+			jobs[i].trace_info);
 		if (status != BT_VALUE_STATUS_OK) {
 			goto error;
 		}
@@ -540,6 +572,13 @@ end:
 		}
 		g_list_free(trace_names);
 	}
+	if (jobs) {
+		for (i = 0; i < job_count; i++) {
+			bt_put(jobs[i].trace_info);
+		}
+
+		g_free(jobs);
+	}
 	/* "path" becomes invalid with the release of path_value. */
 	bt_put(path_value);
 	return trace_infos;
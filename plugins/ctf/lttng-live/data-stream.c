@@ -71,6 +71,63 @@ enum bt_ctf_notif_iter_medium_status medop_request_bytes(
 	return status;
 }
 
+/*
+ * The relay daemon serves one packet at a time, as described by the
+ * current index, and the viewer protocol only gives the next index of
+ * a stream (there's no index to look up the other packets in): seeking
+ * is only supported within the current index's range, that is
+ * [base_offset, base_offset + len]. Seeking anywhere else returns
+ * BT_CTF_NOTIF_ITER_MEDIUM_STATUS_UNSUPPORTED; the notification
+ * iterator then consumes the bytes instead.
+ */
+static
+enum bt_ctf_notif_iter_medium_status medop_seek(
+		enum bt_ctf_notif_iter_seek_whence whence, off_t offset,
+		void *data)
+{
+	enum bt_ctf_notif_iter_medium_status status =
+		BT_CTF_NOTIF_ITER_MEDIUM_STATUS_OK;
+	struct lttng_live_stream_iterator *stream = data;
+	uint64_t target;
+
+	switch (whence) {
+	case BT_CTF_NOTIF_ITER_SEEK_WHENCE_SET:
+		if (offset < 0) {
+			status = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_INVAL;
+			goto end;
+		}
+
+		target = (uint64_t) offset;
+		break;
+	case BT_CTF_NOTIF_ITER_SEEK_WHENCE_CUR:
+		if (offset < 0 && (uint64_t) -offset > stream->offset) {
+			status = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_INVAL;
+			goto end;
+		}
+
+		target = stream->offset + offset;
+		break;
+	default:
+		status = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_INVAL;
+		goto end;
+	}
+
+	if (target < stream->base_offset ||
+			target > stream->base_offset + stream->len) {
+		BT_LOGD("Cannot seek outside of current index of stream %s: "
+			"offset=%" PRIu64 ", index-offset=%" PRIu64 ", "
+			"index-len=%" PRIu64, stream->name, target,
+			stream->base_offset, stream->len);
+		status = BT_CTF_NOTIF_ITER_MEDIUM_STATUS_UNSUPPORTED;
+		goto end;
+	}
+
+	stream->offset = target;
+
+end:
+	return status;
+}
+
 static
 struct bt_ctf_stream *medop_get_stream(
 		struct bt_ctf_stream_class *stream_class, void *data)
@@ -95,6 +152,7 @@ struct bt_ctf_stream *medop_get_stream(
 
 static struct bt_ctf_notif_iter_medium_ops medops = {
 	.request_bytes = medop_request_bytes,
+	.seek = medop_seek,
 	.get_stream = medop_get_stream,
 };
 
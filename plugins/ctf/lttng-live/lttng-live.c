@@ -711,6 +711,7 @@ enum bt_ctf_lttng_live_iterator_status lttng_live_iterator_next_handle_one_activ
 		break;
 	case BT_CTF_NOTIF_ITER_STATUS_INVAL:
 		/* No argument provided by the user, so don't return INVAL. */
+	case BT_CTF_NOTIF_ITER_STATUS_UNSUPPORTED:
 	case BT_CTF_NOTIF_ITER_STATUS_ERROR:
 	default:
 		ret = BT_CTF_LTTNG_LIVE_ITERATOR_STATUS_ERROR;
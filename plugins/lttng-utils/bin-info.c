@@ -37,6 +37,7 @@
 #include <dwarf.h>
 #include <glib.h>
 #include <errno.h>
+#include <sys/stat.h>
 #include <babeltrace/babeltrace-internal.h>
 #include "dwarf.h"
 #include "bin-info.h"
@@ -50,6 +51,27 @@
  */
 #define ADDR_STR_LEN 20
 
+/*
+ * Checksum computed for a candidate debug file, along with the file
+ * attributes which must not change for the checksum to remain valid.
+ */
+struct debug_file_crc {
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	time_t mtime;
+	uint32_t crc;
+};
+
+/*
+ * Debug file path (owned) -> struct debug_file_crc (owned).
+ *
+ * The same debug files are looked up for every bin_info instance of a
+ * given binary (one per traced process), and computing their checksum
+ * means reading them completely, so keep the result around.
+ */
+static GHashTable *debug_file_crcs;
+
 BT_HIDDEN
 int bin_info_init(void)
 {
@@ -64,6 +86,15 @@ int bin_info_init(void)
 	return ret;
 }
 
+BT_HIDDEN
+void bin_info_fini(void)
+{
+	if (debug_file_crcs) {
+		g_hash_table_destroy(debug_file_crcs);
+		debug_file_crcs = NULL;
+	}
+}
+
 BT_HIDDEN
 struct bin_info *bin_info_create(const char *path, uint64_t low_addr,
 		uint64_t memsz, bool is_pic, const char *debug_info_dir,
@@ -318,6 +349,56 @@ end:
 	return ret;
 }
 
+/*
+ * Sets `*crc` to the checksum of the opened debug file `fd` located at
+ * `path`, reusing the previously computed checksum if the file did
+ * not change since.
+ *
+ * Returns 0 on success.
+ */
+static
+int get_debug_file_crc(const char *path, int fd, uint32_t *crc)
+{
+	int ret = 0;
+	struct stat st;
+	struct debug_file_crc *entry;
+
+	if (fstat(fd, &st)) {
+		/* Can't validate a cache entry: always compute */
+		ret = crc32(fd, crc);
+		goto end;
+	}
+
+	if (!debug_file_crcs) {
+		debug_file_crcs = g_hash_table_new_full(g_str_hash,
+			g_str_equal, g_free, g_free);
+	}
+
+	entry = g_hash_table_lookup(debug_file_crcs, path);
+	if (entry && entry->dev == st.st_dev && entry->ino == st.st_ino &&
+			entry->size == st.st_size &&
+			entry->mtime == st.st_mtime) {
+		*crc = entry->crc;
+		goto end;
+	}
+
+	ret = crc32(fd, crc);
+	if (ret) {
+		goto end;
+	}
+
+	entry = g_new0(struct debug_file_crc, 1);
+	entry->dev = st.st_dev;
+	entry->ino = st.st_ino;
+	entry->size = st.st_size;
+	entry->mtime = st.st_mtime;
+	entry->crc = *crc;
+	g_hash_table_insert(debug_file_crcs, g_strdup(path), entry);
+
+end:
+	return ret;
+}
+
 /**
  * Tests whether the file located at path exists and has the expected
  * checksum.
@@ -347,7 +428,7 @@ int is_valid_debug_file(char *path, uint32_t crc)
 		goto end_noclose;
 	}
 
-	ret = crc32(fd, &_crc);
+	ret = get_debug_file_crc(path, fd, &_crc);
 	if (ret) {
 		ret = 0;
 		goto end;
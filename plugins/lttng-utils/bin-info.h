@@ -85,6 +85,14 @@ struct source_location {
 BT_HIDDEN
 int bin_info_init(void);
 
+/**
+ * Finalizes the bin_info framework, freeing the cached checksums of
+ * the debug files. Call this once no bin_info instance is used
+ * anymore.
+ */
+BT_HIDDEN
+void bin_info_fini(void);
+
 /**
  * Instantiate a structure representing an ELF executable, possibly
  * with DWARF info, located at the given path.
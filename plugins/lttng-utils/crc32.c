@@ -31,8 +31,18 @@
  * SUCH DAMAGE.
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <babeltrace/compat/mman-internal.h>
+#include <babeltrace/endian-internal.h>
 #include "crc32.h"
 
+/* Size of the buffer used when the file cannot be mapped */
+#define CRC32_READ_BUF_LEN	(64 * 1024)
+
 #define CRC(crc, ch)	 (crc = (crc >> 8) ^ crctab[(crc ^ (ch)) & 0xff])
 
 /* generated using the AUTODIN II polynomial
@@ -106,26 +116,151 @@ static const uint32_t crctab[256] = {
 	0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d,
 };
 
+/*
+ * Slice-by-8 tables: crctab_slice[0] is crctab, and
+ * crctab_slice[k][i] is the CRC of byte i followed by k null bytes.
+ * This makes it possible to process eight bytes per iteration.
+ */
+static uint32_t crctab_slice[8][256];
+static bool crctab_slice_initialized;
+
+static
+void init_crctab_slice(void)
+{
+	int i, k;
+
+	if (crctab_slice_initialized) {
+		return;
+	}
+
+	for (i = 0; i < 256; i++) {
+		crctab_slice[0][i] = crctab[i];
+	}
+
+	for (k = 1; k < 8; k++) {
+		for (i = 0; i < 256; i++) {
+			uint32_t prev = crctab_slice[k - 1][i];
+
+			crctab_slice[k][i] = (prev >> 8) ^ crctab[prev & 0xff];
+		}
+	}
+
+	crctab_slice_initialized = true;
+}
+
+/*
+ * Updates the (non-inverted) running CRC `crc` with `len` bytes.
+ */
+static
+uint32_t crc32_update(uint32_t crc, const uint8_t *buf, size_t len)
+{
+	init_crctab_slice();
+
+	/* Leading bytes until `buf` is aligned for 32-bit loads */
+	while (len > 0 && ((uintptr_t) buf & 3)) {
+		CRC(crc, *buf);
+		buf++;
+		len--;
+	}
+
+#if BYTE_ORDER == LITTLE_ENDIAN
+	while (len >= 8) {
+		uint32_t one, two;
+
+		memcpy(&one, buf, sizeof(one));
+		memcpy(&two, buf + 4, sizeof(two));
+		one ^= crc;
+		crc = crctab_slice[7][one & 0xff] ^
+			crctab_slice[6][(one >> 8) & 0xff] ^
+			crctab_slice[5][(one >> 16) & 0xff] ^
+			crctab_slice[4][one >> 24] ^
+			crctab_slice[3][two & 0xff] ^
+			crctab_slice[2][(two >> 8) & 0xff] ^
+			crctab_slice[1][(two >> 16) & 0xff] ^
+			crctab_slice[0][two >> 24];
+		buf += 8;
+		len -= 8;
+	}
+#endif
+
+	while (len > 0) {
+		CRC(crc, *buf);
+		buf++;
+		len--;
+	}
+
+	return crc;
+}
+
+static
+int crc32_mmap(int fd, size_t len, uint32_t *crc)
+{
+	void *addr;
+
+	addr = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (addr == MAP_FAILED) {
+		return -1;
+	}
+
+#ifdef MADV_SEQUENTIAL
+	(void) madvise(addr, len, MADV_SEQUENTIAL);
+#endif
+	*crc = crc32_update(*crc, addr, len);
+	munmap(addr, len);
+	return 0;
+}
+
+static
+int crc32_read(int fd, uint32_t *crc)
+{
+	int ret = 0;
+	ssize_t nr;
+	uint8_t *buf;
+
+	buf = malloc(CRC32_READ_BUF_LEN);
+	if (!buf) {
+		ret = -1;
+		goto end;
+	}
+
+	while ((nr = read(fd, buf, CRC32_READ_BUF_LEN)) > 0) {
+		*crc = crc32_update(*crc, buf, nr);
+	}
+
+	if (nr < 0) {
+		ret = -1;
+	}
+
+end:
+	free(buf);
+	return ret;
+}
+
 int crc32(int fd, uint32_t *crc)
 {
-	int nr;
+	int ret;
+	struct stat st;
 	uint32_t _crc = ~0;
-	char buf[BUFSIZ], *p;
 
 	if (fd < 0 || !crc) {
 		goto error;
 	}
 
-	while ((nr = read(fd, buf, sizeof(buf))) > 0) {
-		for (p = buf; nr--; ++p) {
-			CRC(_crc, *p);
-		}
+	/*
+	 * Debug files can be very large: map regular files instead of
+	 * copying them through a buffer.
+	 */
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+			crc32_mmap(fd, st.st_size, &_crc) == 0) {
+		goto end;
 	}
 
-	if (nr < 0) {
+	ret = crc32_read(fd, &_crc);
+	if (ret) {
 		goto error;
 	}
 
+end:
 	*crc = ~_crc;
 	return 0;
 
@@ -42,6 +42,7 @@
 #include <plugins-common.h>
 #include <assert.h>
 #include "debug-info.h"
+#include "bin-info.h"
 #include "copy.h"
 
 static
@@ -476,11 +477,19 @@ error:
 	return ret;
 }
 
+static
+enum bt_plugin_status lttng_utils_exit(void)
+{
+	bin_info_fini();
+	return BT_PLUGIN_STATUS_OK;
+}
+
 /* Initialize plug-in entry points. */
 BT_PLUGIN_WITH_ID(lttng_utils, "lttng-utils");
 BT_PLUGIN_DESCRIPTION_WITH_ID(lttng_utils, "LTTng utilities");
 BT_PLUGIN_AUTHOR_WITH_ID(lttng_utils, "Julien Desfossez");
 BT_PLUGIN_LICENSE_WITH_ID(lttng_utils, "MIT");
+BT_PLUGIN_EXIT_WITH_ID(lttng_utils, lttng_utils_exit);
 
 BT_PLUGIN_FILTER_COMPONENT_CLASS_WITH_ID(lttng_utils, debug_info, "debug-info",
 	debug_info_iterator_next);
@@ -31,20 +31,105 @@
 #include <babeltrace/graph/component-sink.h>
 #include <babeltrace/graph/notification-iterator.h>
 #include <babeltrace/graph/notification.h>
+#include <babeltrace/graph/notification-event.h>
+#include <babeltrace/graph/notification-packet.h>
+#include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/packet.h>
+#include <babeltrace/ctf-ir/fields.h>
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/values.h>
 #include <babeltrace/babeltrace-internal.h>
 #include <plugins-common.h>
+#include <stdio.h>
+#include <inttypes.h>
 #include <assert.h>
 #include "dummy.h"
 
+static
+const char *notif_type_names[] = {
+	[BT_NOTIFICATION_TYPE_EVENT] = "event",
+	[BT_NOTIFICATION_TYPE_INACTIVITY] = "inactivity",
+	[BT_NOTIFICATION_TYPE_STREAM_BEGIN] = "stream-begin",
+	[BT_NOTIFICATION_TYPE_STREAM_END] = "stream-end",
+	[BT_NOTIFICATION_TYPE_PACKET_BEGIN] = "packet-begin",
+	[BT_NOTIFICATION_TYPE_PACKET_END] = "packet-end",
+};
+
+static
+void destroy_event_class_count(struct dummy_event_class_count *ec_count)
+{
+	bt_put(ec_count->event_class);
+	g_free(ec_count);
+}
+
 static
 void destroy_private_dummy_data(struct dummy *dummy)
 {
 	if (dummy->iterators) {
 		g_ptr_array_free(dummy->iterators, TRUE);
 	}
+	if (dummy->event_class_counts) {
+		g_hash_table_destroy(dummy->event_class_counts);
+	}
+	if (dummy->event_class_count_order) {
+		g_ptr_array_free(dummy->event_class_count_order, TRUE);
+	}
 	g_free(dummy);
 }
 
+static
+void print_report(struct dummy *dummy)
+{
+	double wall_s = (double) (dummy->end_wall_us - dummy->start_wall_us) /
+		1e6;
+	double cpu_s = (double) (dummy->end_cpu - dummy->start_cpu) /
+		CLOCKS_PER_SEC;
+	uint64_t total = 0;
+	size_t i;
+
+	for (i = 0; i < BT_NOTIFICATION_TYPE_NR; i++) {
+		total += dummy->notif_counts[i];
+	}
+
+	printf("Notifications: %" PRIu64 " in %.3f s (wall), %.3f s (CPU)\n",
+		total, wall_s, cpu_s);
+
+	for (i = 0; i < BT_NOTIFICATION_TYPE_NR; i++) {
+		if (dummy->notif_counts[i] == 0) {
+			continue;
+		}
+
+		printf("  %s: %" PRIu64, notif_type_names[i],
+			dummy->notif_counts[i]);
+		if (wall_s > 0) {
+			printf(" (%.1f/s)", (double) dummy->notif_counts[i] /
+				wall_s);
+		}
+		printf("\n");
+	}
+
+	if (dummy->event_class_count_order->len > 0) {
+		printf("Events by class:\n");
+	}
+
+	for (i = 0; i < dummy->event_class_count_order->len; i++) {
+		struct dummy_event_class_count *ec_count = g_ptr_array_index(
+			dummy->event_class_count_order, i);
+		const char *name =
+			bt_ctf_event_class_get_name(ec_count->event_class);
+
+		printf("  %s: %" PRIu64 "\n", name ? name : "(unnamed)",
+			ec_count->count);
+	}
+
+	if (dummy->touch_fields) {
+		printf("Touched fields: %" PRIu64 "\n", dummy->touched_fields);
+	}
+
+	fflush(stdout);
+}
+
 void dummy_finalize(struct bt_private_component *component)
 {
 	struct dummy *dummy;
@@ -52,9 +137,44 @@ void dummy_finalize(struct bt_private_component *component)
 	assert(component);
 	dummy = bt_private_component_get_user_data(component);
 	assert(dummy);
+	if (dummy->report && dummy->started) {
+		if (!dummy->ended) {
+			/* Interrupted or failed graph: report what was seen */
+			dummy->end_wall_us = g_get_monotonic_time();
+			dummy->end_cpu = clock();
+		}
+
+		print_report(dummy);
+	}
+
 	destroy_private_dummy_data(dummy);
 }
 
+static
+enum bt_component_status get_bool_param(struct bt_value *params,
+		const char *name, bool *result)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_value *value = bt_value_map_get(params, name);
+	bt_bool val;
+
+	if (!value) {
+		goto end;
+	}
+
+	if (bt_value_bool_get(value, &val)) {
+		printf_error("Failed to retrieve %s value. Expecting a boolean",
+			name);
+		ret = BT_COMPONENT_STATUS_INVALID;
+		goto end;
+	}
+
+	*result = (bool) val;
+end:
+	bt_put(value);
+	return ret;
+}
+
 enum bt_component_status dummy_init(struct bt_private_component *component,
 		struct bt_value *params, UNUSED_VAR void *init_method_data)
 {
@@ -79,6 +199,25 @@ enum bt_component_status dummy_init(struct bt_private_component *component,
 		goto end;
 	}
 
+	dummy->event_class_counts = g_hash_table_new(g_direct_hash,
+		g_direct_equal);
+	dummy->event_class_count_order = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_event_class_count);
+	if (!dummy->event_class_counts || !dummy->event_class_count_order) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto error;
+	}
+
+	ret = get_bool_param(params, "report", &dummy->report);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
+	ret = get_bool_param(params, "touch-fields", &dummy->touch_fields);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
 	ret = bt_private_component_set_user_data(component, dummy);
 	if (ret != BT_COMPONENT_STATUS_OK) {
 		goto error;
@@ -117,6 +256,196 @@ end:
 	bt_put(connection);
 }
 
+static
+void touch_field(struct dummy *dummy, struct bt_ctf_field *field)
+{
+	struct bt_ctf_field_type *type = NULL;
+	struct bt_ctf_field *child = NULL;
+	int64_t i, count;
+	int64_t ival;
+	uint64_t uval;
+	double fval;
+
+	if (!field) {
+		return;
+	}
+
+	dummy->touched_fields++;
+
+	switch (bt_ctf_field_get_type_id(field)) {
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+		type = bt_ctf_field_get_type(field);
+		if (bt_ctf_field_type_integer_is_signed(type)) {
+			(void) bt_ctf_field_signed_integer_get_value(field,
+				&ival);
+		} else {
+			(void) bt_ctf_field_unsigned_integer_get_value(field,
+				&uval);
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_FLOAT:
+		(void) bt_ctf_field_floating_point_get_value(field, &fval);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_STRING:
+		(void) bt_ctf_field_string_get_value(field);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+		child = bt_ctf_field_enumeration_get_container(field);
+		touch_field(dummy, child);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+		type = bt_ctf_field_get_type(field);
+		count = bt_ctf_field_type_structure_get_field_count(type);
+		for (i = 0; i < count; i++) {
+			child = bt_ctf_field_structure_get_field_by_index(
+				field, i);
+			touch_field(dummy, child);
+			BT_PUT(child);
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+		type = bt_ctf_field_get_type(field);
+		count = bt_ctf_field_type_array_get_length(type);
+		for (i = 0; i < count; i++) {
+			child = bt_ctf_field_array_get_field(field, i);
+			touch_field(dummy, child);
+			BT_PUT(child);
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_SEQUENCE:
+		child = bt_ctf_field_sequence_get_length(field);
+		if (!child || bt_ctf_field_unsigned_integer_get_value(child,
+				&uval)) {
+			break;
+		}
+
+		BT_PUT(child);
+		for (i = 0; i < (int64_t) uval; i++) {
+			child = bt_ctf_field_sequence_get_field(field, i);
+			touch_field(dummy, child);
+			BT_PUT(child);
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_VARIANT:
+		child = bt_ctf_field_variant_get_current_field(field);
+		touch_field(dummy, child);
+		break;
+	default:
+		break;
+	}
+
+	bt_put(child);
+	bt_put(type);
+}
+
+static
+void touch_event_fields(struct dummy *dummy, struct bt_ctf_event *event)
+{
+	struct bt_ctf_field *field;
+
+	field = bt_ctf_event_get_header(event);
+	touch_field(dummy, field);
+	bt_put(field);
+	field = bt_ctf_event_get_stream_event_context(event);
+	touch_field(dummy, field);
+	bt_put(field);
+	field = bt_ctf_event_get_event_context(event);
+	touch_field(dummy, field);
+	bt_put(field);
+	field = bt_ctf_event_get_event_payload(event);
+	touch_field(dummy, field);
+	bt_put(field);
+}
+
+static
+void touch_packet_fields(struct dummy *dummy, struct bt_ctf_packet *packet)
+{
+	struct bt_ctf_field *field;
+
+	field = bt_ctf_packet_get_header(packet);
+	touch_field(dummy, field);
+	bt_put(field);
+	field = bt_ctf_packet_get_context(packet);
+	touch_field(dummy, field);
+	bt_put(field);
+}
+
+static
+int count_event(struct dummy *dummy, struct bt_ctf_event *event)
+{
+	int ret = 0;
+	struct bt_ctf_event_class *event_class = bt_ctf_event_get_class(event);
+	struct dummy_event_class_count *ec_count;
+
+	assert(event_class);
+	ec_count = g_hash_table_lookup(dummy->event_class_counts, event_class);
+	if (!ec_count) {
+		ec_count = g_new0(struct dummy_event_class_count, 1);
+		if (!ec_count) {
+			ret = -1;
+			goto end;
+		}
+
+		ec_count->event_class = bt_get(event_class);
+		g_ptr_array_add(dummy->event_class_count_order, ec_count);
+		g_hash_table_insert(dummy->event_class_counts, event_class,
+			ec_count);
+	}
+
+	ec_count->count++;
+
+end:
+	bt_put(event_class);
+	return ret;
+}
+
+/* Counts and touches the current notification of `it`. */
+static
+int handle_notification(struct dummy *dummy,
+		struct bt_notification_iterator *it)
+{
+	int ret = 0;
+	struct bt_notification *notif;
+	struct bt_ctf_event *event = NULL;
+	struct bt_ctf_packet *packet = NULL;
+	enum bt_notification_type type;
+
+	notif = bt_notification_iterator_get_notification(it);
+	assert(notif);
+	type = bt_notification_get_type(notif);
+	if (type >= 0 && type < BT_NOTIFICATION_TYPE_NR) {
+		dummy->notif_counts[type]++;
+	}
+
+	switch (type) {
+	case BT_NOTIFICATION_TYPE_EVENT:
+		event = bt_notification_event_get_event(notif);
+		assert(event);
+		if (dummy->report) {
+			ret = count_event(dummy, event);
+		}
+
+		if (dummy->touch_fields) {
+			touch_event_fields(dummy, event);
+		}
+		break;
+	case BT_NOTIFICATION_TYPE_PACKET_BEGIN:
+		if (dummy->touch_fields) {
+			packet = bt_notification_packet_begin_get_packet(notif);
+			assert(packet);
+			touch_packet_fields(dummy, packet);
+		}
+		break;
+	default:
+		break;
+	}
+
+	bt_put(packet);
+	bt_put(event);
+	bt_put(notif);
+	return ret;
+}
+
 enum bt_component_status dummy_consume(struct bt_private_component *component)
 {
 	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
@@ -132,6 +461,12 @@ enum bt_component_status dummy_consume(struct bt_private_component *component)
 		goto end;
 	}
 
+	if (unlikely(!dummy->started)) {
+		dummy->start_wall_us = g_get_monotonic_time();
+		dummy->start_cpu = clock();
+		dummy->started = true;
+	}
+
 	/* Consume one notification from each iterator. */
 	for (i = 0; i < dummy->iterators->len; i++) {
 		struct bt_notification_iterator *it;
@@ -154,9 +489,19 @@ enum bt_component_status dummy_consume(struct bt_private_component *component)
 		default:
 			break;
 		}
+
+		if (dummy->report || dummy->touch_fields) {
+			if (handle_notification(dummy, it)) {
+				ret = BT_COMPONENT_STATUS_ERROR;
+				goto end;
+			}
+		}
 	}
 
 	if (dummy->iterators->len == 0) {
+		dummy->end_wall_us = g_get_monotonic_time();
+		dummy->end_cpu = clock();
+		dummy->ended = true;
 		ret = BT_COMPONENT_STATUS_END;
 	}
 end:
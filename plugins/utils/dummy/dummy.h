@@ -27,11 +27,42 @@
 #include <babeltrace/graph/private-component.h>
 #include <babeltrace/graph/private-port.h>
 #include <babeltrace/graph/port.h>
+#include <babeltrace/graph/notification.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+struct dummy_event_class_count {
+	/* Owned by this */
+	struct bt_ctf_event_class *event_class;
+	uint64_t count;
+};
 
 struct dummy {
 	GPtrArray *iterators;
 	bool error;
+
+	/* Print a throughput report at finalization time */
+	bool report;
+
+	/* Read the value of every field to simulate a consumer's work */
+	bool touch_fields;
+
+	/* Benchmark state (when `report` or `touch_fields` is true) */
+	bool started;
+	bool ended;
+	gint64 start_wall_us;
+	gint64 end_wall_us;
+	clock_t start_cpu;
+	clock_t end_cpu;
+	uint64_t notif_counts[BT_NOTIFICATION_TYPE_NR];
+	uint64_t touched_fields;
+
+	/* Event class (weak) -> struct dummy_event_class_count * (weak) */
+	GHashTable *event_class_counts;
+
+	/* Array of struct dummy_event_class_count * (owned) */
+	GPtrArray *event_class_count_order;
 };
 
 enum bt_component_status dummy_init(struct bt_private_component *component,
@@ -0,0 +1,1558 @@
+/*
+ * expr.c
+ *
+ * Babeltrace Filter expressions
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/packet.h>
+#include <babeltrace/ctf-ir/fields.h>
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/ctf-ir/clock-class.h>
+#include <babeltrace/graph/clock-class-priority-map.h>
+#include <babeltrace/ref.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <assert.h>
+#include "expr.h"
+
+enum filter_value_type {
+	/* Missing field */
+	FILTER_VALUE_NONE,
+	FILTER_VALUE_INT,
+	FILTER_VALUE_UINT,
+	FILTER_VALUE_FLOAT,
+	FILTER_VALUE_STRING,
+};
+
+struct filter_value {
+	enum filter_value_type type;
+	union {
+		int64_t i;
+		uint64_t u;
+		double f;
+		const char *s;
+	} u;
+};
+
+enum filter_cmp_op {
+	FILTER_CMP_EQ,
+	FILTER_CMP_NE,
+	FILTER_CMP_LT,
+	FILTER_CMP_LE,
+	FILTER_CMP_GT,
+	FILTER_CMP_GE,
+};
+
+enum filter_scope {
+	FILTER_SCOPE_PAYLOAD,
+	FILTER_SCOPE_EVENT_CONTEXT,
+	FILTER_SCOPE_STREAM_EVENT_CONTEXT,
+	FILTER_SCOPE_PACKET_CONTEXT,
+	/* Resolved to one of the context scopes above */
+	FILTER_SCOPE_ANY_CONTEXT,
+};
+
+enum filter_node_type {
+	FILTER_NODE_CONST,
+	FILTER_NODE_NAME,
+	FILTER_NODE_ID,
+	FILTER_NODE_TIMESTAMP,
+	FILTER_NODE_FIELD,
+	FILTER_NODE_NEG,
+	FILTER_NODE_NOT,
+	FILTER_NODE_AND,
+	FILTER_NODE_OR,
+	FILTER_NODE_CMP,
+};
+
+struct filter_node {
+	enum filter_node_type type;
+	union {
+		/* FILTER_NODE_CONST (strings are owned by this) */
+		struct filter_value value;
+
+		/* FILTER_NODE_FIELD */
+		struct {
+			enum filter_scope scope;
+
+			/* Array of gchar * (field names), owned by this */
+			GPtrArray *path;
+		} field;
+
+		/* FILTER_NODE_NEG and FILTER_NODE_NOT */
+		struct filter_node *operand;
+
+		/* FILTER_NODE_AND, FILTER_NODE_OR, and FILTER_NODE_CMP */
+		struct {
+			enum filter_cmp_op op;
+			struct filter_node *left;
+			struct filter_node *right;
+		} binary;
+	} u;
+};
+
+struct filter_expr {
+	/* Owned by this */
+	struct filter_node *root;
+};
+
+enum filter_op {
+	/* Push a constant value */
+	FILTER_OP_PUSH,
+	/* Push the value of a field */
+	FILTER_OP_LOAD_FIELD,
+	/* Push the event's time */
+	FILTER_OP_LOAD_TIMESTAMP,
+	FILTER_OP_NEG,
+	FILTER_OP_NOT,
+	/* Replace the top value with 0 or 1 */
+	FILTER_OP_TO_BOOL,
+	FILTER_OP_CMP,
+	/*
+	 * If the top value is false (true), replace it with 0 (1) and
+	 * jump to the target, otherwise pop it.
+	 */
+	FILTER_OP_JUMP_IF_FALSE,
+	FILTER_OP_JUMP_IF_TRUE,
+};
+
+struct filter_insn {
+	enum filter_op op;
+	union {
+		/* FILTER_OP_PUSH */
+		struct filter_value value;
+
+		/* FILTER_OP_LOAD_FIELD */
+		struct {
+			enum filter_scope scope;
+
+			/* Structure field indexes from the scope's root */
+			uint64_t *indexes;
+			size_t index_count;
+
+			/* Type of the value to read (integer: signed?) */
+			enum bt_ctf_field_type_id type_id;
+			bool is_signed;
+		} field;
+
+		/* FILTER_OP_CMP */
+		enum filter_cmp_op cmp_op;
+
+		/* FILTER_OP_JUMP_IF_FALSE and FILTER_OP_JUMP_IF_TRUE */
+		size_t target;
+	} u;
+};
+
+struct filter_program {
+	/* Owned by this */
+	struct bt_ctf_event_class *event_class;
+
+	/* Array of struct filter_insn, owned by this */
+	GArray *insns;
+
+	/* Evaluation stack, allocated once (max depth) */
+	struct filter_value *stack;
+	size_t stack_size;
+
+	bool is_constant;
+	bool constant_result;
+};
+
+/* Parser */
+
+struct filter_parser {
+	const char *text;
+	const char *at;
+	GString *error;
+};
+
+static
+void filter_node_destroy(struct filter_node *node)
+{
+	if (!node) {
+		return;
+	}
+
+	switch (node->type) {
+	case FILTER_NODE_CONST:
+		if (node->u.value.type == FILTER_VALUE_STRING) {
+			g_free((gchar *) node->u.value.u.s);
+		}
+		break;
+	case FILTER_NODE_FIELD:
+		if (node->u.field.path) {
+			g_ptr_array_free(node->u.field.path, TRUE);
+		}
+		break;
+	case FILTER_NODE_NEG:
+	case FILTER_NODE_NOT:
+		filter_node_destroy(node->u.operand);
+		break;
+	case FILTER_NODE_AND:
+	case FILTER_NODE_OR:
+	case FILTER_NODE_CMP:
+		filter_node_destroy(node->u.binary.left);
+		filter_node_destroy(node->u.binary.right);
+		break;
+	default:
+		break;
+	}
+
+	g_free(node);
+}
+
+static
+struct filter_node *filter_node_create(enum filter_node_type type)
+{
+	struct filter_node *node = g_new0(struct filter_node, 1);
+
+	if (node) {
+		node->type = type;
+	}
+
+	return node;
+}
+
+static
+void parser_error(struct filter_parser *parser, const char *msg)
+{
+	g_string_append_printf(parser->error, "%s at offset %td: `%s`",
+		msg, parser->at - parser->text, parser->at);
+}
+
+static
+void skip_spaces(struct filter_parser *parser)
+{
+	while (isspace((unsigned char) *parser->at)) {
+		parser->at++;
+	}
+}
+
+static
+bool accept(struct filter_parser *parser, const char *token)
+{
+	size_t len = strlen(token);
+
+	skip_spaces(parser);
+	if (strncmp(parser->at, token, len) == 0) {
+		parser->at += len;
+		return true;
+	}
+
+	return false;
+}
+
+static
+bool is_ident_char(char c, bool first)
+{
+	return c == '_' || isalpha((unsigned char) c) ||
+		(!first && isdigit((unsigned char) c));
+}
+
+/*
+ * Parses an identifier, returning a new string, or `NULL` if there's
+ * no identifier at the current position.
+ */
+static
+gchar *parse_ident(struct filter_parser *parser)
+{
+	const char *begin = parser->at;
+
+	if (!is_ident_char(*parser->at, true)) {
+		return NULL;
+	}
+
+	while (is_ident_char(*parser->at, false)) {
+		parser->at++;
+	}
+
+	return g_strndup(begin, parser->at - begin);
+}
+
+static struct filter_node *parse_or(struct filter_parser *parser);
+
+static
+struct filter_node *parse_field(struct filter_parser *parser,
+		enum filter_scope scope, gchar *first_name)
+{
+	struct filter_node *node = filter_node_create(FILTER_NODE_FIELD);
+
+	if (!node) {
+		g_free(first_name);
+		goto error;
+	}
+
+	node->u.field.scope = scope;
+	node->u.field.path = g_ptr_array_new_with_free_func(g_free);
+	if (!node->u.field.path) {
+		g_free(first_name);
+		goto error;
+	}
+
+	if (first_name) {
+		g_ptr_array_add(node->u.field.path, first_name);
+	} else {
+		/* Scope prefix: at least one field name is required */
+		if (*parser->at != '.') {
+			parser_error(parser, "Expecting a field name");
+			goto error;
+		}
+	}
+
+	while (*parser->at == '.') {
+		gchar *name;
+
+		parser->at++;
+		name = parse_ident(parser);
+		if (!name) {
+			parser_error(parser, "Expecting a field name");
+			goto error;
+		}
+
+		g_ptr_array_add(node->u.field.path, name);
+	}
+
+	return node;
+
+error:
+	filter_node_destroy(node);
+	return NULL;
+}
+
+static
+struct filter_node *parse_dollar(struct filter_parser *parser)
+{
+	struct filter_node *node = NULL;
+	gchar *ident;
+	static const struct {
+		const char *name;
+		enum filter_scope scope;
+	} scopes[] = {
+		{ "payload", FILTER_SCOPE_PAYLOAD },
+		{ "event_ctx", FILTER_SCOPE_EVENT_CONTEXT },
+		{ "stream_ctx", FILTER_SCOPE_STREAM_EVENT_CONTEXT },
+		{ "packet_ctx", FILTER_SCOPE_PACKET_CONTEXT },
+		{ "ctx", FILTER_SCOPE_ANY_CONTEXT },
+	};
+	size_t i;
+
+	ident = parse_ident(parser);
+	if (!ident) {
+		parser_error(parser, "Expecting a name after `$`");
+		goto end;
+	}
+
+	if (strcmp(ident, "name") == 0) {
+		node = filter_node_create(FILTER_NODE_NAME);
+		goto end;
+	} else if (strcmp(ident, "id") == 0) {
+		node = filter_node_create(FILTER_NODE_ID);
+		goto end;
+	} else if (strcmp(ident, "ts") == 0) {
+		node = filter_node_create(FILTER_NODE_TIMESTAMP);
+		goto end;
+	}
+
+	for (i = 0; i < sizeof(scopes) / sizeof(*scopes); i++) {
+		if (strcmp(ident, scopes[i].name) == 0) {
+			node = parse_field(parser, scopes[i].scope, NULL);
+			goto end;
+		}
+	}
+
+	parser_error(parser, "Unknown `$` name");
+
+end:
+	g_free(ident);
+	return node;
+}
+
+static
+struct filter_node *parse_string(struct filter_parser *parser)
+{
+	struct filter_node *node = NULL;
+	GString *str = g_string_new(NULL);
+
+	if (!str) {
+		goto end;
+	}
+
+	/* Opening `"` */
+	parser->at++;
+
+	while (*parser->at != '"') {
+		char c = *parser->at;
+
+		if (c == '\0') {
+			parser_error(parser, "Unterminated string literal");
+			goto end;
+		}
+
+		if (c == '\\') {
+			parser->at++;
+			switch (*parser->at) {
+			case 'n':
+				c = '\n';
+				break;
+			case 't':
+				c = '\t';
+				break;
+			case '\\':
+			case '"':
+				c = *parser->at;
+				break;
+			default:
+				parser_error(parser, "Invalid escape sequence");
+				goto end;
+			}
+		}
+
+		g_string_append_c(str, c);
+		parser->at++;
+	}
+
+	/* Closing `"` */
+	parser->at++;
+	node = filter_node_create(FILTER_NODE_CONST);
+	if (!node) {
+		goto end;
+	}
+
+	node->u.value.type = FILTER_VALUE_STRING;
+	node->u.value.u.s = g_string_free(str, FALSE);
+	str = NULL;
+
+end:
+	if (str) {
+		g_string_free(str, TRUE);
+	}
+
+	return node;
+}
+
+static
+struct filter_node *parse_number(struct filter_parser *parser)
+{
+	struct filter_node *node = NULL;
+	const char *begin = parser->at;
+	char *end;
+	bool is_float = false;
+
+	/* Decimal point or exponent (not in hexadecimal literals) */
+	if (!(begin[0] == '0' && (begin[1] == 'x' || begin[1] == 'X'))) {
+		const char *p = begin;
+
+		while (isalnum((unsigned char) *p) || *p == '.') {
+			if (*p == '.' || *p == 'e' || *p == 'E') {
+				is_float = true;
+			}
+
+			p++;
+		}
+	}
+
+	node = filter_node_create(FILTER_NODE_CONST);
+	if (!node) {
+		goto end;
+	}
+
+	errno = 0;
+	if (is_float) {
+		node->u.value.type = FILTER_VALUE_FLOAT;
+		node->u.value.u.f = g_ascii_strtod(begin, &end);
+	} else {
+		uint64_t value = g_ascii_strtoull(begin, &end, 0);
+
+		if (value > (uint64_t) INT64_MAX) {
+			node->u.value.type = FILTER_VALUE_UINT;
+			node->u.value.u.u = value;
+		} else {
+			node->u.value.type = FILTER_VALUE_INT;
+			node->u.value.u.i = (int64_t) value;
+		}
+	}
+
+	if (errno != 0 || end == begin || is_ident_char(*end, false)) {
+		parser_error(parser, "Invalid number literal");
+		filter_node_destroy(node);
+		node = NULL;
+		goto end;
+	}
+
+	parser->at = end;
+
+end:
+	return node;
+}
+
+static
+struct filter_node *parse_primary(struct filter_parser *parser)
+{
+	struct filter_node *node = NULL;
+	gchar *ident;
+
+	skip_spaces(parser);
+
+	if (accept(parser, "(")) {
+		node = parse_or(parser);
+		if (node && !accept(parser, ")")) {
+			parser_error(parser, "Expecting `)`");
+			filter_node_destroy(node);
+			node = NULL;
+		}
+	} else if (*parser->at == '$') {
+		parser->at++;
+		node = parse_dollar(parser);
+	} else if (*parser->at == '"') {
+		node = parse_string(parser);
+	} else if (isdigit((unsigned char) *parser->at) ||
+			(*parser->at == '.' &&
+				isdigit((unsigned char) parser->at[1]))) {
+		node = parse_number(parser);
+	} else if ((ident = parse_ident(parser))) {
+		if (strcmp(ident, "name") == 0 && parser->at[0] != '.') {
+			g_free(ident);
+			node = filter_node_create(FILTER_NODE_NAME);
+		} else {
+			node = parse_field(parser, FILTER_SCOPE_PAYLOAD, ident);
+		}
+	} else {
+		parser_error(parser, "Expecting an operand");
+	}
+
+	return node;
+}
+
+static
+struct filter_node *parse_unary(struct filter_parser *parser)
+{
+	struct filter_node *node;
+	struct filter_node *operand;
+	enum filter_node_type type;
+
+	if (accept(parser, "!")) {
+		type = FILTER_NODE_NOT;
+	} else if (accept(parser, "-")) {
+		type = FILTER_NODE_NEG;
+	} else {
+		return parse_primary(parser);
+	}
+
+	operand = parse_unary(parser);
+	if (!operand) {
+		return NULL;
+	}
+
+	node = filter_node_create(type);
+	if (!node) {
+		filter_node_destroy(operand);
+		return NULL;
+	}
+
+	node->u.operand = operand;
+	return node;
+}
+
+static
+struct filter_node *create_binary_node(enum filter_node_type type,
+		enum filter_cmp_op op, struct filter_node *left,
+		struct filter_node *right)
+{
+	struct filter_node *node = filter_node_create(type);
+
+	if (!node) {
+		filter_node_destroy(left);
+		filter_node_destroy(right);
+		goto end;
+	}
+
+	node->u.binary.op = op;
+	node->u.binary.left = left;
+	node->u.binary.right = right;
+
+end:
+	return node;
+}
+
+static
+struct filter_node *parse_cmp(struct filter_parser *parser)
+{
+	struct filter_node *left;
+	struct filter_node *right;
+	enum filter_cmp_op op;
+
+	left = parse_unary(parser);
+	if (!left) {
+		return NULL;
+	}
+
+	/* Two-character operators first */
+	if (accept(parser, "==")) {
+		op = FILTER_CMP_EQ;
+	} else if (accept(parser, "!=")) {
+		op = FILTER_CMP_NE;
+	} else if (accept(parser, "<=")) {
+		op = FILTER_CMP_LE;
+	} else if (accept(parser, ">=")) {
+		op = FILTER_CMP_GE;
+	} else if (accept(parser, "<")) {
+		op = FILTER_CMP_LT;
+	} else if (accept(parser, ">")) {
+		op = FILTER_CMP_GT;
+	} else {
+		return left;
+	}
+
+	right = parse_unary(parser);
+	if (!right) {
+		filter_node_destroy(left);
+		return NULL;
+	}
+
+	return create_binary_node(FILTER_NODE_CMP, op, left, right);
+}
+
+static
+struct filter_node *parse_and(struct filter_parser *parser)
+{
+	struct filter_node *node = parse_cmp(parser);
+
+	while (node && accept(parser, "&&")) {
+		struct filter_node *right = parse_cmp(parser);
+
+		if (!right) {
+			filter_node_destroy(node);
+			return NULL;
+		}
+
+		node = create_binary_node(FILTER_NODE_AND, 0, node, right);
+	}
+
+	return node;
+}
+
+static
+struct filter_node *parse_or(struct filter_parser *parser)
+{
+	struct filter_node *node = parse_and(parser);
+
+	while (node && accept(parser, "||")) {
+		struct filter_node *right = parse_and(parser);
+
+		if (!right) {
+			filter_node_destroy(node);
+			return NULL;
+		}
+
+		node = create_binary_node(FILTER_NODE_OR, 0, node, right);
+	}
+
+	return node;
+}
+
+BT_HIDDEN
+struct filter_expr *filter_expr_parse(const char *text, GString *error)
+{
+	struct filter_expr *expr = NULL;
+	struct filter_parser parser = {
+		.text = text,
+		.at = text,
+		.error = error,
+	};
+	struct filter_node *root;
+
+	root = parse_or(&parser);
+	if (!root) {
+		goto end;
+	}
+
+	skip_spaces(&parser);
+	if (*parser.at != '\0') {
+		parser_error(&parser, "Unexpected token");
+		filter_node_destroy(root);
+		goto end;
+	}
+
+	expr = g_new0(struct filter_expr, 1);
+	if (!expr) {
+		filter_node_destroy(root);
+		goto end;
+	}
+
+	expr->root = root;
+
+end:
+	return expr;
+}
+
+BT_HIDDEN
+void filter_expr_destroy(struct filter_expr *expr)
+{
+	if (!expr) {
+		return;
+	}
+
+	filter_node_destroy(expr->root);
+	g_free(expr);
+}
+
+/* Values */
+
+static
+bool value_is_true(const struct filter_value *value)
+{
+	switch (value->type) {
+	case FILTER_VALUE_INT:
+		return value->u.i != 0;
+	case FILTER_VALUE_UINT:
+		return value->u.u != 0;
+	case FILTER_VALUE_FLOAT:
+		return value->u.f != 0;
+	case FILTER_VALUE_STRING:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static
+void set_bool_value(struct filter_value *value, bool result)
+{
+	value->type = FILTER_VALUE_INT;
+	value->u.i = result;
+}
+
+static
+void negate_value(struct filter_value *value)
+{
+	switch (value->type) {
+	case FILTER_VALUE_INT:
+		value->u.i = -value->u.i;
+		break;
+	case FILTER_VALUE_UINT:
+		if (value->u.u == (uint64_t) INT64_MAX + 1) {
+			value->type = FILTER_VALUE_INT;
+			value->u.i = INT64_MIN;
+		} else {
+			value->type = FILTER_VALUE_FLOAT;
+			value->u.f = -((double) value->u.u);
+		}
+		break;
+	case FILTER_VALUE_FLOAT:
+		value->u.f = -value->u.f;
+		break;
+	default:
+		value->type = FILTER_VALUE_NONE;
+		break;
+	}
+}
+
+static
+double value_as_double(const struct filter_value *value)
+{
+	switch (value->type) {
+	case FILTER_VALUE_INT:
+		return (double) value->u.i;
+	case FILTER_VALUE_UINT:
+		return (double) value->u.u;
+	default:
+		return value->u.f;
+	}
+}
+
+/*
+ * Compares two numeric values, returning a negative value, 0, or a
+ * positive value.
+ */
+static
+int compare_numbers(const struct filter_value *a, const struct filter_value *b)
+{
+	if (a->type == FILTER_VALUE_FLOAT || b->type == FILTER_VALUE_FLOAT) {
+		double da = value_as_double(a);
+		double db = value_as_double(b);
+
+		return (da > db) - (da < db);
+	}
+
+	if (a->type == FILTER_VALUE_INT && b->type == FILTER_VALUE_INT) {
+		return (a->u.i > b->u.i) - (a->u.i < b->u.i);
+	}
+
+	if (a->type == FILTER_VALUE_UINT && b->type == FILTER_VALUE_UINT) {
+		return (a->u.u > b->u.u) - (a->u.u < b->u.u);
+	}
+
+	/* Mixed signedness */
+	if (a->type == FILTER_VALUE_INT) {
+		if (a->u.i < 0) {
+			return -1;
+		}
+
+		return ((uint64_t) a->u.i > b->u.u) -
+			((uint64_t) a->u.i < b->u.u);
+	}
+
+	if (b->u.i < 0) {
+		return 1;
+	}
+
+	return (a->u.u > (uint64_t) b->u.i) - (a->u.u < (uint64_t) b->u.i);
+}
+
+static
+bool compare_values(const struct filter_value *a, const struct filter_value *b,
+		enum filter_cmp_op op)
+{
+	int cmp;
+
+	if (a->type == FILTER_VALUE_NONE || b->type == FILTER_VALUE_NONE) {
+		return false;
+	}
+
+	if ((a->type == FILTER_VALUE_STRING) !=
+			(b->type == FILTER_VALUE_STRING)) {
+		return false;
+	}
+
+	if (a->type == FILTER_VALUE_STRING) {
+		cmp = strcmp(a->u.s, b->u.s);
+	} else {
+		cmp = compare_numbers(a, b);
+	}
+
+	switch (op) {
+	case FILTER_CMP_EQ:
+		return cmp == 0;
+	case FILTER_CMP_NE:
+		return cmp != 0;
+	case FILTER_CMP_LT:
+		return cmp < 0;
+	case FILTER_CMP_LE:
+		return cmp <= 0;
+	case FILTER_CMP_GT:
+		return cmp > 0;
+	case FILTER_CMP_GE:
+		return cmp >= 0;
+	default:
+		abort();
+	}
+}
+
+/* Compiler */
+
+struct filter_compiler {
+	struct bt_ctf_event_class *event_class;
+	struct filter_program *program;
+	size_t depth;
+};
+
+/*
+ * Resolves the field path `path` within the field type `root_type`,
+ * appending the structure field indexes to `indexes` and setting
+ * `*field_type` to the type of the designated field (new reference).
+ *
+ * Returns -1 if there's no such field.
+ */
+static
+int resolve_field_path(struct bt_ctf_field_type *root_type, GPtrArray *path,
+		GArray *indexes, struct bt_ctf_field_type **field_type)
+{
+	int ret = 0;
+	struct bt_ctf_field_type *type = bt_get(root_type);
+	size_t i;
+
+	for (i = 0; i < path->len; i++) {
+		const char *name = g_ptr_array_index(path, i);
+		struct bt_ctf_field_type *member_type = NULL;
+		int count;
+		int index;
+		uint64_t index_u64;
+
+		if (!type || bt_ctf_field_type_get_type_id(type) !=
+				BT_CTF_FIELD_TYPE_ID_STRUCT) {
+			goto error;
+		}
+
+		count = bt_ctf_field_type_structure_get_field_count(type);
+		for (index = 0; index < count; index++) {
+			const char *member_name;
+
+			ret = bt_ctf_field_type_structure_get_field_by_index(
+				type, &member_name, &member_type, index);
+			if (ret) {
+				goto error;
+			}
+
+			if (strcmp(member_name, name) == 0) {
+				break;
+			}
+
+			BT_PUT(member_type);
+		}
+
+		if (index == count) {
+			goto error;
+		}
+
+		index_u64 = (uint64_t) index;
+		g_array_append_val(indexes, index_u64);
+		BT_MOVE(type, member_type);
+	}
+
+	*field_type = type;
+	goto end;
+
+error:
+	bt_put(type);
+	ret = -1;
+
+end:
+	return ret;
+}
+
+static
+struct bt_ctf_field_type *get_scope_type(
+		struct bt_ctf_event_class *event_class, enum filter_scope scope)
+{
+	struct bt_ctf_field_type *type = NULL;
+	struct bt_ctf_stream_class *stream_class = NULL;
+
+	switch (scope) {
+	case FILTER_SCOPE_PAYLOAD:
+		type = bt_ctf_event_class_get_payload_type(event_class);
+		break;
+	case FILTER_SCOPE_EVENT_CONTEXT:
+		type = bt_ctf_event_class_get_context_type(event_class);
+		break;
+	case FILTER_SCOPE_STREAM_EVENT_CONTEXT:
+		stream_class = bt_ctf_event_class_get_stream_class(event_class);
+		if (stream_class) {
+			type = bt_ctf_stream_class_get_event_context_type(
+				stream_class);
+		}
+		break;
+	case FILTER_SCOPE_PACKET_CONTEXT:
+		stream_class = bt_ctf_event_class_get_stream_class(event_class);
+		if (stream_class) {
+			type = bt_ctf_stream_class_get_packet_context_type(
+				stream_class);
+		}
+		break;
+	default:
+		abort();
+	}
+
+	bt_put(stream_class);
+	return type;
+}
+
+/*
+ * Resolves the field reference `node` for the compiler's event class,
+ * filling the load instruction `insn`.
+ *
+ * Returns -1 if the field does not exist for this event class.
+ */
+static
+int resolve_field(struct filter_compiler *compiler, struct filter_node *node,
+		struct filter_insn *insn)
+{
+	static const enum filter_scope any_context_scopes[] = {
+		FILTER_SCOPE_EVENT_CONTEXT,
+		FILTER_SCOPE_STREAM_EVENT_CONTEXT,
+		FILTER_SCOPE_PACKET_CONTEXT,
+	};
+	const enum filter_scope *scopes = &node->u.field.scope;
+	size_t scope_count = 1;
+	size_t i;
+	int ret = -1;
+	GArray *indexes = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+	struct bt_ctf_field_type *field_type = NULL;
+
+	if (!indexes) {
+		goto end;
+	}
+
+	if (node->u.field.scope == FILTER_SCOPE_ANY_CONTEXT) {
+		scopes = any_context_scopes;
+		scope_count = sizeof(any_context_scopes) /
+			sizeof(*any_context_scopes);
+	}
+
+	for (i = 0; i < scope_count; i++) {
+		struct bt_ctf_field_type *root_type = get_scope_type(
+			compiler->event_class, scopes[i]);
+
+		g_array_set_size(indexes, 0);
+		ret = resolve_field_path(root_type, node->u.field.path,
+			indexes, &field_type);
+		bt_put(root_type);
+		if (ret == 0) {
+			insn->u.field.scope = scopes[i];
+			break;
+		}
+	}
+
+	if (ret) {
+		goto end;
+	}
+
+	insn->u.field.type_id = bt_ctf_field_type_get_type_id(field_type);
+	switch (insn->u.field.type_id) {
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+		insn->u.field.is_signed =
+			bt_ctf_field_type_integer_is_signed(field_type);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+	{
+		struct bt_ctf_field_type *container_type =
+			bt_ctf_field_type_enumeration_get_container_type(
+				field_type);
+
+		assert(container_type);
+		insn->u.field.is_signed =
+			bt_ctf_field_type_integer_is_signed(container_type);
+		bt_put(container_type);
+		break;
+	}
+	case BT_CTF_FIELD_TYPE_ID_FLOAT:
+	case BT_CTF_FIELD_TYPE_ID_STRING:
+		break;
+	default:
+		/* Compound fields cannot be compared */
+		ret = -1;
+		goto end;
+	}
+
+	insn->u.field.index_count = indexes->len;
+	insn->u.field.indexes = (uint64_t *) g_array_free(indexes, FALSE);
+	indexes = NULL;
+
+end:
+	if (indexes) {
+		g_array_free(indexes, TRUE);
+	}
+
+	bt_put(field_type);
+	return ret;
+}
+
+/*
+ * Returns whether or not `node` only depends on the compiler's event
+ * class, setting `*value` to its value if so.
+ */
+static
+bool fold_node(struct filter_compiler *compiler, struct filter_node *node,
+		struct filter_value *value)
+{
+	struct filter_value left, right;
+	struct filter_insn insn;
+	bool left_const, right_const;
+
+	switch (node->type) {
+	case FILTER_NODE_CONST:
+		*value = node->u.value;
+		return true;
+	case FILTER_NODE_NAME:
+		value->type = FILTER_VALUE_STRING;
+		value->u.s = bt_ctf_event_class_get_name(compiler->event_class);
+		if (!value->u.s) {
+			value->type = FILTER_VALUE_NONE;
+		}
+		return true;
+	case FILTER_NODE_ID:
+		value->type = FILTER_VALUE_INT;
+		value->u.i = bt_ctf_event_class_get_id(compiler->event_class);
+		if (value->u.i < 0) {
+			value->type = FILTER_VALUE_NONE;
+		}
+		return true;
+	case FILTER_NODE_TIMESTAMP:
+		return false;
+	case FILTER_NODE_FIELD:
+		if (resolve_field(compiler, node, &insn) == 0) {
+			g_free(insn.u.field.indexes);
+			return false;
+		}
+
+		/* Missing field for this event class */
+		value->type = FILTER_VALUE_NONE;
+		return true;
+	case FILTER_NODE_NEG:
+		if (!fold_node(compiler, node->u.operand, value)) {
+			return false;
+		}
+
+		negate_value(value);
+		return true;
+	case FILTER_NODE_NOT:
+		if (!fold_node(compiler, node->u.operand, value)) {
+			return false;
+		}
+
+		set_bool_value(value, !value_is_true(value));
+		return true;
+	case FILTER_NODE_CMP:
+		if (!fold_node(compiler, node->u.binary.left, &left) ||
+				!fold_node(compiler, node->u.binary.right,
+					&right)) {
+			return false;
+		}
+
+		set_bool_value(value, compare_values(&left, &right,
+			node->u.binary.op));
+		return true;
+	case FILTER_NODE_AND:
+	case FILTER_NODE_OR:
+	{
+		/* Short-circuit value: false for AND, true for OR */
+		bool short_value = node->type == FILTER_NODE_OR;
+
+		left_const = fold_node(compiler, node->u.binary.left, &left);
+		right_const = fold_node(compiler, node->u.binary.right,
+			&right);
+		if ((left_const && value_is_true(&left) == short_value) ||
+				(right_const &&
+					value_is_true(&right) == short_value)) {
+			set_bool_value(value, short_value);
+			return true;
+		}
+
+		if (left_const && right_const) {
+			set_bool_value(value, !short_value);
+			return true;
+		}
+
+		return false;
+	}
+	default:
+		abort();
+	}
+}
+
+static
+void emit(struct filter_compiler *compiler, struct filter_insn *insn,
+		int depth_change)
+{
+	g_array_append_val(compiler->program->insns, *insn);
+	compiler->depth += depth_change;
+	if (compiler->depth > compiler->program->stack_size) {
+		compiler->program->stack_size = compiler->depth;
+	}
+}
+
+static
+int emit_node(struct filter_compiler *compiler, struct filter_node *node)
+{
+	int ret = 0;
+	struct filter_insn insn = { 0 };
+	struct filter_value value;
+	struct filter_value left_value, right_value;
+
+	if (fold_node(compiler, node, &value)) {
+		insn.op = FILTER_OP_PUSH;
+		insn.u.value = value;
+		emit(compiler, &insn, 1);
+		goto end;
+	}
+
+	switch (node->type) {
+	case FILTER_NODE_TIMESTAMP:
+		insn.op = FILTER_OP_LOAD_TIMESTAMP;
+		emit(compiler, &insn, 1);
+		break;
+	case FILTER_NODE_FIELD:
+		insn.op = FILTER_OP_LOAD_FIELD;
+		ret = resolve_field(compiler, node, &insn);
+		assert(ret == 0);
+		emit(compiler, &insn, 1);
+		break;
+	case FILTER_NODE_NEG:
+	case FILTER_NODE_NOT:
+		ret = emit_node(compiler, node->u.operand);
+		if (ret) {
+			goto end;
+		}
+
+		insn.op = node->type == FILTER_NODE_NEG ?
+			FILTER_OP_NEG : FILTER_OP_NOT;
+		emit(compiler, &insn, 0);
+		break;
+	case FILTER_NODE_CMP:
+		ret = emit_node(compiler, node->u.binary.left);
+		if (ret) {
+			goto end;
+		}
+
+		ret = emit_node(compiler, node->u.binary.right);
+		if (ret) {
+			goto end;
+		}
+
+		insn.op = FILTER_OP_CMP;
+		insn.u.cmp_op = node->u.binary.op;
+		emit(compiler, &insn, -1);
+		break;
+	case FILTER_NODE_AND:
+	case FILTER_NODE_OR:
+	{
+		size_t jump_index;
+
+		/*
+		 * A constant operand here does not decide the result:
+		 * only evaluate the other one.
+		 */
+		if (fold_node(compiler, node->u.binary.left, &left_value)) {
+			ret = emit_node(compiler, node->u.binary.right);
+			insn.op = FILTER_OP_TO_BOOL;
+			emit(compiler, &insn, 0);
+			break;
+		}
+
+		if (fold_node(compiler, node->u.binary.right, &right_value)) {
+			ret = emit_node(compiler, node->u.binary.left);
+			insn.op = FILTER_OP_TO_BOOL;
+			emit(compiler, &insn, 0);
+			break;
+		}
+
+		ret = emit_node(compiler, node->u.binary.left);
+		if (ret) {
+			goto end;
+		}
+
+		jump_index = compiler->program->insns->len;
+		insn.op = node->type == FILTER_NODE_AND ?
+			FILTER_OP_JUMP_IF_FALSE : FILTER_OP_JUMP_IF_TRUE;
+		emit(compiler, &insn, -1);
+		ret = emit_node(compiler, node->u.binary.right);
+		if (ret) {
+			goto end;
+		}
+
+		insn.op = FILTER_OP_TO_BOOL;
+		emit(compiler, &insn, 0);
+		g_array_index(compiler->program->insns, struct filter_insn,
+			jump_index).u.target = compiler->program->insns->len;
+		break;
+	}
+	default:
+		abort();
+	}
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+struct filter_program *filter_program_compile(struct filter_expr *expr,
+		struct bt_ctf_event_class *event_class)
+{
+	struct filter_program *program = g_new0(struct filter_program, 1);
+	struct filter_compiler compiler = {
+		.event_class = event_class,
+		.program = program,
+		.depth = 0,
+	};
+	struct filter_value value;
+
+	if (!program) {
+		goto error;
+	}
+
+	program->event_class = bt_get(event_class);
+	program->insns = g_array_new(FALSE, FALSE, sizeof(struct filter_insn));
+	if (!program->insns) {
+		goto error;
+	}
+
+	if (fold_node(&compiler, expr->root, &value)) {
+		program->is_constant = true;
+		program->constant_result = value_is_true(&value);
+		goto end;
+	}
+
+	if (emit_node(&compiler, expr->root)) {
+		goto error;
+	}
+
+	assert(compiler.depth == 1);
+	program->stack = g_new0(struct filter_value, program->stack_size);
+	if (!program->stack) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	filter_program_destroy(program);
+	program = NULL;
+
+end:
+	return program;
+}
+
+BT_HIDDEN
+void filter_program_destroy(struct filter_program *program)
+{
+	size_t i;
+
+	if (!program) {
+		return;
+	}
+
+	if (program->insns) {
+		for (i = 0; i < program->insns->len; i++) {
+			struct filter_insn *insn = &g_array_index(
+				program->insns, struct filter_insn, i);
+
+			if (insn->op == FILTER_OP_LOAD_FIELD) {
+				g_free(insn->u.field.indexes);
+			}
+		}
+
+		g_array_free(program->insns, TRUE);
+	}
+
+	g_free(program->stack);
+	bt_put(program->event_class);
+	g_free(program);
+}
+
+BT_HIDDEN
+bool filter_program_is_constant(struct filter_program *program,
+		bool *result)
+{
+	if (program->is_constant) {
+		*result = program->constant_result;
+	}
+
+	return program->is_constant;
+}
+
+/* Interpreter */
+
+static
+struct bt_ctf_field *get_scope_field(struct bt_ctf_event *event,
+		enum filter_scope scope)
+{
+	struct bt_ctf_field *field = NULL;
+	struct bt_ctf_packet *packet;
+
+	switch (scope) {
+	case FILTER_SCOPE_PAYLOAD:
+		field = bt_ctf_event_get_event_payload(event);
+		break;
+	case FILTER_SCOPE_EVENT_CONTEXT:
+		field = bt_ctf_event_get_event_context(event);
+		break;
+	case FILTER_SCOPE_STREAM_EVENT_CONTEXT:
+		field = bt_ctf_event_get_stream_event_context(event);
+		break;
+	case FILTER_SCOPE_PACKET_CONTEXT:
+		packet = bt_ctf_event_get_packet(event);
+		if (packet) {
+			field = bt_ctf_packet_get_context(packet);
+			bt_put(packet);
+		}
+		break;
+	default:
+		abort();
+	}
+
+	return field;
+}
+
+static
+void load_field(struct filter_insn *insn, struct bt_ctf_event *event,
+		struct filter_value *value)
+{
+	struct bt_ctf_field *field;
+	struct bt_ctf_field *int_field = NULL;
+	size_t i;
+	int ret = -1;
+
+	value->type = FILTER_VALUE_NONE;
+	field = get_scope_field(event, insn->u.field.scope);
+
+	for (i = 0; field && i < insn->u.field.index_count; i++) {
+		struct bt_ctf_field *member =
+			bt_ctf_field_structure_get_field_by_index(field,
+				insn->u.field.indexes[i]);
+
+		BT_MOVE(field, member);
+	}
+
+	if (!field) {
+		goto end;
+	}
+
+	switch (insn->u.field.type_id) {
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+		int_field = bt_ctf_field_enumeration_get_container(field);
+		if (!int_field) {
+			goto end;
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+		int_field = bt_get(field);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_FLOAT:
+		ret = bt_ctf_field_floating_point_get_value(field,
+			&value->u.f);
+		if (ret == 0) {
+			value->type = FILTER_VALUE_FLOAT;
+		}
+		goto end;
+	case BT_CTF_FIELD_TYPE_ID_STRING:
+		/* The event keeps the field and its string */
+		value->u.s = bt_ctf_field_string_get_value(field);
+		if (value->u.s) {
+			value->type = FILTER_VALUE_STRING;
+		}
+		goto end;
+	default:
+		abort();
+	}
+
+	if (insn->u.field.is_signed) {
+		ret = bt_ctf_field_signed_integer_get_value(int_field,
+			&value->u.i);
+		if (ret == 0) {
+			value->type = FILTER_VALUE_INT;
+		}
+	} else {
+		ret = bt_ctf_field_unsigned_integer_get_value(int_field,
+			&value->u.u);
+		if (ret == 0) {
+			value->type = FILTER_VALUE_UINT;
+		}
+	}
+
+end:
+	bt_put(int_field);
+	bt_put(field);
+}
+
+static
+void load_timestamp(struct bt_ctf_event *event,
+		struct bt_clock_class_priority_map *cc_prio_map,
+		struct filter_value *value)
+{
+	struct bt_ctf_clock_class *clock_class = NULL;
+	struct bt_ctf_clock_value *clock_value = NULL;
+
+	value->type = FILTER_VALUE_NONE;
+	if (!cc_prio_map) {
+		goto end;
+	}
+
+	clock_class =
+		bt_clock_class_priority_map_get_highest_priority_clock_class(
+			cc_prio_map);
+	if (!clock_class) {
+		goto end;
+	}
+
+	clock_value = bt_ctf_event_get_clock_value(event, clock_class);
+	if (!clock_value) {
+		goto end;
+	}
+
+	if (bt_ctf_clock_value_get_value_ns_from_epoch(clock_value,
+			&value->u.i) == 0) {
+		value->type = FILTER_VALUE_INT;
+	}
+
+end:
+	bt_put(clock_value);
+	bt_put(clock_class);
+}
+
+BT_HIDDEN
+bool filter_program_evaluate(struct filter_program *program,
+		struct bt_ctf_event *event,
+		struct bt_clock_class_priority_map *cc_prio_map)
+{
+	struct filter_value *top = program->stack - 1;
+	struct filter_insn *insns = (struct filter_insn *) program->insns->data;
+	size_t pc = 0;
+
+	if (program->is_constant) {
+		return program->constant_result;
+	}
+
+	while (pc < program->insns->len) {
+		struct filter_insn *insn = &insns[pc];
+
+		pc++;
+
+		switch (insn->op) {
+		case FILTER_OP_PUSH:
+			*++top = insn->u.value;
+			break;
+		case FILTER_OP_LOAD_FIELD:
+			load_field(insn, event, ++top);
+			break;
+		case FILTER_OP_LOAD_TIMESTAMP:
+			load_timestamp(event, cc_prio_map, ++top);
+			break;
+		case FILTER_OP_NEG:
+			negate_value(top);
+			break;
+		case FILTER_OP_NOT:
+			set_bool_value(top, !value_is_true(top));
+			break;
+		case FILTER_OP_TO_BOOL:
+			set_bool_value(top, value_is_true(top));
+			break;
+		case FILTER_OP_CMP:
+			top--;
+			set_bool_value(top, compare_values(top, top + 1,
+				insn->u.cmp_op));
+			break;
+		case FILTER_OP_JUMP_IF_FALSE:
+		case FILTER_OP_JUMP_IF_TRUE:
+		{
+			bool jump_value = insn->op == FILTER_OP_JUMP_IF_TRUE;
+
+			if (value_is_true(top) == jump_value) {
+				set_bool_value(top, jump_value);
+				pc = insn->u.target;
+			} else {
+				top--;
+			}
+			break;
+		}
+		default:
+			abort();
+		}
+	}
+
+	assert(top == program->stack);
+	return value_is_true(top);
+}
@@ -0,0 +1,108 @@
+#ifndef BABELTRACE_PLUGINS_UTILS_FILTER_EXPR_H
+#define BABELTRACE_PLUGINS_UTILS_FILTER_EXPR_H
+
+/*
+ * BabelTrace - Filter expressions
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <glib.h>
+#include <babeltrace/babeltrace-internal.h>
+
+struct bt_ctf_event;
+struct bt_ctf_event_class;
+struct bt_clock_class_priority_map;
+
+/*
+ * A filter expression is parsed once, and then compiled once per
+ * event class to a filter program: the event class name and ID are
+ * constants within a program, and field references are resolved to
+ * field indexes. A program which only depends on the event class
+ * folds to a constant, so that the events of this class are accepted
+ * or dropped without reading any of their fields.
+ *
+ * Expression syntax:
+ *
+ *     EXPR && EXPR, EXPR || EXPR, !EXPR, (EXPR), -EXPR
+ *     EXPR OP EXPR, where OP is ==, !=, <, <=, >, or >=
+ *     123, 0x7b, 1.5, "string"
+ *     name, $name     Event class name
+ *     $id             Event class ID
+ *     $ts             Event time (ns from origin, first priority clock)
+ *     a.b             Event payload field `b` of structure `a`
+ *     $payload.a      Event payload field `a` (`name` is a field)
+ *     $event_ctx.a    Event context field `a`
+ *     $stream_ctx.a   Stream event context field `a`
+ *     $packet_ctx.a   Packet context field `a`
+ *     $ctx.a          First field `a` of the event context, stream
+ *                     event context, or packet context
+ *
+ * A comparison is false if one of its operands is a missing field
+ * or if their types are incompatible (string versus number).
+ */
+struct filter_expr;
+struct filter_program;
+
+/*
+ * Parses the expression `text`.
+ *
+ * Returns `NULL` on error, appending a description of the error to
+ * `error`.
+ */
+BT_HIDDEN
+struct filter_expr *filter_expr_parse(const char *text, GString *error);
+
+BT_HIDDEN
+void filter_expr_destroy(struct filter_expr *expr);
+
+/*
+ * Compiles the parsed expression `expr` for the events of the class
+ * `event_class`. `expr` must exist as long as the returned program
+ * exists.
+ */
+BT_HIDDEN
+struct filter_program *filter_program_compile(struct filter_expr *expr,
+		struct bt_ctf_event_class *event_class);
+
+BT_HIDDEN
+void filter_program_destroy(struct filter_program *program);
+
+/*
+ * Returns whether or not the result of `program` only depends on its
+ * event class, setting `*result` to this result if so.
+ */
+BT_HIDDEN
+bool filter_program_is_constant(struct filter_program *program,
+		bool *result);
+
+/*
+ * Evaluates `program` for the event `event`, of which the time is
+ * found with `cc_prio_map` (may be `NULL`). This function does not
+ * allocate memory.
+ */
+BT_HIDDEN
+bool filter_program_evaluate(struct filter_program *program,
+		struct bt_ctf_event *event,
+		struct bt_clock_class_priority_map *cc_prio_map);
+
+#endif /* BABELTRACE_PLUGINS_UTILS_FILTER_EXPR_H */
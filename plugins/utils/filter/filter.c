@@ -0,0 +1,363 @@
+/*
+ * filter.c
+ *
+ * Babeltrace Event Filter Component
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <babeltrace/plugin/plugin-dev.h>
+#include <babeltrace/graph/component.h>
+#include <babeltrace/graph/private-component.h>
+#include <babeltrace/graph/component-filter.h>
+#include <babeltrace/graph/private-component-filter.h>
+#include <babeltrace/graph/notification.h>
+#include <babeltrace/graph/notification-event.h>
+#include <babeltrace/graph/notification-iterator.h>
+#include <babeltrace/graph/private-notification-iterator.h>
+#include <babeltrace/graph/private-connection.h>
+#include <babeltrace/graph/connection.h>
+#include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/values.h>
+#include <babeltrace/ref.h>
+#include <plugins-common.h>
+#include <assert.h>
+#include "filter.h"
+
+static
+void destroy_filter_data(struct filter *filter)
+{
+	if (!filter) {
+		return;
+	}
+
+	if (filter->programs) {
+		g_hash_table_destroy(filter->programs);
+	}
+
+	filter_expr_destroy(filter->expr);
+	g_free(filter);
+}
+
+static
+struct filter *create_filter_data(void)
+{
+	struct filter *filter = g_new0(struct filter, 1);
+
+	if (!filter) {
+		goto end;
+	}
+
+	filter->programs = g_hash_table_new_full(g_direct_hash,
+		g_direct_equal, (GDestroyNotify) bt_put,
+		(GDestroyNotify) filter_program_destroy);
+	if (!filter->programs) {
+		destroy_filter_data(filter);
+		filter = NULL;
+	}
+
+end:
+	return filter;
+}
+
+static
+enum bt_component_status init_from_params(struct filter *filter,
+		struct bt_value *params)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_value *value = NULL;
+	GString *error = NULL;
+	const char *text;
+
+	value = bt_value_map_get(params, "expression");
+	if (!value) {
+		printf_error("Missing expression parameter");
+		ret = BT_COMPONENT_STATUS_INVALID;
+		goto end;
+	}
+
+	if (bt_value_string_get(value, &text)) {
+		printf_error("Failed to retrieve expression value. Expecting a string");
+		ret = BT_COMPONENT_STATUS_INVALID;
+		goto end;
+	}
+
+	error = g_string_new(NULL);
+	if (!error) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto end;
+	}
+
+	filter->expr = filter_expr_parse(text, error);
+	if (!filter->expr) {
+		printf_error("Invalid filter expression: %s", error->str);
+		ret = BT_COMPONENT_STATUS_INVALID;
+		goto end;
+	}
+
+end:
+	if (error) {
+		g_string_free(error, TRUE);
+	}
+
+	bt_put(value);
+	return ret;
+}
+
+BT_HIDDEN
+enum bt_component_status filter_component_init(
+		struct bt_private_component *component,
+		struct bt_value *params, UNUSED_VAR void *init_method_data)
+{
+	enum bt_component_status ret;
+	struct filter *filter = create_filter_data();
+
+	if (!filter) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto end;
+	}
+
+	ret = init_from_params(filter, params);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
+	/* Create input and output ports */
+	ret = bt_private_component_filter_add_input_private_port(
+		component, "in", NULL, NULL);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
+	ret = bt_private_component_filter_add_output_private_port(
+		component, "out", NULL, NULL);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
+	ret = bt_private_component_set_user_data(component, filter);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	destroy_filter_data(filter);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+void filter_component_finalize(struct bt_private_component *component)
+{
+	destroy_filter_data(bt_private_component_get_user_data(component));
+}
+
+BT_HIDDEN
+enum bt_notification_iterator_status filter_iterator_init(
+		struct bt_private_notification_iterator *iterator,
+		UNUSED_VAR struct bt_private_port *port)
+{
+	enum bt_notification_iterator_status ret =
+		BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	enum bt_connection_status conn_status;
+	struct bt_private_port *input_port = NULL;
+	struct bt_private_connection *connection = NULL;
+	struct bt_private_component *component =
+		bt_private_notification_iterator_get_private_component(iterator);
+	struct filter_iterator *it_data = g_new0(struct filter_iterator, 1);
+
+	if (!it_data) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_NOMEM;
+		goto end;
+	}
+
+	it_data->filter = bt_private_component_get_user_data(component);
+	assert(it_data->filter);
+
+	/* Create a new iterator on the upstream component. */
+	input_port = bt_private_component_filter_get_input_private_port_by_name(
+		component, "in");
+	assert(input_port);
+	connection = bt_private_port_get_private_connection(input_port);
+	assert(connection);
+
+	/* Forward all the notification types */
+	conn_status = bt_private_connection_create_notification_iterator(
+		connection, NULL, &it_data->input_iterator);
+	if (conn_status != BT_CONNECTION_STATUS_OK) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto error;
+	}
+
+	if (bt_private_notification_iterator_set_user_data(iterator,
+			it_data)) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto error;
+	}
+
+	goto end;
+
+error:
+	bt_put(it_data->input_iterator);
+	g_free(it_data);
+
+end:
+	bt_put(component);
+	bt_put(connection);
+	bt_put(input_port);
+	return ret;
+}
+
+BT_HIDDEN
+void filter_iterator_finalize(struct bt_private_notification_iterator *it)
+{
+	struct filter_iterator *it_data =
+		bt_private_notification_iterator_get_user_data(it);
+
+	assert(it_data);
+	bt_put(it_data->input_iterator);
+	g_free(it_data);
+}
+
+/*
+ * Returns the filter program of the event class `event_class`,
+ * compiling it on first use.
+ */
+static
+struct filter_program *get_program(struct filter *filter,
+		struct bt_ctf_event_class *event_class)
+{
+	struct filter_program *program;
+
+	program = g_hash_table_lookup(filter->programs, event_class);
+	if (program) {
+		goto end;
+	}
+
+	program = filter_program_compile(filter->expr, event_class);
+	if (!program) {
+		printf_error("Cannot compile filter expression for event class \"%s\"",
+			bt_ctf_event_class_get_name(event_class));
+		goto end;
+	}
+
+	g_hash_table_insert(filter->programs, bt_get(event_class), program);
+
+end:
+	return program;
+}
+
+/*
+ * Evaluates the filter for the event notification `notification`,
+ * setting `*keep` accordingly.
+ */
+static
+enum bt_notification_iterator_status evaluate_event_notification(
+		struct filter *filter, struct bt_notification *notification,
+		bool *keep)
+{
+	enum bt_notification_iterator_status ret =
+		BT_NOTIFICATION_ITERATOR_STATUS_OK;
+	struct bt_ctf_event *event = NULL;
+	struct bt_ctf_event_class *event_class = NULL;
+	struct bt_clock_class_priority_map *cc_prio_map = NULL;
+	struct filter_program *program;
+
+	event = bt_notification_event_get_event(notification);
+	assert(event);
+	event_class = bt_ctf_event_get_class(event);
+	assert(event_class);
+	program = get_program(filter, event_class);
+	if (!program) {
+		ret = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+		goto end;
+	}
+
+	/* Classes which only depend on their name or ID: no field reads */
+	if (filter_program_is_constant(program, keep)) {
+		goto end;
+	}
+
+	cc_prio_map = bt_notification_event_get_clock_class_priority_map(
+		notification);
+	*keep = filter_program_evaluate(program, event, cc_prio_map);
+
+end:
+	bt_put(cc_prio_map);
+	bt_put(event_class);
+	bt_put(event);
+	return ret;
+}
+
+BT_HIDDEN
+struct bt_notification_iterator_next_return filter_iterator_next(
+		struct bt_private_notification_iterator *iterator)
+{
+	struct filter_iterator *it_data;
+	struct bt_notification_iterator_next_return ret = {
+		.status = BT_NOTIFICATION_ITERATOR_STATUS_OK,
+		.notification = NULL,
+	};
+	bool keep = false;
+
+	it_data = bt_private_notification_iterator_get_user_data(iterator);
+	assert(it_data);
+
+	while (!keep) {
+		ret.status = bt_notification_iterator_next(
+			it_data->input_iterator);
+		if (ret.status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			goto end;
+		}
+
+		ret.notification = bt_notification_iterator_get_notification(
+			it_data->input_iterator);
+		if (!ret.notification) {
+			ret.status = BT_NOTIFICATION_ITERATOR_STATUS_ERROR;
+			goto end;
+		}
+
+		if (bt_notification_get_type(ret.notification) !=
+				BT_NOTIFICATION_TYPE_EVENT) {
+			/* Forward anything which is not an event as is */
+			keep = true;
+			break;
+		}
+
+		ret.status = evaluate_event_notification(it_data->filter,
+			ret.notification, &keep);
+		if (ret.status != BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+			BT_PUT(ret.notification);
+			goto end;
+		}
+
+		if (!keep) {
+			BT_PUT(ret.notification);
+		}
+	}
+
+end:
+	return ret;
+}
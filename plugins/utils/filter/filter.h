@@ -0,0 +1,76 @@
+#ifndef BABELTRACE_PLUGINS_UTILS_FILTER_H
+#define BABELTRACE_PLUGINS_UTILS_FILTER_H
+
+/*
+ * BabelTrace - Event Filter Plug-in
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/graph/component.h>
+#include <babeltrace/graph/notification-iterator.h>
+#include <babeltrace/graph/private-component.h>
+#include <babeltrace/graph/private-notification-iterator.h>
+#include <babeltrace/graph/private-port.h>
+#include "expr.h"
+
+struct filter {
+	/* Owned by this */
+	struct filter_expr *expr;
+
+	/*
+	 * Event class (owned by this) to filter program (owned by this),
+	 * filled as event classes are encountered.
+	 */
+	GHashTable *programs;
+};
+
+struct filter_iterator {
+	/* Owned by this */
+	struct bt_notification_iterator *input_iterator;
+
+	/* Weak */
+	struct filter *filter;
+};
+
+BT_HIDDEN
+enum bt_component_status filter_component_init(
+		struct bt_private_component *component,
+		struct bt_value *params, void *init_method_data);
+
+BT_HIDDEN
+void filter_component_finalize(struct bt_private_component *component);
+
+BT_HIDDEN
+enum bt_notification_iterator_status filter_iterator_init(
+		struct bt_private_notification_iterator *iterator,
+		struct bt_private_port *port);
+
+BT_HIDDEN
+void filter_iterator_finalize(struct bt_private_notification_iterator *it);
+
+BT_HIDDEN
+struct bt_notification_iterator_next_return filter_iterator_next(
+		struct bt_private_notification_iterator *iterator);
+
+#endif /* BABELTRACE_PLUGINS_UTILS_FILTER_H */
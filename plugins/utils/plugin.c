@@ -25,6 +25,8 @@
 #include "trimmer/trimmer.h"
 #include "trimmer/iterator.h"
 #include "muxer/muxer.h"
+#include "filter/filter.h"
+#include "stats/stats.h"
 
 BT_PLUGIN(utils);
 BT_PLUGIN_DESCRIPTION("Graph utilities");
@@ -38,7 +40,16 @@ BT_PLUGIN_SINK_COMPONENT_CLASS_FINALIZE_METHOD(dummy, dummy_finalize);
 BT_PLUGIN_SINK_COMPONENT_CLASS_PORT_CONNECTED_METHOD(dummy,
 	dummy_port_connected);
 BT_PLUGIN_SINK_COMPONENT_CLASS_DESCRIPTION(dummy,
-	"Consume notifications and discard them.");
+	"Consume notifications and discard them, optionally reporting the throughput.");
+
+/* stats sink */
+BT_PLUGIN_SINK_COMPONENT_CLASS(stats, stats_consume);
+BT_PLUGIN_SINK_COMPONENT_CLASS_INIT_METHOD(stats, stats_init);
+BT_PLUGIN_SINK_COMPONENT_CLASS_FINALIZE_METHOD(stats, stats_finalize);
+BT_PLUGIN_SINK_COMPONENT_CLASS_PORT_CONNECTED_METHOD(stats,
+	stats_port_connected);
+BT_PLUGIN_SINK_COMPONENT_CLASS_DESCRIPTION(stats,
+	"Compute event counts, rates, field statistics, and latencies in a single pass.");
 
 /* trimmer filter */
 BT_PLUGIN_FILTER_COMPONENT_CLASS(trimmer, trimmer_iterator_next);
@@ -67,3 +78,15 @@ BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_INIT_METHOD(muxer,
 	muxer_notif_iter_init);
 BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_FINALIZE_METHOD(muxer,
 	muxer_notif_iter_finalize);
+
+/* filter filter */
+BT_PLUGIN_FILTER_COMPONENT_CLASS(filter, filter_iterator_next);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_DESCRIPTION(filter,
+	"Keep events matching a predicate expression.");
+BT_PLUGIN_FILTER_COMPONENT_CLASS_INIT_METHOD(filter, filter_component_init);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_FINALIZE_METHOD(filter,
+	filter_component_finalize);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_INIT_METHOD(filter,
+	filter_iterator_init);
+BT_PLUGIN_FILTER_COMPONENT_CLASS_NOTIFICATION_ITERATOR_FINALIZE_METHOD(filter,
+	filter_iterator_finalize);
@@ -0,0 +1,161 @@
+/*
+ * histogram.c
+ *
+ * Babeltrace Statistics Sink: Latency Histograms
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <glib.h>
+#include "histogram.h"
+
+static
+unsigned int get_bucket_index(uint64_t value)
+{
+	unsigned int msb;
+	unsigned int shift;
+
+	/* Values below two sub-bucket ranges are exact */
+	if (value < 2 * STATS_HISTOGRAM_SUB_BUCKET_COUNT) {
+		return (unsigned int) value;
+	}
+
+	msb = 63 - __builtin_clzll(value);
+	shift = msb - STATS_HISTOGRAM_SUB_BUCKET_BITS;
+
+	/* (value >> shift) is within [SUB_BUCKET_COUNT, 2 * SUB_BUCKET_COUNT[ */
+	return (shift + 1) * STATS_HISTOGRAM_SUB_BUCKET_COUNT +
+		(unsigned int) ((value >> shift) -
+			STATS_HISTOGRAM_SUB_BUCKET_COUNT);
+}
+
+/* Returns the highest value of which the bucket is `index`. */
+static
+uint64_t get_bucket_highest_value(unsigned int index)
+{
+	unsigned int shift;
+	uint64_t sub;
+
+	if (index < 2 * STATS_HISTOGRAM_SUB_BUCKET_COUNT) {
+		return index;
+	}
+
+	shift = index / STATS_HISTOGRAM_SUB_BUCKET_COUNT - 1;
+	sub = index % STATS_HISTOGRAM_SUB_BUCKET_COUNT +
+		STATS_HISTOGRAM_SUB_BUCKET_COUNT;
+	return (sub << shift) + ((1ULL << shift) - 1);
+}
+
+BT_HIDDEN
+struct stats_histogram *stats_histogram_create(void)
+{
+	struct stats_histogram *histogram = g_new0(struct stats_histogram, 1);
+
+	if (!histogram) {
+		goto error;
+	}
+
+	histogram->counts = g_new0(uint64_t, STATS_HISTOGRAM_BUCKET_COUNT);
+	if (!histogram->counts) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	stats_histogram_destroy(histogram);
+	histogram = NULL;
+
+end:
+	return histogram;
+}
+
+BT_HIDDEN
+void stats_histogram_destroy(struct stats_histogram *histogram)
+{
+	if (!histogram) {
+		return;
+	}
+
+	g_free(histogram->counts);
+	g_free(histogram);
+}
+
+BT_HIDDEN
+void stats_histogram_record(struct stats_histogram *histogram,
+		uint64_t value)
+{
+	histogram->counts[get_bucket_index(value)]++;
+
+	if (histogram->count == 0 || value < histogram->min) {
+		histogram->min = value;
+	}
+
+	if (histogram->count == 0 || value > histogram->max) {
+		histogram->max = value;
+	}
+
+	histogram->count++;
+	histogram->sum += (double) value;
+}
+
+BT_HIDDEN
+uint64_t stats_histogram_get_percentile(struct stats_histogram *histogram,
+		double percentile)
+{
+	double exact_target;
+	uint64_t target;
+	uint64_t seen = 0;
+	uint64_t value = 0;
+	unsigned int i;
+
+	if (histogram->count == 0) {
+		goto end;
+	}
+
+	/* Rank of the value, rounded up */
+	exact_target = percentile / 100. * (double) histogram->count;
+	target = (uint64_t) exact_target;
+	if ((double) target < exact_target || target == 0) {
+		target++;
+	}
+
+	for (i = 0; i < STATS_HISTOGRAM_BUCKET_COUNT; i++) {
+		seen += histogram->counts[i];
+		if (seen >= target) {
+			value = get_bucket_highest_value(i);
+			break;
+		}
+	}
+
+	/* Never report a value outside the recorded range */
+	if (value > histogram->max) {
+		value = histogram->max;
+	}
+
+	if (value < histogram->min) {
+		value = histogram->min;
+	}
+
+end:
+	return value;
+}
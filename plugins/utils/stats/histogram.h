@@ -0,0 +1,73 @@
+#ifndef BABELTRACE_PLUGINS_UTILS_STATS_HISTOGRAM_H
+#define BABELTRACE_PLUGINS_UTILS_STATS_HISTOGRAM_H
+
+/*
+ * BabelTrace - Statistics Sink: Latency Histograms
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <babeltrace/babeltrace-internal.h>
+
+/*
+ * Log-linear histogram of unsigned 64-bit values, in the style of HDR
+ * histograms: each power of two range is divided in
+ * 2^STATS_HISTOGRAM_SUB_BUCKET_BITS linear sub-buckets, so that the
+ * relative error of a recorded value is at most 1 / 2^(bits + 1)
+ * whatever its magnitude, with a fixed memory footprint.
+ */
+#define STATS_HISTOGRAM_SUB_BUCKET_BITS		5
+#define STATS_HISTOGRAM_SUB_BUCKET_COUNT	\
+	(1ULL << STATS_HISTOGRAM_SUB_BUCKET_BITS)
+#define STATS_HISTOGRAM_BUCKET_COUNT		\
+	((64 - STATS_HISTOGRAM_SUB_BUCKET_BITS + 1) * \
+		STATS_HISTOGRAM_SUB_BUCKET_COUNT)
+
+struct stats_histogram {
+	/* STATS_HISTOGRAM_BUCKET_COUNT counters */
+	uint64_t *counts;
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+	double sum;
+};
+
+BT_HIDDEN
+struct stats_histogram *stats_histogram_create(void);
+
+BT_HIDDEN
+void stats_histogram_destroy(struct stats_histogram *histogram);
+
+BT_HIDDEN
+void stats_histogram_record(struct stats_histogram *histogram,
+		uint64_t value);
+
+/*
+ * Returns the highest value equivalent to the value at the percentile
+ * `percentile` (0 to 100) of the recorded values, or 0 if there's no
+ * recorded value.
+ */
+BT_HIDDEN
+uint64_t stats_histogram_get_percentile(struct stats_histogram *histogram,
+		double percentile);
+
+#endif /* BABELTRACE_PLUGINS_UTILS_STATS_HISTOGRAM_H */
@@ -0,0 +1,1492 @@
+/*
+ * stats.c
+ *
+ * Babeltrace Statistics Sink
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <babeltrace/plugin/plugin-dev.h>
+#include <babeltrace/graph/connection.h>
+#include <babeltrace/graph/component.h>
+#include <babeltrace/graph/private-component.h>
+#include <babeltrace/graph/private-component-sink.h>
+#include <babeltrace/graph/private-port.h>
+#include <babeltrace/graph/port.h>
+#include <babeltrace/graph/private-connection.h>
+#include <babeltrace/graph/component-sink.h>
+#include <babeltrace/graph/notification-iterator.h>
+#include <babeltrace/graph/notification.h>
+#include <babeltrace/graph/notification-event.h>
+#include <babeltrace/graph/clock-class-priority-map.h>
+#include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/packet.h>
+#include <babeltrace/ctf-ir/fields.h>
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/ctf-ir/clock-class.h>
+#include <babeltrace/values.h>
+#include <babeltrace/ref.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <plugins-common.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include "stats.h"
+
+#define DEFAULT_BUCKET_NS	1000000000LL
+
+/* Percentiles of the latency reports */
+static const double latency_percentiles[] = { 50, 90, 99, 99.9 };
+
+/* Group keys */
+
+static
+guint group_key_hash(gconstpointer data)
+{
+	const struct stats_group_key *key = data;
+
+	switch (key->kind) {
+	case STATS_VALUE_KIND_SIGNED:
+		return g_int64_hash(&key->u.i);
+	case STATS_VALUE_KIND_UNSIGNED:
+		return g_int64_hash(&key->u.u) ^ 1;
+	case STATS_VALUE_KIND_STRING:
+		return g_str_hash(key->u.s);
+	default:
+		return 0;
+	}
+}
+
+static
+gboolean group_key_equal(gconstpointer a_data, gconstpointer b_data)
+{
+	const struct stats_group_key *a = a_data;
+	const struct stats_group_key *b = b_data;
+
+	if (a->kind != b->kind) {
+		return FALSE;
+	}
+
+	switch (a->kind) {
+	case STATS_VALUE_KIND_SIGNED:
+		return a->u.i == b->u.i;
+	case STATS_VALUE_KIND_UNSIGNED:
+		return a->u.u == b->u.u;
+	case STATS_VALUE_KIND_STRING:
+		return strcmp(a->u.s, b->u.s) == 0;
+	default:
+		return TRUE;
+	}
+}
+
+/*
+ * Copies the group key `src` to `dst`, duplicating its string if any.
+ */
+static
+void group_key_copy(struct stats_group_key *dst,
+		const struct stats_group_key *src)
+{
+	*dst = *src;
+	if (src->kind == STATS_VALUE_KIND_STRING) {
+		dst->u.s = g_strdup(src->u.s);
+	}
+}
+
+static
+void group_key_fini(struct stats_group_key *key)
+{
+	if (key->kind == STATS_VALUE_KIND_STRING) {
+		g_free(key->u.s);
+	}
+}
+
+static
+void group_key_destroy(struct stats_group_key *key)
+{
+	group_key_fini(key);
+	g_free(key);
+}
+
+/* Destruction */
+
+static
+void destroy_group(struct stats_group *group)
+{
+	if (!group) {
+		return;
+	}
+
+	group_key_fini(&group->key);
+	if (group->rate_buckets) {
+		g_array_free(group->rate_buckets, TRUE);
+	}
+
+	g_free(group->accumulators);
+	g_free(group);
+}
+
+static
+void field_handle_fini(struct stats_field_handle *handle)
+{
+	g_free(handle->indexes);
+}
+
+static
+void destroy_event_class_stats(struct stats_event_class *ec_stats,
+		size_t field_count)
+{
+	size_t i;
+
+	if (!ec_stats) {
+		return;
+	}
+
+	if (ec_stats->groups) {
+		g_hash_table_destroy(ec_stats->groups);
+	}
+
+	if (ec_stats->group_order) {
+		g_ptr_array_free(ec_stats->group_order, TRUE);
+	}
+
+	if (ec_stats->entry_of) {
+		g_array_free(ec_stats->entry_of, TRUE);
+	}
+
+	if (ec_stats->exit_of) {
+		g_array_free(ec_stats->exit_of, TRUE);
+	}
+
+	if (ec_stats->field_handles) {
+		for (i = 0; i < field_count; i++) {
+			field_handle_fini(&ec_stats->field_handles[i]);
+		}
+
+		g_free(ec_stats->field_handles);
+	}
+
+	field_handle_fini(&ec_stats->group_handle);
+	bt_put(ec_stats->event_class);
+	g_free(ec_stats);
+}
+
+static
+void destroy_latency(struct stats_latency *latency)
+{
+	if (!latency) {
+		return;
+	}
+
+	if (latency->pending) {
+		g_hash_table_destroy(latency->pending);
+	}
+
+	stats_histogram_destroy(latency->histogram);
+	g_free(latency->entry_name);
+	g_free(latency->exit_name);
+	g_free(latency);
+}
+
+static
+void destroy_stats_data(struct stats *stats)
+{
+	size_t i;
+
+	if (!stats) {
+		return;
+	}
+
+	if (stats->event_class_order) {
+		for (i = 0; i < stats->event_class_order->len; i++) {
+			destroy_event_class_stats(
+				g_ptr_array_index(stats->event_class_order, i),
+				stats->fields->len);
+		}
+
+		g_ptr_array_free(stats->event_class_order, TRUE);
+	}
+
+	if (stats->event_classes) {
+		g_hash_table_destroy(stats->event_classes);
+	}
+
+	if (stats->latencies) {
+		g_ptr_array_free(stats->latencies, TRUE);
+	}
+
+	if (stats->fields) {
+		g_ptr_array_free(stats->fields, TRUE);
+	}
+
+	if (stats->out && stats->out != stdout) {
+		fclose(stats->out);
+	}
+
+	bt_put(stats->iterator);
+	g_free(stats->group_by);
+	g_free(stats);
+}
+
+/* Field handles */
+
+static
+struct bt_ctf_field_type *get_scope_type(
+		struct bt_ctf_event_class *event_class, enum stats_scope scope)
+{
+	struct bt_ctf_field_type *type = NULL;
+	struct bt_ctf_stream_class *stream_class = NULL;
+
+	switch (scope) {
+	case STATS_SCOPE_PAYLOAD:
+		type = bt_ctf_event_class_get_payload_type(event_class);
+		break;
+	case STATS_SCOPE_EVENT_CONTEXT:
+		type = bt_ctf_event_class_get_context_type(event_class);
+		break;
+	case STATS_SCOPE_STREAM_EVENT_CONTEXT:
+		stream_class = bt_ctf_event_class_get_stream_class(event_class);
+		if (stream_class) {
+			type = bt_ctf_stream_class_get_event_context_type(
+				stream_class);
+		}
+		break;
+	case STATS_SCOPE_PACKET_CONTEXT:
+		stream_class = bt_ctf_event_class_get_stream_class(event_class);
+		if (stream_class) {
+			type = bt_ctf_stream_class_get_packet_context_type(
+				stream_class);
+		}
+		break;
+	default:
+		abort();
+	}
+
+	bt_put(stream_class);
+	return type;
+}
+
+/*
+ * Resolves the dot-separated field path `path` within the root field
+ * type `type`, filling `handle`'s indexes and kind.
+ *
+ * Returns -1 if there's no such field.
+ */
+static
+int resolve_path_in_type(struct bt_ctf_field_type *root_type,
+		const char *path, struct stats_field_handle *handle)
+{
+	int ret = 0;
+	gchar **names = g_strsplit(path, ".", -1);
+	struct bt_ctf_field_type *type = bt_get(root_type);
+	struct bt_ctf_field_type *int_type = NULL;
+	guint count = g_strv_length(names);
+	guint i;
+
+	handle->indexes = g_new0(uint64_t, count);
+	handle->index_count = count;
+
+	for (i = 0; i < count; i++) {
+		struct bt_ctf_field_type *member_type = NULL;
+		int member_count;
+		int index;
+
+		if (!type || bt_ctf_field_type_get_type_id(type) !=
+				BT_CTF_FIELD_TYPE_ID_STRUCT) {
+			goto error;
+		}
+
+		member_count = bt_ctf_field_type_structure_get_field_count(type);
+		for (index = 0; index < member_count; index++) {
+			const char *member_name;
+
+			ret = bt_ctf_field_type_structure_get_field_by_index(
+				type, &member_name, &member_type, index);
+			if (ret) {
+				goto error;
+			}
+
+			if (strcmp(member_name, names[i]) == 0) {
+				break;
+			}
+
+			BT_PUT(member_type);
+		}
+
+		if (index == member_count) {
+			goto error;
+		}
+
+		handle->indexes[i] = (uint64_t) index;
+		BT_MOVE(type, member_type);
+	}
+
+	switch (bt_ctf_field_type_get_type_id(type)) {
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+		handle->is_enum = true;
+		int_type = bt_ctf_field_type_enumeration_get_container_type(
+			type);
+		assert(int_type);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+		int_type = bt_get(type);
+		break;
+	case BT_CTF_FIELD_TYPE_ID_FLOAT:
+		handle->kind = STATS_VALUE_KIND_FLOAT;
+		goto end;
+	case BT_CTF_FIELD_TYPE_ID_STRING:
+		handle->kind = STATS_VALUE_KIND_STRING;
+		goto end;
+	default:
+		goto error;
+	}
+
+	handle->kind = bt_ctf_field_type_integer_is_signed(int_type) ?
+		STATS_VALUE_KIND_SIGNED : STATS_VALUE_KIND_UNSIGNED;
+	goto end;
+
+error:
+	ret = -1;
+	field_handle_fini(handle);
+	memset(handle, 0, sizeof(*handle));
+
+end:
+	g_strfreev(names);
+	bt_put(int_type);
+	bt_put(type);
+	return ret;
+}
+
+/*
+ * Resolves `path` within the first scope of `scopes` which has it.
+ * `handle->kind` is STATS_VALUE_KIND_NONE if no scope has this field.
+ */
+static
+void resolve_field_handle(struct bt_ctf_event_class *event_class,
+		const char *path, const enum stats_scope *scopes,
+		size_t scope_count, struct stats_field_handle *handle)
+{
+	size_t i;
+
+	memset(handle, 0, sizeof(*handle));
+
+	for (i = 0; i < scope_count; i++) {
+		struct bt_ctf_field_type *root_type =
+			get_scope_type(event_class, scopes[i]);
+		int ret = resolve_path_in_type(root_type, path, handle);
+
+		bt_put(root_type);
+		if (ret == 0) {
+			handle->scope = scopes[i];
+			break;
+		}
+	}
+}
+
+static
+struct bt_ctf_field *get_scope_field(struct bt_ctf_event *event,
+		enum stats_scope scope)
+{
+	struct bt_ctf_field *field = NULL;
+	struct bt_ctf_packet *packet;
+
+	switch (scope) {
+	case STATS_SCOPE_PAYLOAD:
+		field = bt_ctf_event_get_event_payload(event);
+		break;
+	case STATS_SCOPE_EVENT_CONTEXT:
+		field = bt_ctf_event_get_event_context(event);
+		break;
+	case STATS_SCOPE_STREAM_EVENT_CONTEXT:
+		field = bt_ctf_event_get_stream_event_context(event);
+		break;
+	case STATS_SCOPE_PACKET_CONTEXT:
+		packet = bt_ctf_event_get_packet(event);
+		if (packet) {
+			field = bt_ctf_packet_get_context(packet);
+			bt_put(packet);
+		}
+		break;
+	default:
+		abort();
+	}
+
+	return field;
+}
+
+/*
+ * Reads the value of the field designated by `handle` within `event`.
+ * A string value remains valid as long as `event` exists.
+ */
+static
+void read_field_handle(struct stats_field_handle *handle,
+		struct bt_ctf_event *event, struct stats_value *value)
+{
+	struct bt_ctf_field *field = NULL;
+	struct bt_ctf_field *int_field = NULL;
+	size_t i;
+
+	value->kind = STATS_VALUE_KIND_NONE;
+	if (handle->kind == STATS_VALUE_KIND_NONE) {
+		goto end;
+	}
+
+	field = get_scope_field(event, handle->scope);
+	for (i = 0; field && i < handle->index_count; i++) {
+		struct bt_ctf_field *member =
+			bt_ctf_field_structure_get_field_by_index(field,
+				handle->indexes[i]);
+
+		BT_MOVE(field, member);
+	}
+
+	if (!field) {
+		goto end;
+	}
+
+	switch (handle->kind) {
+	case STATS_VALUE_KIND_SIGNED:
+	case STATS_VALUE_KIND_UNSIGNED:
+		int_field = handle->is_enum ?
+			bt_ctf_field_enumeration_get_container(field) :
+			bt_get(field);
+		if (!int_field) {
+			goto end;
+		}
+
+		if (handle->kind == STATS_VALUE_KIND_SIGNED) {
+			if (bt_ctf_field_signed_integer_get_value(int_field,
+					&value->u.i) == 0) {
+				value->kind = STATS_VALUE_KIND_SIGNED;
+			}
+		} else {
+			if (bt_ctf_field_unsigned_integer_get_value(int_field,
+					&value->u.u) == 0) {
+				value->kind = STATS_VALUE_KIND_UNSIGNED;
+			}
+		}
+		break;
+	case STATS_VALUE_KIND_FLOAT:
+		if (bt_ctf_field_floating_point_get_value(field,
+				&value->u.f) == 0) {
+			value->kind = STATS_VALUE_KIND_FLOAT;
+		}
+		break;
+	case STATS_VALUE_KIND_STRING:
+		value->u.s = bt_ctf_field_string_get_value(field);
+		if (value->u.s) {
+			value->kind = STATS_VALUE_KIND_STRING;
+		}
+		break;
+	default:
+		abort();
+	}
+
+end:
+	bt_put(int_field);
+	bt_put(field);
+}
+
+static
+double value_as_double(const struct stats_value *value)
+{
+	switch (value->kind) {
+	case STATS_VALUE_KIND_SIGNED:
+		return (double) value->u.i;
+	case STATS_VALUE_KIND_UNSIGNED:
+		return (double) value->u.u;
+	default:
+		return value->u.f;
+	}
+}
+
+/* Compares two numeric values of the same kind. */
+static
+int compare_values(const struct stats_value *a, const struct stats_value *b)
+{
+	switch (a->kind) {
+	case STATS_VALUE_KIND_SIGNED:
+		return (a->u.i > b->u.i) - (a->u.i < b->u.i);
+	case STATS_VALUE_KIND_UNSIGNED:
+		return (a->u.u > b->u.u) - (a->u.u < b->u.u);
+	default:
+		return (a->u.f > b->u.f) - (a->u.f < b->u.f);
+	}
+}
+
+static
+void accumulate(struct stats_accumulator *acc, const struct stats_value *value)
+{
+	if (acc->count == 0 || compare_values(value, &acc->min) < 0) {
+		acc->min = *value;
+	}
+
+	if (acc->count == 0 || compare_values(value, &acc->max) > 0) {
+		acc->max = *value;
+	}
+
+	acc->count++;
+	acc->sum += value_as_double(value);
+}
+
+/* Parameters */
+
+/*
+ * Parses a latency pair specification, `ENTRY:EXIT`, where ENTRY and
+ * EXIT are event class names.
+ */
+static
+struct stats_latency *create_latency(const char *spec)
+{
+	struct stats_latency *latency = NULL;
+	gchar **names = g_strsplit(spec, ":", 2);
+
+	if (g_strv_length(names) != 2 || names[0][0] == '\0' ||
+			names[1][0] == '\0') {
+		printf_error("Invalid latency pair `%s`: expecting `ENTRY:EXIT`",
+			spec);
+		goto end;
+	}
+
+	latency = g_new0(struct stats_latency, 1);
+	if (!latency) {
+		goto end;
+	}
+
+	latency->entry_name = g_strdup(g_strstrip(names[0]));
+	latency->exit_name = g_strdup(g_strstrip(names[1]));
+	latency->pending = g_hash_table_new_full(group_key_hash,
+		group_key_equal, (GDestroyNotify) group_key_destroy, g_free);
+	latency->histogram = stats_histogram_create();
+	if (!latency->entry_name || !latency->exit_name ||
+			!latency->pending || !latency->histogram) {
+		destroy_latency(latency);
+		latency = NULL;
+	}
+
+end:
+	g_strfreev(names);
+	return latency;
+}
+
+/*
+ * Gets the string parameter named `name`, setting `*str` to `NULL` if
+ * there's no such parameter.
+ *
+ * Returns -1 if the parameter exists and is not a string.
+ */
+static
+int get_string_param(struct bt_value *params, const char *name,
+		const char **str)
+{
+	int ret = 0;
+	struct bt_value *value = bt_value_map_get(params, name);
+
+	*str = NULL;
+	if (!value) {
+		goto end;
+	}
+
+	if (!bt_value_is_string(value)) {
+		printf_error("%s parameter should be a string", name);
+		ret = -1;
+		goto end;
+	}
+
+	ret = bt_value_string_get(value, str);
+	assert(ret == 0);
+
+end:
+	/* The string is owned by `params`, which exists during init */
+	bt_put(value);
+	return ret;
+}
+
+static
+enum bt_component_status init_from_params(struct stats *stats,
+		struct bt_value *params)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_value *value = NULL;
+	const char *str;
+	gchar **list = NULL;
+	gchar **item;
+
+	if (get_string_param(params, "group-by", &str)) {
+		goto error;
+	}
+
+	if (str && str[0] != '\0') {
+		stats->group_by = g_strdup(str);
+	}
+
+	if (get_string_param(params, "fields", &str)) {
+		goto error;
+	}
+
+	if (str) {
+		list = g_strsplit(str, ",", -1);
+		for (item = list; *item; item++) {
+			g_strstrip(*item);
+			if ((*item)[0] != '\0') {
+				g_ptr_array_add(stats->fields, g_strdup(*item));
+			}
+		}
+
+		g_strfreev(list);
+		list = NULL;
+	}
+
+	if (get_string_param(params, "latency", &str)) {
+		goto error;
+	}
+
+	if (str) {
+		list = g_strsplit(str, ",", -1);
+		for (item = list; *item; item++) {
+			struct stats_latency *latency;
+
+			if (g_strstrip(*item)[0] == '\0') {
+				continue;
+			}
+
+			latency = create_latency(*item);
+			if (!latency) {
+				goto error;
+			}
+
+			g_ptr_array_add(stats->latencies, latency);
+		}
+	}
+
+	value = bt_value_map_get(params, "bucket-ns");
+	if (value) {
+		if (!bt_value_is_integer(value) ||
+				bt_value_integer_get(value, &stats->bucket_ns) ||
+				stats->bucket_ns <= 0) {
+			printf_error("bucket-ns parameter should be a positive integer");
+			goto error;
+		}
+	}
+
+	if (get_string_param(params, "format", &str)) {
+		goto error;
+	}
+
+	if (str) {
+		if (strcmp(str, "json") == 0) {
+			stats->json = true;
+		} else if (strcmp(str, "text") != 0) {
+			printf_error("Unknown format `%s`: expecting `text` or `json`",
+				str);
+			goto error;
+		}
+	}
+
+	if (get_string_param(params, "path", &str)) {
+		goto error;
+	}
+
+	if (str) {
+		stats->out = fopen(str, "w");
+		if (!stats->out) {
+			printf_error("Cannot open file `%s`: %s", str,
+				strerror(errno));
+			goto error;
+		}
+	}
+
+	goto end;
+
+error:
+	ret = BT_COMPONENT_STATUS_INVALID;
+
+end:
+	g_strfreev(list);
+	bt_put(value);
+	return ret;
+}
+
+BT_HIDDEN
+void stats_finalize(struct bt_private_component *component)
+{
+	destroy_stats_data(bt_private_component_get_user_data(component));
+}
+
+BT_HIDDEN
+enum bt_component_status stats_init(struct bt_private_component *component,
+		struct bt_value *params, UNUSED_VAR void *init_method_data)
+{
+	enum bt_component_status ret;
+	struct stats *stats = g_new0(struct stats, 1);
+
+	if (!stats) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto end;
+	}
+
+	stats->bucket_ns = DEFAULT_BUCKET_NS;
+	stats->out = stdout;
+	stats->fields = g_ptr_array_new_with_free_func(g_free);
+	stats->latencies = g_ptr_array_new_with_free_func(
+		(GDestroyNotify) destroy_latency);
+	stats->event_classes = g_hash_table_new(g_direct_hash,
+		g_direct_equal);
+	stats->event_class_order = g_ptr_array_new();
+	if (!stats->fields || !stats->latencies || !stats->event_classes ||
+			!stats->event_class_order) {
+		ret = BT_COMPONENT_STATUS_NOMEM;
+		goto error;
+	}
+
+	ret = init_from_params(stats, params);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
+	ret = bt_private_component_sink_add_input_private_port(component,
+		"in", NULL, NULL);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
+	ret = bt_private_component_set_user_data(component, stats);
+	if (ret != BT_COMPONENT_STATUS_OK) {
+		goto error;
+	}
+
+	goto end;
+
+error:
+	destroy_stats_data(stats);
+
+end:
+	return ret;
+}
+
+BT_HIDDEN
+void stats_port_connected(struct bt_private_component *component,
+		struct bt_private_port *self_port,
+		UNUSED_VAR struct bt_port *other_port)
+{
+	struct stats *stats;
+	struct bt_private_connection *connection;
+	enum bt_connection_status conn_status;
+	static const enum bt_notification_type notif_types[] = {
+		BT_NOTIFICATION_TYPE_EVENT,
+		BT_NOTIFICATION_TYPE_SENTINEL,
+	};
+
+	stats = bt_private_component_get_user_data(component);
+	assert(stats);
+	connection = bt_private_port_get_private_connection(self_port);
+	assert(connection);
+	conn_status = bt_private_connection_create_notification_iterator(
+		connection, notif_types, &stats->iterator);
+	if (conn_status != BT_CONNECTION_STATUS_OK) {
+		stats->error = true;
+	}
+
+	bt_put(connection);
+}
+
+/* Aggregation */
+
+static
+struct stats_event_class *create_event_class_stats(struct stats *stats,
+		struct bt_ctf_event_class *event_class)
+{
+	static const enum stats_scope group_scopes[] = {
+		STATS_SCOPE_EVENT_CONTEXT,
+		STATS_SCOPE_STREAM_EVENT_CONTEXT,
+		STATS_SCOPE_PACKET_CONTEXT,
+		STATS_SCOPE_PAYLOAD,
+	};
+	static const enum stats_scope field_scopes[] = {
+		STATS_SCOPE_PAYLOAD,
+	};
+	struct stats_event_class *ec_stats =
+		g_new0(struct stats_event_class, 1);
+	const char *name = bt_ctf_event_class_get_name(event_class);
+	size_t i;
+
+	if (!ec_stats) {
+		goto error;
+	}
+
+	ec_stats->event_class = bt_get(event_class);
+	ec_stats->groups = g_hash_table_new_full(group_key_hash,
+		group_key_equal, NULL, (GDestroyNotify) destroy_group);
+	ec_stats->group_order = g_ptr_array_new();
+	ec_stats->entry_of = g_array_new(FALSE, FALSE, sizeof(size_t));
+	ec_stats->exit_of = g_array_new(FALSE, FALSE, sizeof(size_t));
+	ec_stats->field_handles = g_new0(struct stats_field_handle,
+		stats->fields->len);
+	if (!ec_stats->groups || !ec_stats->group_order ||
+			!ec_stats->entry_of || !ec_stats->exit_of ||
+			(stats->fields->len > 0 && !ec_stats->field_handles)) {
+		goto error;
+	}
+
+	/* Resolve the field paths once for all the events of this class */
+	if (stats->group_by) {
+		resolve_field_handle(event_class, stats->group_by,
+			group_scopes, sizeof(group_scopes) /
+				sizeof(*group_scopes),
+			&ec_stats->group_handle);
+	}
+
+	for (i = 0; i < stats->fields->len; i++) {
+		struct stats_field_handle *handle =
+			&ec_stats->field_handles[i];
+
+		resolve_field_handle(event_class,
+			g_ptr_array_index(stats->fields, i), field_scopes,
+			sizeof(field_scopes) / sizeof(*field_scopes), handle);
+		if (handle->kind == STATS_VALUE_KIND_STRING) {
+			/* Not aggregatable */
+			field_handle_fini(handle);
+			memset(handle, 0, sizeof(*handle));
+		}
+	}
+
+	for (i = 0; name && i < stats->latencies->len; i++) {
+		struct stats_latency *latency =
+			g_ptr_array_index(stats->latencies, i);
+
+		if (strcmp(name, latency->entry_name) == 0) {
+			g_array_append_val(ec_stats->entry_of, i);
+		}
+
+		if (strcmp(name, latency->exit_name) == 0) {
+			g_array_append_val(ec_stats->exit_of, i);
+		}
+	}
+
+	g_hash_table_insert(stats->event_classes, event_class, ec_stats);
+	g_ptr_array_add(stats->event_class_order, ec_stats);
+	goto end;
+
+error:
+	destroy_event_class_stats(ec_stats, stats->fields->len);
+	ec_stats = NULL;
+
+end:
+	return ec_stats;
+}
+
+static
+struct stats_group *get_group(struct stats *stats,
+		struct stats_event_class *ec_stats,
+		const struct stats_group_key *key)
+{
+	struct stats_group *group = g_hash_table_lookup(ec_stats->groups, key);
+
+	if (group) {
+		goto end;
+	}
+
+	group = g_new0(struct stats_group, 1);
+	if (!group) {
+		goto end;
+	}
+
+	group_key_copy(&group->key, key);
+	group->rate_buckets = g_array_new(FALSE, TRUE, sizeof(uint64_t));
+	group->accumulators = g_new0(struct stats_accumulator,
+		stats->fields->len);
+	if (!group->rate_buckets ||
+			(stats->fields->len > 0 && !group->accumulators)) {
+		destroy_group(group);
+		group = NULL;
+		goto end;
+	}
+
+	g_hash_table_insert(ec_stats->groups, &group->key, group);
+	g_ptr_array_add(ec_stats->group_order, group);
+
+end:
+	return group;
+}
+
+static
+void value_to_group_key(const struct stats_value *value,
+		struct stats_group_key *key)
+{
+	switch (value->kind) {
+	case STATS_VALUE_KIND_SIGNED:
+		if (value->u.i >= 0) {
+			key->kind = STATS_VALUE_KIND_UNSIGNED;
+			key->u.u = (uint64_t) value->u.i;
+		} else {
+			key->kind = STATS_VALUE_KIND_SIGNED;
+			key->u.i = value->u.i;
+		}
+		break;
+	case STATS_VALUE_KIND_UNSIGNED:
+		key->kind = STATS_VALUE_KIND_UNSIGNED;
+		key->u.u = value->u.u;
+		break;
+	case STATS_VALUE_KIND_STRING:
+		/* Not copied: only used for lookups */
+		key->kind = STATS_VALUE_KIND_STRING;
+		key->u.s = (char *) value->u.s;
+		break;
+	default:
+		key->kind = STATS_VALUE_KIND_NONE;
+		break;
+	}
+}
+
+/* Returns 0 and sets `*ts` if the event has a time. */
+static
+int get_event_time(struct bt_notification *notification,
+		struct bt_ctf_event *event, int64_t *ts)
+{
+	int ret = -1;
+	struct bt_clock_class_priority_map *cc_prio_map = NULL;
+	struct bt_ctf_clock_class *clock_class = NULL;
+	struct bt_ctf_clock_value *clock_value = NULL;
+
+	cc_prio_map = bt_notification_event_get_clock_class_priority_map(
+		notification);
+	if (!cc_prio_map) {
+		goto end;
+	}
+
+	clock_class =
+		bt_clock_class_priority_map_get_highest_priority_clock_class(
+			cc_prio_map);
+	if (!clock_class) {
+		goto end;
+	}
+
+	clock_value = bt_ctf_event_get_clock_value(event, clock_class);
+	if (!clock_value) {
+		goto end;
+	}
+
+	ret = bt_ctf_clock_value_get_value_ns_from_epoch(clock_value, ts);
+
+end:
+	bt_put(clock_value);
+	bt_put(clock_class);
+	bt_put(cc_prio_map);
+	return ret;
+}
+
+static
+void count_in_rate_bucket(struct stats *stats, struct stats_group *group,
+		int64_t ts)
+{
+	uint64_t index = 0;
+
+	if (!stats->has_origin) {
+		stats->origin = ts;
+		stats->has_origin = true;
+	}
+
+	/* Events before the origin (unsorted input) go in the first bucket */
+	if (ts > stats->origin) {
+		index = (uint64_t) (ts - stats->origin) /
+			(uint64_t) stats->bucket_ns;
+	}
+
+	if (index >= group->rate_buckets->len) {
+		g_array_set_size(group->rate_buckets, index + 1);
+	}
+
+	g_array_index(group->rate_buckets, uint64_t, index)++;
+}
+
+static
+void update_latencies(struct stats *stats, struct stats_event_class *ec_stats,
+		const struct stats_group_key *key, int64_t ts)
+{
+	size_t i;
+
+	for (i = 0; i < ec_stats->exit_of->len; i++) {
+		struct stats_latency *latency = g_ptr_array_index(
+			stats->latencies,
+			g_array_index(ec_stats->exit_of, size_t, i));
+		int64_t *entry_ts = g_hash_table_lookup(latency->pending, key);
+
+		if (!entry_ts || ts < *entry_ts) {
+			latency->unmatched_exits++;
+			continue;
+		}
+
+		stats_histogram_record(latency->histogram,
+			(uint64_t) (ts - *entry_ts));
+		g_hash_table_remove(latency->pending, key);
+	}
+
+	for (i = 0; i < ec_stats->entry_of->len; i++) {
+		struct stats_latency *latency = g_ptr_array_index(
+			stats->latencies,
+			g_array_index(ec_stats->entry_of, size_t, i));
+		int64_t *entry_ts = g_hash_table_lookup(latency->pending, key);
+
+		if (!entry_ts) {
+			struct stats_group_key *pending_key =
+				g_new0(struct stats_group_key, 1);
+
+			entry_ts = g_new0(int64_t, 1);
+			group_key_copy(pending_key, key);
+			g_hash_table_insert(latency->pending, pending_key,
+				entry_ts);
+		}
+
+		/* A new entry replaces a pending one without exit */
+		*entry_ts = ts;
+	}
+}
+
+static
+int handle_event_notification(struct stats *stats,
+		struct bt_notification *notification)
+{
+	int ret = 0;
+	struct bt_ctf_event *event = NULL;
+	struct bt_ctf_event_class *event_class = NULL;
+	struct stats_event_class *ec_stats;
+	struct stats_group *group;
+	struct stats_group_key key;
+	struct stats_value value;
+	int64_t ts;
+	bool has_ts;
+	size_t i;
+
+	event = bt_notification_event_get_event(notification);
+	assert(event);
+	event_class = bt_ctf_event_get_class(event);
+	assert(event_class);
+	ec_stats = g_hash_table_lookup(stats->event_classes, event_class);
+	if (!ec_stats) {
+		ec_stats = create_event_class_stats(stats, event_class);
+		if (!ec_stats) {
+			ret = -1;
+			goto end;
+		}
+	}
+
+	read_field_handle(&ec_stats->group_handle, event, &value);
+	value_to_group_key(&value, &key);
+	group = get_group(stats, ec_stats, &key);
+	if (!group) {
+		ret = -1;
+		goto end;
+	}
+
+	group->count++;
+	has_ts = get_event_time(notification, event, &ts) == 0;
+	if (has_ts) {
+		if (!group->has_ts || ts < group->first_ts) {
+			group->first_ts = ts;
+		}
+
+		if (!group->has_ts || ts > group->last_ts) {
+			group->last_ts = ts;
+		}
+
+		group->has_ts = true;
+		count_in_rate_bucket(stats, group, ts);
+	}
+
+	for (i = 0; i < stats->fields->len; i++) {
+		read_field_handle(&ec_stats->field_handles[i], event, &value);
+		if (value.kind != STATS_VALUE_KIND_NONE) {
+			accumulate(&group->accumulators[i], &value);
+		}
+	}
+
+	if (has_ts) {
+		update_latencies(stats, ec_stats, &key, ts);
+	}
+
+end:
+	bt_put(event_class);
+	bt_put(event);
+	return ret;
+}
+
+/* Report */
+
+static
+void print_json_string(FILE *out, const char *str)
+{
+	const char *ch;
+
+	fputc('"', out);
+	for (ch = str; *ch; ch++) {
+		switch (*ch) {
+		case '"':
+			fputs("\\\"", out);
+			break;
+		case '\\':
+			fputs("\\\\", out);
+			break;
+		case '\n':
+			fputs("\\n", out);
+			break;
+		case '\t':
+			fputs("\\t", out);
+			break;
+		default:
+			if ((unsigned char) *ch < 0x20) {
+				fprintf(out, "\\u%04x", (unsigned int) *ch);
+			} else {
+				fputc(*ch, out);
+			}
+			break;
+		}
+	}
+
+	fputc('"', out);
+}
+
+static
+void print_value(FILE *out, const struct stats_value *value)
+{
+	switch (value->kind) {
+	case STATS_VALUE_KIND_SIGNED:
+		fprintf(out, "%" PRId64, value->u.i);
+		break;
+	case STATS_VALUE_KIND_UNSIGNED:
+		fprintf(out, "%" PRIu64, value->u.u);
+		break;
+	case STATS_VALUE_KIND_FLOAT:
+		fprintf(out, "%g", value->u.f);
+		break;
+	default:
+		fputs("null", out);
+		break;
+	}
+}
+
+static
+void print_group_key(FILE *out, const struct stats_group_key *key, bool json)
+{
+	switch (key->kind) {
+	case STATS_VALUE_KIND_SIGNED:
+		fprintf(out, "%" PRId64, key->u.i);
+		break;
+	case STATS_VALUE_KIND_UNSIGNED:
+		fprintf(out, "%" PRIu64, key->u.u);
+		break;
+	case STATS_VALUE_KIND_STRING:
+		if (json) {
+			print_json_string(out, key->u.s);
+		} else {
+			fputs(key->u.s, out);
+		}
+		break;
+	default:
+		fputs(json ? "null" : "(none)", out);
+		break;
+	}
+}
+
+static
+uint64_t get_peak_bucket_count(struct stats_group *group)
+{
+	uint64_t peak = 0;
+	guint i;
+
+	for (i = 0; i < group->rate_buckets->len; i++) {
+		uint64_t count = g_array_index(group->rate_buckets,
+			uint64_t, i);
+
+		if (count > peak) {
+			peak = count;
+		}
+	}
+
+	return peak;
+}
+
+/* Returns the mean rate of `group` in events/s, or 0 if unknown. */
+static
+double get_group_rate(struct stats_group *group)
+{
+	if (!group->has_ts || group->last_ts <= group->first_ts) {
+		return 0;
+	}
+
+	return (double) group->count * 1e9 /
+		(double) (group->last_ts - group->first_ts);
+}
+
+static
+void print_text_report(struct stats *stats)
+{
+	FILE *out = stats->out;
+	size_t i, j, k;
+
+	for (i = 0; i < stats->event_class_order->len; i++) {
+		struct stats_event_class *ec_stats =
+			g_ptr_array_index(stats->event_class_order, i);
+		const char *name =
+			bt_ctf_event_class_get_name(ec_stats->event_class);
+
+		fprintf(out, "%s (ID %" PRId64 ")\n", name ? name : "(unnamed)",
+			bt_ctf_event_class_get_id(ec_stats->event_class));
+
+		for (j = 0; j < ec_stats->group_order->len; j++) {
+			struct stats_group *group =
+				g_ptr_array_index(ec_stats->group_order, j);
+
+			fputs("  ", out);
+			if (stats->group_by) {
+				fprintf(out, "%s=", stats->group_by);
+				print_group_key(out, &group->key, false);
+				fputs(": ", out);
+			}
+
+			fprintf(out, "%" PRIu64 " events", group->count);
+			if (group->has_ts) {
+				fprintf(out, ", %.3f events/s, peak %" PRIu64
+					" per %" PRId64 " ns",
+					get_group_rate(group),
+					get_peak_bucket_count(group),
+					stats->bucket_ns);
+			}
+
+			fputc('\n', out);
+
+			for (k = 0; k < stats->fields->len; k++) {
+				struct stats_accumulator *acc =
+					&group->accumulators[k];
+
+				if (acc->count == 0) {
+					continue;
+				}
+
+				fprintf(out, "    %s: min ",
+					(const char *) g_ptr_array_index(
+						stats->fields, k));
+				print_value(out, &acc->min);
+				fputs(", max ", out);
+				print_value(out, &acc->max);
+				fprintf(out, ", sum %g, mean %g\n", acc->sum,
+					acc->sum / (double) acc->count);
+			}
+		}
+	}
+
+	for (i = 0; i < stats->latencies->len; i++) {
+		struct stats_latency *latency =
+			g_ptr_array_index(stats->latencies, i);
+		struct stats_histogram *histogram = latency->histogram;
+
+		fprintf(out, "Latency %s -> %s: %" PRIu64 " pairs, %" PRIu64
+			" unmatched exits\n", latency->entry_name,
+			latency->exit_name, histogram->count,
+			latency->unmatched_exits);
+		if (histogram->count == 0) {
+			continue;
+		}
+
+		fprintf(out, "  min %" PRIu64 " ns", histogram->min);
+		for (j = 0; j < sizeof(latency_percentiles) /
+				sizeof(*latency_percentiles); j++) {
+			fprintf(out, ", p%g %" PRIu64 " ns",
+				latency_percentiles[j],
+				stats_histogram_get_percentile(histogram,
+					latency_percentiles[j]));
+		}
+
+		fprintf(out, ", max %" PRIu64 " ns, mean %.0f ns\n",
+			histogram->max,
+			histogram->sum / (double) histogram->count);
+	}
+}
+
+static
+void print_json_report(struct stats *stats)
+{
+	FILE *out = stats->out;
+	size_t i, j, k;
+
+	fprintf(out, "{\n  \"bucket-ns\": %" PRId64 ",\n", stats->bucket_ns);
+	if (stats->has_origin) {
+		fprintf(out, "  \"origin-ns\": %" PRId64 ",\n", stats->origin);
+	}
+
+	fputs("  \"event-classes\": [", out);
+	for (i = 0; i < stats->event_class_order->len; i++) {
+		struct stats_event_class *ec_stats =
+			g_ptr_array_index(stats->event_class_order, i);
+		const char *name =
+			bt_ctf_event_class_get_name(ec_stats->event_class);
+
+		fprintf(out, "%s\n    {\"name\": ", i > 0 ? "," : "");
+		if (name) {
+			print_json_string(out, name);
+		} else {
+			fputs("null", out);
+		}
+
+		fprintf(out, ", \"id\": %" PRId64 ", \"groups\": [",
+			bt_ctf_event_class_get_id(ec_stats->event_class));
+
+		for (j = 0; j < ec_stats->group_order->len; j++) {
+			struct stats_group *group =
+				g_ptr_array_index(ec_stats->group_order, j);
+			guint b;
+
+			fprintf(out, "%s\n      {\"key\": ", j > 0 ? "," : "");
+			print_group_key(out, &group->key, true);
+			fprintf(out, ", \"count\": %" PRIu64, group->count);
+			if (group->has_ts) {
+				fprintf(out, ", \"first-ns\": %" PRId64
+					", \"last-ns\": %" PRId64
+					", \"rate\": %.3f",
+					group->first_ts, group->last_ts,
+					get_group_rate(group));
+			}
+
+			fputs(", \"buckets\": [", out);
+			for (b = 0; b < group->rate_buckets->len; b++) {
+				fprintf(out, "%s%" PRIu64, b > 0 ? ", " : "",
+					g_array_index(group->rate_buckets,
+						uint64_t, b));
+			}
+
+			fputs("], \"fields\": {", out);
+			for (k = 0; k < stats->fields->len; k++) {
+				struct stats_accumulator *acc =
+					&group->accumulators[k];
+
+				fputs(k > 0 ? ", " : "", out);
+				print_json_string(out,
+					g_ptr_array_index(stats->fields, k));
+				fprintf(out, ": {\"count\": %" PRIu64,
+					acc->count);
+				if (acc->count > 0) {
+					fputs(", \"min\": ", out);
+					print_value(out, &acc->min);
+					fputs(", \"max\": ", out);
+					print_value(out, &acc->max);
+					fprintf(out, ", \"sum\": %g", acc->sum);
+				}
+
+				fputc('}', out);
+			}
+
+			fputs("}}", out);
+		}
+
+		fputs("]}", out);
+	}
+
+	fputs("\n  ],\n  \"latencies\": [", out);
+	for (i = 0; i < stats->latencies->len; i++) {
+		struct stats_latency *latency =
+			g_ptr_array_index(stats->latencies, i);
+		struct stats_histogram *histogram = latency->histogram;
+
+		fprintf(out, "%s\n    {\"entry\": ", i > 0 ? "," : "");
+		print_json_string(out, latency->entry_name);
+		fputs(", \"exit\": ", out);
+		print_json_string(out, latency->exit_name);
+		fprintf(out, ", \"count\": %" PRIu64
+			", \"unmatched-exits\": %" PRIu64,
+			histogram->count, latency->unmatched_exits);
+		if (histogram->count > 0) {
+			fprintf(out, ", \"min-ns\": %" PRIu64
+				", \"max-ns\": %" PRIu64
+				", \"mean-ns\": %.0f, \"percentiles-ns\": {",
+				histogram->min, histogram->max,
+				histogram->sum / (double) histogram->count);
+			for (j = 0; j < sizeof(latency_percentiles) /
+					sizeof(*latency_percentiles); j++) {
+				fprintf(out, "%s\"%g\": %" PRIu64,
+					j > 0 ? ", " : "",
+					latency_percentiles[j],
+					stats_histogram_get_percentile(
+						histogram,
+						latency_percentiles[j]));
+			}
+
+			fputc('}', out);
+		}
+
+		fputc('}', out);
+	}
+
+	fputs("\n  ]\n}\n", out);
+}
+
+BT_HIDDEN
+enum bt_component_status stats_consume(struct bt_private_component *component)
+{
+	enum bt_component_status ret = BT_COMPONENT_STATUS_OK;
+	struct bt_notification *notif = NULL;
+	enum bt_notification_iterator_status it_ret;
+	struct stats *stats;
+
+	stats = bt_private_component_get_user_data(component);
+	assert(stats);
+
+	if (unlikely(stats->error || !stats->iterator)) {
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+	it_ret = bt_notification_iterator_next(stats->iterator);
+	switch (it_ret) {
+	case BT_NOTIFICATION_ITERATOR_STATUS_OK:
+		break;
+	case BT_NOTIFICATION_ITERATOR_STATUS_AGAIN:
+		ret = BT_COMPONENT_STATUS_AGAIN;
+		goto end;
+	case BT_NOTIFICATION_ITERATOR_STATUS_END:
+		if (stats->json) {
+			print_json_report(stats);
+		} else {
+			print_text_report(stats);
+		}
+
+		fflush(stats->out);
+		BT_PUT(stats->iterator);
+		ret = BT_COMPONENT_STATUS_END;
+		goto end;
+	default:
+		ret = BT_COMPONENT_STATUS_ERROR;
+		goto end;
+	}
+
+	notif = bt_notification_iterator_get_notification(stats->iterator);
+	assert(notif);
+	if (bt_notification_get_type(notif) == BT_NOTIFICATION_TYPE_EVENT) {
+		if (handle_event_notification(stats, notif)) {
+			ret = BT_COMPONENT_STATUS_ERROR;
+			goto end;
+		}
+	}
+
+end:
+	bt_put(notif);
+	return ret;
+}
@@ -0,0 +1,201 @@
+#ifndef BABELTRACE_PLUGINS_UTILS_STATS_H
+#define BABELTRACE_PLUGINS_UTILS_STATS_H
+
+/*
+ * BabelTrace - Statistics Sink
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <glib.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/graph/component.h>
+#include <babeltrace/graph/notification-iterator.h>
+#include <babeltrace/graph/private-component.h>
+#include <babeltrace/graph/private-port.h>
+#include <babeltrace/graph/port.h>
+#include "histogram.h"
+
+enum stats_value_kind {
+	/* Missing or unsupported field */
+	STATS_VALUE_KIND_NONE,
+	STATS_VALUE_KIND_SIGNED,
+	STATS_VALUE_KIND_UNSIGNED,
+	STATS_VALUE_KIND_FLOAT,
+	STATS_VALUE_KIND_STRING,
+};
+
+struct stats_value {
+	enum stats_value_kind kind;
+	union {
+		int64_t i;
+		uint64_t u;
+		double f;
+		const char *s;
+	} u;
+};
+
+enum stats_scope {
+	STATS_SCOPE_PAYLOAD,
+	STATS_SCOPE_EVENT_CONTEXT,
+	STATS_SCOPE_STREAM_EVENT_CONTEXT,
+	STATS_SCOPE_PACKET_CONTEXT,
+};
+
+/*
+ * A field path resolved once per event class to structure field
+ * indexes, so that reading the field's value for an event does not
+ * look up any name.
+ */
+struct stats_field_handle {
+	enum stats_scope scope;
+	uint64_t *indexes;
+	size_t index_count;
+
+	/* STATS_VALUE_KIND_NONE if the event class has no such field */
+	enum stats_value_kind kind;
+	bool is_enum;
+};
+
+/* Minimum, maximum, and sum of a numeric field's values */
+struct stats_accumulator {
+	uint64_t count;
+	struct stats_value min;
+	struct stats_value max;
+	double sum;
+};
+
+/*
+ * Group key, from the value of the `group-by` field. Nonnegative
+ * signed integers are stored as unsigned integers so that equal values
+ * from fields of different signedness are in the same group.
+ */
+struct stats_group_key {
+	enum stats_value_kind kind;
+	union {
+		int64_t i;
+		uint64_t u;
+		char *s;
+	} u;
+};
+
+struct stats_group {
+	/* String owned by this */
+	struct stats_group_key key;
+	uint64_t count;
+	bool has_ts;
+	int64_t first_ts;
+	int64_t last_ts;
+
+	/* Event counts per time bucket (uint64_t) from the origin */
+	GArray *rate_buckets;
+
+	/* One per `fields` parameter entry */
+	struct stats_accumulator *accumulators;
+};
+
+struct stats_event_class {
+	/* Owned by this */
+	struct bt_ctf_event_class *event_class;
+
+	struct stats_field_handle group_handle;
+
+	/* One per `fields` parameter entry */
+	struct stats_field_handle *field_handles;
+
+	/* Indexes (size_t) of the latency pairs of which this is the entry */
+	GArray *entry_of;
+
+	/* Indexes (size_t) of the latency pairs of which this is the exit */
+	GArray *exit_of;
+
+	/* struct stats_group_key * (weak) -> struct stats_group * (owned) */
+	GHashTable *groups;
+
+	/* Groups in order of appearance (weak) */
+	GPtrArray *group_order;
+};
+
+struct stats_latency {
+	gchar *entry_name;
+	gchar *exit_name;
+
+	/*
+	 * Group key (owned) -> entry time (int64_t *, owned) of the
+	 * entries waiting for their exit.
+	 */
+	GHashTable *pending;
+
+	struct stats_histogram *histogram;
+	uint64_t unmatched_exits;
+};
+
+struct stats {
+	/* Context field path, or `NULL` to not group events */
+	gchar *group_by;
+
+	/* Array of gchar * (payload field paths) */
+	GPtrArray *fields;
+
+	/* Array of struct stats_latency * */
+	GPtrArray *latencies;
+
+	/* Duration of a rate bucket */
+	int64_t bucket_ns;
+
+	bool json;
+	FILE *out;
+
+	/* Owned by this */
+	struct bt_notification_iterator *iterator;
+
+	/* Event class (weak) -> struct stats_event_class * (owned) */
+	GHashTable *event_classes;
+
+	/* Event classes in order of appearance (weak) */
+	GPtrArray *event_class_order;
+
+	/* Time of the first event with a time: start of the first bucket */
+	bool has_origin;
+	int64_t origin;
+
+	bool error;
+};
+
+BT_HIDDEN
+enum bt_component_status stats_init(struct bt_private_component *component,
+		struct bt_value *params, void *init_method_data);
+
+BT_HIDDEN
+void stats_finalize(struct bt_private_component *component);
+
+BT_HIDDEN
+void stats_port_connected(struct bt_private_component *component,
+		struct bt_private_port *self_port,
+		struct bt_port *other_port);
+
+BT_HIDDEN
+enum bt_component_status stats_consume(struct bt_private_component *component);
+
+#endif /* BABELTRACE_PLUGINS_UTILS_STATS_H */
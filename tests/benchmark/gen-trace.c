@@ -0,0 +1,637 @@
+/*
+ * gen-trace.c
+ *
+ * Synthetic CTF trace generator for benchmarks
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <babeltrace/ctf-writer/writer.h>
+#include <babeltrace/ctf-writer/clock.h>
+#include <babeltrace/ctf-writer/stream.h>
+#include <babeltrace/ctf-writer/event.h>
+#include <babeltrace/ctf-writer/event-types.h>
+#include <babeltrace/ctf-writer/event-fields.h>
+#include <babeltrace/ctf-writer/stream-class.h>
+#include <babeltrace/ref.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+#include <getopt.h>
+#include <assert.h>
+
+/* Time between two consecutive events of the trace (ns) */
+#define EVENT_PERIOD_NS		1000
+#define FIRST_EVENT_TIME_NS	1000000000ULL
+
+/* Approximate size of the default event header (ID and timestamp) */
+#define EVENT_HEADER_BITS	96
+
+#define MAX_SEQUENCE_LENGTH	16
+
+struct gen_options {
+	uint64_t stream_count;
+	uint64_t events_per_stream;
+	uint64_t event_class_count;
+	uint64_t packet_size;
+	uint64_t seed;
+	bool bitfields;
+
+	/* Payload shape */
+	bool ints;
+	bool strings;
+	bool sequences;
+	bool variants;
+	bool enums;
+	bool floats;
+
+	const char *path;
+};
+
+static const char *string_pool[] = {
+	"swapper/0",
+	"kworker/u16:2",
+	"systemd-journald",
+	"a",
+	"lttng-sessiond",
+	"babeltrace",
+	"",
+	"a somewhat longer string to make the string lengths vary a bit",
+};
+
+static uint64_t rng_state;
+
+/* xorshift64* */
+static
+uint64_t next_random(void)
+{
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return rng_state * 2685821657736338717ULL;
+}
+
+static
+void print_usage(FILE *fp)
+{
+	fprintf(fp, "Usage: gen-trace [OPTIONS] OUTPUT-DIR\n");
+	fprintf(fp, "\n");
+	fprintf(fp, "Options:\n");
+	fprintf(fp, "  -s, --streams=COUNT        Number of streams (default: 4)\n");
+	fprintf(fp, "  -e, --events=COUNT         Number of events per stream (default: 100000)\n");
+	fprintf(fp, "  -c, --event-classes=COUNT  Number of event classes (default: 4)\n");
+	fprintf(fp, "  -p, --payload=SHAPE[,SHAPE]...\n");
+	fprintf(fp, "                             Payload fields; SHAPE can be: `int`,\n");
+	fprintf(fp, "                             `string`, `sequence`, `variant`, `enum`,\n");
+	fprintf(fp, "                             `float`, or `all` (default: `int,string`)\n");
+	fprintf(fp, "  -b, --bitfields            Use integers which are not byte-aligned\n");
+	fprintf(fp, "                             and not multiples of 8 bits\n");
+	fprintf(fp, "  -P, --packet-size=BYTES    Approximate packet size (default: 65536)\n");
+	fprintf(fp, "  -S, --seed=SEED            Random seed of the field values (default: 1)\n");
+	fprintf(fp, "  -h, --help                 Show this help and quit\n");
+}
+
+static
+int parse_payload_shape(struct gen_options *opts, const char *arg)
+{
+	int ret = 0;
+	char *list = strdup(arg);
+	char *saveptr = NULL;
+	char *shape;
+
+	assert(list);
+	opts->ints = opts->strings = opts->sequences = false;
+	opts->variants = opts->enums = opts->floats = false;
+
+	for (shape = strtok_r(list, ",", &saveptr); shape;
+			shape = strtok_r(NULL, ",", &saveptr)) {
+		if (strcmp(shape, "int") == 0) {
+			opts->ints = true;
+		} else if (strcmp(shape, "string") == 0) {
+			opts->strings = true;
+		} else if (strcmp(shape, "sequence") == 0) {
+			opts->sequences = true;
+		} else if (strcmp(shape, "variant") == 0) {
+			opts->variants = true;
+		} else if (strcmp(shape, "enum") == 0) {
+			opts->enums = true;
+		} else if (strcmp(shape, "float") == 0) {
+			opts->floats = true;
+		} else if (strcmp(shape, "all") == 0) {
+			opts->ints = opts->strings = opts->sequences = true;
+			opts->variants = opts->enums = opts->floats = true;
+		} else {
+			fprintf(stderr, "Unknown payload shape `%s`\n", shape);
+			ret = -1;
+			break;
+		}
+	}
+
+	free(list);
+	return ret;
+}
+
+static
+int parse_count(const char *arg, uint64_t *count)
+{
+	char *end;
+
+	*count = strtoull(arg, &end, 0);
+	if (*arg == '\0' || *end != '\0') {
+		fprintf(stderr, "Invalid number `%s`\n", arg);
+		return -1;
+	}
+
+	return 0;
+}
+
+static
+int parse_options(int argc, char **argv, struct gen_options *opts)
+{
+	static const struct option long_options[] = {
+		{ "streams", required_argument, NULL, 's' },
+		{ "events", required_argument, NULL, 'e' },
+		{ "event-classes", required_argument, NULL, 'c' },
+		{ "payload", required_argument, NULL, 'p' },
+		{ "bitfields", no_argument, NULL, 'b' },
+		{ "packet-size", required_argument, NULL, 'P' },
+		{ "seed", required_argument, NULL, 'S' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	int opt;
+	int ret = 0;
+
+	opts->stream_count = 4;
+	opts->events_per_stream = 100000;
+	opts->event_class_count = 4;
+	opts->packet_size = 65536;
+	opts->seed = 1;
+	opts->ints = true;
+	opts->strings = true;
+
+	while ((opt = getopt_long(argc, argv, "s:e:c:p:bP:S:h",
+			long_options, NULL)) != -1) {
+		switch (opt) {
+		case 's':
+			ret = parse_count(optarg, &opts->stream_count);
+			break;
+		case 'e':
+			ret = parse_count(optarg, &opts->events_per_stream);
+			break;
+		case 'c':
+			ret = parse_count(optarg, &opts->event_class_count);
+			break;
+		case 'p':
+			ret = parse_payload_shape(opts, optarg);
+			break;
+		case 'b':
+			opts->bitfields = true;
+			break;
+		case 'P':
+			ret = parse_count(optarg, &opts->packet_size);
+			break;
+		case 'S':
+			ret = parse_count(optarg, &opts->seed);
+			break;
+		case 'h':
+			print_usage(stdout);
+			exit(EXIT_SUCCESS);
+		default:
+			ret = -1;
+			break;
+		}
+
+		if (ret) {
+			goto end;
+		}
+	}
+
+	if (optind != argc - 1 || opts->stream_count == 0 ||
+			opts->event_class_count == 0) {
+		ret = -1;
+		goto end;
+	}
+
+	opts->path = argv[optind];
+
+end:
+	if (ret) {
+		print_usage(stderr);
+	}
+
+	return ret;
+}
+
+/*
+ * Creates an integer field type of `size` bits, or of `bitfield_size`
+ * bits with a 1-bit alignment if bitfields are requested.
+ */
+static
+struct bt_ctf_field_type *create_int_type(struct gen_options *opts,
+		unsigned int size, unsigned int bitfield_size, bool is_signed)
+{
+	struct bt_ctf_field_type *type;
+	int ret;
+
+	type = bt_ctf_field_type_integer_create(
+		opts->bitfields ? bitfield_size : size);
+	assert(type);
+	ret = bt_ctf_field_type_integer_set_signed(type, is_signed);
+	assert(ret == 0);
+	if (opts->bitfields) {
+		ret = bt_ctf_field_type_set_alignment(type, 1);
+		assert(ret == 0);
+	}
+
+	return type;
+}
+
+static
+struct bt_ctf_field_type *create_enum_type(struct gen_options *opts,
+		const char **labels, unsigned int label_count)
+{
+	struct bt_ctf_field_type *container_type =
+		create_int_type(opts, 8, 3, false);
+	struct bt_ctf_field_type *type =
+		bt_ctf_field_type_enumeration_create(container_type);
+	unsigned int i;
+	int ret;
+
+	assert(type);
+	for (i = 0; i < label_count; i++) {
+		ret = bt_ctf_field_type_enumeration_add_mapping_unsigned(type,
+			labels[i], i, i);
+		assert(ret == 0);
+	}
+
+	bt_put(container_type);
+	return type;
+}
+
+static const char *state_labels[] = {
+	"RUNNING", "SLEEPING", "STOPPED", "ZOMBIE",
+};
+
+static const char *tag_labels[] = { "INT", "STR" };
+
+static
+void add_payload_fields(struct gen_options *opts,
+		struct bt_ctf_event_class *event_class)
+{
+	struct bt_ctf_field_type *type;
+	struct bt_ctf_field_type *elem_type;
+	struct bt_ctf_field_type *option_type;
+	int ret;
+
+	if (opts->ints) {
+		type = create_int_type(opts, 32, 13, false);
+		ret = bt_ctf_event_class_add_field(event_class, type, "a");
+		assert(ret == 0);
+		bt_put(type);
+		type = create_int_type(opts, 64, 27, true);
+		ret = bt_ctf_event_class_add_field(event_class, type, "b");
+		assert(ret == 0);
+		bt_put(type);
+	}
+
+	if (opts->strings) {
+		type = bt_ctf_field_type_string_create();
+		assert(type);
+		ret = bt_ctf_event_class_add_field(event_class, type, "s");
+		assert(ret == 0);
+		bt_put(type);
+	}
+
+	if (opts->sequences) {
+		type = create_int_type(opts, 8, 5, false);
+		ret = bt_ctf_event_class_add_field(event_class, type,
+			"seq_len");
+		assert(ret == 0);
+		bt_put(type);
+		elem_type = create_int_type(opts, 16, 11, false);
+		type = bt_ctf_field_type_sequence_create(elem_type, "seq_len");
+		assert(type);
+		ret = bt_ctf_event_class_add_field(event_class, type, "seq");
+		assert(ret == 0);
+		bt_put(type);
+		bt_put(elem_type);
+	}
+
+	if (opts->variants) {
+		type = create_enum_type(opts, tag_labels,
+			sizeof(tag_labels) / sizeof(*tag_labels));
+		ret = bt_ctf_event_class_add_field(event_class, type, "tag");
+		assert(ret == 0);
+		elem_type = bt_ctf_field_type_variant_create(type, "tag");
+		assert(elem_type);
+		bt_put(type);
+		option_type = create_int_type(opts, 32, 19, false);
+		ret = bt_ctf_field_type_variant_add_field(elem_type,
+			option_type, "INT");
+		assert(ret == 0);
+		bt_put(option_type);
+		option_type = bt_ctf_field_type_string_create();
+		assert(option_type);
+		ret = bt_ctf_field_type_variant_add_field(elem_type,
+			option_type, "STR");
+		assert(ret == 0);
+		bt_put(option_type);
+		ret = bt_ctf_event_class_add_field(event_class, elem_type,
+			"var");
+		assert(ret == 0);
+		bt_put(elem_type);
+	}
+
+	if (opts->enums) {
+		type = create_enum_type(opts, state_labels,
+			sizeof(state_labels) / sizeof(*state_labels));
+		ret = bt_ctf_event_class_add_field(event_class, type, "state");
+		assert(ret == 0);
+		bt_put(type);
+	}
+
+	if (opts->floats) {
+		type = bt_ctf_field_type_floating_point_create();
+		assert(type);
+		ret = bt_ctf_event_class_add_field(event_class, type, "f");
+		assert(ret == 0);
+		bt_put(type);
+	}
+}
+
+static
+void set_uint_payload(struct bt_ctf_event *event, const char *name,
+		uint64_t value)
+{
+	struct bt_ctf_field *field = bt_ctf_event_get_payload(event, name);
+	int ret;
+
+	assert(field);
+	ret = bt_ctf_field_unsigned_integer_set_value(field, value);
+	assert(ret == 0);
+	bt_put(field);
+}
+
+static
+void set_enum_value(struct bt_ctf_field *field, uint64_t value)
+{
+	struct bt_ctf_field *container =
+		bt_ctf_field_enumeration_get_container(field);
+	int ret;
+
+	assert(container);
+	ret = bt_ctf_field_unsigned_integer_set_value(container, value);
+	assert(ret == 0);
+	bt_put(container);
+}
+
+/*
+ * Sets the payload fields of `event`, returning the approximate size
+ * of the event in bits.
+ */
+static
+uint64_t set_payload(struct gen_options *opts, struct bt_ctf_event *event)
+{
+	uint64_t bits = EVENT_HEADER_BITS;
+	uint64_t random = next_random();
+	const char *str;
+	struct bt_ctf_field *field;
+	struct bt_ctf_field *tag_field;
+	struct bt_ctf_field *child;
+	int ret;
+
+	if (opts->ints) {
+		set_uint_payload(event, "a", random & 0x1fff);
+		field = bt_ctf_event_get_payload(event, "b");
+		assert(field);
+		ret = bt_ctf_field_signed_integer_set_value(field,
+			(int64_t) ((random >> 13) & 0x3ffffff) - 0x2000000);
+		assert(ret == 0);
+		bt_put(field);
+		bits += opts->bitfields ? 13 + 27 : 32 + 64;
+	}
+
+	if (opts->strings) {
+		str = string_pool[(random >> 40) %
+			(sizeof(string_pool) / sizeof(*string_pool))];
+		field = bt_ctf_event_get_payload(event, "s");
+		assert(field);
+		ret = bt_ctf_field_string_set_value(field, str);
+		assert(ret == 0);
+		bt_put(field);
+		bits += (strlen(str) + 1) * 8;
+	}
+
+	if (opts->sequences) {
+		uint64_t length = (random >> 44) % MAX_SEQUENCE_LENGTH;
+		struct bt_ctf_field *length_field;
+		uint64_t i;
+
+		length_field = bt_ctf_event_get_payload(event, "seq_len");
+		assert(length_field);
+		ret = bt_ctf_field_unsigned_integer_set_value(length_field,
+			length);
+		assert(ret == 0);
+		field = bt_ctf_event_get_payload(event, "seq");
+		assert(field);
+		ret = bt_ctf_field_sequence_set_length(field, length_field);
+		assert(ret == 0);
+		for (i = 0; i < length; i++) {
+			child = bt_ctf_field_sequence_get_field(field, i);
+			assert(child);
+			ret = bt_ctf_field_unsigned_integer_set_value(child,
+				(random + i) & 0x7ff);
+			assert(ret == 0);
+			bt_put(child);
+		}
+
+		bt_put(field);
+		bt_put(length_field);
+		bits += opts->bitfields ? 5 + length * 11 : 8 + length * 16;
+	}
+
+	if (opts->variants) {
+		uint64_t tag = (random >> 50) & 1;
+
+		tag_field = bt_ctf_event_get_payload(event, "tag");
+		assert(tag_field);
+		set_enum_value(tag_field, tag);
+		field = bt_ctf_event_get_payload(event, "var");
+		assert(field);
+		child = bt_ctf_field_variant_get_field(field, tag_field);
+		assert(child);
+		if (tag == 0) {
+			ret = bt_ctf_field_unsigned_integer_set_value(child,
+				random & 0x7ffff);
+			bits += opts->bitfields ? 19 : 32;
+		} else {
+			ret = bt_ctf_field_string_set_value(child, "option");
+			bits += 7 * 8;
+		}
+
+		assert(ret == 0);
+		bt_put(child);
+		bt_put(field);
+		bt_put(tag_field);
+		bits += opts->bitfields ? 3 : 8;
+	}
+
+	if (opts->enums) {
+		field = bt_ctf_event_get_payload(event, "state");
+		assert(field);
+		set_enum_value(field, (random >> 52) %
+			(sizeof(state_labels) / sizeof(*state_labels)));
+		bt_put(field);
+		bits += opts->bitfields ? 3 : 8;
+	}
+
+	if (opts->floats) {
+		field = bt_ctf_event_get_payload(event, "f");
+		assert(field);
+		ret = bt_ctf_field_floating_point_set_value(field,
+			(double) (random >> 11) / (double) (1ULL << 53));
+		assert(ret == 0);
+		bt_put(field);
+		bits += 64;
+	}
+
+	return bits;
+}
+
+int main(int argc, char **argv)
+{
+	struct gen_options opts = { 0 };
+	struct bt_ctf_writer *writer = NULL;
+	struct bt_ctf_clock *clock = NULL;
+	struct bt_ctf_stream_class *stream_class = NULL;
+	struct bt_ctf_event_class **event_classes = NULL;
+	struct bt_ctf_stream **streams = NULL;
+	uint64_t *packet_bits = NULL;
+	uint64_t time = FIRST_EVENT_TIME_NS;
+	uint64_t event_index = 0;
+	uint64_t i, s;
+	int exit_status = EXIT_FAILURE;
+	int ret;
+
+	if (parse_options(argc, argv, &opts)) {
+		goto end;
+	}
+
+	rng_state = opts.seed ? opts.seed : 1;
+	writer = bt_ctf_writer_create(opts.path);
+	if (!writer) {
+		fprintf(stderr, "Cannot create CTF writer for `%s`\n",
+			opts.path);
+		goto end;
+	}
+
+	clock = bt_ctf_clock_create("bench_clock");
+	assert(clock);
+	ret = bt_ctf_writer_add_clock(writer, clock);
+	assert(ret == 0);
+	stream_class = bt_ctf_stream_class_create("bench_stream");
+	assert(stream_class);
+	ret = bt_ctf_stream_class_set_clock(stream_class, clock);
+	assert(ret == 0);
+
+	event_classes = calloc(opts.event_class_count,
+		sizeof(*event_classes));
+	streams = calloc(opts.stream_count, sizeof(*streams));
+	packet_bits = calloc(opts.stream_count, sizeof(*packet_bits));
+	assert(event_classes && streams && packet_bits);
+
+	for (i = 0; i < opts.event_class_count; i++) {
+		char name[64];
+
+		snprintf(name, sizeof(name), "bench:event_%" PRIu64, i);
+		event_classes[i] = bt_ctf_event_class_create(name);
+		assert(event_classes[i]);
+		add_payload_fields(&opts, event_classes[i]);
+		ret = bt_ctf_stream_class_add_event_class(stream_class,
+			event_classes[i]);
+		assert(ret == 0);
+	}
+
+	for (s = 0; s < opts.stream_count; s++) {
+		streams[s] = bt_ctf_writer_create_stream(writer, stream_class);
+		if (!streams[s]) {
+			fprintf(stderr, "Cannot create stream\n");
+			goto end;
+		}
+	}
+
+	/* Interleave the streams so that they overlap in time */
+	for (i = 0; i < opts.events_per_stream; i++) {
+		for (s = 0; s < opts.stream_count; s++) {
+			struct bt_ctf_event *event;
+
+			ret = bt_ctf_clock_set_time(clock, time);
+			assert(ret == 0);
+			time += EVENT_PERIOD_NS;
+			event = bt_ctf_event_create(event_classes[
+				event_index % opts.event_class_count]);
+			assert(event);
+			event_index++;
+			packet_bits[s] += set_payload(&opts, event);
+			ret = bt_ctf_stream_append_event(streams[s], event);
+			bt_put(event);
+			if (ret) {
+				fprintf(stderr, "Cannot append event\n");
+				goto end;
+			}
+
+			if (packet_bits[s] / 8 >= opts.packet_size) {
+				if (bt_ctf_stream_flush(streams[s])) {
+					fprintf(stderr, "Cannot flush stream\n");
+					goto end;
+				}
+
+				packet_bits[s] = 0;
+			}
+		}
+	}
+
+	for (s = 0; s < opts.stream_count; s++) {
+		if (packet_bits[s] > 0 && bt_ctf_stream_flush(streams[s])) {
+			fprintf(stderr, "Cannot flush stream\n");
+			goto end;
+		}
+	}
+
+	bt_ctf_writer_flush_metadata(writer);
+	exit_status = EXIT_SUCCESS;
+
+end:
+	for (s = 0; streams && s < opts.stream_count; s++) {
+		bt_put(streams[s]);
+	}
+
+	for (i = 0; event_classes && i < opts.event_class_count; i++) {
+		bt_put(event_classes[i]);
+	}
+
+	free(streams);
+	free(event_classes);
+	free(packet_bits);
+	bt_put(stream_class);
+	bt_put(clock);
+	bt_put(writer);
+	return exit_status;
+}
@@ -292,6 +292,7 @@ int main(int argc, char **argv)
 	test_bin_info_elf(opt_debug_info_dir);
 	test_bin_info_build_id(opt_debug_info_dir);
 	test_bin_info_debug_link(opt_debug_info_dir);
+	bin_info_fini();
 
 	return EXIT_SUCCESS;
 }
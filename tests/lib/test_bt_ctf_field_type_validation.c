@@ -2157,6 +2157,98 @@ struct bt_ctf_event *create_event_with_context_and_payload(
 	return event;
 }
 
+static
+void test_copy_on_write(void)
+{
+	int ret;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_stream_class *sc;
+	struct bt_ctf_event_class *ec;
+	struct bt_ctf_field_type *ep;
+	struct bt_ctf_field_type *len;
+	struct bt_ctf_field_type *str;
+	struct bt_ctf_field_type *seq;
+	struct bt_ctf_field_type *inner;
+	struct bt_ctf_field_type *resolved_ep;
+	struct bt_ctf_field_type *resolved_seq;
+	struct bt_ctf_field_type *resolved_inner;
+	struct bt_ctf_field_path *field_path;
+
+	trace = bt_ctf_trace_create();
+	assert(trace);
+	sc = bt_ctf_stream_class_create("sc");
+	assert(sc);
+	ec = bt_ctf_event_class_create("ec");
+	assert(ec);
+	ep = bt_ctf_field_type_structure_create();
+	assert(ep);
+	len = bt_ctf_field_type_integer_create(8);
+	assert(len);
+	str = bt_ctf_field_type_string_create();
+	assert(str);
+	seq = bt_ctf_field_type_sequence_create(str, "len");
+	assert(seq);
+	inner = bt_ctf_field_type_structure_create();
+	assert(inner);
+	ret = bt_ctf_field_type_structure_add_field(inner, len, "x");
+	assert(ret == 0);
+	ret = bt_ctf_field_type_structure_add_field(ep, len, "len");
+	assert(ret == 0);
+	ret = bt_ctf_field_type_structure_add_field(ep, seq, "seq");
+	assert(ret == 0);
+	ret = bt_ctf_field_type_structure_add_field(ep, seq, "seq_again");
+	assert(ret == 0);
+	ret = bt_ctf_field_type_structure_add_field(ep, inner, "inner");
+	assert(ret == 0);
+	ret = bt_ctf_event_class_set_payload_type(ec, ep);
+	assert(ret == 0);
+	ret = bt_ctf_stream_class_add_event_class(sc, ec);
+	assert(ret == 0);
+
+	/* Validation happens here */
+	ret = bt_ctf_trace_add_stream_class(trace, sc);
+	ok(ret == 0, "Type system with a shared sequence FT is considered valid");
+
+	field_path = bt_ctf_field_type_sequence_get_length_field_path(seq);
+	ok(!field_path, "Resolving does not modify the original sequence FT");
+	BT_PUT(field_path);
+
+	resolved_ep = bt_ctf_event_class_get_payload_type(ec);
+	assert(resolved_ep);
+	ok(resolved_ep != ep,
+		"Resolving replaces a root FT containing a sequence FT with a copy");
+	resolved_seq = bt_ctf_field_type_structure_get_field_type_by_name(
+		resolved_ep, "seq");
+	assert(resolved_seq);
+	ok(resolved_seq != seq &&
+		!validate_field_path(resolved_seq, BT_CTF_SCOPE_EVENT_FIELDS,
+			0, FIELD_PATH_END),
+		"Resolved sequence FT copy has the correct field path");
+	BT_PUT(resolved_seq);
+	resolved_seq = bt_ctf_field_type_structure_get_field_type_by_name(
+		resolved_ep, "seq_again");
+	assert(resolved_seq);
+	ok(!validate_field_path(resolved_seq, BT_CTF_SCOPE_EVENT_FIELDS,
+			0, FIELD_PATH_END),
+		"Second use of a shared sequence FT has the correct field path");
+	resolved_inner = bt_ctf_field_type_structure_get_field_type_by_name(
+		resolved_ep, "inner");
+	ok(resolved_inner == inner,
+		"Resolving shares the unchanged FT subtrees with the original");
+
+	BT_PUT(resolved_inner);
+	BT_PUT(resolved_seq);
+	BT_PUT(resolved_ep);
+	BT_PUT(inner);
+	BT_PUT(seq);
+	BT_PUT(str);
+	BT_PUT(len);
+	BT_PUT(ep);
+	BT_PUT(ec);
+	BT_PUT(sc);
+	BT_PUT(trace);
+}
+
 
 static
 struct bt_ctf_field_type *test_fail_unavailable_root_get_event_payload(void)
@@ -2967,6 +3059,7 @@ int main(void)
 	plan_no_plan();
 
 	test_pass();
+	test_copy_on_write();
 	test_fail();
 
 	return 0;
@@ -0,0 +1,294 @@
+/*
+ * test_ctf_ir_layout.c
+ *
+ * Babeltrace CTF IR field type static layout test
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/ctf-ir/field-types-internal.h>
+#include <babeltrace/ctf-ir/fields.h>
+#include <babeltrace/ref.h>
+#include <assert.h>
+#include <stdbool.h>
+#include "tap/tap.h"
+
+#define NR_TESTS	18
+
+static
+struct bt_ctf_field_type *create_int(unsigned int size, unsigned int align)
+{
+	struct bt_ctf_field_type *ft = bt_ctf_field_type_integer_create(size);
+
+	assert(ft);
+	assert(bt_ctf_field_type_set_alignment(ft, align) == 0);
+	assert(bt_ctf_field_type_set_byte_order(ft,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN) == 0);
+	return ft;
+}
+
+static
+void add_field(struct bt_ctf_field_type *struct_ft,
+		struct bt_ctf_field_type *field_ft, const char *name)
+{
+	assert(bt_ctf_field_type_structure_add_field(struct_ft, field_ft,
+		name) == 0);
+	bt_put(field_ft);
+}
+
+/* struct { uint8_t a; uint32_t b (32-bit aligned); } */
+static
+struct bt_ctf_field_type *create_padded_struct(void)
+{
+	struct bt_ctf_field_type *ft = bt_ctf_field_type_structure_create();
+
+	assert(ft);
+	add_field(ft, create_int(8, 8), "a");
+	add_field(ft, create_int(32, 32), "b");
+	return ft;
+}
+
+/* struct { uint32_t a (32-bit aligned); uint8_t b; } */
+static
+struct bt_ctf_field_type *create_tail_struct(void)
+{
+	struct bt_ctf_field_type *ft = bt_ctf_field_type_structure_create();
+
+	assert(ft);
+	add_field(ft, create_int(32, 32), "a");
+	add_field(ft, create_int(8, 8), "b");
+	return ft;
+}
+
+/* variant <tag> { uint8_t a; uint32_t b; } */
+static
+struct bt_ctf_field_type *create_variant(void)
+{
+	struct bt_ctf_field_type *tag_ft;
+	struct bt_ctf_field_type *ft;
+	struct bt_ctf_field_type *int_ft;
+
+	int_ft = create_int(8, 8);
+	tag_ft = bt_ctf_field_type_enumeration_create(int_ft);
+	assert(tag_ft);
+	assert(bt_ctf_field_type_enumeration_add_mapping_unsigned(tag_ft, "a",
+		0, 0) == 0);
+	assert(bt_ctf_field_type_enumeration_add_mapping_unsigned(tag_ft, "b",
+		1, 1) == 0);
+	ft = bt_ctf_field_type_variant_create(tag_ft, "tag");
+	assert(ft);
+	bt_put(tag_ft);
+	bt_put(int_ft);
+	assert(bt_ctf_field_type_variant_add_field(ft, create_int(8, 8),
+		"a") == 0);
+	assert(bt_ctf_field_type_variant_add_field(ft, create_int(32, 32),
+		"b") == 0);
+	return ft;
+}
+
+/*
+ * Freezes `ft` by creating a field of this type, and returns its
+ * layout.
+ */
+static
+const struct bt_ctf_field_type_layout *get_frozen_layout(
+		struct bt_ctf_field_type *ft)
+{
+	struct bt_ctf_field *field = bt_ctf_field_create(ft);
+
+	assert(field);
+	bt_put(field);
+	return bt_ctf_field_type_get_layout(ft);
+}
+
+static
+bool has_static_size(struct bt_ctf_field_type *ft, uint64_t size)
+{
+	const struct bt_ctf_field_type_layout *layout = get_frozen_layout(ft);
+
+	return layout && layout->has_static_size &&
+		layout->static_size == size;
+}
+
+static
+bool has_dynamic_size(struct bt_ctf_field_type *ft)
+{
+	const struct bt_ctf_field_type_layout *layout = get_frozen_layout(ft);
+
+	return layout && !layout->has_static_size;
+}
+
+static
+void test_basic(void)
+{
+	struct bt_ctf_field_type *ft;
+	struct bt_ctf_field_type *int_ft;
+
+	ft = create_int(32, 32);
+	ok(!bt_ctf_field_type_get_layout(ft),
+		"field type which is not frozen has no layout");
+	ok(has_static_size(ft, 32) && ft->layout.byte_order ==
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN,
+		"integer field type has its size and byte order");
+	BT_PUT(ft);
+
+	ft = create_int(16, 8);
+	assert(bt_ctf_field_type_set_byte_order(ft,
+		BT_CTF_BYTE_ORDER_NETWORK) == 0);
+	ok(has_static_size(ft, 16) && ft->layout.byte_order ==
+		BT_CTF_BYTE_ORDER_BIG_ENDIAN,
+		"network byte order is reported as big endian");
+	BT_PUT(ft);
+
+	int_ft = create_int(16, 8);
+	ft = bt_ctf_field_type_enumeration_create(int_ft);
+	assert(ft);
+	assert(bt_ctf_field_type_enumeration_add_mapping_unsigned(ft, "x",
+		0, 0) == 0);
+	ok(has_static_size(ft, 16) && ft->layout.byte_order ==
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN,
+		"enumeration field type has the layout of its container");
+	BT_PUT(ft);
+	BT_PUT(int_ft);
+
+	ft = bt_ctf_field_type_floating_point_create();
+	assert(ft);
+	ok(has_static_size(ft, 32),
+		"single precision floating point number field type has 32 bits");
+	BT_PUT(ft);
+
+	ft = bt_ctf_field_type_string_create();
+	assert(ft);
+	ok(has_dynamic_size(ft), "string field type has a dynamic size");
+	BT_PUT(ft);
+}
+
+static
+void test_struct(void)
+{
+	struct bt_ctf_field_type *ft;
+	struct bt_ctf_field_type *outer_ft;
+
+	ft = create_padded_struct();
+	ok(has_static_size(ft, 64),
+		"structure size includes the padding before a member");
+	ok(ft->layout.byte_order == BT_CTF_BYTE_ORDER_UNKNOWN,
+		"structure field type has no byte order");
+	BT_PUT(ft);
+
+	ft = create_tail_struct();
+	ok(has_static_size(ft, 40),
+		"structure size does not include trailing padding");
+	BT_PUT(ft);
+
+	/* struct { uint8_t x; struct { uint8_t a; uint32_t b; } s; } */
+	outer_ft = bt_ctf_field_type_structure_create();
+	assert(outer_ft);
+	add_field(outer_ft, create_int(8, 8), "x");
+	add_field(outer_ft, create_padded_struct(), "s");
+	ok(has_static_size(outer_ft, 96),
+		"nested structure is aligned on its largest member alignment");
+	BT_PUT(outer_ft);
+
+	/* struct { int3_t a; int5_t b; } (bit-packed) */
+	ft = bt_ctf_field_type_structure_create();
+	assert(ft);
+	add_field(ft, create_int(3, 1), "a");
+	add_field(ft, create_int(5, 1), "b");
+	ok(has_static_size(ft, 8), "bit-packed structure has no padding");
+	BT_PUT(ft);
+
+	ft = bt_ctf_field_type_structure_create();
+	assert(ft);
+	ok(has_static_size(ft, 0), "empty structure has a null size");
+	BT_PUT(ft);
+}
+
+static
+void test_array(void)
+{
+	struct bt_ctf_field_type *ft;
+	struct bt_ctf_field_type *elem_ft;
+	struct bt_ctf_field_type *outer_ft;
+
+	elem_ft = create_padded_struct();
+	ft = bt_ctf_field_type_array_create(elem_ft, 3);
+	assert(ft);
+	ok(has_static_size(ft, 192),
+		"array of aligned structures has the size of its elements");
+	BT_PUT(ft);
+	BT_PUT(elem_ft);
+
+	elem_ft = create_tail_struct();
+	ft = bt_ctf_field_type_array_create(elem_ft, 2);
+	assert(ft);
+	ok(has_static_size(ft, 104),
+		"array size includes the padding between elements only");
+
+	/* struct { uint8_t x; struct { uint32_t a; uint8_t b; } arr[2]; } */
+	outer_ft = bt_ctf_field_type_structure_create();
+	assert(outer_ft);
+	add_field(outer_ft, create_int(8, 8), "x");
+	add_field(outer_ft, bt_get(ft), "arr");
+	ok(has_static_size(outer_ft, 136),
+		"array in a structure is aligned on its element alignment");
+	BT_PUT(outer_ft);
+	BT_PUT(ft);
+	BT_PUT(elem_ft);
+}
+
+static
+void test_variant(void)
+{
+	struct bt_ctf_field_type *ft;
+	struct bt_ctf_field_type *var_ft;
+	struct bt_ctf_field_type *tag_ft;
+
+	var_ft = create_variant();
+	ok(has_dynamic_size(var_ft), "variant field type has a dynamic size");
+	BT_PUT(var_ft);
+
+	/* struct { enum tag; uint32_t a; variant <tag> v; } */
+	var_ft = create_variant();
+	tag_ft = bt_ctf_field_type_variant_get_tag_type(var_ft);
+	assert(tag_ft);
+	ft = bt_ctf_field_type_structure_create();
+	assert(ft);
+	add_field(ft, tag_ft, "tag");
+	add_field(ft, create_int(32, 32), "a");
+	add_field(ft, var_ft, "v");
+	ok(has_dynamic_size(ft) && ft->layout.static_size == 0,
+		"structure containing a variant has a dynamic size");
+	BT_PUT(ft);
+
+	var_ft = create_variant();
+	ft = bt_ctf_field_type_array_create(var_ft, 4);
+	assert(ft);
+	ok(has_dynamic_size(ft), "array of variants has a dynamic size");
+	BT_PUT(ft);
+	BT_PUT(var_ft);
+}
+
+int main(int argc, char **argv)
+{
+	plan_tests(NR_TESTS);
+	test_basic();
+	test_struct();
+	test_array();
+	test_variant();
+	return exit_status();
+}
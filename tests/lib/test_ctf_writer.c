@@ -61,7 +61,7 @@
 #define DEFAULT_CLOCK_TIME 0
 #define DEFAULT_CLOCK_VALUE 0
 
-#define NR_TESTS 634
+#define NR_TESTS 670
 
 static int64_t current_time = 42;
 
@@ -2812,6 +2812,81 @@ void test_static_trace(void)
 	bt_put(clock_class);
 }
 
+static
+void test_add_event_classes(void)
+{
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_event_class *ecs[3];
+	struct bt_ctf_event_class *ec;
+	int ret;
+	int i;
+
+	trace = bt_ctf_trace_create();
+	assert(trace);
+	stream_class = bt_ctf_stream_class_create(NULL);
+	assert(stream_class);
+	ret = bt_ctf_stream_class_set_packet_context_type(stream_class, NULL);
+	assert(ret == 0);
+
+	for (i = 0; i < 3; i++) {
+		ecs[i] = create_minimal_event_class();
+	}
+
+	ret = bt_ctf_event_class_set_id(ecs[0], 5);
+	assert(ret == 0);
+	ret = bt_ctf_event_class_set_id(ecs[2], 5);
+	assert(ret == 0);
+	ok(bt_ctf_stream_class_add_event_classes(stream_class, ecs, 3),
+		"bt_ctf_stream_class_add_event_classes() fails with two event classes having the same ID");
+	ok(bt_ctf_stream_class_get_event_class_count(stream_class) == 0,
+		"bt_ctf_stream_class_add_event_classes() does not add any event class on failure");
+
+	for (i = 0; i < 3; i++) {
+		BT_PUT(ecs[i]);
+		ecs[i] = create_minimal_event_class();
+	}
+
+	ret = bt_ctf_event_class_set_id(ecs[1], 0);
+	assert(ret == 0);
+	ok(bt_ctf_stream_class_add_event_classes(stream_class, ecs, 3) == 0,
+		"bt_ctf_stream_class_add_event_classes() succeeds");
+	ok(bt_ctf_stream_class_get_event_class_count(stream_class) == 3,
+		"bt_ctf_stream_class_add_event_classes() adds all the event classes");
+	ec = bt_ctf_stream_class_get_event_class_by_id(stream_class, 2);
+	ok(ec == ecs[2],
+		"bt_ctf_stream_class_add_event_classes() sets automatic IDs which are not used");
+	bt_put(ec);
+	ok(bt_ctf_stream_class_add_event_class(stream_class, ecs[0]),
+		"bt_ctf_stream_class_add_event_class() fails with an event class which is already added");
+	ok(bt_ctf_stream_class_add_event_classes(stream_class, NULL, 0) == 0,
+		"bt_ctf_stream_class_add_event_classes() succeeds with no event classes");
+	ret = bt_ctf_trace_add_stream_class(trace, stream_class);
+	assert(ret == 0);
+
+	for (i = 0; i < 3; i++) {
+		BT_PUT(ecs[i]);
+		ecs[i] = create_minimal_event_class();
+	}
+
+	BT_PUT(ecs[1]);
+	ecs[1] = ecs[0];
+	ok(bt_ctf_stream_class_add_event_classes(stream_class, ecs, 3),
+		"bt_ctf_stream_class_add_event_classes() fails with the same event class twice");
+	ecs[1] = create_minimal_event_class();
+	ok(bt_ctf_stream_class_add_event_classes(stream_class, ecs, 3) == 0,
+		"bt_ctf_stream_class_add_event_classes() succeeds with a stream class which is part of a trace");
+	ok(bt_ctf_stream_class_get_event_class_count(stream_class) == 6,
+		"bt_ctf_stream_class_add_event_classes() adds all the event classes to a stream class which is part of a trace");
+
+	for (i = 0; i < 3; i++) {
+		bt_put(ecs[i]);
+	}
+
+	bt_put(stream_class);
+	bt_put(trace);
+}
+
 static
 void trace_is_static_listener(struct bt_ctf_trace *trace, void *data)
 {
@@ -2915,6 +2990,304 @@ void test_trace_uuid(void)
 	bt_put(trace);
 }
 
+static
+void test_frozen_field_type_lookups(void)
+{
+	struct bt_ctf_field_type *int_ft = bt_ctf_field_type_integer_create(8);
+	struct bt_ctf_field_type *enum_ft;
+	struct bt_ctf_field_type *struct_ft;
+	struct bt_ctf_field_type *variant_ft;
+	struct bt_ctf_field_type *copy_ft;
+	struct bt_ctf_field_type *ft;
+	struct bt_ctf_field *struct_field;
+	struct bt_ctf_field *variant_field;
+	struct bt_ctf_field *tag_field;
+	struct bt_ctf_field *container_field;
+	struct bt_ctf_field *field;
+	const char *name = NULL;
+	uint64_t begin = 0, end = 0;
+	int ret;
+
+	assert(int_ft);
+	enum_ft = bt_ctf_field_type_enumeration_create(int_ft);
+	assert(enum_ft);
+	ret = bt_ctf_field_type_enumeration_add_mapping_unsigned(enum_ft,
+		"c", 0, 0);
+	ret |= bt_ctf_field_type_enumeration_add_mapping_unsigned(enum_ft,
+		"a", 1, 1);
+	ret |= bt_ctf_field_type_enumeration_add_mapping_unsigned(enum_ft,
+		"b", 2, 7);
+	assert(!ret);
+	struct_ft = bt_ctf_field_type_structure_create();
+	assert(struct_ft);
+	ret = bt_ctf_field_type_structure_add_field(struct_ft, int_ft, "z");
+	ret |= bt_ctf_field_type_structure_add_field(struct_ft, int_ft, "a");
+	ret |= bt_ctf_field_type_structure_add_field(struct_ft, enum_ft, "m");
+	assert(!ret);
+	variant_ft = bt_ctf_field_type_variant_create(enum_ft, "m");
+	assert(variant_ft);
+	ret = bt_ctf_field_type_variant_add_field(variant_ft, int_ft, "c");
+	ret |= bt_ctf_field_type_variant_add_field(variant_ft, enum_ft, "a");
+	ret |= bt_ctf_field_type_variant_add_field(variant_ft, int_ft, "b");
+	assert(!ret);
+
+	/* Creating fields freezes the field types */
+	struct_field = bt_ctf_field_create(struct_ft);
+	variant_field = bt_ctf_field_create(variant_ft);
+	tag_field = bt_ctf_field_create(enum_ft);
+	assert(struct_field && variant_field && tag_field);
+
+	ft = bt_ctf_field_type_structure_get_field_type_by_name(struct_ft, "m");
+	ok(ft == enum_ft,
+		"frozen structure field type: field type is found by name");
+	bt_put(ft);
+	ft = bt_ctf_field_type_structure_get_field_type_by_name(struct_ft,
+		"nope");
+	ok(!ft, "frozen structure field type: unknown field name is not found");
+	ret = bt_ctf_field_type_structure_get_field_by_index(struct_ft, &name,
+		NULL, 1);
+	ok(ret == 0 && name && !strcmp(name, "a"),
+		"frozen structure field type: fields keep their order");
+	field = bt_ctf_field_structure_get_field_by_name(struct_field, "z");
+	ok(field, "structure field of a frozen field type: field is found by name");
+	bt_put(field);
+	ft = bt_ctf_field_type_variant_get_field_type_by_name(variant_ft, "a");
+	ok(ft == enum_ft,
+		"frozen variant field type: field type is found by name");
+	bt_put(ft);
+	container_field = bt_ctf_field_enumeration_get_container(tag_field);
+	assert(container_field);
+	ret = bt_ctf_field_unsigned_integer_set_value(container_field, 5);
+	assert(!ret);
+	ft = bt_ctf_field_type_variant_get_field_type_from_tag(variant_ft,
+		tag_field);
+	ok(ft == int_ft,
+		"frozen variant field type: field type is found from a tag");
+	bt_put(ft);
+	ret = bt_ctf_field_type_enumeration_get_mapping_unsigned(enum_ft, 2,
+		&name, &begin, &end);
+	ok(ret == 0 && !strcmp(name, "b") && begin == 2 && end == 7,
+		"frozen enumeration field type: mappings are kept");
+
+	copy_ft = bt_ctf_field_type_copy(struct_ft);
+	assert(copy_ft);
+	ft = bt_ctf_field_type_structure_get_field_type_by_name(copy_ft, "a");
+	ok(ft, "copy of a frozen structure field type: field type is found by name");
+	bt_put(ft);
+	ok(bt_ctf_field_type_structure_add_field(copy_ft, int_ft, "a"),
+		"copy of a frozen structure field type: duplicate field name is rejected");
+	ok(bt_ctf_field_type_structure_add_field(copy_ft, int_ft, "n") == 0,
+		"copy of a frozen structure field type: field can be added");
+
+	bt_put(copy_ft);
+	bt_put(container_field);
+	bt_put(tag_field);
+	bt_put(variant_field);
+	bt_put(struct_field);
+	bt_put(variant_ft);
+	bt_put(struct_ft);
+	bt_put(enum_ft);
+	bt_put(int_ft);
+}
+
+static
+char *get_file_contents(const char *dir_path, const char *name,
+		gsize *len)
+{
+	char *path = g_build_filename(dir_path, name, NULL);
+	char *contents = NULL;
+
+	assert(path);
+	if (!g_file_get_contents(path, &contents, len, NULL)) {
+		contents = NULL;
+	}
+
+	g_free(path);
+	return contents;
+}
+
+static
+void test_incremental_metadata(void)
+{
+	char trace_path[] = "/tmp/ctfwriter_XXXXXX";
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_event_class *ec;
+	struct bt_ctf_clock *clock;
+	char *metadata_string;
+	char *contents1;
+	char *contents2;
+	gsize len1, len2;
+	uint32_t magic;
+	int ret;
+
+	if (!bt_mkdtemp(trace_path)) {
+		perror("# perror");
+	}
+
+	writer = bt_ctf_writer_create(trace_path);
+	assert(writer);
+	clock = bt_ctf_clock_create("incremental_clock");
+	assert(clock);
+	ret = bt_ctf_writer_add_clock(writer, clock);
+	assert(!ret);
+	trace = bt_ctf_writer_get_trace(writer);
+	assert(trace);
+	stream_class = bt_ctf_stream_class_create("incremental_sc");
+	assert(stream_class);
+	ret = bt_ctf_stream_class_set_clock(stream_class, clock);
+	assert(!ret);
+	ec = create_minimal_event_class();
+	ret = bt_ctf_stream_class_add_event_class(stream_class, ec);
+	assert(!ret);
+	BT_PUT(ec);
+	ret = bt_ctf_trace_add_stream_class(trace, stream_class);
+	assert(!ret);
+
+	bt_ctf_writer_flush_metadata(writer);
+	contents1 = get_file_contents(trace_path, "metadata", &len1);
+	metadata_string = bt_ctf_writer_get_metadata_string(writer);
+	assert(metadata_string);
+	ok(contents1 && strcmp(contents1, metadata_string) == 0,
+		"bt_ctf_writer_flush_metadata() writes the complete metadata initially");
+	free(metadata_string);
+
+	ec = create_minimal_event_class();
+	ret = bt_ctf_stream_class_add_event_class(stream_class, ec);
+	assert(!ret);
+	BT_PUT(ec);
+	bt_ctf_writer_flush_metadata(writer);
+	contents2 = get_file_contents(trace_path, "metadata", &len2);
+	ok(contents1 && contents2 && len2 > len1 &&
+		memcmp(contents1, contents2, len1) == 0 &&
+		strstr(contents2 + len1, "event {") &&
+		!strstr(contents2 + len1, "stream {"),
+		"bt_ctf_writer_flush_metadata() only appends a new event class");
+	g_free(contents1);
+	contents1 = contents2;
+	len1 = len2;
+	bt_ctf_writer_flush_metadata(writer);
+	contents2 = get_file_contents(trace_path, "metadata", &len2);
+	ok(contents2 && len2 == len1,
+		"bt_ctf_writer_flush_metadata() appends nothing when nothing changed");
+	g_free(contents1);
+	g_free(contents2);
+
+	ret = bt_ctf_writer_add_environment_field(writer, "incremental",
+		"yes");
+	assert(!ret);
+	bt_ctf_writer_flush_metadata(writer);
+	contents1 = get_file_contents(trace_path, "metadata", &len1);
+	metadata_string = bt_ctf_writer_get_metadata_string(writer);
+	assert(metadata_string);
+	ok(contents1 && strcmp(contents1, metadata_string) == 0,
+		"bt_ctf_writer_flush_metadata() rewrites the metadata when the environment changes");
+	free(metadata_string);
+	g_free(contents1);
+
+	ok(bt_ctf_writer_set_packetized_metadata(NULL, BT_TRUE),
+		"bt_ctf_writer_set_packetized_metadata() handles NULL");
+	ok(bt_ctf_writer_set_packetized_metadata(writer, BT_TRUE) == 0,
+		"bt_ctf_writer_set_packetized_metadata() succeeds");
+	bt_ctf_writer_flush_metadata(writer);
+	contents1 = get_file_contents(trace_path, "metadata", &len1);
+	assert(contents1 && len1 >= sizeof(magic));
+	memcpy(&magic, contents1, sizeof(magic));
+	ok(magic == 0x75d11d57,
+		"bt_ctf_writer_flush_metadata() writes packetized metadata");
+	ec = create_minimal_event_class();
+	ret = bt_ctf_stream_class_add_event_class(stream_class, ec);
+	assert(!ret);
+	BT_PUT(ec);
+	bt_ctf_writer_flush_metadata(writer);
+	contents2 = get_file_contents(trace_path, "metadata", &len2);
+	assert(contents2 && len2 > len1 + sizeof(magic));
+	memcpy(&magic, contents2 + len1, sizeof(magic));
+	ok(memcmp(contents1, contents2, len1) == 0 && magic == 0x75d11d57,
+		"bt_ctf_writer_flush_metadata() appends a metadata packet");
+	g_free(contents1);
+	g_free(contents2);
+
+	bt_put(stream_class);
+	bt_put(trace);
+	bt_put(clock);
+	bt_put(writer);
+	recursive_rmdir(trace_path);
+}
+
+static
+void test_stream_ids_and_append(void)
+{
+	char trace_path[] = "/tmp/ctfwriter_XXXXXX";
+	static const char existing[] = "existing packets";
+	struct bt_ctf_writer *writer;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_event_class *ec;
+	struct bt_ctf_clock *clock;
+	struct bt_ctf_stream *stream;
+	char *stream_path;
+	char *contents;
+	gsize len;
+	int ret;
+
+	if (!bt_mkdtemp(trace_path)) {
+		perror("# perror");
+	}
+
+	/* Stream class 0's stream with ID 3 writes to `stream_0_3` */
+	stream_path = g_build_filename(trace_path, "stream_0_3", NULL);
+	assert(stream_path);
+	ret = g_file_set_contents(stream_path, existing, sizeof(existing),
+		NULL);
+	assert(ret);
+	writer = bt_ctf_writer_create(trace_path);
+	assert(writer);
+	clock = bt_ctf_clock_create("append_clock");
+	assert(clock);
+	ret = bt_ctf_writer_add_clock(writer, clock);
+	assert(!ret);
+	stream_class = bt_ctf_stream_class_create("append_sc");
+	assert(stream_class);
+	ret = bt_ctf_stream_class_set_clock(stream_class, clock);
+	assert(!ret);
+	ec = create_minimal_event_class();
+	ret = bt_ctf_stream_class_add_event_class(stream_class, ec);
+	assert(!ret);
+	BT_PUT(ec);
+
+	ok(bt_ctf_writer_set_append_stream_files(NULL, BT_TRUE),
+		"bt_ctf_writer_set_append_stream_files() handles NULL");
+	ok(bt_ctf_writer_set_append_stream_files(writer, BT_TRUE) == 0,
+		"bt_ctf_writer_set_append_stream_files() succeeds");
+	ok(!bt_ctf_writer_create_stream_with_id(NULL, stream_class, 3),
+		"bt_ctf_writer_create_stream_with_id() handles NULL (writer)");
+	ok(!bt_ctf_writer_create_stream_with_id(writer, NULL, 3),
+		"bt_ctf_writer_create_stream_with_id() handles NULL (stream class)");
+	ok(!bt_ctf_writer_create_stream_with_id(writer, stream_class,
+		(uint64_t) INT64_MAX + 1),
+		"bt_ctf_writer_create_stream_with_id() rejects an ID greater than INT64_MAX");
+	stream = bt_ctf_writer_create_stream_with_id(writer, stream_class, 3);
+	ok(stream && bt_ctf_stream_get_id(stream) == 3,
+		"bt_ctf_writer_create_stream_with_id() creates a stream with the given ID");
+	ok(!bt_ctf_writer_create_stream_with_id(writer, stream_class, 3),
+		"bt_ctf_writer_create_stream_with_id() rejects a duplicate ID");
+	contents = get_file_contents(trace_path, "stream_0_3", &len);
+	ok(contents && len == sizeof(existing) &&
+		memcmp(contents, existing, len) == 0,
+		"Stream file is not truncated in append mode");
+	g_free(contents);
+	ok(bt_ctf_writer_set_append_stream_files(writer, BT_FALSE),
+		"bt_ctf_writer_set_append_stream_files() fails once the writer created a stream");
+
+	g_free(stream_path);
+	bt_put(stream);
+	bt_put(stream_class);
+	bt_put(clock);
+	bt_put(writer);
+	recursive_rmdir(trace_path);
+}
+
 int main(int argc, char **argv)
 {
 	char trace_path[] = "/tmp/ctfwriter_XXXXXX";
@@ -3565,10 +3938,18 @@ int main(int argc, char **argv)
 
 	test_static_trace();
 
+	test_add_event_classes();
+
 	test_trace_is_static_listener();
 
 	test_trace_uuid();
 
+	test_frozen_field_type_lookups();
+
+	test_incremental_metadata();
+
+	test_stream_ids_and_append();
+
 	metadata_string = bt_ctf_writer_get_metadata_string(writer);
 	ok(metadata_string, "Get metadata string");
 
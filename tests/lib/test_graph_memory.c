@@ -0,0 +1,112 @@
+/*
+ * test_graph_memory.c
+ *
+ * Babeltrace graph memory budget tests
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <babeltrace/graph/graph.h>
+#include <babeltrace/ref.h>
+#include <assert.h>
+#include <stdint.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 14
+
+static
+uint64_t get_reserved(struct bt_graph *graph)
+{
+	uint64_t reserved = UINT64_MAX;
+	int ret = bt_graph_get_reserved_memory(graph, &reserved);
+
+	assert(ret == 0);
+	return reserved;
+}
+
+static
+void test_invalid(void)
+{
+	uint64_t value;
+
+	ok(bt_graph_set_memory_budget(NULL, 1) == BT_GRAPH_STATUS_INVALID,
+		"bt_graph_set_memory_budget() fails with a NULL graph");
+	ok(bt_graph_get_memory_budget(NULL, &value) == BT_GRAPH_STATUS_INVALID,
+		"bt_graph_get_memory_budget() fails with a NULL graph");
+	ok(bt_graph_reserve_memory(NULL, 1) == BT_GRAPH_STATUS_INVALID,
+		"bt_graph_reserve_memory() fails with a NULL graph");
+}
+
+static
+void test_no_budget(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	uint64_t budget = 1;
+
+	assert(graph);
+	ok(bt_graph_get_memory_budget(graph, &budget) == BT_GRAPH_STATUS_OK &&
+		budget == 0,
+		"a graph has no memory budget by default");
+	ok(bt_graph_reserve_memory(graph, UINT64_MAX / 2) == BT_GRAPH_STATUS_OK &&
+		get_reserved(graph) == UINT64_MAX / 2,
+		"any reservation succeeds without a memory budget");
+	ok(bt_graph_release_memory(graph, UINT64_MAX / 2) == BT_GRAPH_STATUS_OK &&
+		get_reserved(graph) == 0,
+		"releasing reserved memory without a memory budget");
+	bt_put(graph);
+}
+
+static
+void test_budget(void)
+{
+	struct bt_graph *graph = bt_graph_create();
+	uint64_t budget = 0;
+
+	assert(graph);
+	ok(bt_graph_set_memory_budget(graph, 1000) == BT_GRAPH_STATUS_OK &&
+		bt_graph_get_memory_budget(graph, &budget) ==
+			BT_GRAPH_STATUS_OK && budget == 1000,
+		"setting and getting a graph's memory budget");
+	ok(bt_graph_reserve_memory(graph, 600) == BT_GRAPH_STATUS_OK &&
+		get_reserved(graph) == 600,
+		"reserving memory within the memory budget");
+	ok(bt_graph_reserve_memory(graph, 401) == BT_GRAPH_STATUS_AGAIN &&
+		get_reserved(graph) == 600,
+		"reserving memory beyond the memory budget fails without reserving");
+	ok(bt_graph_reserve_memory(graph, 400) == BT_GRAPH_STATUS_OK &&
+		get_reserved(graph) == 1000,
+		"reserving the rest of the memory budget");
+	ok(bt_graph_reserve_memory(graph, UINT64_MAX) == BT_GRAPH_STATUS_AGAIN,
+		"a huge reservation does not overflow");
+	ok(bt_graph_release_memory(graph, 1001) == BT_GRAPH_STATUS_INVALID &&
+		get_reserved(graph) == 1000,
+		"releasing more memory than reserved fails");
+	ok(bt_graph_release_memory(graph, 1000) == BT_GRAPH_STATUS_OK &&
+		get_reserved(graph) == 0,
+		"releasing reserved memory");
+	ok(bt_graph_reserve_memory(graph, 1000) == BT_GRAPH_STATUS_OK,
+		"released memory can be reserved again");
+	bt_put(graph);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_invalid();
+	test_no_budget();
+	test_budget();
+	return exit_status();
+}
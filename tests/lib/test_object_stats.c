@@ -0,0 +1,230 @@
+/*
+ * test_object_stats.c
+ *
+ * Babeltrace object statistics tests
+ *
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <babeltrace/object-stats.h>
+#include <babeltrace/values.h>
+#include <babeltrace/ref.h>
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/ctf-ir/fields.h>
+#include <babeltrace/ctf-ir/clock-class.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "tap/tap.h"
+
+#define NR_TESTS 25
+
+static
+struct bt_object_stats get_stats(enum bt_object_stats_type type)
+{
+	struct bt_object_stats stats;
+	int ret = bt_object_stats_get(type, &stats);
+
+	if (ret) {
+		memset(&stats, 0, sizeof(stats));
+	}
+
+	return stats;
+}
+
+static
+void test_invalid(void)
+{
+	struct bt_object_stats stats;
+
+	ok(bt_object_stats_get(BT_OBJECT_STATS_TYPE_UNKNOWN, &stats),
+		"bt_object_stats_get() fails with an unknown type");
+	ok(bt_object_stats_get(BT_OBJECT_STATS_TYPE_NR, &stats),
+		"bt_object_stats_get() fails with BT_OBJECT_STATS_TYPE_NR");
+	ok(bt_object_stats_get(BT_OBJECT_STATS_TYPE_VALUE, NULL),
+		"bt_object_stats_get() fails with NULL statistics");
+	ok(bt_object_stats_get_total(NULL),
+		"bt_object_stats_get_total() fails with NULL statistics");
+	ok(!bt_object_stats_type_string(BT_OBJECT_STATS_TYPE_NR),
+		"bt_object_stats_type_string() returns NULL with an unknown type");
+	ok(bt_object_stats_type_string(BT_OBJECT_STATS_TYPE_EVENT) &&
+		strcmp(bt_object_stats_type_string(BT_OBJECT_STATS_TYPE_EVENT),
+			"event") == 0,
+		"bt_object_stats_type_string() returns the expected name");
+}
+
+static
+void test_values(void)
+{
+	struct bt_object_stats before = get_stats(BT_OBJECT_STATS_TYPE_VALUE);
+	struct bt_object_stats after;
+	struct bt_value *map = bt_value_map_create();
+	struct bt_value *integer = bt_value_integer_create_init(23);
+
+	after = get_stats(BT_OBJECT_STATS_TYPE_VALUE);
+	ok(after.created == before.created + 2 &&
+		after.live == before.live + 2,
+		"creating value objects increments the created and live counts");
+	ok(after.live_bytes > before.live_bytes,
+		"creating value objects increments the live size");
+	ok(after.peak_live >= after.live &&
+		after.peak_live_bytes >= after.live_bytes,
+		"value object peak counts are at least the live counts");
+	ok(bt_value_map_insert(map, "int", integer) == BT_VALUE_STATUS_OK,
+		"inserting a value object into a map value object");
+	BT_PUT(integer);
+	after = get_stats(BT_OBJECT_STATS_TYPE_VALUE);
+	ok(after.live == before.live + 2,
+		"a value object owned by a map value object is still live");
+	BT_PUT(map);
+	after = get_stats(BT_OBJECT_STATS_TYPE_VALUE);
+	ok(after.destroyed == before.destroyed + 2 &&
+		after.live == before.live &&
+		after.live_bytes == before.live_bytes,
+		"destroying value objects restores the live counts");
+	ok(after.peak_live >= before.live + 2,
+		"destroying value objects keeps the peak count");
+	bt_get(bt_value_null);
+	bt_put(bt_value_null);
+	ok(get_stats(BT_OBJECT_STATS_TYPE_VALUE).destroyed ==
+		after.destroyed,
+		"the null value object singleton is not accounted");
+}
+
+static
+void test_fields(void)
+{
+	struct bt_object_stats int_before =
+		get_stats(BT_OBJECT_STATS_TYPE_FIELD_INTEGER);
+	struct bt_object_stats struct_before =
+		get_stats(BT_OBJECT_STATS_TYPE_FIELD_STRUCT);
+	struct bt_object_stats str_before =
+		get_stats(BT_OBJECT_STATS_TYPE_FIELD_STRING);
+	struct bt_object_stats stats;
+	struct bt_ctf_field_type *int_ft = bt_ctf_field_type_integer_create(8);
+	struct bt_ctf_field_type *str_ft = bt_ctf_field_type_string_create();
+	struct bt_ctf_field_type *struct_ft =
+		bt_ctf_field_type_structure_create();
+	struct bt_ctf_field *struct_field;
+	struct bt_ctf_field *int_field;
+	struct bt_ctf_field *str_field;
+
+	assert(int_ft && str_ft && struct_ft);
+	bt_ctf_field_type_structure_add_field(struct_ft, int_ft, "a");
+	bt_ctf_field_type_structure_add_field(struct_ft, int_ft, "b");
+	bt_ctf_field_type_structure_add_field(struct_ft, str_ft, "c");
+	struct_field = bt_ctf_field_create(struct_ft);
+	ok(struct_field, "creating a structure field");
+	stats = get_stats(BT_OBJECT_STATS_TYPE_FIELD_STRUCT);
+	ok(stats.created == struct_before.created + 1 &&
+		stats.live == struct_before.live + 1,
+		"creating a structure field is accounted as a structure field");
+	ok(get_stats(BT_OBJECT_STATS_TYPE_FIELD_INTEGER).created ==
+		int_before.created,
+		"structure field members are not created eagerly");
+	int_field = bt_ctf_field_structure_get_field_by_name(struct_field, "a");
+	bt_put(int_field);
+	int_field = bt_ctf_field_structure_get_field_by_name(struct_field, "b");
+	bt_put(int_field);
+	str_field = bt_ctf_field_structure_get_field_by_name(struct_field, "c");
+	bt_put(str_field);
+	stats = get_stats(BT_OBJECT_STATS_TYPE_FIELD_INTEGER);
+	ok(stats.created == int_before.created + 2 &&
+		stats.live == int_before.live + 2,
+		"creating integer fields is accounted as integer fields");
+	stats = get_stats(BT_OBJECT_STATS_TYPE_FIELD_STRING);
+	ok(stats.created == str_before.created + 1,
+		"creating a string field is accounted as a string field");
+	BT_PUT(struct_field);
+	stats = get_stats(BT_OBJECT_STATS_TYPE_FIELD_INTEGER);
+	ok(stats.live == int_before.live &&
+		stats.live_bytes == int_before.live_bytes &&
+		stats.destroyed == int_before.destroyed + 2,
+		"destroying a structure field destroys its integer fields");
+	stats = get_stats(BT_OBJECT_STATS_TYPE_FIELD_STRUCT);
+	ok(stats.live == struct_before.live &&
+		stats.destroyed == struct_before.destroyed + 1,
+		"destroying a structure field is accounted");
+	bt_put(int_ft);
+	bt_put(str_ft);
+	bt_put(struct_ft);
+}
+
+static
+void test_clock_values(void)
+{
+	struct bt_object_stats before =
+		get_stats(BT_OBJECT_STATS_TYPE_CLOCK_VALUE);
+	struct bt_ctf_clock_class *cc = bt_ctf_clock_class_create("clk");
+	struct bt_ctf_clock_value *cv;
+
+	assert(cc);
+	cv = bt_ctf_clock_value_create(cc, 42);
+	ok(get_stats(BT_OBJECT_STATS_TYPE_CLOCK_VALUE).live ==
+		before.live + 1,
+		"creating a clock value is accounted");
+	BT_PUT(cv);
+	ok(get_stats(BT_OBJECT_STATS_TYPE_CLOCK_VALUE).destroyed ==
+		before.destroyed + 1,
+		"destroying a clock value is accounted");
+	bt_put(cc);
+}
+
+static
+void test_total(void)
+{
+	struct bt_object_stats total;
+	struct bt_object_stats sum = { 0 };
+	int type;
+
+	ok(bt_object_stats_get_total(&total) == 0,
+		"bt_object_stats_get_total() succeeds");
+
+	for (type = 0; type < BT_OBJECT_STATS_TYPE_NR; type++) {
+		struct bt_object_stats stats = get_stats(type);
+
+		sum.created += stats.created;
+		sum.destroyed += stats.destroyed;
+		sum.live += stats.live;
+		sum.live_bytes += stats.live_bytes;
+	}
+
+	ok(total.created == sum.created &&
+		total.destroyed == sum.destroyed &&
+		total.live == sum.live &&
+		total.live_bytes == sum.live_bytes,
+		"total object statistics are the sums of all the types");
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+
+	if (!bt_object_stats_is_enabled()) {
+		skip(NR_TESTS, "Object statistics are disabled "
+			"(set BABELTRACE_OBJECT_STATS=1)");
+		goto end;
+	}
+
+	test_invalid();
+	test_values();
+	test_fields();
+	test_clock_values();
+	test_total();
+
+end:
+	return exit_status();
+}
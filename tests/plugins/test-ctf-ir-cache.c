@@ -0,0 +1,607 @@
+/*
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/field-path.h>
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/trace.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/compat/memstream-internal.h>
+#include <babeltrace/ref.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "tap/tap.h"
+#include "ctf/common/metadata/decoder.h"
+#include "ctf/common/metadata/ir-cache.h"
+
+#define NR_TESTS	25
+
+static const char metadata[] =
+	"/* CTF 1.8 */\n"
+	"typealias integer { size = 8; align = 8; signed = false; } := uint8_t;\n"
+	"typealias integer { size = 32; align = 8; signed = false; } := uint32_t;\n"
+	"typealias integer { size = 64; align = 8; signed = false; } := uint64_t;\n"
+	"trace {\n"
+	"	major = 1;\n"
+	"	minor = 8;\n"
+	"	byte_order = le;\n"
+	"	packet.header := struct {\n"
+	"		uint32_t magic;\n"
+	"		uint32_t stream_id;\n"
+	"	};\n"
+	"};\n"
+	"env {\n"
+	"	hostname = \"test-host\";\n"
+	"	tracer_major = 2;\n"
+	"};\n"
+	"clock {\n"
+	"	name = test_clock;\n"
+	"	freq = 1000000000;\n"
+	"	offset = 1500000000;\n"
+	"};\n"
+	"typealias integer { size = 64; align = 8; signed = false; "
+		"map = clock.test_clock.value; } := uint64_clock_t;\n"
+	"stream {\n"
+	"	id = 0;\n"
+	"	packet.context := struct {\n"
+	"		uint64_t content_size;\n"
+	"		uint64_t packet_size;\n"
+	"		uint8_t cpu_count;\n"
+	"		uint8_t cpus[cpu_count];\n"
+	"	};\n"
+	"	event.header := struct {\n"
+	"		uint32_t id;\n"
+	"		uint64_clock_t timestamp;\n"
+	"	};\n"
+	"};\n"
+	"event {\n"
+	"	name = \"ev\";\n"
+	"	id = 0;\n"
+	"	stream_id = 0;\n"
+	"	fields := struct {\n"
+	"		enum : uint8_t { A, B } tag;\n"
+	"		uint32_t len;\n"
+	"		variant <tag> {\n"
+	"			uint32_t A;\n"
+	"			string B;\n"
+	"		} var;\n"
+	"		struct {\n"
+	"			uint8_t arr[4];\n"
+	"			uint32_t seq[event.fields.len];\n"
+	"			uint8_t cpus[stream.packet.context.cpu_count];\n"
+	"		} nested;\n"
+	"	};\n"
+	"};\n";
+
+static
+struct bt_ctf_trace *decode_metadata(const char *text, int64_t offset_ns)
+{
+	FILE *fp;
+	struct bt_ctf_trace *trace = NULL;
+	struct ctf_metadata_decoder *decoder;
+
+	decoder = ctf_metadata_decoder_create(offset_ns, "trace");
+	assert(decoder);
+	fp = bt_fmemopen((void *) text, strlen(text), "rb");
+	assert(fp);
+
+	if (ctf_metadata_decoder_decode(decoder, fp) ==
+			CTF_METADATA_DECODER_STATUS_OK) {
+		trace = ctf_metadata_decoder_get_trace(decoder);
+	}
+
+	fclose(fp);
+	ctf_metadata_decoder_destroy(decoder);
+	return trace;
+}
+
+static
+bool field_paths_are_equal(struct bt_ctf_field_path *a,
+		struct bt_ctf_field_path *b)
+{
+	int64_t i;
+
+	if (!a || !b) {
+		return false;
+	}
+
+	if (bt_ctf_field_path_get_root_scope(a) !=
+			bt_ctf_field_path_get_root_scope(b) ||
+			bt_ctf_field_path_get_index_count(a) !=
+			bt_ctf_field_path_get_index_count(b)) {
+		return false;
+	}
+
+	for (i = 0; i < bt_ctf_field_path_get_index_count(a); i++) {
+		if (bt_ctf_field_path_get_index(a, i) !=
+				bt_ctf_field_path_get_index(b, i)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Compares two field types like bt_ctf_field_type_compare() does, and
+ * also their length and tag field paths, and variant tag field types,
+ * which are resolved again when loaded classes are added to their
+ * trace.
+ */
+static
+bool field_types_are_equal(struct bt_ctf_field_type *a,
+		struct bt_ctf_field_type *b)
+{
+	bool equal = false;
+	struct bt_ctf_field_type *child_a = NULL;
+	struct bt_ctf_field_type *child_b = NULL;
+	struct bt_ctf_field_path *path_a = NULL;
+	struct bt_ctf_field_path *path_b = NULL;
+	int64_t i;
+
+	if (!a || !b) {
+		return a == b;
+	}
+
+	if (bt_ctf_field_type_compare(a, b) != 0) {
+		goto end;
+	}
+
+	switch (bt_ctf_field_type_get_type_id(a)) {
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+		for (i = 0; i < bt_ctf_field_type_structure_get_field_count(a);
+				i++) {
+			BT_PUT(child_a);
+			BT_PUT(child_b);
+			(void) bt_ctf_field_type_structure_get_field_by_index(a,
+				NULL, &child_a, i);
+			(void) bt_ctf_field_type_structure_get_field_by_index(b,
+				NULL, &child_b, i);
+			if (!field_types_are_equal(child_a, child_b)) {
+				goto end;
+			}
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_VARIANT:
+		path_a = bt_ctf_field_type_variant_get_tag_field_path(a);
+		path_b = bt_ctf_field_type_variant_get_tag_field_path(b);
+		if (!field_paths_are_equal(path_a, path_b)) {
+			goto end;
+		}
+
+		child_a = bt_ctf_field_type_variant_get_tag_type(a);
+		child_b = bt_ctf_field_type_variant_get_tag_type(b);
+		if (!child_a || !child_b ||
+				bt_ctf_field_type_compare(child_a, child_b)) {
+			goto end;
+		}
+
+		for (i = 0; i < bt_ctf_field_type_variant_get_field_count(a);
+				i++) {
+			BT_PUT(child_a);
+			BT_PUT(child_b);
+			(void) bt_ctf_field_type_variant_get_field_by_index(a,
+				NULL, &child_a, i);
+			(void) bt_ctf_field_type_variant_get_field_by_index(b,
+				NULL, &child_b, i);
+			if (!field_types_are_equal(child_a, child_b)) {
+				goto end;
+			}
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+		child_a = bt_ctf_field_type_array_get_element_type(a);
+		child_b = bt_ctf_field_type_array_get_element_type(b);
+		if (!field_types_are_equal(child_a, child_b)) {
+			goto end;
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_SEQUENCE:
+		path_a = bt_ctf_field_type_sequence_get_length_field_path(a);
+		path_b = bt_ctf_field_type_sequence_get_length_field_path(b);
+		if (!field_paths_are_equal(path_a, path_b)) {
+			goto end;
+		}
+
+		child_a = bt_ctf_field_type_sequence_get_element_type(a);
+		child_b = bt_ctf_field_type_sequence_get_element_type(b);
+		if (!field_types_are_equal(child_a, child_b)) {
+			goto end;
+		}
+		break;
+	default:
+		break;
+	}
+
+	equal = true;
+
+end:
+	bt_put(child_a);
+	bt_put(child_b);
+	bt_put(path_a);
+	bt_put(path_b);
+	return equal;
+}
+
+static
+bool stream_classes_are_equal(struct bt_ctf_stream_class *a,
+		struct bt_ctf_stream_class *b)
+{
+	bool equal = false;
+	struct bt_ctf_field_type *ft_a = NULL;
+	struct bt_ctf_field_type *ft_b = NULL;
+
+	if (bt_ctf_stream_class_get_id(a) != bt_ctf_stream_class_get_id(b)) {
+		goto end;
+	}
+
+	ft_a = bt_ctf_stream_class_get_packet_context_type(a);
+	ft_b = bt_ctf_stream_class_get_packet_context_type(b);
+	if (!field_types_are_equal(ft_a, ft_b)) {
+		goto end;
+	}
+
+	BT_PUT(ft_a);
+	BT_PUT(ft_b);
+	ft_a = bt_ctf_stream_class_get_event_header_type(a);
+	ft_b = bt_ctf_stream_class_get_event_header_type(b);
+	if (!field_types_are_equal(ft_a, ft_b)) {
+		goto end;
+	}
+
+	BT_PUT(ft_a);
+	BT_PUT(ft_b);
+	ft_a = bt_ctf_stream_class_get_event_context_type(a);
+	ft_b = bt_ctf_stream_class_get_event_context_type(b);
+	if (!field_types_are_equal(ft_a, ft_b)) {
+		goto end;
+	}
+
+	equal = bt_ctf_stream_class_get_event_class_count(a) ==
+		bt_ctf_stream_class_get_event_class_count(b);
+
+end:
+	bt_put(ft_a);
+	bt_put(ft_b);
+	return equal;
+}
+
+static
+bool event_classes_are_equal(struct bt_ctf_event_class *a,
+		struct bt_ctf_event_class *b)
+{
+	bool equal = false;
+	struct bt_ctf_field_type *ft_a = NULL;
+	struct bt_ctf_field_type *ft_b = NULL;
+
+	if (strcmp(bt_ctf_event_class_get_name(a),
+			bt_ctf_event_class_get_name(b)) != 0 ||
+			bt_ctf_event_class_get_id(a) !=
+			bt_ctf_event_class_get_id(b)) {
+		goto end;
+	}
+
+	ft_a = bt_ctf_event_class_get_context_type(a);
+	ft_b = bt_ctf_event_class_get_context_type(b);
+	if (!field_types_are_equal(ft_a, ft_b)) {
+		goto end;
+	}
+
+	BT_PUT(ft_a);
+	BT_PUT(ft_b);
+	ft_a = bt_ctf_event_class_get_payload_type(a);
+	ft_b = bt_ctf_event_class_get_payload_type(b);
+	equal = field_types_are_equal(ft_a, ft_b);
+
+end:
+	bt_put(ft_a);
+	bt_put(ft_b);
+	return equal;
+}
+
+static
+gchar *get_entry_path(const char *cache_dir, const char *key)
+{
+	gchar *basename = g_strdup_printf("%s.ir", key);
+	gchar *path = g_build_filename(cache_dir, basename, NULL);
+
+	g_free(basename);
+	return path;
+}
+
+static
+void test_round_trip(const char *cache_dir)
+{
+	int ret;
+	gchar *key;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_trace *loaded_trace;
+	struct bt_ctf_stream_class *sc = NULL;
+	struct bt_ctf_stream_class *loaded_sc = NULL;
+	struct bt_ctf_event_class *ec = NULL;
+	struct bt_ctf_event_class *loaded_ec = NULL;
+	struct bt_ctf_field_type *ft = NULL;
+	struct bt_ctf_field_type *loaded_ft = NULL;
+	struct bt_ctf_field_type *var_ft = NULL;
+	struct bt_ctf_field_type *tag_ft = NULL;
+	struct bt_ctf_field_type *var_tag_ft = NULL;
+
+	trace = decode_metadata(metadata, 0);
+	ok(trace, "metadata text is decoded");
+	key = ctf_metadata_ir_cache_get_key(metadata, strlen(metadata), 0);
+	assert(key);
+	ret = ctf_metadata_ir_cache_store(cache_dir, key, trace);
+	ok(ret == 0, "trace is stored in the cache");
+	loaded_trace = ctf_metadata_ir_cache_load(cache_dir, key, "trace");
+	ok(loaded_trace, "trace is loaded from the cache");
+	if (!loaded_trace) {
+		skip(10, "cannot compare without a loaded trace");
+		goto end;
+	}
+
+	ok(strcmp(bt_ctf_trace_get_name(trace),
+		bt_ctf_trace_get_name(loaded_trace)) == 0,
+		"loaded trace has the same name");
+	ft = bt_ctf_trace_get_packet_header_type(trace);
+	loaded_ft = bt_ctf_trace_get_packet_header_type(loaded_trace);
+	ok(field_types_are_equal(ft, loaded_ft),
+		"loaded packet header field type is the same");
+	ok(bt_ctf_trace_get_clock_class_count(trace) ==
+		bt_ctf_trace_get_clock_class_count(loaded_trace),
+		"loaded trace has the same clock classes");
+	ok(bt_ctf_trace_get_stream_class_count(trace) == 1 &&
+		bt_ctf_trace_get_stream_class_count(loaded_trace) == 1,
+		"loaded trace has the same stream classes");
+	sc = bt_ctf_trace_get_stream_class_by_index(trace, 0);
+	loaded_sc = bt_ctf_trace_get_stream_class_by_index(loaded_trace, 0);
+	ok(sc && loaded_sc && stream_classes_are_equal(sc, loaded_sc),
+		"loaded stream class and its field types are the same");
+	ec = bt_ctf_stream_class_get_event_class_by_index(sc, 0);
+	loaded_ec = bt_ctf_stream_class_get_event_class_by_index(loaded_sc, 0);
+	ok(ec && loaded_ec && event_classes_are_equal(ec, loaded_ec),
+		"loaded event class and its field types are the same");
+
+	/* The tag of a loaded variant is the field type in its payload */
+	BT_PUT(loaded_ft);
+	loaded_ft = bt_ctf_event_class_get_payload_type(loaded_ec);
+	tag_ft = bt_ctf_field_type_structure_get_field_type_by_name(loaded_ft,
+		"tag");
+	var_ft = bt_ctf_field_type_structure_get_field_type_by_name(loaded_ft,
+		"var");
+	var_tag_ft = bt_ctf_field_type_variant_get_tag_type(var_ft);
+	ok(tag_ft && tag_ft == var_tag_ft,
+		"loaded variant's tag field type is the one of the payload");
+	ok(bt_ctf_field_type_set_alignment(loaded_ft, 32) != 0,
+		"loaded field types are frozen");
+	BT_PUT(trace);
+	trace = bt_ctf_stream_class_get_trace(loaded_sc);
+	ok(trace == loaded_trace,
+		"loaded stream class is part of the loaded trace");
+	ok(bt_ctf_stream_class_get_event_class_count(loaded_sc) == 1,
+		"loaded stream class has the same event classes");
+
+end:
+	g_free(key);
+	bt_put(trace);
+	bt_put(loaded_trace);
+	bt_put(sc);
+	bt_put(loaded_sc);
+	bt_put(ec);
+	bt_put(loaded_ec);
+	bt_put(ft);
+	bt_put(loaded_ft);
+	bt_put(var_ft);
+	bt_put(tag_ft);
+	bt_put(var_tag_ft);
+}
+
+static
+void test_share(void)
+{
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_trace *shared_trace;
+	struct bt_ctf_stream_class *sc = NULL;
+	struct bt_ctf_stream_class *shared_sc = NULL;
+	struct bt_ctf_event_class *ec = NULL;
+	struct bt_ctf_event_class *shared_ec = NULL;
+	struct bt_ctf_clock_class *cc = NULL;
+	struct bt_ctf_clock_class *shared_cc = NULL;
+	struct bt_ctf_field_type *ft = NULL;
+	struct bt_ctf_field_type *shared_ft = NULL;
+
+	trace = decode_metadata(metadata, 0);
+	assert(trace);
+	shared_trace = ctf_metadata_ir_cache_share(trace, "other");
+	ok(shared_trace, "trace sharing the field types of another is created");
+	if (!shared_trace) {
+		skip(5, "cannot compare without a shared trace");
+		goto end;
+	}
+
+	ok(strcmp(bt_ctf_trace_get_name(shared_trace),
+		"test-host/other") == 0,
+		"shared trace has its own name");
+	sc = bt_ctf_trace_get_stream_class_by_index(trace, 0);
+	shared_sc = bt_ctf_trace_get_stream_class_by_index(shared_trace, 0);
+	ok(sc && shared_sc && sc != shared_sc &&
+		stream_classes_are_equal(sc, shared_sc),
+		"shared trace has its own, identical stream class");
+	ec = bt_ctf_stream_class_get_event_class_by_index(sc, 0);
+	shared_ec = bt_ctf_stream_class_get_event_class_by_index(shared_sc, 0);
+	ok(ec && shared_ec && ec != shared_ec &&
+		event_classes_are_equal(ec, shared_ec),
+		"shared trace has its own, identical event class");
+	ft = bt_ctf_event_class_get_payload_type(ec);
+	shared_ft = bt_ctf_event_class_get_payload_type(shared_ec);
+	ok(ft && ft == shared_ft,
+		"resolved payload field type is shared, not copied");
+	cc = bt_ctf_trace_get_clock_class_by_index(trace, 0);
+	shared_cc = bt_ctf_trace_get_clock_class_by_index(shared_trace, 0);
+	ok(cc && cc == shared_cc, "clock class is shared");
+
+end:
+	bt_put(trace);
+	bt_put(shared_trace);
+	bt_put(sc);
+	bt_put(shared_sc);
+	bt_put(ec);
+	bt_put(shared_ec);
+	bt_put(cc);
+	bt_put(shared_cc);
+	bt_put(ft);
+	bt_put(shared_ft);
+}
+
+static
+void test_key(void)
+{
+	gchar *key = ctf_metadata_ir_cache_get_key(metadata,
+		strlen(metadata), 0);
+	gchar *other_offset_key = ctf_metadata_ir_cache_get_key(metadata,
+		strlen(metadata), 1);
+	gchar *other_contents_key = ctf_metadata_ir_cache_get_key(metadata,
+		strlen(metadata) - 1, 0);
+
+	ok(strcmp(key, other_offset_key) != 0 &&
+		strcmp(key, other_contents_key) != 0,
+		"cache key depends on the clock offset and on the contents");
+	g_free(key);
+	g_free(other_offset_key);
+	g_free(other_contents_key);
+}
+
+/*
+ * Stores the decoded trace, applies `corrupt` to the raw entry, and
+ * checks that loading it fails.
+ */
+static
+void test_corrupted_entry(const char *cache_dir,
+		void (*corrupt)(gchar *contents, gsize *len), const char *what)
+{
+	gboolean ret;
+	gchar *key;
+	gchar *path;
+	gchar *contents;
+	gsize len;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_trace *loaded_trace;
+
+	trace = decode_metadata(metadata, 0);
+	assert(trace);
+	key = ctf_metadata_ir_cache_get_key(metadata, strlen(metadata), 0);
+	assert(key);
+	(void) ctf_metadata_ir_cache_store(cache_dir, key, trace);
+	path = get_entry_path(cache_dir, key);
+	ret = g_file_get_contents(path, &contents, &len, NULL);
+	assert(ret);
+	corrupt(contents, &len);
+	ret = g_file_set_contents(path, contents, len, NULL);
+	assert(ret);
+	loaded_trace = ctf_metadata_ir_cache_load(cache_dir, key, "trace");
+	ok(!loaded_trace, "%s cache entry is not loaded", what);
+	bt_put(loaded_trace);
+	bt_put(trace);
+	g_free(contents);
+	g_free(path);
+	g_free(key);
+}
+
+static
+void flip_last_byte(gchar *contents, gsize *len)
+{
+	contents[*len - 1] ^= 0x5a;
+}
+
+static
+void flip_field_type_byte(gchar *contents, gsize *len)
+{
+	/* Somewhere in the field types, after the header and digest */
+	contents[*len / 2] ^= 0x01;
+}
+
+static
+void truncate_entry(gchar *contents, gsize *len)
+{
+	*len /= 2;
+}
+
+static
+void change_version(gchar *contents, gsize *len)
+{
+	/* Version is the second 32-bit word */
+	contents[4] ^= 0xff;
+}
+
+static
+void test_missing_entry(const char *cache_dir)
+{
+	struct bt_ctf_trace *trace = ctf_metadata_ir_cache_load(cache_dir,
+		"0000", "trace");
+
+	ok(!trace, "missing cache entry is not loaded");
+	bt_put(trace);
+}
+
+static
+void remove_dir(const char *path)
+{
+	GDir *dir = g_dir_open(path, 0, NULL);
+	const gchar *name;
+
+	if (!dir) {
+		return;
+	}
+
+	while ((name = g_dir_read_name(dir))) {
+		gchar *entry_path = g_build_filename(path, name, NULL);
+
+		(void) g_unlink(entry_path);
+		g_free(entry_path);
+	}
+
+	g_dir_close(dir);
+	(void) g_rmdir(path);
+}
+
+int main(int argc, char **argv)
+{
+	gchar *cache_dir;
+
+	plan_tests(NR_TESTS);
+	cache_dir = g_dir_make_tmp("test-ctf-ir-cache-XXXXXX", NULL);
+	assert(cache_dir);
+	test_round_trip(cache_dir);
+	test_share();
+	test_key();
+	test_corrupted_entry(cache_dir, flip_last_byte, "bit-flipped (end)");
+	test_corrupted_entry(cache_dir, flip_field_type_byte,
+		"bit-flipped (field type)");
+	test_corrupted_entry(cache_dir, truncate_entry, "truncated");
+	test_corrupted_entry(cache_dir, change_version,
+		"other version's");
+	test_missing_entry(cache_dir);
+	remove_dir(cache_dir);
+	g_free(cache_dir);
+	return exit_status();
+}
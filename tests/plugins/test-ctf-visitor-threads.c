@@ -0,0 +1,491 @@
+/*
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <babeltrace/ctf-ir/clock-class.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/trace.h>
+#include <babeltrace/babeltrace-internal.h>
+#include <babeltrace/compat/memstream-internal.h>
+#include <babeltrace/ref.h>
+#include <glib.h>
+
+#include "tap/tap.h"
+#include "ctf/common/metadata/scanner.h"
+#include "ctf/common/metadata/ast.h"
+
+#define NR_TESTS	7
+
+/* Enough event declarations for the visitor to use 4 threads */
+#define EVENT_COUNT	256
+#define THREAD_COUNT	4
+
+static const char metadata_header[] =
+	"/* CTF 1.8 */\n"
+	"typealias integer { size = 8; align = 8; signed = false; } := uint8_t;\n"
+	"typealias integer { size = 32; align = 8; signed = false; } := uint32_t;\n"
+	"typealias integer { size = 64; align = 8; signed = false; } := uint64_t;\n"
+	"trace {\n"
+	"	major = 1;\n"
+	"	minor = 8;\n"
+	"	byte_order = le;\n"
+	"	packet.header := struct {\n"
+	"		uint32_t magic;\n"
+	"		uint32_t stream_id;\n"
+	"	};\n"
+	"};\n"
+	"clock {\n"
+	"	name = test_clock;\n"
+	"	freq = 1000000000;\n"
+	"};\n"
+	"typealias integer { size = 64; align = 8; signed = false; "
+		"map = clock.test_clock.value; } := uint64_clock_t;\n"
+	"typealias struct {\n"
+	"	uint32_t x;\n"
+	"	uint64_clock_t t;\n"
+	"} := point_t;\n"
+	"typealias enum : uint8_t { A, B = 5 ... 7 } := tag_t;\n"
+	"stream {\n"
+	"	id = 0;\n"
+	"	event.header := struct {\n"
+	"		uint32_t id;\n"
+	"		uint64_clock_t timestamp;\n"
+	"	};\n"
+	"};\n"
+	"stream {\n"
+	"	id = 1;\n"
+	"	event.header := struct {\n"
+	"		uint32_t id;\n"
+	"		uint64_clock_t timestamp;\n"
+	"	};\n"
+	"};\n";
+
+/*
+ * Returns metadata text with EVENT_COUNT event declarations, in two
+ * stream classes, using root and event scope declarations. If
+ * `dup_event_index` is not negative, the event declaration at this
+ * index has the ID of the previous one in the same stream class.
+ */
+static
+gchar *create_metadata(int dup_event_index)
+{
+	int i;
+	GString *text = g_string_new(metadata_header);
+
+	assert(text);
+
+	for (i = 0; i < EVENT_COUNT; i++) {
+		int id = i / 2;
+
+		if (i == dup_event_index) {
+			id--;
+		}
+
+		g_string_append_printf(text,
+			"event {\n"
+			"	name = \"ev%d\";\n"
+			"	id = %d;\n"
+			"	stream_id = %d;\n"
+			"	typealias integer { size = %d; align = 8; "
+				"signed = true; } := value%d_t;\n"
+			"	context := struct {\n"
+			"		uint64_clock_t ctx_ts;\n"
+			"	};\n"
+			"	fields := struct {\n"
+			"		value%d_t value;\n"
+			"		tag_t tag;\n"
+			"		variant <tag> {\n"
+			"			point_t A;\n"
+			"			string B;\n"
+			"		} var;\n"
+			"		uint8_t len;\n"
+			"		uint64_clock_t stamps[len];\n"
+			"		point_t points[%d];\n"
+			"	};\n"
+			"};\n",
+			i, id, i % 2, 8 << (i % 4), i, i, i % 7 + 1);
+	}
+
+	return g_string_free(text, FALSE);
+}
+
+static
+struct bt_ctf_trace *decode_metadata(const char *text,
+		unsigned int thread_count)
+{
+	FILE *fp;
+	struct bt_ctf_trace *trace = NULL;
+	struct ctf_scanner *scanner;
+	struct ctf_visitor_generate_ir *visitor;
+
+	fp = bt_fmemopen((void *) text, strlen(text), "rb");
+	assert(fp);
+	scanner = ctf_scanner_alloc();
+	assert(scanner);
+	visitor = ctf_visitor_generate_ir_create(0, "trace");
+	assert(visitor);
+	ctf_visitor_generate_ir_set_thread_count(visitor, thread_count);
+
+	if (ctf_scanner_append_ast(scanner, fp)) {
+		goto end;
+	}
+
+	if (ctf_visitor_semantic_check(0, &scanner->ast->root)) {
+		goto end;
+	}
+
+	if (ctf_visitor_generate_ir_visit_node(visitor,
+			&scanner->ast->root)) {
+		goto end;
+	}
+
+	trace = ctf_visitor_generate_ir_get_trace(visitor);
+
+end:
+	ctf_visitor_generate_ir_destroy(visitor);
+	ctf_scanner_free(scanner);
+	fclose(fp);
+	return trace;
+}
+
+/*
+ * Compares two field types of the traces `trace_a` and `trace_b`.
+ * Integer field types mapped to a clock class are equal if they are
+ * mapped to the clock class with the same name in their own trace.
+ */
+static
+bool field_types_are_equal(struct bt_ctf_trace *trace_a,
+		struct bt_ctf_field_type *a, struct bt_ctf_trace *trace_b,
+		struct bt_ctf_field_type *b)
+{
+	bool equal = false;
+	struct bt_ctf_field_type *child_a = NULL;
+	struct bt_ctf_field_type *child_b = NULL;
+	struct bt_ctf_clock_class *clock_a = NULL;
+	struct bt_ctf_clock_class *clock_b = NULL;
+	struct bt_ctf_clock_class *trace_clock_a = NULL;
+	struct bt_ctf_clock_class *trace_clock_b = NULL;
+	const char *name_a;
+	const char *name_b;
+	int64_t i;
+
+	if (!a || !b) {
+		return a == b;
+	}
+
+	if (bt_ctf_field_type_get_type_id(a) !=
+			bt_ctf_field_type_get_type_id(b) ||
+			bt_ctf_field_type_get_alignment(a) !=
+			bt_ctf_field_type_get_alignment(b)) {
+		goto end;
+	}
+
+	switch (bt_ctf_field_type_get_type_id(a)) {
+	case BT_CTF_FIELD_TYPE_ID_INTEGER:
+		if (bt_ctf_field_type_integer_get_size(a) !=
+				bt_ctf_field_type_integer_get_size(b) ||
+				bt_ctf_field_type_integer_is_signed(a) !=
+				bt_ctf_field_type_integer_is_signed(b) ||
+				bt_ctf_field_type_integer_get_base(a) !=
+				bt_ctf_field_type_integer_get_base(b) ||
+				bt_ctf_field_type_integer_get_encoding(a) !=
+				bt_ctf_field_type_integer_get_encoding(b) ||
+				bt_ctf_field_type_get_byte_order(a) !=
+				bt_ctf_field_type_get_byte_order(b)) {
+			goto end;
+		}
+
+		clock_a = bt_ctf_field_type_integer_get_mapped_clock_class(a);
+		clock_b = bt_ctf_field_type_integer_get_mapped_clock_class(b);
+		if (!clock_a || !clock_b) {
+			if (clock_a != clock_b) {
+				goto end;
+			}
+
+			break;
+		}
+
+		trace_clock_a = bt_ctf_trace_get_clock_class_by_name(trace_a,
+			bt_ctf_clock_class_get_name(clock_a));
+		trace_clock_b = bt_ctf_trace_get_clock_class_by_name(trace_b,
+			bt_ctf_clock_class_get_name(clock_b));
+		if (!trace_clock_a || trace_clock_a != clock_a ||
+				!trace_clock_b || trace_clock_b != clock_b ||
+				strcmp(bt_ctf_clock_class_get_name(clock_a),
+					bt_ctf_clock_class_get_name(clock_b))) {
+			goto end;
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ENUM:
+		if (bt_ctf_field_type_enumeration_get_mapping_count(a) !=
+				bt_ctf_field_type_enumeration_get_mapping_count(b)) {
+			goto end;
+		}
+
+		child_a = bt_ctf_field_type_enumeration_get_container_type(a);
+		child_b = bt_ctf_field_type_enumeration_get_container_type(b);
+		if (!field_types_are_equal(trace_a, child_a, trace_b,
+				child_b)) {
+			goto end;
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_STRUCT:
+		if (bt_ctf_field_type_structure_get_field_count(a) !=
+				bt_ctf_field_type_structure_get_field_count(b)) {
+			goto end;
+		}
+
+		for (i = 0; i < bt_ctf_field_type_structure_get_field_count(a);
+				i++) {
+			BT_PUT(child_a);
+			BT_PUT(child_b);
+			(void) bt_ctf_field_type_structure_get_field_by_index(a,
+				&name_a, &child_a, i);
+			(void) bt_ctf_field_type_structure_get_field_by_index(b,
+				&name_b, &child_b, i);
+			if (strcmp(name_a, name_b) ||
+					!field_types_are_equal(trace_a, child_a,
+						trace_b, child_b)) {
+				goto end;
+			}
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_VARIANT:
+		if (strcmp(bt_ctf_field_type_variant_get_tag_name(a),
+				bt_ctf_field_type_variant_get_tag_name(b)) ||
+				bt_ctf_field_type_variant_get_field_count(a) !=
+				bt_ctf_field_type_variant_get_field_count(b)) {
+			goto end;
+		}
+
+		for (i = 0; i < bt_ctf_field_type_variant_get_field_count(a);
+				i++) {
+			BT_PUT(child_a);
+			BT_PUT(child_b);
+			(void) bt_ctf_field_type_variant_get_field_by_index(a,
+				&name_a, &child_a, i);
+			(void) bt_ctf_field_type_variant_get_field_by_index(b,
+				&name_b, &child_b, i);
+			if (strcmp(name_a, name_b) ||
+					!field_types_are_equal(trace_a, child_a,
+						trace_b, child_b)) {
+				goto end;
+			}
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_ARRAY:
+		if (bt_ctf_field_type_array_get_length(a) !=
+				bt_ctf_field_type_array_get_length(b)) {
+			goto end;
+		}
+
+		child_a = bt_ctf_field_type_array_get_element_type(a);
+		child_b = bt_ctf_field_type_array_get_element_type(b);
+		if (!field_types_are_equal(trace_a, child_a, trace_b,
+				child_b)) {
+			goto end;
+		}
+		break;
+	case BT_CTF_FIELD_TYPE_ID_SEQUENCE:
+		if (strcmp(bt_ctf_field_type_sequence_get_length_field_name(a),
+				bt_ctf_field_type_sequence_get_length_field_name(b))) {
+			goto end;
+		}
+
+		child_a = bt_ctf_field_type_sequence_get_element_type(a);
+		child_b = bt_ctf_field_type_sequence_get_element_type(b);
+		if (!field_types_are_equal(trace_a, child_a, trace_b,
+				child_b)) {
+			goto end;
+		}
+		break;
+	default:
+		if (bt_ctf_field_type_compare(a, b) != 0) {
+			goto end;
+		}
+		break;
+	}
+
+	equal = true;
+
+end:
+	bt_put(child_a);
+	bt_put(child_b);
+	bt_put(clock_a);
+	bt_put(clock_b);
+	bt_put(trace_clock_a);
+	bt_put(trace_clock_b);
+	return equal;
+}
+
+static
+bool event_classes_are_equal(struct bt_ctf_trace *trace_a,
+		struct bt_ctf_event_class *a, struct bt_ctf_trace *trace_b,
+		struct bt_ctf_event_class *b)
+{
+	bool equal = false;
+	struct bt_ctf_field_type *ft_a = NULL;
+	struct bt_ctf_field_type *ft_b = NULL;
+
+	if (strcmp(bt_ctf_event_class_get_name(a),
+			bt_ctf_event_class_get_name(b)) != 0 ||
+			bt_ctf_event_class_get_id(a) !=
+			bt_ctf_event_class_get_id(b)) {
+		goto end;
+	}
+
+	ft_a = bt_ctf_event_class_get_context_type(a);
+	ft_b = bt_ctf_event_class_get_context_type(b);
+	if (!field_types_are_equal(trace_a, ft_a, trace_b, ft_b)) {
+		goto end;
+	}
+
+	BT_PUT(ft_a);
+	BT_PUT(ft_b);
+	ft_a = bt_ctf_event_class_get_payload_type(a);
+	ft_b = bt_ctf_event_class_get_payload_type(b);
+	equal = field_types_are_equal(trace_a, ft_a, trace_b, ft_b);
+
+end:
+	bt_put(ft_a);
+	bt_put(ft_b);
+	return equal;
+}
+
+/*
+ * Returns true if the stream classes of `a` and `b` have the same IDs
+ * and the same event classes, in the same order. If `event_count` is
+ * not NULL, it is set to the total number of event classes.
+ */
+static
+bool traces_are_equal(struct bt_ctf_trace *a, struct bt_ctf_trace *b,
+		int64_t *event_count)
+{
+	bool equal = false;
+	int64_t i, j;
+	int64_t total = 0;
+	struct bt_ctf_stream_class *sc_a = NULL;
+	struct bt_ctf_stream_class *sc_b = NULL;
+	struct bt_ctf_event_class *ec_a = NULL;
+	struct bt_ctf_event_class *ec_b = NULL;
+
+	if (bt_ctf_trace_get_stream_class_count(a) !=
+			bt_ctf_trace_get_stream_class_count(b)) {
+		goto end;
+	}
+
+	for (i = 0; i < bt_ctf_trace_get_stream_class_count(a); i++) {
+		BT_PUT(sc_a);
+		BT_PUT(sc_b);
+		sc_a = bt_ctf_trace_get_stream_class_by_index(a, i);
+		sc_b = bt_ctf_trace_get_stream_class_by_index(b, i);
+		if (bt_ctf_stream_class_get_id(sc_a) !=
+				bt_ctf_stream_class_get_id(sc_b) ||
+				bt_ctf_stream_class_get_event_class_count(sc_a) !=
+				bt_ctf_stream_class_get_event_class_count(sc_b)) {
+			goto end;
+		}
+
+		for (j = 0; j < bt_ctf_stream_class_get_event_class_count(sc_a);
+				j++) {
+			BT_PUT(ec_a);
+			BT_PUT(ec_b);
+			ec_a = bt_ctf_stream_class_get_event_class_by_index(sc_a,
+				j);
+			ec_b = bt_ctf_stream_class_get_event_class_by_index(sc_b,
+				j);
+			if (!event_classes_are_equal(a, ec_a, b, ec_b)) {
+				goto end;
+			}
+
+			total++;
+		}
+	}
+
+	if (event_count) {
+		*event_count = total;
+	}
+
+	equal = true;
+
+end:
+	bt_put(sc_a);
+	bt_put(sc_b);
+	bt_put(ec_a);
+	bt_put(ec_b);
+	return equal;
+}
+
+static
+void test_same_ir(void)
+{
+	int64_t event_count = 0;
+	gchar *metadata = create_metadata(-1);
+	struct bt_ctf_trace *serial_trace;
+	struct bt_ctf_trace *parallel_trace;
+	struct bt_ctf_trace *parallel_trace2;
+
+	serial_trace = decode_metadata(metadata, 1);
+	ok(serial_trace, "metadata is decoded by a serial visit");
+	parallel_trace = decode_metadata(metadata, THREAD_COUNT);
+	ok(parallel_trace, "metadata is decoded by a parallel visit");
+	if (!serial_trace || !parallel_trace) {
+		skip(3, "cannot compare without both traces");
+		goto end;
+	}
+
+	ok(traces_are_equal(serial_trace, parallel_trace, &event_count),
+		"parallel visit creates the same stream classes, event classes, and field types");
+	ok(event_count == EVENT_COUNT,
+		"parallel visit creates all the event classes");
+	parallel_trace2 = decode_metadata(metadata, THREAD_COUNT);
+	ok(parallel_trace2 && traces_are_equal(parallel_trace,
+		parallel_trace2, NULL),
+		"parallel visits create the same event classes");
+	bt_put(parallel_trace2);
+
+end:
+	bt_put(serial_trace);
+	bt_put(parallel_trace);
+	g_free(metadata);
+}
+
+static
+void test_same_error(void)
+{
+	gchar *metadata = create_metadata(EVENT_COUNT - 3);
+
+	ok(!decode_metadata(metadata, 1),
+		"serial visit fails with a duplicate event class ID");
+	ok(!decode_metadata(metadata, THREAD_COUNT),
+		"parallel visit fails with a duplicate event class ID");
+	g_free(metadata);
+}
+
+int main(void)
+{
+	plan_tests(NR_TESTS);
+	test_same_ir();
+	test_same_error();
+	return exit_status();
+}
@@ -0,0 +1,288 @@
+/*
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/ctf-ir/fields.h>
+#include <babeltrace/ctf-ir/packet.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/stream.h>
+#include <babeltrace/ctf-ir/trace.h>
+#include <babeltrace/ref.h>
+#include <glib.h>
+
+#include "tap/tap.h"
+#include "utils/filter/expr.h"
+
+#define NR_TESTS	19
+
+static struct bt_ctf_event_class *switch_event_class;
+static struct bt_ctf_event_class *other_event_class;
+static struct bt_ctf_event *switch_event;
+static struct bt_ctf_event *other_event;
+static struct bt_ctf_packet *packet;
+
+static
+void init_static_data(void)
+{
+	int ret;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_stream_class *stream_class;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_field_type *empty_struct_ft;
+	struct bt_ctf_field_type *int_ft;
+	struct bt_ctf_field_type *uint_ft;
+	struct bt_ctf_field_type *string_ft;
+	struct bt_ctf_field_type *nested_ft;
+	struct bt_ctf_field *field;
+	struct bt_ctf_field *nested_field;
+
+	/* Metadata */
+	empty_struct_ft = bt_ctf_field_type_structure_create();
+	assert(empty_struct_ft);
+	int_ft = bt_ctf_field_type_integer_create(32);
+	assert(int_ft);
+	ret = bt_ctf_field_type_integer_set_signed(int_ft, 1);
+	assert(ret == 0);
+	uint_ft = bt_ctf_field_type_integer_create(8);
+	assert(uint_ft);
+	string_ft = bt_ctf_field_type_string_create();
+	assert(string_ft);
+	nested_ft = bt_ctf_field_type_structure_create();
+	assert(nested_ft);
+	ret = bt_ctf_field_type_structure_add_field(nested_ft, uint_ft, "cpu");
+	assert(ret == 0);
+	trace = bt_ctf_trace_create();
+	assert(trace);
+	ret = bt_ctf_trace_set_native_byte_order(trace,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	assert(ret == 0);
+	ret = bt_ctf_trace_set_packet_header_type(trace, empty_struct_ft);
+	assert(ret == 0);
+	stream_class = bt_ctf_stream_class_create("my-stream-class");
+	assert(stream_class);
+	ret = bt_ctf_stream_class_set_packet_context_type(stream_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	ret = bt_ctf_stream_class_set_event_header_type(stream_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	ret = bt_ctf_stream_class_set_event_context_type(stream_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	switch_event_class = bt_ctf_event_class_create("sched_switch");
+	assert(switch_event_class);
+	ret = bt_ctf_event_class_add_field(switch_event_class, int_ft,
+		"prev_state");
+	assert(ret == 0);
+	ret = bt_ctf_event_class_add_field(switch_event_class, string_ft,
+		"next_comm");
+	assert(ret == 0);
+	ret = bt_ctf_event_class_add_field(switch_event_class, nested_ft,
+		"where");
+	assert(ret == 0);
+	ret = bt_ctf_stream_class_add_event_class(stream_class,
+		switch_event_class);
+	assert(ret == 0);
+	other_event_class = bt_ctf_event_class_create("sched_wakeup");
+	assert(other_event_class);
+	ret = bt_ctf_event_class_add_field(other_event_class, string_ft,
+		"comm");
+	assert(ret == 0);
+	ret = bt_ctf_stream_class_add_event_class(stream_class,
+		other_event_class);
+	assert(ret == 0);
+	ret = bt_ctf_trace_add_stream_class(trace, stream_class);
+	assert(ret == 0);
+	stream = bt_ctf_stream_create(stream_class, "stream0");
+	assert(stream);
+	packet = bt_ctf_packet_create(stream);
+	assert(packet);
+
+	/* Events */
+	switch_event = bt_ctf_event_create(switch_event_class);
+	assert(switch_event);
+	ret = bt_ctf_event_set_packet(switch_event, packet);
+	assert(ret == 0);
+	field = bt_ctf_event_get_payload(switch_event, "prev_state");
+	assert(field);
+	ret = bt_ctf_field_signed_integer_set_value(field, -2);
+	assert(ret == 0);
+	bt_put(field);
+	field = bt_ctf_event_get_payload(switch_event, "next_comm");
+	assert(field);
+	ret = bt_ctf_field_string_set_value(field, "swapper");
+	assert(ret == 0);
+	bt_put(field);
+	nested_field = bt_ctf_event_get_payload(switch_event, "where");
+	assert(nested_field);
+	field = bt_ctf_field_structure_get_field_by_name(nested_field, "cpu");
+	assert(field);
+	bt_put(nested_field);
+	ret = bt_ctf_field_unsigned_integer_set_value(field, 3);
+	assert(ret == 0);
+	bt_put(field);
+	other_event = bt_ctf_event_create(other_event_class);
+	assert(other_event);
+	ret = bt_ctf_event_set_packet(other_event, packet);
+	assert(ret == 0);
+	field = bt_ctf_event_get_payload(other_event, "comm");
+	assert(field);
+	ret = bt_ctf_field_string_set_value(field, "bash");
+	assert(ret == 0);
+	bt_put(field);
+
+	bt_put(stream);
+	bt_put(stream_class);
+	bt_put(trace);
+	bt_put(nested_ft);
+	bt_put(string_ft);
+	bt_put(uint_ft);
+	bt_put(int_ft);
+	bt_put(empty_struct_ft);
+}
+
+static
+void fini_static_data(void)
+{
+	bt_put(switch_event);
+	bt_put(other_event);
+	bt_put(packet);
+	bt_put(switch_event_class);
+	bt_put(other_event_class);
+}
+
+static
+bool parses(const char *text)
+{
+	GString *error = g_string_new(NULL);
+	struct filter_expr *expr;
+
+	assert(error);
+	expr = filter_expr_parse(text, error);
+	filter_expr_destroy(expr);
+	g_string_free(error, TRUE);
+	return expr != NULL;
+}
+
+/*
+ * Evaluates the expression `text` for `event`, setting `*is_constant`
+ * to whether or not the compiled program is a constant.
+ */
+static
+bool evaluate(const char *text, struct bt_ctf_event *event, bool *is_constant)
+{
+	GString *error = g_string_new(NULL);
+	struct filter_expr *expr;
+	struct filter_program *program;
+	struct bt_ctf_event_class *event_class;
+	bool result;
+	bool constant_result;
+
+	assert(error);
+	expr = filter_expr_parse(text, error);
+	assert(expr);
+	event_class = bt_ctf_event_get_class(event);
+	assert(event_class);
+	program = filter_program_compile(expr, event_class);
+	assert(program);
+	*is_constant = filter_program_is_constant(program, &constant_result);
+	result = filter_program_evaluate(program, event, NULL);
+	assert(!*is_constant || result == constant_result);
+	filter_program_destroy(program);
+	filter_expr_destroy(expr);
+	bt_put(event_class);
+	g_string_free(error, TRUE);
+	return result;
+}
+
+static
+void test_parse(void)
+{
+	ok(parses("name == \"sched_switch\" && (prev_state != 0 || !$ts)"),
+		"valid expression is parsed");
+	ok(parses("$ctx.cpu_id >= 0x10 && $payload.name < -1.5e3"),
+		"scoped fields and number literals are parsed");
+	ok(!parses("prev_state =="), "missing operand is rejected");
+	ok(!parses("(prev_state"), "missing `)` is rejected");
+	ok(!parses("$nope.a"), "unknown `$` name is rejected");
+	ok(!parses("\"abc"), "unterminated string literal is rejected");
+	ok(!parses("a b"), "trailing token is rejected");
+}
+
+static
+void test_constant_folding(void)
+{
+	bool is_constant;
+	bool result;
+
+	result = evaluate("name == \"sched_switch\"", switch_event,
+		&is_constant);
+	ok(result && is_constant, "event class name folds to true");
+	result = evaluate("name == \"sched_switch\" && prev_state < 0",
+		other_event, &is_constant);
+	ok(!result && is_constant,
+		"other event class folds to false without reading fields");
+	result = evaluate("prev_state == 1 || $name != \"sched_switch\"",
+		other_event, &is_constant);
+	ok(result && is_constant, "missing field folds within `||`");
+}
+
+static
+void test_fields(void)
+{
+	bool is_constant;
+	bool result;
+
+	result = evaluate("prev_state == -2", switch_event, &is_constant);
+	ok(result && !is_constant, "signed payload field is compared");
+	result = evaluate("prev_state < 0 && where.cpu == 3", switch_event,
+		&is_constant);
+	ok(result, "nested unsigned payload field is compared");
+	result = evaluate("where.cpu > -1", switch_event, &is_constant);
+	ok(result, "unsigned field is compared with a negative literal");
+	result = evaluate("where.cpu == 3.0", switch_event, &is_constant);
+	ok(result, "integer field is compared with a float literal");
+	result = evaluate("next_comm == \"swapper\"", switch_event,
+		&is_constant);
+	ok(result, "string payload field is compared");
+	result = evaluate("next_comm == 3", switch_event, &is_constant);
+	ok(!result, "string field compared with a number is false");
+	result = evaluate("!(next_comm > \"t\")", switch_event, &is_constant);
+	ok(result, "string ordering is used");
+	result = evaluate("comm == \"bash\"", other_event, &is_constant);
+	ok(result, "field of another event class is compared");
+	result = evaluate("$ts > 0", switch_event, &is_constant);
+	ok(!result, "missing time makes a comparison false");
+}
+
+int main(int argc, char **argv)
+{
+	plan_tests(NR_TESTS);
+	init_static_data();
+	test_parse();
+	test_constant_folding();
+	test_fields();
+	fini_static_data();
+	return exit_status();
+}
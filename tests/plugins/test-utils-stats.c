@@ -0,0 +1,548 @@
+/*
+ * Copyright 2017 - EfficiOS Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; under version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <babeltrace/ctf-ir/clock-class.h>
+#include <babeltrace/ctf-ir/event-class.h>
+#include <babeltrace/ctf-ir/event.h>
+#include <babeltrace/ctf-ir/field-types.h>
+#include <babeltrace/ctf-ir/fields.h>
+#include <babeltrace/ctf-ir/packet.h>
+#include <babeltrace/ctf-ir/stream-class.h>
+#include <babeltrace/ctf-ir/stream.h>
+#include <babeltrace/ctf-ir/trace.h>
+#include <babeltrace/graph/clock-class-priority-map.h>
+#include <babeltrace/graph/component-class-sink.h>
+#include <babeltrace/graph/component-class-source.h>
+#include <babeltrace/graph/component-class.h>
+#include <babeltrace/graph/component-sink.h>
+#include <babeltrace/graph/component-source.h>
+#include <babeltrace/graph/graph.h>
+#include <babeltrace/graph/notification-event.h>
+#include <babeltrace/graph/notification-packet.h>
+#include <babeltrace/graph/private-component-source.h>
+#include <babeltrace/graph/private-notification-iterator.h>
+#include <babeltrace/values.h>
+#include <babeltrace/ref.h>
+#include <glib.h>
+
+#include "tap/tap.h"
+#include "utils/stats/stats.h"
+
+#define NR_TESTS	21
+
+/* One source event: class, time, `tid` and `size` payload fields */
+struct test_event {
+	bool is_exit;
+	int64_t ts_ns;
+	uint64_t tid;
+	int64_t size;
+};
+
+/*
+ * Entry/exit pairs per `tid`: the latencies are 200, 250, and 100 ns,
+ * and the exit of `tid` 3 has no entry.
+ */
+static const struct test_event test_events[] = {
+	{ false, 100, 1, 10 },
+	{ false, 150, 2, -5 },
+	{ true, 300, 1, 0 },
+	{ true, 400, 2, 0 },
+	{ true, 500, 3, 0 },
+	{ false, 600, 1, 30 },
+	{ true, 700, 1, 0 },
+};
+
+#define NR_TEST_EVENTS	(sizeof(test_events) / sizeof(*test_events))
+
+static const char expected_json[] =
+	"{\n"
+	"  \"bucket-ns\": 1000,\n"
+	"  \"origin-ns\": 100,\n"
+	"  \"event-classes\": [\n"
+	"    {\"name\": \"entry\", \"id\": 0, \"groups\": [\n"
+	"      {\"key\": 1, \"count\": 2, \"first-ns\": 100, \"last-ns\": 600, "
+		"\"rate\": 4000000.000, \"buckets\": [2], \"fields\": "
+		"{\"size\": {\"count\": 2, \"min\": 10, \"max\": 30, "
+		"\"sum\": 40}}},\n"
+	"      {\"key\": 2, \"count\": 1, \"first-ns\": 150, \"last-ns\": 150, "
+		"\"rate\": 0.000, \"buckets\": [1], \"fields\": "
+		"{\"size\": {\"count\": 1, \"min\": -5, \"max\": -5, "
+		"\"sum\": -5}}}]},\n"
+	"    {\"name\": \"exit\", \"id\": 1, \"groups\": [\n"
+	"      {\"key\": 1, \"count\": 2, \"first-ns\": 300, \"last-ns\": 700, "
+		"\"rate\": 5000000.000, \"buckets\": [2], \"fields\": "
+		"{\"size\": {\"count\": 0}}},\n"
+	"      {\"key\": 2, \"count\": 1, \"first-ns\": 400, \"last-ns\": 400, "
+		"\"rate\": 0.000, \"buckets\": [1], \"fields\": "
+		"{\"size\": {\"count\": 0}}},\n"
+	"      {\"key\": 3, \"count\": 1, \"first-ns\": 500, \"last-ns\": 500, "
+		"\"rate\": 0.000, \"buckets\": [1], \"fields\": "
+		"{\"size\": {\"count\": 0}}}]}\n"
+	"  ],\n"
+	"  \"latencies\": [\n"
+	"    {\"entry\": \"entry\", \"exit\": \"exit\", \"count\": 3, "
+		"\"unmatched-exits\": 1, \"min-ns\": 100, \"max-ns\": 250, "
+		"\"mean-ns\": 183, \"percentiles-ns\": {\"50\": 203, "
+		"\"90\": 250, \"99\": 250, \"99.9\": 250}}\n"
+	"  ]\n"
+	"}\n";
+
+static struct bt_ctf_clock_class *src_clock_class;
+static struct bt_clock_class_priority_map *src_cc_prio_map;
+static struct bt_ctf_event_class *entry_event_class;
+static struct bt_ctf_event_class *exit_event_class;
+static struct bt_ctf_stream_class *src_stream_class;
+static struct bt_ctf_packet *src_packet;
+
+/* Index of the next notification: packet beginning, events, packet end */
+struct src_iter_user_data {
+	size_t at;
+};
+
+static
+void init_static_data(void)
+{
+	int ret;
+	struct bt_ctf_trace *trace;
+	struct bt_ctf_stream *stream;
+	struct bt_ctf_field_type *empty_struct_ft;
+	struct bt_ctf_field_type *uint_ft;
+	struct bt_ctf_field_type *int_ft;
+
+	empty_struct_ft = bt_ctf_field_type_structure_create();
+	assert(empty_struct_ft);
+	uint_ft = bt_ctf_field_type_integer_create(32);
+	assert(uint_ft);
+	int_ft = bt_ctf_field_type_integer_create(64);
+	assert(int_ft);
+	ret = bt_ctf_field_type_integer_set_signed(int_ft, 1);
+	assert(ret == 0);
+	trace = bt_ctf_trace_create();
+	assert(trace);
+	ret = bt_ctf_trace_set_native_byte_order(trace,
+		BT_CTF_BYTE_ORDER_LITTLE_ENDIAN);
+	assert(ret == 0);
+	ret = bt_ctf_trace_set_packet_header_type(trace, empty_struct_ft);
+	assert(ret == 0);
+	src_clock_class = bt_ctf_clock_class_create("my-clock");
+	assert(src_clock_class);
+	ret = bt_ctf_clock_class_set_is_absolute(src_clock_class, 1);
+	assert(ret == 0);
+	ret = bt_ctf_trace_add_clock_class(trace, src_clock_class);
+	assert(ret == 0);
+	src_cc_prio_map = bt_clock_class_priority_map_create();
+	assert(src_cc_prio_map);
+	ret = bt_clock_class_priority_map_add_clock_class(src_cc_prio_map,
+		src_clock_class, 0);
+	assert(ret == 0);
+	src_stream_class = bt_ctf_stream_class_create("my-stream-class");
+	assert(src_stream_class);
+	ret = bt_ctf_stream_class_set_packet_context_type(src_stream_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	ret = bt_ctf_stream_class_set_event_header_type(src_stream_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	ret = bt_ctf_stream_class_set_event_context_type(src_stream_class,
+		empty_struct_ft);
+	assert(ret == 0);
+	entry_event_class = bt_ctf_event_class_create("entry");
+	assert(entry_event_class);
+	ret = bt_ctf_event_class_add_field(entry_event_class, uint_ft, "tid");
+	assert(ret == 0);
+	ret = bt_ctf_event_class_add_field(entry_event_class, int_ft, "size");
+	assert(ret == 0);
+	ret = bt_ctf_stream_class_add_event_class(src_stream_class,
+		entry_event_class);
+	assert(ret == 0);
+	exit_event_class = bt_ctf_event_class_create("exit");
+	assert(exit_event_class);
+	ret = bt_ctf_event_class_add_field(exit_event_class, uint_ft, "tid");
+	assert(ret == 0);
+	ret = bt_ctf_stream_class_add_event_class(src_stream_class,
+		exit_event_class);
+	assert(ret == 0);
+	ret = bt_ctf_trace_add_stream_class(trace, src_stream_class);
+	assert(ret == 0);
+	stream = bt_ctf_stream_create(src_stream_class, "stream0");
+	assert(stream);
+	src_packet = bt_ctf_packet_create(stream);
+	assert(src_packet);
+	bt_put(stream);
+	bt_put(trace);
+	bt_put(empty_struct_ft);
+	bt_put(uint_ft);
+	bt_put(int_ft);
+}
+
+static
+void fini_static_data(void)
+{
+	bt_put(src_cc_prio_map);
+	bt_put(src_clock_class);
+	bt_put(src_stream_class);
+	bt_put(entry_event_class);
+	bt_put(exit_event_class);
+	bt_put(src_packet);
+}
+
+static
+void set_payload_field(struct bt_ctf_event *event, const char *name,
+		bool is_signed, uint64_t value)
+{
+	struct bt_ctf_field *field = bt_ctf_event_get_payload(event, name);
+	int ret;
+
+	assert(field);
+
+	if (is_signed) {
+		ret = bt_ctf_field_signed_integer_set_value(field,
+			(int64_t) value);
+	} else {
+		ret = bt_ctf_field_unsigned_integer_set_value(field, value);
+	}
+
+	assert(ret == 0);
+	bt_put(field);
+}
+
+static
+struct bt_notification *src_create_event_notification(
+		const struct test_event *test_event)
+{
+	struct bt_ctf_event *event;
+	struct bt_ctf_clock_value *clock_value;
+	struct bt_notification *notification;
+	int ret;
+
+	event = bt_ctf_event_create(test_event->is_exit ?
+		exit_event_class : entry_event_class);
+	assert(event);
+	ret = bt_ctf_event_set_packet(event, src_packet);
+	assert(ret == 0);
+	set_payload_field(event, "tid", false, test_event->tid);
+	if (!test_event->is_exit) {
+		set_payload_field(event, "size", true,
+			(uint64_t) test_event->size);
+	}
+
+	clock_value = bt_ctf_clock_value_create(src_clock_class,
+		(uint64_t) test_event->ts_ns);
+	assert(clock_value);
+	ret = bt_ctf_event_set_clock_value(event, clock_value);
+	assert(ret == 0);
+	notification = bt_notification_event_create(event, src_cc_prio_map);
+	assert(notification);
+	bt_put(clock_value);
+	bt_put(event);
+	return notification;
+}
+
+static
+void src_iter_finalize(
+		struct bt_private_notification_iterator *private_notification_iterator)
+{
+	g_free(bt_private_notification_iterator_get_user_data(
+		private_notification_iterator));
+}
+
+static
+enum bt_notification_iterator_status src_iter_init(
+		struct bt_private_notification_iterator *priv_notif_iter,
+		struct bt_private_port *private_port)
+{
+	struct src_iter_user_data *user_data =
+		g_new0(struct src_iter_user_data, 1);
+	int ret;
+
+	assert(user_data);
+	ret = bt_private_notification_iterator_set_user_data(priv_notif_iter,
+		user_data);
+	assert(ret == 0);
+	return BT_NOTIFICATION_ITERATOR_STATUS_OK;
+}
+
+static
+struct bt_notification_iterator_next_return src_iter_next(
+		struct bt_private_notification_iterator *priv_iterator)
+{
+	struct bt_notification_iterator_next_return next_return = {
+		.notification = NULL,
+		.status = BT_NOTIFICATION_ITERATOR_STATUS_OK,
+	};
+	struct src_iter_user_data *user_data =
+		bt_private_notification_iterator_get_user_data(priv_iterator);
+
+	assert(user_data);
+
+	if (user_data->at == 0) {
+		next_return.notification =
+			bt_notification_packet_begin_create(src_packet);
+	} else if (user_data->at <= NR_TEST_EVENTS) {
+		next_return.notification = src_create_event_notification(
+			&test_events[user_data->at - 1]);
+	} else if (user_data->at == NR_TEST_EVENTS + 1) {
+		next_return.notification =
+			bt_notification_packet_end_create(src_packet);
+	} else {
+		next_return.status = BT_NOTIFICATION_ITERATOR_STATUS_END;
+	}
+
+	if (next_return.status == BT_NOTIFICATION_ITERATOR_STATUS_OK) {
+		assert(next_return.notification);
+		user_data->at++;
+	}
+
+	return next_return;
+}
+
+static
+enum bt_component_status src_init(
+		struct bt_private_component *private_component,
+		struct bt_value *params, void *init_method_data)
+{
+	int ret;
+
+	ret = bt_private_component_source_add_output_private_port(
+		private_component, "out", NULL, NULL);
+	assert(ret == 0);
+	return BT_COMPONENT_STATUS_OK;
+}
+
+/*
+ * Runs a graph of which the source emits `test_events` and the sink is
+ * a statistics sink writing its `format` report to `path`. Returns
+ * the report, or NULL if the graph fails.
+ */
+static
+gchar *run_stats(const char *format, const char *path)
+{
+	struct bt_component_class *src_comp_class;
+	struct bt_component_class *stats_comp_class;
+	struct bt_component *src_comp;
+	struct bt_component *stats_comp;
+	struct bt_port *upstream_port;
+	struct bt_port *downstream_port;
+	struct bt_graph *graph;
+	struct bt_value *params;
+	enum bt_graph_status graph_status = BT_GRAPH_STATUS_OK;
+	gchar *report = NULL;
+	int ret;
+
+	src_comp_class = bt_component_class_source_create("src", src_iter_next);
+	assert(src_comp_class);
+	ret = bt_component_class_set_init_method(src_comp_class, src_init);
+	assert(ret == 0);
+	ret = bt_component_class_source_set_notification_iterator_init_method(
+		src_comp_class, src_iter_init);
+	assert(ret == 0);
+	ret = bt_component_class_source_set_notification_iterator_finalize_method(
+		src_comp_class, src_iter_finalize);
+	assert(ret == 0);
+	stats_comp_class = bt_component_class_sink_create("stats",
+		stats_consume);
+	assert(stats_comp_class);
+	ret = bt_component_class_set_init_method(stats_comp_class, stats_init);
+	assert(ret == 0);
+	ret = bt_component_class_set_finalize_method(stats_comp_class,
+		stats_finalize);
+	assert(ret == 0);
+	ret = bt_component_class_set_port_connected_method(stats_comp_class,
+		stats_port_connected);
+	assert(ret == 0);
+
+	params = bt_value_map_create();
+	assert(params);
+	ret = bt_value_map_insert_string(params, "group-by", "tid");
+	assert(ret == 0);
+	ret = bt_value_map_insert_string(params, "fields", "size");
+	assert(ret == 0);
+	ret = bt_value_map_insert_string(params, "latency", "entry:exit");
+	assert(ret == 0);
+	ret = bt_value_map_insert_integer(params, "bucket-ns", 1000);
+	assert(ret == 0);
+	ret = bt_value_map_insert_string(params, "format", format);
+	assert(ret == 0);
+	ret = bt_value_map_insert_string(params, "path", path);
+	assert(ret == 0);
+
+	graph = bt_graph_create();
+	assert(graph);
+	ret = bt_graph_add_component(graph, src_comp_class, "source", NULL,
+		&src_comp);
+	assert(ret == 0);
+	ret = bt_graph_add_component(graph, stats_comp_class, "stats", params,
+		&stats_comp);
+	assert(ret == 0);
+	upstream_port = bt_component_source_get_output_port_by_name(src_comp,
+		"out");
+	assert(upstream_port);
+	downstream_port = bt_component_sink_get_input_port_by_name(stats_comp,
+		"in");
+	assert(downstream_port);
+	graph_status = bt_graph_connect_ports(graph, upstream_port,
+		downstream_port, NULL);
+	assert(graph_status == 0);
+	bt_put(upstream_port);
+	bt_put(downstream_port);
+
+	while (graph_status == BT_GRAPH_STATUS_OK ||
+			graph_status == BT_GRAPH_STATUS_AGAIN) {
+		graph_status = bt_graph_run(graph);
+	}
+
+	/* Finalizing the sink closes its output file. */
+	bt_put(src_comp);
+	bt_put(stats_comp);
+	bt_put(graph);
+	bt_put(params);
+	bt_put(src_comp_class);
+	bt_put(stats_comp_class);
+
+	if (graph_status == BT_GRAPH_STATUS_END) {
+		ret = g_file_get_contents(path, &report, NULL, NULL);
+		assert(ret);
+	}
+
+	return report;
+}
+
+static
+void test_histogram(void)
+{
+	struct stats_histogram *histogram = stats_histogram_create();
+	uint64_t value;
+
+	assert(histogram);
+	ok(stats_histogram_get_percentile(histogram, 50) == 0,
+		"percentile of an empty histogram is 0");
+
+	for (value = 1; value <= 100; value++) {
+		stats_histogram_record(histogram, value);
+	}
+
+	ok(histogram->count == 100 && histogram->min == 1 &&
+		histogram->max == 100 && histogram->sum == 5050,
+		"histogram records the count, min, max, and sum");
+	ok(stats_histogram_get_percentile(histogram, 50) == 50,
+		"values below 64 are exact");
+	ok(stats_histogram_get_percentile(histogram, 90) == 91,
+		"percentile is the highest value of its bucket");
+	ok(stats_histogram_get_percentile(histogram, 100) == 100,
+		"percentile is not above the maximum");
+	ok(stats_histogram_get_percentile(histogram, 0) == 1,
+		"percentile is not below the minimum");
+	stats_histogram_destroy(histogram);
+
+	histogram = stats_histogram_create();
+	assert(histogram);
+	stats_histogram_record(histogram, 1000000);
+	stats_histogram_record(histogram, 1000001);
+	stats_histogram_record(histogram, 2000000);
+	value = stats_histogram_get_percentile(histogram, 50);
+	ok(value >= 1000001 && value <= 1000000 + 1000000 / 32,
+		"percentile of large values is within the relative error");
+	ok(stats_histogram_get_percentile(histogram, 99) == 2000000,
+		"highest percentile of large values is the maximum");
+	stats_histogram_destroy(histogram);
+}
+
+static
+void test_json_report(const char *path)
+{
+	gchar *report = run_stats("json", path);
+
+	ok(report, "graph with a JSON statistics sink finishes");
+	if (!report) {
+		skip(7, "No JSON report");
+		return;
+	}
+
+	ok(strstr(report, "{\"name\": \"entry\", \"id\": 0, \"groups\": [\n"
+		"      {\"key\": 1, \"count\": 2,"),
+		"entry events are counted per group");
+	ok(strstr(report, "{\"key\": 3, \"count\": 1, \"first-ns\": 500"),
+		"exit events are counted per group");
+	ok(strstr(report, "{\"size\": {\"count\": 2, \"min\": 10, "
+		"\"max\": 30, \"sum\": 40}}"),
+		"min, max, and sum of a field are accumulated");
+	ok(strstr(report, "{\"size\": {\"count\": 1, \"min\": -5, "
+		"\"max\": -5, \"sum\": -5}}"),
+		"signed field values are accumulated");
+	ok(strstr(report, "\"count\": 3, \"unmatched-exits\": 1, "
+		"\"min-ns\": 100, \"max-ns\": 250"),
+		"entries and exits are paired per group");
+	ok(strstr(report, "\"percentiles-ns\": {\"50\": 203, \"90\": 250, "
+		"\"99\": 250, \"99.9\": 250}"),
+		"latency percentiles are reported");
+	ok(strcmp(report, expected_json) == 0,
+		"JSON report is the expected one");
+	if (strcmp(report, expected_json) != 0) {
+		diag("Got:\n%s", report);
+	}
+
+	g_free(report);
+}
+
+static
+void test_text_report(const char *path)
+{
+	gchar *report = run_stats("text", path);
+
+	ok(report, "graph with a text statistics sink finishes");
+	if (!report) {
+		skip(4, "No text report");
+		return;
+	}
+
+	ok(strstr(report, "entry (ID 0)\n  tid=1: 2 events, 4000000.000 events/s, "
+		"peak 2 per 1000 ns\n    size: min 10, max 30, sum 40, mean 20\n"),
+		"text report has the per-group count and field statistics");
+	ok(strstr(report, "exit (ID 1)\n"),
+		"text report has all the event classes");
+	ok(strstr(report, "Latency entry -> exit: 3 pairs, 1 unmatched exits\n"),
+		"text report has the latency pair counts");
+	ok(strstr(report, "  min 100 ns, p50 203 ns, p90 250 ns, p99 250 ns, "
+		"p99.9 250 ns, max 250 ns, mean 183 ns\n"),
+		"text report has the latency percentiles");
+	g_free(report);
+}
+
+int main(int argc, char **argv)
+{
+	char path[] = "/tmp/test-utils-stats-XXXXXX";
+	int fd;
+
+	plan_tests(NR_TESTS);
+	fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+	init_static_data();
+	test_histogram();
+	test_json_report(path);
+	test_text_report(path);
+	fini_static_data();
+	unlink(path);
+	return exit_status();
+}